@@ -50,6 +50,7 @@ SOURCES += \
     src/linenumber.cpp \
     src/highlightdata.cpp \
     src/highlight.cpp \
+    src/highlighttokenizer.cpp \
     src/completepopup.cpp \
     src/search.cpp \
     src/linemark.cpp \
@@ -94,7 +95,21 @@ SOURCES += \
     src/plugininterface.cpp \
     src/spellwords.cpp \
     src/virtualinput.cpp \
-    src/welcome.cpp
+    src/welcome.cpp \
+    src/projectindexer.cpp \
+    src/workerlanes.cpp \
+    src/projectindex.cpp \
+    src/projectwatcher.cpp \
+    src/completeindex.cpp \
+    src/highlightworker.cpp \
+    src/highlightbenchmark.cpp \
+    src/parsebenchmark.cpp \
+    src/fileindex.cpp \
+    src/filesearcher.cpp \
+    src/pathfilter.cpp \
+    src/lintserver.cpp \
+    src/spellworker.cpp \
+    src/keywordtable.cpp
 
 HEADERS += \
     include/colordialog.h \
@@ -117,6 +132,7 @@ HEADERS += \
     include/linenumber.h \
     include/highlightdata.h \
     include/highlight.h \
+    include/highlighttokenizer.h \
     include/completepopup.h \
     include/search.h \
     include/linemark.h \
@@ -162,7 +178,21 @@ HEADERS += \
     include/plugininterface.h \
     include/spellwords.h \
     include/virtualinput.h \
-    include/welcome.h
+    include/welcome.h \
+    include/projectindexer.h \
+    include/workerlanes.h \
+    include/projectindex.h \
+    include/projectwatcher.h \
+    include/completeindex.h \
+    include/highlightworker.h \
+    include/highlightbenchmark.h \
+    include/parsebenchmark.h \
+    include/fileindex.h \
+    include/filesearcher.h \
+    include/pathfilter.h \
+    include/lintserver.h \
+    include/spellworker.h \
+    include/keywordtable.h
 
 FORMS += \
     ui/contextdialog.ui \
@@ -0,0 +1,62 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef COMPLETEINDEX_H
+#define COMPLETEINDEX_H
+
+#include <QString>
+#include <map>
+#include <vector>
+
+class CompleteIndex
+{
+public:
+    struct Entry {
+        QString foldedKey;
+        QString key;
+        QString value;
+        quint64 charsMask;
+    };
+    struct Match {
+        const Entry * entry;
+        int score;
+        int source;
+    };
+    class Range
+    {
+    public:
+        Range(const Entry * from, const Entry * to): from(from), to(to) {}
+        const Entry * begin() const { return from; }
+        const Entry * end() const { return to; }
+        bool isEmpty() const { return from == to; }
+    private:
+        const Entry * from;
+        const Entry * to;
+    };
+    CompleteIndex();
+    void build(const std::map<std::string, std::string> & words);
+    void clear();
+    bool isBuilt();
+    Range findPrefix(QString prefix);
+    Range getAll();
+    void findFuzzy(QString pattern, std::vector<Match> & matches, int source = 0);
+    static int fuzzyScore(const Entry & entry, const QString & foldedPattern);
+    static int fuzzyScore(const QString & key, const QString & foldedKey, const QString & foldedPattern);
+    static quint64 getCharsMask(const QString & foldedText);
+protected:
+    static bool compareEntries(const Entry & a, const Entry & b);
+    static bool isWordBoundary(const QString & key, int pos);
+    int lowerBound(const QString & prefix);
+    int prefixEnd(int from, const QString & prefix);
+private:
+    std::vector<Entry> entries;
+    bool built;
+    QString fuzzyPattern;
+    std::vector<int> fuzzyCandidates;
+    bool fuzzyCached;
+};
+
+#endif // COMPLETEINDEX_H
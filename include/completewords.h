@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <map>
 #include "highlightwords.h"
+#include "completeindex.h"
 
 class CompleteWords : public QObject
 {
@@ -19,6 +20,10 @@ public:
     static void loadDelayed();
     static void reload();
     static void reset();
+    CompleteIndex::Range findPrefix(std::map<std::string, std::string> & words, QString prefix);
+    CompleteIndex::Range findAll(std::map<std::string, std::string> & words);
+    std::vector<CompleteIndex::Match> findFuzzy(std::vector<std::map<std::string, std::string> *> wordsList, QString pattern, int limit);
+    void invalidateIndexes();
     std::unordered_map<std::string, std::string> tooltipsPHP;
     std::unordered_map<std::string, std::string>::iterator tooltipsIteratorPHP;
     std::unordered_map<std::string, std::string> htmlTags;
@@ -64,8 +69,11 @@ protected:
     void _reload();
     void _reset();
     void _load();
+    CompleteIndex & getIndex(std::map<std::string, std::string> & words);
+    static bool compareMatches(const CompleteIndex::Match & a, const CompleteIndex::Match & b);
 private:
     CompleteWords();
+    std::unordered_map<const std::map<std::string, std::string> *, CompleteIndex> indexes;
 public slots:
     static void load();
 };
@@ -21,6 +21,7 @@
 #include "completewords.h"
 #include "helpwords.h"
 #include "spellwords.h"
+#include "spellworker.h"
 #include "snippets.h"
 #include "tooltip.h"
 #include "parsephp.h"
@@ -80,6 +81,7 @@ public:
     void addLineMark(int y);
     void setTabIndex(int index);
     int getTabIndex();
+    int getId();
     bool isModified();
     void setModified(bool m);
     void updateSizes(bool updateGeometry = true);
@@ -90,6 +92,8 @@ public:
     void gotoLine(int line, bool focus = true);
     void gotoLineSymbol(int line, int symbol);
     int getCursorLine();
+    int getParseRevision();
+    int updateParseRevision();
     void setParseResult(ParsePHP::ParseResult result);
     void setParseResult(ParseJS::ParseResult result);
     void setParseResult(ParseCSS::ParseResult result);
@@ -108,7 +112,19 @@ public:
     void setIsBigFile(bool isBig);
     void setFileIsDeleted();
     void setFileIsOutdated();
+    void setSharedDocument(Editor * source);
+    Editor * getSharedDocumentEditor();
 protected:
+    struct BlockLayout {
+        int top = 0;
+        int height = 0;
+        int indentSpaces = -1;
+        int indentTabs = 0;
+        int gutterFlags = 0;
+        int gutterRevision = -1;
+        int markRevision = -1;
+        bool valid = false;
+    };
     void focusInEvent(QFocusEvent *e) override;
     void focusOutEvent(QFocusEvent *e) override;
     void keyPressEvent(QKeyEvent *e) override;
@@ -177,12 +193,22 @@ protected:
     QString completeClassNamePHPAtCursor(QTextCursor & curs, QString prevWord, QString nsName);
     void scrollToMiddle(QTextCursor cursor, int line);
     void initSpellChecker();
+    bool collectSpellWords(QTextBlock & block, SpellWorker::Block & snapshot);
+    void applySpellResult(QTextBlock & block, SpellWorker::Result & result);
+    void applySpellResults();
     void suggestWords(QStringList words, int cursorTextPos);
     bool isKnownWord(QString word);
     QString getFixedCompleteClassMethodName(QString clsMethodComplete, QString params);
     QString getFixedCompleteClassConstName(QString clsConstComplete);
     void enableGestures();
     void disableGestures();
+    bool isParseContentChanged(const QString & content);
+    void takeSharedDocument();
+    void sharedDocumentSaved(QString name);
+    BlockLayout getBlockLayout(const QTextBlock & block);
+    int getBlockTop(int blockNumber);
+    int getBlockGutterFlags(int blockNumber);
+    int findGutterFlags(int line);
 public slots:
     void save(QString name = "");
     void back();
@@ -221,11 +247,13 @@ private slots:
     void highlightProgressChanged(int percent);
     void spellProgressChanged(int percent);
     void contentsChange(int position, int charsRemoved, int charsAdded);
+    void documentSizeChanged(const QSizeF & size);
     void duplicateLine();
     void deleteLine();
     void reloadRequested();
-    void spellCheck(bool suggest = false, bool forceRehighlight = true);
+    void spellCheck(bool suggest = false);
     void spellCheckPasted();
+    void spellTimeout();
     void qaBtnClicked();
 private:
     SpellCheckerInterface * spellChecker;
@@ -235,6 +263,7 @@ private:
     SpellWords * SW;
     Snippets * SNP;
     int tabIndex;
+    int editorId;
     std::string tabWidthStr;
     std::string tabTypeStr;
     std::string detectTabTypeStr;
@@ -389,12 +418,22 @@ private:
     int gitAnnotationLastLineNumber;
     bool annotationsEnabled;
     int parseResultChangedDelay;
+    int contentRevision;
+    int parseRevision;
+    QString parseContent;
+    bool parseContentStored;
     bool spellCheckerEnabled;
     bool spellLocked;
     QVector<int> spellBlocksQueue;
     QVector<int> spellPastedBlocksQueue;
     int spellCheckInitBlockNumber;
+    SpellWorker * spellWorker;
+    Editor * documentSource;
+    Editor * documentView;
+    QVector<BlockLayout> blockLayouts;
+    int gutterRevision;
     bool isBigFile;
+    bool lazyHighlightBigFiles;
     int highlightProgressPercent;
     int spellProgressPercent;
     bool drawLongLineMarker;
@@ -409,6 +448,7 @@ private:
     QTextCursor multiSelectCursor;
     int inputEventKey; // workaround for Android
     QTimer mousePressTimer;
+    QTimer spellTimer;
     bool ignoreMouseRelease;
     bool isGesturesEnabled;
     bool searchDisplayOnTop;
@@ -421,9 +461,9 @@ signals:
     void reloaded(int index);
     void showDeclaration(int index, QString name);
     void showHelp(int index, QString name);
-    void parsePHP(int index, QString text);
-    void parseJS(int index, QString text);
-    void parseCSS(int index, QString text);
+    void parsePHP(int editorId, int revision, QString text);
+    void parseJS(int editorId, int revision, QString text);
+    void parseCSS(int editorId, int revision, QString text);
     void undoRedoChanged(int index);
     void backForwardChanged(int index);
     void searchInFiles(QString text);
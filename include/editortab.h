@@ -17,6 +17,14 @@ public:
     explicit EditorTab(QWidget *parent = nullptr);
     void setEditor(Editor * editor);
     Editor * getEditor();
+    void setLazy(QString path);
+    bool isLazy();
+    QString getFilePath();
+    void setLine(int line);
+    int getLine();
+private:
+    QString filePath;
+    int line;
 signals:
 
 public slots:
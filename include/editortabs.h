@@ -9,6 +9,7 @@
 
 #include <QObject>
 #include "editor.h"
+#include "editortab.h"
 
 class EditorTabs : public QObject
 {
@@ -32,6 +33,12 @@ public:
 protected:
     bool eventFilter(QObject *watched, QEvent *event) override;
     Editor * getTabEditor(int index);
+    EditorTab * getLazyTab(int index);
+    int findTab(QString filepath);
+    int createLazyTab(QString filepath);
+    void materializeTab(int index, bool initHighlight);
+    void createTabEditor(EditorTab * tab, int tabIndex);
+    void initTabEditor(EditorTab * tab, int tabIndex, QString filepath, bool initHighlight);
     QString getTabNameFromPath(QString filepath);
     void fileBrowserFileRenamed(QString oldpath, QString newpath);
     void fileBrowserFolderRenamed(QString oldpath, QString newpath);
@@ -45,14 +52,15 @@ signals:
     void tabOpened(int index);
     void tabSwitched(int index);
     void tabClosed(int index);
+    void editorClosed(int editorId);
     void modifiedStateChanged(bool m);
     void editorSaved(int index);
     void editorReady(int index);
     void editorShowDeclaration(QString name);
     void editorShowHelp(QString name);
-    void editorParsePHPRequested(int index, QString text);
-    void editorParseJSRequested(int index, QString text);
-    void editorParseCSSRequested(int index, QString text);
+    void editorParsePHPRequested(int editorId, int revision, QString text);
+    void editorParseJSRequested(int editorId, int revision, QString text);
+    void editorParseCSSRequested(int editorId, int revision, QString text);
     void editorUndoRedoChanged();
     void editorBackForwardChanged();
     void editorSearchInFilesRequested(QString text);
@@ -66,6 +74,8 @@ signals:
     void editorPaneResize();
 public slots:
     void openFile(QString filepath, bool initHighlight = true);
+    void openFiles(QStringList files);
+    void openSharedFile(Editor * sourceEditor);
     void fileBrowserCreated(QString path);
     void fileBrowserRenamed(QString oldpath, QString newpath);
     void fileBrowserDeleted(QString path);
@@ -76,6 +86,7 @@ public slots:
     void close();
     void closeTab(int index);
 private slots:
+    void activateCurrentTab();
     void ready(int index);
     void switchTab(int index);
     void movedTab(int from, int to);
@@ -86,9 +97,9 @@ private slots:
     void reloaded(int index);
     void showDeclaration(int index, QString name);
     void showHelp(int index, QString name);
-    void parsePHP(int index, QString text);
-    void parseJS(int index, QString text);
-    void parseCSS(int index, QString text);
+    void parsePHP(int editorId, int revision, QString text);
+    void parseJS(int editorId, int revision, QString text);
+    void parseCSS(int editorId, int revision, QString text);
     void undoRedoChanged(int index);
     void backForwardChanged(int index);
     void searchInFiles(QString text);
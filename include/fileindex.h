@@ -0,0 +1,66 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef FILEINDEX_H
+#define FILEINDEX_H
+
+#include <QStringList>
+#include <QSet>
+#include <QHash>
+#include <QElapsedTimer>
+#include <vector>
+#include "pathfilter.h"
+
+class FileIndex
+{
+public:
+    struct Entry {
+        QString path;
+        QString relativePath;
+        QString foldedPath;
+        QString name;
+        QString foldedName;
+        quint64 charsMask;
+    };
+    struct Match {
+        const Entry * entry;
+        int score;
+    };
+    FileIndex();
+    void build(QString dir);
+    void clear();
+    bool isBuilt();
+    bool isExpired();
+    QString getPath();
+    int getFilesCount();
+    void update(QStringList paths);
+    void find(QString pattern, std::vector<Match> & matches, int limit);
+protected:
+    static bool compareMatches(const Match & a, const Match & b);
+    static QString getParentPath(const QString & path);
+    void addDirectory(QString dir);
+    void addFile(QString path);
+    void addChild(QString path);
+    void updateDirectory(QString dir);
+    void removePaths(QStringList paths);
+    int score(const Entry & entry, const QString & foldedPattern);
+    void resetFuzzyCache();
+private:
+    QString rootPath;
+    QString rootPrefix;
+    PathFilter filter;
+    std::vector<Entry> entries;
+    QSet<QString> files;
+    QSet<QString> directories;
+    QHash<QString, QSet<QString>> children;
+    QElapsedTimer builtTimer;
+    bool built;
+    QString fuzzyPattern;
+    std::vector<int> fuzzyCandidates;
+    bool fuzzyCached;
+};
+
+#endif // FILEINDEX_H
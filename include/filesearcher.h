@@ -0,0 +1,82 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef FILESEARCHER_H
+#define FILESEARCHER_H
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QVector>
+#include <QStringList>
+#include <QRegularExpression>
+#include "parse.h"
+
+class FileSearcher
+{
+public:
+    struct Result {
+        QString file;
+        QString lineText;
+        int line;
+        int symbol;
+    };
+    typedef QVector<Result> Results;
+    FileSearcher(QString searchText, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp, std::string encoding, std::string encodingFallback);
+    ~FileSearcher();
+    void start();
+    void addFile(QString file);
+    void finish();
+    void cancel();
+    void wait(int msecs);
+    bool takeNext(QString & file, Results & results);
+    bool isDone();
+    int getSearchedCount();
+    int getFilesCount();
+protected:
+    void run();
+    bool takeFile(int & index, QString & file);
+    void searchInFile(QString file, Results & results, QRegularExpression & regexp, Parse & parser);
+    bool isCandidate(const char * data, qint64 size);
+    bool findLiteral(const char * data, qint64 size);
+    static bool isBinary(const char * data, qint64 size);
+    static bool isAsciiCompatible(std::string encoding);
+private:
+    class Task : public QRunnable
+    {
+    public:
+        Task(FileSearcher * searcher);
+        void run() override;
+    private:
+        FileSearcher * searcher;
+    };
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition fileCondition;
+    QWaitCondition readyCondition;
+    QStringList files;
+    QVector<Results> results;
+    QVector<bool> readyList;
+    QAtomicInt searchedCount;
+    QAtomicInt cancelled;
+    int searchIndex;
+    int takeIndex;
+    bool finished;
+    QString searchText;
+    bool searchOptionCase;
+    bool searchOptionWord;
+    bool searchOptionRegexp;
+    QRegularExpression searchExpression;
+    QByteArray literal;
+    bool literalFolding;
+    bool asciiCompatible;
+    std::string encoding;
+    std::string encodingFallback;
+};
+
+#endif // FILESEARCHER_H
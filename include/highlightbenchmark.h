@@ -0,0 +1,36 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef HIGHLIGHTBENCHMARK_H
+#define HIGHLIGHTBENCHMARK_H
+
+#include <QStringList>
+#include <QTextDocument>
+#include <QTextStream>
+#include "highlight.h"
+
+extern const QString HIGHLIGHT_BENCHMARK_ARGUMENT;
+
+class HighlightBenchmark
+{
+public:
+    static bool isRequested(int argc, char *argv[]);
+    static int run(QStringList args);
+protected:
+    static void loadWords();
+    static QString generateCorpus(QString extension);
+    static void benchmark(QTextStream & out, QString name, QString extension, QString text);
+    static int contentsChange(Highlight * highlight, QTextDocument * doc, int position, int charsRemoved, int charsAdded);
+    static QString getUnterminatedComment(QString extension);
+    static int findCommentPosition(QTextDocument * doc, QString extension);
+    static qint64 getHeapUsage();
+    static qint64 getPeakRSS();
+    static QString formatRate(int blocks, qint64 nsecs);
+    static QString formatMsecs(qint64 nsecs);
+    static QString formatBytes(qint64 bytes);
+};
+
+#endif // HIGHLIGHTBENCHMARK_H
@@ -8,23 +8,68 @@
 #define HIGHLIGHTDATA_H
 
 #include <QTextBlockUserData>
+#include <QVector>
+#include <QSet>
 #include <unordered_map>
 
 class HighlightData : public QTextBlockUserData
 {
 public:
+    struct Span {
+        int start;
+        int end;
+        int id;
+    };
+    struct SpecialChar {
+        int pos;
+        QChar c;
+    };
+    struct SpecialWord {
+        int pos;
+        QString word;
+    };
+    struct ExpectedArg {
+        int pos;
+        int block;
+        QString name;
+    };
     HighlightData();
     void reset();
+    static QString intern(const QString & str);
+    static quint8 modeToId(const std::string & mode);
+    static const std::string & idToMode(quint8 id);
+    const std::string & getMode();
+    void setMode(const std::string & mode);
+    const std::string & getPrevMode();
+    void setPrevMode(const std::string & mode);
+    const std::string & getModeExpect();
+    void setModeExpect(const std::string & mode);
+    const std::string & getModeExpectC();
+    void setModeExpectC(const std::string & mode);
+    const std::string & getPrevModeExpect();
+    void setPrevModeExpect(const std::string & mode);
+    const std::string & getPrevModeExpectC();
+    void setPrevModeExpectC(const std::string & mode);
+    void setModeSpans(const QVector<int> & starts, const QVector<int> & ends, const QVector<std::string> & modes);
+    bool findModeSpan(int pos, std::string & mode);
+    void setStateSpans(const QVector<int> & starts, const QVector<int> & ends, const QVector<int> & states);
+    bool findStateSpan(int pos, int & state);
+    void setSpecialChars(const QVector<QChar> & chars, const QVector<int> & positions);
+    int specialCharsCount();
+    QChar specialCharAt(int i);
+    int specialCharPosAt(int i);
+    void setSpecialWords(const QVector<QString> & words, const QVector<int> & positions);
+    int specialWordsCount();
+    QString specialWordAt(int i);
+    int specialWordPosAt(int i);
+    void setExpectedFuncArgsPHP(const QStringList & names, const QVector<int> & positions, const QVector<int> & blocks);
+    void getExpectedFuncArgsPHP(QStringList & names, QVector<int> & positions, QVector<int> & blocks);
+    QString getExpectedFuncArgsPHPChain();
+    qint64 getMemoryUsage(QSet<const void *> * sharedData = nullptr);
     QString stringBlock;
-    QString mode;
-    QString prevMode;
-    QString modeExpect;
-    QString modeExpectC;
     QString modeString;
     QString modeStringC;
-    QString prevModeExpect;
     QString prevModeString;
-    QString prevModeExpectC;
     QString prevModeStringC;
     bool prevModeSkip;
     bool prevModeSkipC;
@@ -32,7 +77,7 @@ public:
     int prevState;
     int prevPrevState;
     QString stringEscStringCSS;
-    QString stringEscStringJS;
+    int stringEscCountJS;
     QString regexpEscStringJS;
     QString regexpPrevCharJS;
     int bracesCSS;
@@ -46,16 +91,6 @@ public:
     bool keywordJSScoped;
     QString exprEscStringJS;
     QString stringEscVariableJS;
-    QVector<QChar> specialChars;
-    QVector<int> specialCharsPos;
-    QVector<QString> specialWords;
-    QVector<int> specialWordsPos;
-    QVector<int> modeStarts;
-    QVector<int> modeEnds;
-    QVector<std::string> modeTags;
-    QVector<int> stateStarts;
-    QVector<int> stateEnds;
-    QVector<int> stateIds;
     bool hasMarkPoint;
     bool isModified;
     QString nsNamePHP;
@@ -80,9 +115,6 @@ public:
     QString expectedClsNamePHP;
     QString expectedFuncNamePHP;
     int expectedFuncParsPHP;
-    QStringList expectedFuncArgsPHP;
-    QVector<int> expectedFuncArgsPHPPositions;
-    QVector<int> expectedFuncArgsPHPBlocks;
     int nsScopePHP;
     int clsScopePHP;
     int funcScopePHP;
@@ -109,7 +141,7 @@ public:
     int expectedFuncParsJS;
     int funcScopeJS;
     QString varsChainJS;
-    QStringList expectedFuncArgsJS;
+    QString expectedFuncArgsChainJS;
     QString mediaNameCSS;
     QVector<int> mediaStartsCSS;
     QVector<int> mediaEndsCSS;
@@ -144,6 +176,18 @@ public:
     QVector<bool> clsOpensJS;
     bool clsOpenJS;
     bool isNewBlock;
+private:
+    quint8 modeId;
+    quint8 prevModeId;
+    quint8 modeExpectId;
+    quint8 modeExpectCId;
+    quint8 prevModeExpectId;
+    quint8 prevModeExpectCId;
+    QVector<Span> modeSpans;
+    QVector<Span> stateSpans;
+    QVector<SpecialChar> specialChars;
+    QVector<SpecialWord> specialWords;
+    QVector<ExpectedArg> expectedFuncArgsPHP;
 };
 
 #endif // HIGHLIGHTDATA_H
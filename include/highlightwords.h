@@ -8,32 +8,16 @@
 #define HIGHLIGHTWORDS_H
 
 #include <QObject>
-#include <unordered_map>
 #include <QTextCharFormat>
 #include "settings.h"
+#include "keywordtable.h"
 
-class HighlightWords : public QObject
+// Formats and keyword tables are changed on the GUI thread only.
+// Workers get a copy, that shares the data until the tables are changed.
+class HighlightWordsData
 {
-    Q_OBJECT
 public:
-    static HighlightWords& instance();
-    static void loadDelayed();
-    static void setColors();
-    static void reload();
-    static void reset();
-    static void addPHPClass(QString k);
-    static void addPHPFunction(QString k);
-    static void addPHPVariable(QString k);
-    static void addPHPConstant(QString k);
-    static void addPHPClassConstant(QString cls, QString c);
-    static void addJSFunction(QString k);
-    static void addJSInterface(QString k);
-    static void addJSObject(QString k);
-    static void addJSExtDartObject(QString k);
-    static void addJSExtDartFunction(QString k);
-    static void addCSSProperty(QString k);
-    static void addHTMLTag(QString k);
-    static void addHTMLShortTag(QString k);
+    HighlightWordsData();
     QTextCharFormat keywordFormat;
     QTextCharFormat classFormat;
     QTextCharFormat variableFormat;
@@ -59,24 +43,40 @@ public:
     QTextCharFormat tabFormat;
     QTextCharFormat colorFormat;
     QTextCharFormat punctuationFormat;
-    std::unordered_map<std::string, QTextCharFormat> phpwords;
-    std::unordered_map<std::string, QTextCharFormat>::iterator phpwordsIterator;
-    std::unordered_map<std::string, QTextCharFormat> phpwordsCS;
-    std::unordered_map<std::string, QTextCharFormat>::iterator phpwordsCSIterator;
-    std::unordered_map<std::string, QTextCharFormat> phpClassWordsCS;
-    std::unordered_map<std::string, QTextCharFormat>::iterator phpClassWordsCSIterator;
-    std::unordered_map<std::string, QTextCharFormat> jswordsCS;
-    std::unordered_map<std::string, QTextCharFormat>::iterator jswordsCSIterator;
-    std::unordered_map<std::string, QTextCharFormat> jsExtDartWordsCS;
-    std::unordered_map<std::string, QTextCharFormat>::iterator jsExtDartWordsCSIterator;
-    std::unordered_map<std::string, QTextCharFormat> csswords;
-    std::unordered_map<std::string, QTextCharFormat>::iterator csswordsIterator;
-    std::unordered_map<std::string, QTextCharFormat> htmlwords;
-    std::unordered_map<std::string, QTextCharFormat>::iterator htmlwordsIterator;
-    std::unordered_map<std::string, QTextCharFormat> htmlshorts;
-    std::unordered_map<std::string, QTextCharFormat>::iterator htmlshortsIterator;
-    std::unordered_map<std::string, QTextCharFormat> generalwords;
-    std::unordered_map<std::string, QTextCharFormat>::iterator generalwordsIterator;
+    KeywordTable phpwords;
+    KeywordTable phpwordsCS;
+    KeywordTable phpClassWordsCS;
+    KeywordTable jswordsCS;
+    KeywordTable jsExtDartWordsCS;
+    KeywordTable csswords;
+    KeywordTable htmlwords;
+    KeywordTable htmlshorts;
+    KeywordTable generalwords;
+    const QTextCharFormat & getFormat(int formatId) const;
+};
+
+class HighlightWords : public QObject, public HighlightWordsData
+{
+    Q_OBJECT
+public:
+    static HighlightWords& instance();
+    static void loadDelayed();
+    static void setColors();
+    static void reload();
+    static void reset();
+    static void addPHPClass(QString k);
+    static void addPHPFunction(QString k);
+    static void addPHPVariable(QString k);
+    static void addPHPConstant(QString k);
+    static void addPHPClassConstant(QString cls, QString c);
+    static void addJSFunction(QString k);
+    static void addJSInterface(QString k);
+    static void addJSObject(QString k);
+    static void addJSExtDartObject(QString k);
+    static void addJSExtDartFunction(QString k);
+    static void addCSSProperty(QString k);
+    static void addHTMLTag(QString k);
+    static void addHTMLShortTag(QString k);
 protected:
     void loadPHPWords();
     void loadJSWords();
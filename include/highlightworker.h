@@ -0,0 +1,56 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef HIGHLIGHTWORKER_H
+#define HIGHLIGHTWORKER_H
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QQueue>
+#include <QStringList>
+#include "highlighttokenizer.h"
+
+class HighlightWorker
+{
+public:
+    struct Result {
+        int blockNumber;
+        QVector<QTextLayout::FormatRange> formats;
+        HighlightData * data;
+    };
+    HighlightWorker(QStringList lines, QString extension, QString fileName, int firstBlockNumber, HighlightData * prevData);
+    ~HighlightWorker();
+    void start();
+    void cancel();
+    bool takeNext(Result & result);
+    static bool isAvailable();
+protected:
+    void run();
+private:
+    class Task : public QRunnable
+    {
+    public:
+        Task(HighlightWorker * worker);
+        void run() override;
+    private:
+        HighlightWorker * worker;
+    };
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition takenCondition;
+    QQueue<Result> results;
+    QAtomicInt cancelled;
+    HighlightWordsData words;
+    HighlightTokenizer tokenizer;
+    QStringList lines;
+    int firstBlockNumber;
+    HighlightData * prevData;
+};
+
+#endif // HIGHLIGHTWORKER_H
@@ -0,0 +1,50 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef KEYWORDTABLE_H
+#define KEYWORDTABLE_H
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QHash>
+
+class QThread;
+
+// Words are added on the thread, that created the table.
+// Other threads read copies, which share the slots until the table is changed.
+class KeywordTable
+{
+public:
+    KeywordTable(bool caseSensitive = true);
+    void add(const QString & word, int formatId);
+    void addStatic(const QString & word, int formatId);
+    void build();
+    void clear();
+    int find(QStringView word) const;
+    bool contains(QStringView word) const;
+protected:
+    struct Entry {
+        QString word;
+        int formatId;
+    };
+    QString foldWord(const QString & word) const;
+    uint hash(QStringView word, uint seed) const;
+    bool equals(const QString & key, QStringView word) const;
+    bool buildSlots(const QVector<Entry> & entries, int slotsCount);
+    void insertDynamic(const Entry & entry);
+    static QChar fold(QChar c);
+private:
+    bool caseSensitive;
+    QThread * ownerThread;
+    QHash<QString, int> staticWords;
+    QVector<uint> staticSeeds;
+    QVector<Entry> staticSlots;
+    QVector<Entry> dynamicSlots;
+    int dynamicCount;
+};
+
+#endif // KEYWORDTABLE_H
@@ -29,6 +29,10 @@ public:
     int getErrorsCount();
     int getWarningsCount();
     int getMarksCount();
+    bool hasMark(int line);
+    bool hasError(int line);
+    bool hasWarning(int line);
+    int getRevision();
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
@@ -41,6 +45,7 @@ private:
     std::unordered_map<int, std::string>::iterator errorsIterator;
     std::unordered_map<int, std::string> warnings;
     std::unordered_map<int, std::string>::iterator warningsIterator;
+    int revision;
 signals:
 
 public slots:
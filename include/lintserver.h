@@ -0,0 +1,31 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef LINTSERVER_H
+#define LINTSERVER_H
+
+#include <QProcess>
+#include <QByteArray>
+
+class LintServer
+{
+public:
+    LintServer(QString phpPath);
+    ~LintServer();
+    bool lint(QString path, QString content, QString & output);
+protected:
+    bool start();
+    void stop();
+    bool request(const QByteArray & data, QByteArray & response);
+    bool readLine(QByteArray & line, int msecs);
+    bool readData(int size, QByteArray & data);
+private:
+    QString phpPath;
+    QProcess * process;
+    bool unsupported;
+};
+
+#endif // LINTSERVER_H
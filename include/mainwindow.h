@@ -32,6 +32,7 @@
 #include "quickaccess.h"
 #include "progressline.h"
 #include "progressinfo.h"
+#include "projectwatcher.h"
 #include "popup.h"
 #include "tabslist.h"
 #include "welcome.h"
@@ -60,6 +61,8 @@ Q_DECLARE_METATYPE(ParsePHP::ParseResult)
 Q_DECLARE_METATYPE(ParseJS::ParseResult)
 Q_DECLARE_METATYPE(ParseCSS::ParseResult)
 Q_DECLARE_METATYPE(WordsMapList)
+Q_DECLARE_METATYPE(FileSearcher::Results)
+Q_DECLARE_METATYPE(FileIndex)
 
 class MainWindow : public QMainWindow
 {
@@ -90,12 +93,14 @@ protected:
     void scrollMessagesTabToTop();
     void parseTab();
     void parseTabSplit();
+    void checkProjectFileSaved(QString fileName);
     void reloadWords();
     QString getGitWorkingDir();
     void runServersCommand(QString command, QString pwd, QString description);
     void compileSass(QString src, QString dst);
     void applyThemeColors(QString pluginsDir, bool light, bool applyFont);
     void applyThemeIcons();
+    void connectParserWorker(ParserWorker * worker, QThread * thread);
     void updateTabsListButton();
     void resetLastSearchParams();
     void showWelcomeScreen();
@@ -202,10 +207,11 @@ private slots:
     void execPHPFinished(int tabIndex, QString output);
     void execPHPWebServerFinished(bool success, QString output);
     void parsePHPCSFinished(int tabIndex, QStringList errorTexts, QStringList errorLines);
-    void parseMixedFinished(int tabIndex, ParsePHP::ParseResult result);
-    void parseJSFinished(int tabIndex, ParseJS::ParseResult result);
-    void parseCSSFinished(int tabIndex, ParseCSS::ParseResult result);
+    void parseMixedFinished(int editorId, int revision, ParsePHP::ParseResult result);
+    void parseJSFinished(int editorId, int revision, ParseJS::ParseResult result);
+    void parseCSSFinished(int editorId, int revision, ParseCSS::ParseResult result);
     void parseProjectFinished(bool success = true, bool isModified = true);
+    void updateProjectFileFinished(QVariantMap oldMap, QVariantMap newMap);
     void projectCreateRequested(QString name, QString path, bool lintEnabled, bool csEnabled);
     void projectEditRequested(QString name, QString path, bool lintEnabled, bool csEnabled);
     void projectOpenRequested(QString path);
@@ -220,13 +226,14 @@ private slots:
     void editorShowHelp(QString name);
     void helpBrowserAnchorClicked(QUrl url);
     void messagesBrowserAnchorClicked(QUrl url);
-    void editorParsePHPRequested(int index, QString text);
-    void editorParseJSRequested(int index, QString text);
-    void editorParseCSSRequested(int index, QString text);
+    void editorParsePHPRequested(int editorId, int revision, QString text);
+    void editorParseJSRequested(int editorId, int revision, QString text);
+    void editorParseCSSRequested(int editorId, int revision, QString text);
     void menuEditOnShow();
     void menuViewOnShow();
     void menuToolsOnShow();
     void searchInFilesFound(QString file, QString lineText, int line, int symbol);
+    void searchInFilesResultsFound(FileSearcher::Results results);
     void searchInFilesFinished();
     void searchListItemDoubleClicked(QListWidgetItem * item);
     void outputDockLocationChanged(Qt::DockWidgetArea area);
@@ -258,6 +265,7 @@ private slots:
     void activateProgressInfo(QString text);
     void updateProgressInfo(QString text);
     void deactivateProgressInfo();
+    void progressInfoCancelled();
     void editorTabsResize();
     //void editorPaneResize();
     void tabsListTriggered();
@@ -276,7 +284,14 @@ private slots:
 private:
     Ui::MainWindow *ui;
     ParserWorker * parserWorker;
+    ParserWorker * lintWorker;
+    ParserWorker * processWorker;
+    ParserWorker * indexWorker;
+    ParserWorker * progressInfoWorker;
     QThread parserThread;
+    QThread lintThread;
+    QThread processThread;
+    QThread indexThread;
     FileBrowser * filebrowser;
     Navigator * navigator;
     GitBrowser * gitBrowser;
@@ -313,10 +328,14 @@ private:
     QuickAccess * qa;
     Popup * popup;
     ProgressLine * progressLine;
+    int progressLineCount;
     ProgressInfo * progressInfo;
+    ProjectWatcher * projectWatcher;
+    bool projectWatchEnabled;
     TabsList * tabsList;
     QStringList args;
     bool tmpDisableParser;
+    QStringList projectUpdateFiles;
     Welcome * welcomeScreen;
     int terminalTabIndex;
     QTabWidget * tabWidgetSplit;
@@ -327,21 +346,23 @@ private:
 signals:
     void initWorker();
     void disableWorker();
-    void parseLint(int tabIndex, QString path);
+    void parseLint(int tabIndex, QString path, QString content);
     void execPHP(int tabIndex, QString path);
     void execSelection(int tabIndex, QString text);
     void startPHPWebServer(QString path);
     void stopPHPWebServer();
     void parsePHPCS(int tabIndex, QString path);
-    void parseMixed(int tabIndex, QString content);
-    void parseJS(int tabIndex, QString content);
-    void parseCSS(int tabIndex, QString content);
+    void parseMixed(int editorId, int revision, QString content);
+    void parseJS(int editorId, int revision, QString content);
+    void parseCSS(int editorId, int revision, QString content);
     void parseProject(QString path);
+    void updateProjectFile(QString path, QString file, ParsePHP::ParseResult result);
+    void checkProjectChanges(QString path, QStringList paths);
     void searchInFiles(QString searchDirectory, QString searchText, QString searchExtensions, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp, QStringList excludeDirs);
     void gitCommand(QString path, QString command, QStringList attrs, bool outputResult = true, bool silent = false);
     void serversCommand(QString command, QString pwd);
     void sassCommand(QString src, QString dst);
-    void quickFind(QString dir, QString text, WordsMapList words, QStringList wordPrefixes);
+    void quickFind(QString dir, QString text, WordsMapList words, QStringList wordPrefixes, bool dirWatched);
     void installAndroidPack();
 };
 
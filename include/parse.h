@@ -8,6 +8,7 @@
 #define PARSE_H
 
 #include <QRegularExpression>
+#include <QVector>
 
 class Parse
 {
@@ -16,9 +17,10 @@ public:
     virtual ~Parse();
     virtual void prepare(QString & text);
     virtual QString strip(QRegularExpressionMatch & match, QString & text, int group);
-    virtual int getLine(QString & text, int offset);
-    virtual QString getLineText(QString & text, int offset);
-    virtual int getFirstNotEmptyLineTo(QString & text, int offset);
+    virtual void buildLineIndex(QString & text);
+    virtual int findLine(int offset);
+    virtual QString findLineText(QString & text, int offset);
+    virtual int findFirstNotEmptyLineTo(QString & text, int offset);
     virtual int findOpenScope(QVector<int> list);
     virtual int findCloseScope(QVector<int> list);
 protected:
@@ -26,6 +28,7 @@ protected:
     QRegularExpression stringSQExpression;
     QRegularExpression commentMLExpression;
     QRegularExpression backtickExpression;
+    QVector<int> lineStarts;
 };
 
 #endif // PARSE_H
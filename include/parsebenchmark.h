@@ -0,0 +1,35 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef PARSEBENCHMARK_H
+#define PARSEBENCHMARK_H
+
+#include <QStringList>
+#include <QTextStream>
+#include <random>
+#include "parsephp.h"
+
+extern const QString PARSE_BENCHMARK_ARGUMENT;
+
+class ParseBenchmark
+{
+public:
+    static bool isRequested(int argc, char *argv[]);
+    static int run(QStringList args);
+protected:
+    static QString generateCorpus();
+    static QString generateSnippet(std::mt19937 & random);
+    static bool checkSnippets(QTextStream & out);
+    static bool benchmark(QTextStream & out, QString name, QString text);
+    static bool checkIncremental(QTextStream & out, QString name, QString text);
+    static QString generateEdit(std::mt19937 & random, QString text);
+    static QStringList describeResult(const ParsePHP::ParseResult & result);
+    static bool compare(ParsePHP & parser, QString text, QString & error);
+    static QString cleanUpLegacy(ParsePHP & parser, QString text);
+    static QString formatMsecs(qint64 nsecs);
+};
+
+#endif // PARSEBENCHMARK_H
@@ -9,6 +9,8 @@
 
 #include "parse.h"
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
 #include <QVector>
 
 extern const QString IMPORT_TYPE_CLASS;
@@ -17,6 +19,7 @@ extern const QString IMPORT_TYPE_CONSTANT;
 
 class ParsePHP : public Parse
 {
+    friend class ParseBenchmark;
 public:
     ParsePHP();
 
@@ -95,12 +98,83 @@ public:
     };
 
     ParsePHP::ParseResult parse(QString text);
+    ParsePHP::ParseResult parseIncremental(QString text);
     static std::unordered_map<std::string, std::string> dataTypes;
 protected:
+    struct DeclarationDependency {
+        int type;
+        std::string key;
+        bool found;
+        QString value;
+    };
+    struct DeclarationEffect {
+        int type;
+        std::string key;
+        int index;
+        QString value;
+    };
+    struct Declaration {
+        int type;
+        int start;
+        int end;
+        int keyStart;
+        int keyEnd;
+        int headerStart;
+        int headerEnd;
+        bool last;
+        bool changesContext;
+        uint context;
+        int resultLine;
+        int resultStart;
+        ParsePHP::ParseResult result;
+        QVector<DeclarationDependency> dependencies;
+        QVector<DeclarationEffect> effects;
+    };
     void reset();
+    void parseText(QString & text, QString & cleanText);
+    int findStatementEnd(const QString & cleanText, int offset, int end);
+    bool splitDeclarations(const QString & text, const QString & cleanText, QVector<Declaration> & list);
+    bool splitClassDeclaration(const QString & text, const QString & cleanText, int start, int end, QVector<Declaration> & list);
+    void addDeclaration(QVector<Declaration> & list, const QString & text, const QString & cleanText, int type, int start, int end, int headerStart = -1, int headerEnd = -1);
+    bool isContextStatement(const QString & cleanText, int start, int end);
+    bool isSameDeclaration(const QString & text, const QString & cleanText, const Declaration & declaration, const QString & oldText, const QString & oldCleanText, const Declaration & oldDeclaration);
+    bool isValidDeclaration(const Declaration & declaration, uint context);
+    QString getDeclarationCode(const QString & cleanText, const Declaration & declaration, int & textOffset);
+    void parseDeclaration(QString & text, const QString & cleanText, Declaration & declaration, QString ns, const std::map<int, std::string> & orderedComments, int fromLine, int toLine);
+    ParsePHP::ParseResult getDeclarationResult();
+    void shiftDeclaration(Declaration & declaration, int lineDelta, int offsetDelta);
+    void appendDeclaration(const Declaration & declaration);
+    static void shiftIndexes(QVector<int> & indexes, int delta);
+    int findVariableIndex(const std::string & key);
+    int findFunctionIndex(const std::string & key);
+    int findClassIndex(const std::string & key);
+    int findNamespaceIndex(const std::string & key);
+    QString findComment(QString & text, int offset);
+    QString getComment(QString & text, int line);
+    void getDependencyValue(int type, const std::string & key, bool & found, QString & value);
+    void recordDependency(int type, const std::string & key);
+    void recordEffect(int type, const std::string & key, int index, QString value = "");
     QString cleanUp(QString text);
+    int getQuoteIndex(QChar c);
+    bool isStringStart(const QString & text, int pos);
+    void skipRegion(const QString & text, int start, int end);
+    int findStringEnd(const QString & text, int pos);
+    bool matchHeredoc(const QString & text, int pos, int & contentStart, int & contentEnd, int & end);
+    bool isHeredocNameChar(QChar c, bool first);
+    bool matchCommentSL(const QString & text, int contentStart, int & contentEnd, int & end);
+    void blank(QString & text, int start, int end);
     bool isValidName(QString name);
-    void parseCode(QString & code, QString & origText, int textOffset);
+    struct Token {
+        Token(): keyword(0) {}
+        bool is(const char * str) const { return text == QLatin1String(str); }
+        QStringRef text;
+        int keyword;
+    };
+    bool isTokenWordChar(QChar c);
+    bool isTokenPunctuation(QChar c);
+    int getKeyword(const QStringRef & text);
+    bool nextToken(const QString & code, int & offset, Token & token);
+    void parseCode(QString & code, QString & origText, int textOffset, QString namespaceName = "");
     QString toAbs(QString ns, QString path, QString type = "");
     void addImport(QString nsName, QString name, QString path, QString type, int line);
     void addNamespace(QString name, int line);
@@ -117,15 +191,11 @@ protected:
 
     QRegularExpression phpExpression;
     QRegularExpression phpStartExpression;
-    QRegularExpression phpEndExpression;
-    QRegularExpression stringHeredocExpression;
-    QRegularExpression stringHeredocDQExpression;
-    QRegularExpression stringNowdocExpression;
-    QRegularExpression commentSLExpression;
-    QRegularExpression commentSLAExpression;
-    QRegularExpression parseExpression;
     QRegularExpression nameExpression;
+    QRegularExpression classHeaderExpression;
 private:
+    QVector<int> quoteOrigins;
+    QVector<int> quoteLastCloses;
     std::unordered_map<std::string, std::string> classAliases;
     std::unordered_map<std::string, std::string>::iterator classAliasesIterator;
     std::unordered_map<std::string, std::string> functionAliases;
@@ -152,6 +222,23 @@ private:
     std::unordered_map<std::string, std::string>::iterator dataTypesIterator;
 
     ParsePHP::ParseResult result;
+
+    QVector<Declaration> declarations;
+    QString declarationsText;
+    QString declarationsCleanText;
+    Declaration * recordDeclaration;
+    std::unordered_set<std::string> recordedKeys;
+    bool classDeclarationSkipped;
+    int declarationLine;
+    QString parsedNamespace;
+    int importsBase;
+    int namespacesBase;
+    int classesBase;
+    int functionsBase;
+    int variablesBase;
+    int constantsBase;
+    int commentsBase;
+    int errorsBase;
 };
 
 #endif // PARSEPHP_H
@@ -9,11 +9,17 @@
 
 #include <QObject>
 #include <QDir>
+#include <QProcess>
+#include <QAtomicInt>
 #include "settings.h"
 #include "parsephp.h"
 #include "parsejs.h"
 #include "parsecss.h"
 #include "types.h"
+#include "fileindex.h"
+#include "filesearcher.h"
+#include "pathfilter.h"
+#include "lintserver.h"
 
 extern const QString PHP_WEBSERVER_URI;
 
@@ -23,13 +29,35 @@ class ParserWorker : public QObject
 public:
     explicit ParserWorker(QObject *parent = nullptr);
     ~ParserWorker();
+    void restorePHPWebServerPid();
 protected:
-    void parseProjectDir(QString dir, QStringList & files);
+    struct ParseRequest {
+        int type;
+        int editorId;
+        int revision;
+        QString text;
+    };
+    struct ParseCache {
+        int type;
+        quint64 textHash;
+        int textLength;
+        ParsePHP::ParseResult phpResult;
+        ParseJS::ParseResult jsResult;
+        ParseCSS::ParseResult cssResult;
+    };
+    void parseProjectDir(QString dir, QStringList & files, PathFilter & filter);
     void parseProjectFile(QString file, QVariantMap & map);
-    void searchInDir(QString searchDirectory, QString searchText, QString searchExtensions, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp, QStringList excludeDirs);
-    void searchInFile(QString file, QString searchText, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp);
-    void searchInFilesResultFound(QString file, QString lineText, int line, int symbol);
-    void quickFindInDir(QString startDir, QString dir, QString text);
+    bool parseProjectFilesParallel(QStringList & files, QVariantMap & map);
+    void updateProjectFiles(QString path, QStringList files, QVariantMap & map);
+    void checkProjectChangesPending();
+    bool waitForProcess(QProcess & process, int msecs = 30000);
+    void queueParseRequest(int type, int editorId, int revision, QString text);
+    bool takeCachedParseResult(const ParseRequest & request, quint64 textHash);
+    void scheduleParseRequests();
+    void searchInDir(FileSearcher & searcher, PathFilter & filter, QString searchDirectory, QString searchExtensions, QStringList excludeDirs);
+    void takeSearchResults(FileSearcher & searcher);
+    void quickFindFiles(QString dir, QString text, bool dirWatched);
+    void quickFindIndexedFiles(QString text);
     bool createAndroidDirectory(QDir rootDir, QString path);
     bool setAndroidFilePermissions(QFile &f);
     bool setAndroidFilePermissions(QString path);
@@ -49,28 +77,43 @@ private:
     std::string encoding;
     std::string encodingFallback;
     bool enabled;
+    bool parallelIndexingEnabled;
     int searchResultsCount;
     bool searchBreaked;
     bool isBusy;
-    int quickResultsCount;
-    bool quickBreaked;
-    bool wantStop;
+    FileIndex fileIndex;
+    QString fileIndexPendingPath;
+    QStringList fileIndexPendingPaths;
+    QString quickFindDir;
+    QString quickFindText;
+    bool quickFindFilesMissed;
+    QAtomicInt wantStop;
+    bool watchPending;
+    QString watchProjectPath;
+    QStringList watchPaths;
+    QList<ParseRequest> parseRequests;
+    QHash<int, ParseCache> parseCache;
+    std::unordered_map<int, ParsePHP> phpParsers;
+    bool parseScheduled;
     QString androidHomePath;
     QStringList androidBinFiles;
     QStringList androidGitFiles;
     QStringList androidOtherFiles;
     qint64 phpWebServerPid;
+    LintServer * lintServer;
 signals:
     void lintFinished(int tabIndex, QStringList errorTexts, QStringList errorLines, QString output);
     void execPHPFinished(int tabIndex, QString output);
     void execPHPWebServerFinished(bool success, QString output);
     void phpcsFinished(int tabIndex, QStringList errorTexts, QStringList errorLines);
-    void parseMixedFinished(int tabIndex, ParsePHP::ParseResult result);
-    void parseJSFinished(int tabIndex, ParseJS::ParseResult result);
-    void parseCSSFinished(int tabIndex, ParseCSS::ParseResult result);
+    void parseMixedFinished(int editorId, int revision, ParsePHP::ParseResult result);
+    void parseJSFinished(int editorId, int revision, ParseJS::ParseResult result);
+    void parseCSSFinished(int editorId, int revision, ParseCSS::ParseResult result);
     void parseProjectFinished(bool success = true, bool isModified = true);
     void parseProjectProgress(int v);
+    void updateProjectFileFinished(QVariantMap oldMap, QVariantMap newMap);
     void searchInFilesFound(QString file, QString lineText, int line, int symbol);
+    void searchInFilesResultsFound(FileSearcher::Results results);
     void searchInFilesFinished();
     void message(QString text);
     void gitCommandFinished(QString command, QString output, bool outputResult = true);
@@ -83,26 +126,38 @@ signals:
     void deactivateProgressInfo();
     void updateProgressInfo(QString text);
     void installAndroidPackFinished(QString result);
+    void fileIndexRequested(QString dir);
+    void fileIndexBuilt(FileIndex index);
+    void toolPathsDetected(QString phpPath, QString gitPath, QString bashPath, QString sasscPath, QString phpcsPath);
 public slots:
     void init();
+    void setToolPaths(QString phpPath, QString gitPath, QString bashPath, QString sasscPath, QString phpcsPath);
     void disable();
-    void lint(int tabIndex, QString path);
+    void lint(int tabIndex, QString path, QString content);
     void execPHP(int tabIndex, QString path);
     void execSelection(int tabIndex, QString text);
     void startPHPWebServer(QString path);
     void stopPHPWebServer();
     void phpcs(int tabIndex, QString path);
-    void parseMixed(int tabIndex, QString text);
-    void parseJS(int tabIndex, QString text);
-    void parseCSS(int tabIndex, QString text);
+    void parseMixed(int editorId, int revision, QString text);
+    void parseJS(int editorId, int revision, QString text);
+    void parseCSS(int editorId, int revision, QString text);
     void parseProject(QString path);
+    void updateProjectFile(QString path, QString file, ParsePHP::ParseResult result);
+    void checkProjectChanges(QString path, QStringList paths);
+    void updateFileIndex(QString path, QStringList paths);
+    void buildFileIndex(QString dir);
+    void setFileIndex(FileIndex index);
     void searchInFiles(QString searchDirectory, QString searchText, QString searchExtensions, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp, QStringList excludeDirs);
     void gitCommand(QString path, QString command, QStringList attrs, bool outputResult = true, bool silent = false);
     void serversCommand(QString command, QString pwd);
     void sassCommand(QString src, QString dst);
-    void quickFind(QString dir, QString text, WordsMapList words, QStringList wordPrefixes);
+    void quickFind(QString dir, QString text, WordsMapList words, QStringList wordPrefixes, bool dirWatched);
     void cancelRequested();
+    void releaseEditor(int editorId);
     void installAndroidPack();
+private slots:
+    void processParseRequests();
 };
 
 #endif // PARSERWORKER_H
@@ -0,0 +1,47 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef PATHFILTER_H
+#define PATHFILTER_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QRegularExpression>
+
+class PathFilter
+{
+public:
+    PathFilter(QString rootDir = "");
+    bool isIgnored(const QString & path, bool isDir);
+    bool isFileTooLarge(qint64 size);
+    QString getRootPath();
+    static bool isExcludedDirectoryName(const QString & name);
+protected:
+    struct Rule {
+        QString pattern;
+        QRegularExpression expression;
+        int type;
+        bool negated;
+        bool directoryOnly;
+        bool anchored;
+    };
+    const QVector<Rule> & getRules(const QString & dir);
+    void loadRulesFile(QString file, QVector<Rule> & rules);
+    bool parseRule(QString line, Rule & rule);
+    int matchRules(const QVector<Rule> & rules, const QString & relativePath, const QString & name, bool isDir);
+    static QString wildcardToPattern(const QString & wildcard);
+    static QString getParentPath(const QString & path);
+    static QString getRelativePath(const QString & dir, const QString & path);
+private:
+    QString rootPath;
+    QString rootPrefix;
+    bool ignoreFilesEnabled;
+    qint64 maxFileSize;
+    QHash<QString, QVector<Rule>> rulesMap;
+};
+
+#endif // PATHFILTER_H
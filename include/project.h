@@ -9,6 +9,7 @@
 
 #include <QObject>
 #include "parsephp.h"
+#include "projectindex.h"
 #include "completewords.h"
 #include "highlightwords.h"
 #include "helpwords.h"
@@ -34,14 +35,17 @@ public:
     bool isPHPLintEnabled();
     bool isPHPCSEnabled();
     void loadWords();
+    void updateWords(QVariantMap oldMap, QVariantMap newMap);
     void deleteDataFile();
     void findDeclaration(QString name, QString & path, int & line);
     static QVariantMap createPHPResultMap();
-    static QVariantMap loadPHPDataMap(QString path);
+    static bool loadPHPDataIndex(QString path, ProjectIndex & index);
     static bool isProjectFile(QString path);
-    static void checkParsePHPFilesModified(QStringList & files, QVariantMap & data, QVariantMap & map);
+    static void checkParsePHPFilesModified(QStringList & files, ProjectIndex & index, QVariantMap & map);
+    static void loadPHPDataIndexFiles(ProjectIndex & index, QStringList files, QVariantMap & map);
     static void parsePHPResult(ParsePHP::ParseResult result, QVariantMap & map, QString path, QString lastModified);
     static void savePHPResults(QString path, QVariantMap & map);
+    static bool updatePHPResults(QString path, ProjectIndex & index, QStringList files, QVariantMap & oldMap, QVariantMap & newMap);
     std::unordered_map<std::string, std::string> phpFunctionDeclarations;
     std::unordered_map<std::string, std::string>::iterator phpFunctionDeclarationsIterator;
     std::unordered_map<std::string, std::string> phpClassMethodDeclarations;
@@ -49,11 +53,20 @@ public:
     std::unordered_map<std::string, std::string> phpClassDeclarations;
     std::unordered_map<std::string, std::string>::iterator phpClassDeclarationsIterator;
 protected:
+    std::unordered_map<std::string, int> phpWordsRefs;
+    std::unordered_map<std::string, int>::iterator phpWordsRefsIterator;
     void reset();
     void loadPHPWords(QString project_dir);
+    void loadPHPWord(QString file, QString k);
+    void unloadPHPWord(QString file, QString k);
+    static QString getPHPWordKey(QString file, QString k);
+    static QStringList getPHPWordsFiles();
+    static QStringList loadPHPWordsLines(QString project_dir, QString file);
+    static void compactPHPWordsFile(QString project_dir, QString file);
+    static void loadPHPDataIndexRecords(ProjectIndex & index, QVector<bool> & files, QVariantMap & map);
     bool updateMetaFile(QString name, QString path, bool lintEnabled, bool csEnabled, QString time_created, QString time_modified, QStringList openTabFiles, QList<int> openTabLines, int currentTabIndex, QString todo);
-    static std::unordered_map<std::string, std::string> getPHPFilesMapFromData(QVariantMap & data);
     static void preparePHPResults(QString project_dir, QVariantMap & map);
+    static QMap<QString, QString> createPHPResultsData(QVariantMap & map);
     static void preparePHPClasses(QString cls_name, QVariantMap cls, QString & cls_args, QString & class_consts_str, QString & class_properties_str, QString & class_methods_str, QString & class_method_types_str, QString & class_methods_search_str, QString & class_methods_help_str,std::unordered_map<std::string, std::string> & cls_methods_map, std::unordered_map<std::string, std::string> & cls_props_map, std::unordered_map<std::string, std::string> & cls_consts_map);
 private:
     Project();
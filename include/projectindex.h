@@ -0,0 +1,182 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef PROJECTINDEX_H
+#define PROJECTINDEX_H
+
+#include <QFile>
+#include <QVariantMap>
+#include <QHash>
+#include <QVector>
+#include <QStringList>
+#include <QSet>
+
+extern const QString PROJECT_INDEX_OVERLAY_SUFFIX;
+
+class ProjectIndex
+{
+public:
+    ProjectIndex();
+    ~ProjectIndex();
+    bool load(QString filename);
+    void close();
+    bool isLoaded();
+    static bool save(QString filename, QVariantMap & map);
+    bool update(QString filename, QStringList paths, QVariantMap & map);
+    int getFilesCount();
+    int findFile(QString path);
+    QStringList getDirectoryFiles(QString dir);
+    QStringList getDirectoryFilesRecursive(QString dir);
+    QStringList getDirectorySubdirs(QString dir);
+    QString getFilePath(int index);
+    qint64 getFileLastModified(int index);
+    int getConstantsCount();
+    int getConstantFile(int index);
+    QVariantMap getConstant(int index);
+    int getGlobalsCount();
+    int getGlobalFile(int index);
+    QVariantMap getGlobal(int index);
+    int getFunctionsCount();
+    int getFunctionFile(int index);
+    QVariantMap getFunction(int index);
+    int getClassesCount();
+    int getClassFile(int index);
+    QVariantMap getClass(int index);
+protected:
+    enum Section {
+        SECTION_STRINGS = 0,
+        SECTION_CHARS,
+        SECTION_FILES,
+        SECTION_CONSTANTS,
+        SECTION_GLOBALS,
+        SECTION_FUNCTIONS,
+        SECTION_CLASSES,
+        SECTION_CLASS_CONSTANTS,
+        SECTION_CLASS_PROPERTIES,
+        SECTION_CLASS_METHODS,
+        SECTION_CLASS_INTERFACES,
+        SECTIONS_COUNT
+    };
+    struct SectionRecord {
+        quint32 offset;
+        quint32 count;
+    };
+    struct Header {
+        char magic[4];
+        quint32 version;
+        quint32 byteOrder;
+        quint32 sectionsCount;
+        SectionRecord sections[SECTIONS_COUNT];
+    };
+    struct StringRecord {
+        quint32 offset;
+        quint32 length;
+    };
+    struct FileRecord {
+        quint32 path;
+        quint32 reserved;
+        qint64 lastModified;
+    };
+    struct ConstantRecord {
+        quint32 name;
+        quint32 value;
+        quint32 file;
+        qint32 line;
+    };
+    struct VariableRecord {
+        quint32 name;
+        quint32 type;
+        quint32 visibility;
+        quint32 file;
+        qint32 line;
+    };
+    struct FunctionRecord {
+        quint32 name;
+        quint32 args;
+        quint32 synopsis;
+        quint32 returnType;
+        quint32 comment;
+        quint32 visibility;
+        quint32 file;
+        qint32 line;
+        quint32 flags;
+    };
+    struct ClassRecord {
+        quint32 name;
+        quint32 parent;
+        quint32 file;
+        qint32 line;
+        quint32 flags;
+        quint32 interfacesStart;
+        quint32 interfacesCount;
+        quint32 constantsStart;
+        quint32 constantsCount;
+        quint32 propertiesStart;
+        quint32 propertiesCount;
+        quint32 methodsStart;
+        quint32 methodsCount;
+    };
+    struct Builder {
+        QHash<QString, quint32> ids;
+        QHash<QString, quint32> fileIds;
+        QVector<quint32> stringIdsMap;
+        QVector<StringRecord> strings;
+        QVector<QChar> chars;
+        QVector<FileRecord> files;
+        QVector<ConstantRecord> constants;
+        QVector<VariableRecord> globals;
+        QVector<FunctionRecord> functions;
+        QVector<ClassRecord> classes;
+        QVector<ConstantRecord> classConstants;
+        QVector<VariableRecord> classProperties;
+        QVector<FunctionRecord> classMethods;
+        QVector<quint32> classInterfaces;
+    };
+    const void * getSection(Section section, int & count);
+    QString getString(quint32 id);
+    QString getFileString(quint32 id);
+    int compareFilePath(int index, QString path);
+    int findFilePosition(QString path);
+    QVariantMap constantToMap(const ConstantRecord & record);
+    QVariantMap variableToMap(const VariableRecord & record);
+    QVariantMap functionToMap(const FunctionRecord & record);
+    static quint32 addString(QString str, Builder & builder);
+    quint32 copyString(quint32 id, Builder & builder);
+    void copyStrings(ConstantRecord & record, Builder & builder);
+    void copyStrings(VariableRecord & record, Builder & builder);
+    void copyStrings(FunctionRecord & record, Builder & builder);
+    static quint32 fileId(QString path, Builder & builder);
+    static quint32 remapFileId(quint32 id, QVector<quint32> & fileIdsMap);
+    static void appendFile(QString path, QVariantMap & php_files, Builder & builder);
+    static ConstantRecord createConstantRecord(QVariantMap & data, Builder & builder);
+    static VariableRecord createVariableRecord(QVariantMap & data, Builder & builder);
+    static FunctionRecord createFunctionRecord(QVariantMap & data, Builder & builder);
+    static ClassRecord createClassRecord(QVariantMap & data, Builder & builder);
+    static void addFiles(QVariantMap & map, QStringList removedPaths, Builder & builder);
+    static void addRecords(QVariantMap & map, Builder & builder);
+    static void appendSection(QByteArray & data, Header & header, Section section, const void * records, int count, int recordSize);
+    static bool write(QString filename, Builder & builder);
+    bool loadSegment(QString filename);
+    bool rebuild(QString filename, QStringList paths, QVariantMap & map);
+    void appendOverlayRecords(QStringList & paths, QVariantMap & map);
+    bool isFileRemoved(int index);
+    int baseFileIndex(quint32 id);
+    int overlayFileIndex(int index);
+private:
+    QFile file;
+    uchar * data;
+    qint64 dataSize;
+    const StringRecord * strings;
+    int stringsCount;
+    const QChar * chars;
+    int charsCount;
+    const FileRecord * files;
+    int filesCount;
+    ProjectIndex * overlay;
+    QSet<int> shadowedFiles;
+};
+
+#endif // PROJECTINDEX_H
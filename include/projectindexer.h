@@ -0,0 +1,55 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef PROJECTINDEXER_H
+#define PROJECTINDEXER_H
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QVector>
+#include "parsephp.h"
+
+class ProjectIndexer
+{
+public:
+    ProjectIndexer(QStringList files, std::string encoding, std::string encodingFallback);
+    ~ProjectIndexer();
+    void start();
+    void cancel();
+    void wait(int msecs);
+    bool takeNext(QString & file, ParsePHP::ParseResult & result, QString & lastModified);
+    int getParsedCount();
+    static bool isAvailable();
+protected:
+    void run();
+private:
+    class Task : public QRunnable
+    {
+    public:
+        Task(ProjectIndexer * indexer);
+        void run() override;
+    private:
+        ProjectIndexer * indexer;
+    };
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition readyCondition;
+    QStringList files;
+    QVector<ParsePHP::ParseResult> results;
+    QVector<QString> lastModifiedList;
+    QVector<bool> readyList;
+    QAtomicInt nextIndex;
+    QAtomicInt parsedCount;
+    QAtomicInt cancelled;
+    int takeIndex;
+    std::string encoding;
+    std::string encodingFallback;
+};
+
+#endif // PROJECTINDEXER_H
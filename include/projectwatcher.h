@@ -0,0 +1,49 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef PROJECTWATCHER_H
+#define PROJECTWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QStringList>
+#include <QHash>
+#include "pathfilter.h"
+
+class ProjectWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProjectWatcher(QObject *parent = nullptr);
+    void watch(QString path);
+    void unwatch();
+    QString getPath();
+protected:
+    void addDirectory(QString dir, QStringList & paths);
+    void addPaths(QStringList & paths);
+    void queuePath(QString path);
+    void addPollDirectory(QString dir);
+private:
+    QFileSystemWatcher * watcher;
+    QTimer debounceTimer;
+    QTimer pollTimer;
+    QString projectPath;
+    PathFilter filter;
+    QStringList changedPaths;
+    QHash<QString, qint64> directoryTimes;
+    bool polling;
+    int pollCount;
+signals:
+    void changesDetected(QString path, QStringList paths);
+private slots:
+    void directoryChanged(const QString & path);
+    void fileChanged(const QString & path);
+    void debounceTimeout();
+    void pollTimeout();
+};
+
+#endif // PROJECTWATCHER_H
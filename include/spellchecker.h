@@ -1,6 +1,8 @@
 #ifndef SPELLCHECKER_H
 #define SPELLCHECKER_H
 
+#include <QCache>
+#include <QMutex>
 #include "helper.h"
 
 class SpellChecker
@@ -9,9 +11,19 @@ public:
     static SpellChecker& instance();
     SpellCheckerInterface * load();
     SpellCheckerInterface * getSpellChecker();
+    bool check(const QString & word);
+    QStringList suggest(const QString & word);
 private:
     SpellChecker();
+    struct Verdict {
+        bool correct;
+        bool suggested;
+        QStringList suggestions;
+    };
+    Verdict * findVerdict(const QString & word);
     SpellCheckerInterface * spellChecker;
+    QMutex mutex;
+    QCache<QString, Verdict> verdicts;
 };
 
 #endif // SPELLCHECKER_H
@@ -0,0 +1,71 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef SPELLWORKER_H
+#define SPELLWORKER_H
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QQueue>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+class SpellWorker
+{
+public:
+    struct Word {
+        QString text;
+        int start;
+        int length;
+        bool suggest;
+    };
+    struct Block {
+        int number;
+        int revision;
+        QVector<Word> words;
+        int suggestWord;
+    };
+    struct Result {
+        int blockNumber;
+        int revision;
+        QVector<int> starts;
+        QVector<int> lengths;
+        int suggestStart;
+        int suggestEnd;
+        QStringList suggestions;
+    };
+    SpellWorker();
+    ~SpellWorker();
+    void addBlocks(const QVector<Block> & snapshots, bool urgent = false);
+    bool takeNext(Result & result);
+    bool isIdle();
+    void clear();
+protected:
+    static QThreadPool * sharedPool();
+    void run();
+    bool takeBlock(Block & block);
+private:
+    class Task : public QRunnable
+    {
+    public:
+        Task(SpellWorker * worker);
+        void run() override;
+    private:
+        SpellWorker * worker;
+    };
+    QMutex mutex;
+    QWaitCondition finished;
+    QQueue<Block> blocks;
+    QQueue<Result> results;
+    QAtomicInt cancelled;
+    bool running;
+};
+
+#endif // SPELLWORKER_H
@@ -0,0 +1,28 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#ifndef WORKERLANES_H
+#define WORKERLANES_H
+
+#include <QAtomicInt>
+
+extern const int WORKER_LANE_INTERACTIVE;
+extern const int WORKER_LANE_LINT;
+extern const int WORKER_LANE_INDEX;
+
+class WorkerLanes
+{
+public:
+    static void setPending(int lane, int count);
+    static void acquire(int lane);
+    static void release(int lane);
+    static bool hasPriorityWork(int lane);
+    static void yield(int lane, QAtomicInt & cancelled);
+private:
+    static QAtomicInt pending[3];
+};
+
+#endif // WORKERLANES_H
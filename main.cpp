@@ -8,10 +8,20 @@
 #include <QApplication>
 #include "settings.h"
 #include "helper.h"
+#include "highlightbenchmark.h"
+#include "parsebenchmark.h"
 
 int main(int argc, char *argv[])
 {
     Helper::setApplicationAttributes();
+    if (HighlightBenchmark::isRequested(argc, argv)) {
+        QApplication a(argc, argv);
+        return HighlightBenchmark::run(a.arguments());
+    }
+    if (ParseBenchmark::isRequested(argc, argv)) {
+        QApplication a(argc, argv);
+        return ParseBenchmark::run(a.arguments());
+    }
     int exitCode = 0;
     do {
         Settings::initApplicationScaling();
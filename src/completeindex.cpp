@@ -0,0 +1,183 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "completeindex.h"
+#include <algorithm>
+
+const int FUZZY_SCORE_MATCH = 16;
+const int FUZZY_SCORE_CONSECUTIVE = 24;
+const int FUZZY_SCORE_BOUNDARY = 32;
+const int FUZZY_SCORE_START = 48;
+const int FUZZY_SCORE_PREFIX = 1000;
+const int FUZZY_SCORE_EXACT = 2000;
+const int FUZZY_PENALTY_GAP = 1;
+const int FUZZY_PENALTY_GAP_MAX = 40;
+
+CompleteIndex::CompleteIndex(): built(false), fuzzyCached(false)
+{
+
+}
+
+bool CompleteIndex::compareEntries(const Entry & a, const Entry & b)
+{
+    return a.foldedKey < b.foldedKey;
+}
+
+void CompleteIndex::build(const std::map<std::string, std::string> & words)
+{
+    entries.clear();
+    entries.reserve(words.size());
+    for (auto & it : words) {
+        Entry entry;
+        entry.key = QString::fromStdString(it.first);
+        entry.foldedKey = entry.key.toCaseFolded();
+        entry.value = QString::fromStdString(it.second);
+        entry.charsMask = getCharsMask(entry.foldedKey);
+        entries.push_back(entry);
+    }
+    // keys with the same folded prefix are stored in a row
+    std::stable_sort(entries.begin(), entries.end(), compareEntries);
+    built = true;
+    fuzzyCached = false;
+    fuzzyCandidates.clear();
+}
+
+void CompleteIndex::clear()
+{
+    entries.clear();
+    built = false;
+    fuzzyCached = false;
+    fuzzyCandidates.clear();
+}
+
+bool CompleteIndex::isBuilt()
+{
+    return built;
+}
+
+int CompleteIndex::lowerBound(const QString & prefix)
+{
+    int lo = 0, hi = static_cast<int>(entries.size());
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (entries[static_cast<size_t>(mid)].foldedKey < prefix) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int CompleteIndex::prefixEnd(int from, const QString & prefix)
+{
+    int lo = from, hi = static_cast<int>(entries.size());
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (entries[static_cast<size_t>(mid)].foldedKey.startsWith(prefix)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+CompleteIndex::Range CompleteIndex::findPrefix(QString prefix)
+{
+    if (entries.size() == 0) return Range(nullptr, nullptr);
+    QString foldedPrefix = prefix.toCaseFolded();
+    int from = lowerBound(foldedPrefix);
+    int to = prefixEnd(from, foldedPrefix);
+    return Range(entries.data() + from, entries.data() + to);
+}
+
+CompleteIndex::Range CompleteIndex::getAll()
+{
+    if (entries.size() == 0) return Range(nullptr, nullptr);
+    return Range(entries.data(), entries.data() + entries.size());
+}
+
+quint64 CompleteIndex::getCharsMask(const QString & foldedText)
+{
+    // one bit per latin letter, digit and underscore, the rest share two bits
+    quint64 mask = 0;
+    for (int i=0; i<foldedText.size(); i++) {
+        ushort c = foldedText[i].unicode();
+        if (c >= 'a' && c <= 'z') mask |= (1ULL << (c - 'a'));
+        else if (c >= '0' && c <= '9') mask |= (1ULL << (26 + c - '0'));
+        else if (c == '_') mask |= (1ULL << 36);
+        else if (c < 128) mask |= (1ULL << 37);
+        else mask |= (1ULL << 38);
+    }
+    return mask;
+}
+
+bool CompleteIndex::isWordBoundary(const QString & key, int pos)
+{
+    if (pos == 0) return true;
+    QChar prev = key[pos-1];
+    QChar c = key[pos];
+    if (prev == "_" || prev == "\\" || prev == "/" || prev == ":" || prev == "$" || prev == "-" || prev == "." || prev == " ") return true;
+    if (c.isUpper() && prev.isLower()) return true;
+    if (c.isLetter() && prev.isDigit()) return true;
+    return false;
+}
+
+int CompleteIndex::fuzzyScore(const Entry & entry, const QString & foldedPattern)
+{
+    return fuzzyScore(entry.key, entry.foldedKey, foldedPattern);
+}
+
+int CompleteIndex::fuzzyScore(const QString & key, const QString & foldedKey, const QString & foldedPattern)
+{
+    int patternSize = foldedPattern.size();
+    int keySize = foldedKey.size();
+    if (patternSize == 0 || patternSize > keySize) return -1;
+    int score = 0, lastPos = -1, gaps = 0;
+    for (int i=0; i<patternSize; i++) {
+        int pos = foldedKey.indexOf(foldedPattern[i], lastPos + 1);
+        if (pos < 0) return -1;
+        score += FUZZY_SCORE_MATCH;
+        if (pos == 0) score += FUZZY_SCORE_START;
+        if (lastPos >= 0 && pos == lastPos + 1) score += FUZZY_SCORE_CONSECUTIVE;
+        else if (isWordBoundary(key, pos)) score += FUZZY_SCORE_BOUNDARY;
+        if (lastPos >= 0) gaps += pos - lastPos - 1;
+        lastPos = pos;
+    }
+    score -= std::min(gaps * FUZZY_PENALTY_GAP, FUZZY_PENALTY_GAP_MAX);
+    if (foldedKey.startsWith(foldedPattern)) {
+        score += patternSize == keySize ? FUZZY_SCORE_EXACT : FUZZY_SCORE_PREFIX;
+    }
+    return score;
+}
+
+void CompleteIndex::findFuzzy(QString pattern, std::vector<Match> & matches, int source)
+{
+    if (entries.size() == 0) return;
+    QString foldedPattern = pattern.toCaseFolded();
+    if (foldedPattern.size() == 0) return;
+    quint64 mask = getCharsMask(foldedPattern);
+    std::vector<int> candidates;
+    // a key matching the longer pattern also matches its prefix,
+    // so the previous candidates are refined instead of scanning all
+    if (fuzzyCached && foldedPattern.startsWith(fuzzyPattern)) {
+        for (int i : fuzzyCandidates) {
+            const Entry & entry = entries[static_cast<size_t>(i)];
+            if ((entry.charsMask & mask) != mask) continue;
+            int score = fuzzyScore(entry, foldedPattern);
+            if (score < 0) continue;
+            candidates.push_back(i);
+            matches.push_back(Match{& entry, score, source});
+        }
+    } else {
+        for (size_t i=0; i<entries.size(); i++) {
+            const Entry & entry = entries[i];
+            if ((entry.charsMask & mask) != mask) continue;
+            int score = fuzzyScore(entry, foldedPattern);
+            if (score < 0) continue;
+            candidates.push_back(static_cast<int>(i));
+            matches.push_back(Match{& entry, score, source});
+        }
+    }
+    fuzzyPattern = foldedPattern;
+    fuzzyCandidates.swap(candidates);
+    fuzzyCached = true;
+}
@@ -10,6 +10,7 @@
 #include <QFile>
 #include <QTextStream>
 #include <QTimer>
+#include <algorithm>
 
 const int LOAD_DELAY = 250; // should not be less then PROJECT_LOAD_DELAY
 
@@ -43,6 +44,7 @@ void CompleteWords::_load()
     loadJSWords();
     loadFlutterWords();
     loadPHPWords();
+    invalidateIndexes();
 }
 
 void CompleteWords::reload()
@@ -86,6 +88,56 @@ void CompleteWords::_reset()
     phpClassMethodsComplete.clear();
     phpGlobalsComplete.clear();
     phpSpecialsComplete.clear();
+    invalidateIndexes();
+}
+
+CompleteIndex & CompleteWords::getIndex(std::map<std::string, std::string> & words)
+{
+    // indexes are built on first lookup
+    CompleteIndex & index = indexes[& words];
+    if (!index.isBuilt()) index.build(words);
+    return index;
+}
+
+CompleteIndex::Range CompleteWords::findPrefix(std::map<std::string, std::string> & words, QString prefix)
+{
+    return getIndex(words).findPrefix(prefix);
+}
+
+CompleteIndex::Range CompleteWords::findAll(std::map<std::string, std::string> & words)
+{
+    return getIndex(words).getAll();
+}
+
+bool CompleteWords::compareMatches(const CompleteIndex::Match & a, const CompleteIndex::Match & b)
+{
+    if (a.score != b.score) return a.score > b.score;
+    if (a.entry->key.size() != b.entry->key.size()) return a.entry->key.size() < b.entry->key.size();
+    if (a.source != b.source) return a.source < b.source;
+    return a.entry->foldedKey < b.entry->foldedKey;
+}
+
+std::vector<CompleteIndex::Match> CompleteWords::findFuzzy(std::vector<std::map<std::string, std::string> *> wordsList, QString pattern, int limit)
+{
+    std::vector<CompleteIndex::Match> matches;
+    for (size_t i=0; i<wordsList.size(); i++) {
+        getIndex(* wordsList[i]).findFuzzy(pattern, matches, static_cast<int>(i));
+    }
+    // only the best matches are sorted
+    if (limit >= 0 && matches.size() > static_cast<size_t>(limit)) {
+        std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), compareMatches);
+        matches.resize(static_cast<size_t>(limit));
+    } else {
+        std::sort(matches.begin(), matches.end(), compareMatches);
+    }
+    return matches;
+}
+
+void CompleteWords::invalidateIndexes()
+{
+    for (auto & it : indexes) {
+        it.second.clear();
+    }
 }
 
 void CompleteWords::loadCSSWords()
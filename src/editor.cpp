@@ -32,6 +32,7 @@
 #include <QInputDialog>
 #include <QAction>
 #include <QScreen>
+#include <QSet>
 #include "math.h"
 #include "helper.h"
 #include "icon.h"
@@ -47,7 +48,8 @@ const int INTERVAL_TEXT_CHANGED_MILLISECONDS = 200;
 const int INTERVAL_CURSOR_POS_CHANGED_MILLISECONDS = 200;
 const int INTERVAL_SPELL_CHECK_MILLISECONDS = 500;
 
-const int SPELLCHECKER_INIT_BLOCKS_COUNT = 10;
+const int SPELLCHECKER_WORKER_INTERVAL = 50;
+const int SPELLCHECKER_SLICE_MILLISECONDS = 20;
 
 const int TOOLTIP_OFFSET = 20;
 const int TOOLTIP_SCREEN_MARGIN = 10;
@@ -60,6 +62,18 @@ const int LINE_MAP_WIDGET_WIDTH = 20;
 const int SEARCH_WIDGET_HEIGHT = 100;
 const int BREADCRUMBS_WIDGET_HEIGHT = 21;
 
+// parse results are routed by id, tab indexes are reused
+int editorIdCounter = 0;
+
+const int GUTTER_FLAG_GIT_LINE = 1;
+const int GUTTER_FLAG_GIT_MODIFIED = 2;
+const int GUTTER_FLAG_GIT_DELETED = 4;
+const int GUTTER_FLAG_MODIFIED = 8;
+const int GUTTER_FLAG_ERROR = 16;
+const int GUTTER_FLAG_WARNING = 32;
+const int GUTTER_FLAG_MARK = 64;
+const int GUTTER_FLAG_MARK_POINT = 128;
+
 const int LINE_MAP_LINE_NUMBER_OFFSET = 10;
 const int LINE_MAP_PROGRESS_WIDTH = 3;
 const int LINE_MAP_PROGRESS_HEIGHT = 50;
@@ -80,7 +94,7 @@ const int FIRST_BLOCK_BIN_SEARCH_SCROLL_VALUE = 300;
 const QString SNIPPET_PREFIX = "Snippet: @";
 
 Editor::Editor(QWidget * parent):
-    QTextEdit(parent), mousePressTimer(this)
+    QTextEdit(parent), mousePressTimer(this), spellTimer(this)
 {
     setMinimumSize(0, 0);
     setMaximumSize(16777215, 16777215);
@@ -296,11 +310,16 @@ Editor::Editor(QWidget * parent):
     if (experimentalModeStr == "yes") experimentalMode = true;
     #endif
 
+    std::string lazyHighlightStr = Settings::get("highlight_lazy_big_files");
+    if (lazyHighlightStr == "yes") lazyHighlightBigFiles = true;
+    else lazyHighlightBigFiles = false;
+
     // highlighter
     highlight = new Highlight(document());
     std::string unusedVariableColorStr = Settings::get("highlight_unused_variable_color");
     unusedVariableColor = QColor(unusedVariableColorStr.c_str());
     connect(document(), SIGNAL(contentsChange(int,int,int)), this, SLOT(contentsChange(int,int,int)));
+    connect(document()->documentLayout(), SIGNAL(documentSizeChanged(QSizeF)), this, SLOT(documentSizeChanged(QSizeF)));
     connect(highlight, SIGNAL(progressChanged(int)), this, SLOT(highlightProgressChanged(int)));
 
     // update area slots
@@ -438,7 +457,12 @@ Editor::Editor(QWidget * parent):
     scrollBarValueChangeLocked = false;
     overwrite = false;
     tabIndex = -1;
+    editorId = ++editorIdCounter;
     parseLocked = false;
+    contentRevision = 0;
+    parseRevision = 0;
+    parseContent = "";
+    parseContentStored = false;
     isUndoAvailable = false;
     isRedoAvailable = false;
     lastCursorPositionBlockNumber = -1;
@@ -494,6 +518,12 @@ Editor::Editor(QWidget * parent):
     std::string spellCheckerEnabledStr = Settings::get("spellchecker_enabled");
     if (spellCheckerEnabledStr == "yes") spellCheckerEnabled = true;
     spellChecker = SpellChecker::instance().getSpellChecker();
+    spellWorker = nullptr;
+    documentSource = nullptr;
+    documentView = nullptr;
+    gutterRevision = 0;
+    spellTimer.setInterval(SPELLCHECKER_WORKER_INTERVAL);
+    connect(&spellTimer, SIGNAL(timeout()), this, SLOT(spellTimeout()));
 
     drawLongLineMarker = false;
     std::string drawLongLineMarkerStr = Settings::get("editor_long_line_marker_enabled");
@@ -525,7 +555,14 @@ Editor::Editor(QWidget * parent):
 
 Editor::~Editor()
 {
-    delete highlight;
+    if (spellWorker != nullptr) delete spellWorker;
+    if (documentSource != nullptr) {
+        documentSource->documentView = nullptr;
+    } else if (documentView != nullptr) {
+        documentView->takeSharedDocument();
+    } else {
+        delete highlight;
+    }
 }
 
 void Editor::init()
@@ -544,6 +581,11 @@ int Editor::getTabIndex()
     return tabIndex;
 }
 
+int Editor::getId()
+{
+    return editorId;
+}
+
 void Editor::setTabsSettings()
 {
     tabWidth = std::stoi(tabWidthStr);
@@ -588,10 +630,14 @@ void Editor::reset()
     static_cast<LineMark *>(lineMark)->clear();
     markPoints.clear();
     modifiedLines.clear();
+    blockLayouts.clear();
+    gutterRevision++;
     modified = false;
     lastModifiedMsec = 0;
     warningDisplayed = false;
     parseLocked = false;
+    parseContent = "";
+    parseContentStored = false;
     isUndoAvailable = false;
     isRedoAvailable = false;
     backPositions.clear();
@@ -604,6 +650,8 @@ void Editor::reset()
     spellLocked = false;
     spellBlocksQueue.clear();
     spellPastedBlocksQueue.clear();
+    spellTimer.stop();
+    if (spellWorker != nullptr) spellWorker->clear();
     errorsExtraSelections.clear();
     spellCheckInitBlockNumber = 0;
     highlightProgressPercent = 0;
@@ -715,44 +763,175 @@ void Editor::initMode(QString ext)
 void Editor::initHighlighter()
 {
     if (highlighterInitialized) return;
+    if (documentSource != nullptr) {
+        // shared document is highlighted by its source editor
+        if (!documentSource->isReady()) return;
+        highlighterInitialized = true;
+        setReadOnly(false);
+        emit statusBarText(tabIndex, "");
+        is_ready = true;
+        cursorPositionChangedDelayed();
+        emit ready(tabIndex);
+        if (highlight->getModeType() == MODE_MIXED) highlightUnusedVars(false);
+        initSpellChecker();
+        return;
+    }
     highlighterInitialized = true;
 
-    highlight->setIsBigFile(isBigFile);
+    // big files are highlighted in full, visible blocks first
+    bool lazyHighlight = isBigFile && lazyHighlightBigFiles && document()->characterCount() >= BIG_FILE_SIZE;
+    highlight->setIsBigFile(isBigFile && !lazyHighlight);
     highlight->initMode(extension, getLastVisibleBlockIndex());
 
     bool isFocused = hasFocus();
     int line = getCursorLine();
-    highlight->setFirstRunMode(true);
-    highlight->rehighlight();
-    highlight->setFirstRunMode(false);
+    if (lazyHighlight) {
+        highlight->rehighlightLazy(getLastVisibleBlockIndex());
+    } else {
+        highlight->setFirstRunMode(true);
+        highlight->rehighlight();
+        highlight->setFirstRunMode(false);
+    }
     if (line > 1) gotoLine(line, false);
     if (isFocused) setFocus();
 
     setReadOnly(false);
     emit statusBarText(tabIndex, "");
     is_ready = true;
+    if (lazyHighlight) highlight->updateBlocks(getLastVisibleBlockIndex());
     cursorPositionChangedDelayed();
     emit ready(tabIndex);
     if (highlight->getModeType() == MODE_MIXED) highlightUnusedVars(false);
     initSpellChecker();
+    if (documentView != nullptr) documentView->initHighlighter();
 }
 
 void Editor::initSpellChecker()
 {
     if (!spellCheckerEnabled || spellChecker == nullptr || isBigFile) return;
+    if (spellWorker == nullptr) spellWorker = new SpellWorker();
+    // shared document is checked in full by its source editor
+    spellCheckInitBlockNumber = documentSource != nullptr ? document()->blockCount() : 0;
+    spellTimer.start();
+}
+
+void Editor::setSharedDocument(Editor * source)
+{
+    if (source == nullptr || source == this || source->documentSource != nullptr || source->documentView != nullptr) return;
+    reset();
+    // view keeps its own cursor and scroll, while the document,
+    // its highlighting and parse results belong to the source editor
+    delete highlight;
+    highlight = source->highlight;
+    documentSource = source;
+    source->documentView = this;
+    setDocument(source->document());
+    connect(document(), SIGNAL(contentsChange(int,int,int)), this, SLOT(contentsChange(int,int,int)));
+    connect(document()->documentLayout(), SIGNAL(documentSizeChanged(QSizeF)), this, SLOT(documentSizeChanged(QSizeF)));
+    connect(document(), SIGNAL(blockCountChanged(int)), this, SLOT(blockCountChanged(int)));
+    multiSelectCursor = QTextCursor(document());
+    fileName = source->fileName;
+    extension = source->extension;
+    lastModifiedMsec = source->lastModifiedMsec;
+    newLineMode = source->newLineMode;
+    isBigFile = source->isBigFile;
+    modified = source->modified;
+    parseResultPHP = source->parseResultPHP;
+    parseResultJS = source->parseResultJS;
+    parseResultCSS = source->parseResultCSS;
+    gitAnnotations = source->gitAnnotations;
+    gitDiffLines = source->gitDiffLines;
+    gutterRevision++;
+    emit modifiedStateChanged(tabIndex, modified);
+    updateWidgetsGeometry();
+    detectTabsMode();
+}
+
+Editor * Editor::getSharedDocumentEditor()
+{
+    if (documentSource != nullptr) return documentSource;
+    return documentView;
+}
+
+void Editor::takeSharedDocument()
+{
+    if (documentSource == nullptr) return;
+    // source editor is closed, so the view becomes the owner of the document
+    documentSource = nullptr;
+    document()->setParent(this);
+    connect(highlight, SIGNAL(progressChanged(int)), this, SLOT(highlightProgressChanged(int)));
+}
+
+void Editor::sharedDocumentSaved(QString name)
+{
+    bool nameChanged = name != fileName;
+    setFileName(name);
+    modified = false;
+    warningDisplayed = false;
+    emit modifiedStateChanged(tabIndex, modified);
+    if (nameChanged) emit filenameChanged(tabIndex, fileName);
+}
+
+void Editor::spellTimeout()
+{
+    if (spellWorker == nullptr || tabIndex < 0) {
+        spellTimer.stop();
+        return;
+    }
     int totalBlocks = document()->blockCount();
-    while(spellCheckInitBlockNumber < totalBlocks) {
-        for (int i=0; i<SPELLCHECKER_INIT_BLOCKS_COUNT; i++) {
-            spellBlocksQueue.append(i+spellCheckInitBlockNumber);
+    // words are collected in slices, then checked by the worker
+    if (!isBigFile && spellCheckInitBlockNumber < totalBlocks) {
+        QVector<SpellWorker::Block> snapshots;
+        QElapsedTimer timer;
+        timer.start();
+        QTextBlock block = document()->findBlockByNumber(spellCheckInitBlockNumber);
+        while (block.isValid() && timer.elapsed() < SPELLCHECKER_SLICE_MILLISECONDS) {
+            SpellWorker::Block snapshot;
+            if (collectSpellWords(block, snapshot)) snapshots.append(snapshot);
+            block = block.next();
         }
-        spellCheckInitBlockNumber += SPELLCHECKER_INIT_BLOCKS_COUNT;
-        spellCheck(false, false);
+        spellCheckInitBlockNumber = block.isValid() ? block.blockNumber() : totalBlocks;
+        spellWorker->addBlocks(snapshots);
         int percent = (spellCheckInitBlockNumber * 100) / totalBlocks;
         if (percent - spellProgressPercent > 10) spellProgressChanged(percent);
-        QCoreApplication::processEvents();
-        if (tabIndex < 0) break;
     }
-    spellProgressChanged(100);
+    applySpellResults();
+    if ((isBigFile || spellCheckInitBlockNumber >= totalBlocks) && spellWorker->isIdle()) {
+        spellTimer.stop();
+        if (spellProgressPercent < 100) spellProgressChanged(100);
+    }
+}
+
+void Editor::applySpellResults()
+{
+    SpellWorker::Result result;
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < SPELLCHECKER_SLICE_MILLISECONDS && spellWorker->takeNext(result)) {
+        QTextBlock block = document()->findBlockByNumber(result.blockNumber);
+        // changed blocks are checked again while typing
+        if (!block.isValid() || block.revision() != result.revision) continue;
+        applySpellResult(block, result);
+        // suggestions are shown if the cursor is still at the end of the word
+        QTextCursor cursor = textCursor();
+        if (result.suggestStart < 0 || cursor.block().blockNumber() != result.blockNumber || cursor.positionInBlock() != result.suggestEnd) continue;
+        hideCompletePopup();
+        suggestWords(result.suggestions, result.suggestStart);
+    }
+}
+
+void Editor::applySpellResult(QTextBlock & block, SpellWorker::Result & result)
+{
+    HighlightData * blockData = dynamic_cast<HighlightData *>(block.userData());
+    if (blockData == nullptr) return;
+    bool changed = blockData->spellStarts != result.starts || blockData->spellLengths != result.lengths;
+    blockData->spellStarts = result.starts;
+    blockData->spellLengths = result.lengths;
+    if (changed) {
+        blockSignals(true);
+        highlight->rehighlightBlock(block);
+        blockSignals(false);
+    }
 }
 
 void Editor::spellCheckPasted()
@@ -761,7 +940,7 @@ void Editor::spellCheckPasted()
     if (tabIndex < 0) return;
     if (spellPastedBlocksQueue.size() == 0) return;
     spellBlocksQueue.append(spellPastedBlocksQueue.last());
-    spellCheck(false, false);
+    spellCheck(false);
     spellPastedBlocksQueue.removeLast();
     if (spellPastedBlocksQueue.size() > 0) {
         QTimer::singleShot(INTERVAL_SPELL_CHECK_MILLISECONDS, this, SLOT(spellCheckPasted()));
@@ -794,19 +973,9 @@ void Editor::paintEvent(QPaintEvent * event)
         if (blockNumber>0) blockNumber--;
 
         QTextBlock block = document()->findBlockByNumber(blockNumber);
-        //int top = contentsMargins().top();
-        int top = 0; // widget has offset
-
-        if (blockNumber == 0) {
-            top += static_cast<int>(document()->documentMargin()) - verticalScrollBar()->sliderPosition();
-        } else {
-            QTextBlock prev_block = document()->findBlockByNumber(blockNumber-1);
-            int prev_y = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).y());
-            int prev_h = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).height());
-            top += prev_y + prev_h - verticalScrollBar()->sliderPosition();
-        }
-
-        int bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+        int top = getBlockTop(blockNumber);
+        BlockLayout layout = getBlockLayout(block);
+        int bottom = top + layout.height;
 
         int scrollX = horizontalScrollBar()->value();
         int prevBraces = 0;
@@ -814,20 +983,10 @@ void Editor::paintEvent(QPaintEvent * event)
         while (block.isValid() && top <= event->rect().bottom()) {
             if (block.isVisible()) {
                 int braces = 0;
-                QString blockText = block.text();
-                if (blockText.size() != 0) {
-                    QString prefix = "";
-                    for (int i=0; i<blockText.size(); i++) {
-                        QChar c = blockText[i];
-                        if (iswspace(c.toLatin1())) {
-                            prefix += c;
-                        } else {
-                            break;
-                        }
-                    }
-                    if (prefix.size() > 0) {
-                        prefix = prefix.replace("\t", QString(" ").repeated(tabWidth));
-                        braces = static_cast<int>(ceil(prefix.size() * 1.0 / tabWidth) - 1);
+                if (layout.indentSpaces >= 0) {
+                    int indent = layout.indentSpaces + layout.indentTabs * tabWidth;
+                    if (indent > 0 && tabWidth > 0) {
+                        braces = (indent + tabWidth - 1) / tabWidth - 1;
                     }
                     prevBraces = braces;
                 } else {
@@ -840,8 +999,9 @@ void Editor::paintEvent(QPaintEvent * event)
                 }
             }
             block = block.next();
+            layout = getBlockLayout(block);
             top = bottom;
-            bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+            bottom = top + layout.height;
             blockNumber++;
         }
     }
@@ -864,22 +1024,37 @@ void Editor::paintEvent(QPaintEvent * event)
     QTextEdit::paintEvent(event);
 }
 
+int Editor::getParseRevision()
+{
+    return parseRevision;
+}
+
+int Editor::updateParseRevision()
+{
+    // results of older revisions are dropped, when they arrive
+    parseRevision = contentRevision;
+    return parseRevision;
+}
+
 void Editor::setParseResult(ParsePHP::ParseResult result)
 {
     parseResultPHP = result;
     parseLocked = false;
+    if (documentView != nullptr) documentView->parseResultPHP = result;
 }
 
 void Editor::setParseResult(ParseJS::ParseResult result)
 {
     parseResultJS = result;
     parseLocked = false;
+    if (documentView != nullptr) documentView->parseResultJS = result;
 }
 
 void Editor::setParseResult(ParseCSS::ParseResult result)
 {
     parseResultCSS = result;
     parseLocked = false;
+    if (documentView != nullptr) documentView->parseResultCSS = result;
 }
 
 void Editor::setGitAnnotations(QHash<int, Git::Annotation> annotations)
@@ -894,6 +1069,7 @@ void Editor::setGitDiffLines(QHash<int, Git::DiffLine> mLines)
 {
     if (warningDisplayed) return;
     gitDiffLines = mLines;
+    gutterRevision++;
     updateLineWidgetsArea();
 }
 
@@ -1909,6 +2085,7 @@ bool Editor::onKeyPress(QKeyEvent *e)
                 modifiedLinesIterator = modifiedLines.find(cursor.block().blockNumber() + 1);
                 if (modifiedLinesIterator == modifiedLines.end()) {
                     modifiedLines[cursor.block().blockNumber() + 1] = cursor.block().blockNumber() + 1;
+                    gutterRevision++;
                     HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
                     if (blockData != nullptr) {
                         blockData->isModified = true;
@@ -1939,6 +2116,7 @@ bool Editor::onKeyPress(QKeyEvent *e)
                     modifiedLinesIterator = modifiedLines.find(cursor.block().blockNumber() + 1);
                     if (modifiedLinesIterator == modifiedLines.end()) {
                         modifiedLines[cursor.block().blockNumber() + 1] = cursor.block().blockNumber() + 1;
+                        gutterRevision++;
                         HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
                         if (blockData != nullptr) {
                             blockData->isModified = true;
@@ -2416,25 +2594,25 @@ bool Editor::onKeyRelease(QKeyEvent *e)
         QTextCursor cursor = textCursor();
         int pos = cursor.positionInBlock()-1;
         HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-        if (blockData != nullptr && blockData->specialChars.size()>0 && blockData->specialCharsPos.size()>0 && blockData->specialChars.size()==blockData->specialCharsPos.size()) {
+        if (blockData != nullptr && blockData->specialCharsCount()>0) {
             bool sFound = false;
             int count = 0;
             int positionInBlock = -1;
             int iterations = 0;
             do {
-                if (blockData->specialChars.size()>0 && blockData->specialCharsPos.size()>0) {
-                    for (int i=blockData->specialChars.size()-1; i>=0; i--) {
+                if (blockData->specialCharsCount()>0) {
+                    for (int i=blockData->specialCharsCount()-1; i>=0; i--) {
                         iterations++;
                         if (iterations > SEARCH_LIMIT) break;
-                        QChar c = blockData->specialChars.at(i);
-                        if (!sFound && c == closeChar && blockData->specialCharsPos.at(i) == pos) {
+                        QChar c = blockData->specialCharAt(i);
+                        if (!sFound && c == closeChar && blockData->specialCharPosAt(i) == pos) {
                             sFound = true;
                         } else if (sFound && c == closeChar) {
                             count++;
                         } else if (sFound && c == openChar && count > 0) {
                             count--;
                         } else if (sFound && c == openChar && count == 0) {
-                            positionInBlock = blockData->specialCharsPos.at(i);
+                            positionInBlock = blockData->specialCharPosAt(i);
                             int total = cursor.block().text().size();
                             cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::MoveAnchor);
                             do {
@@ -2452,7 +2630,7 @@ bool Editor::onKeyRelease(QKeyEvent *e)
                 if (!sFound) break;
                 if (!cursor.movePosition(QTextCursor::PreviousBlock, QTextCursor::MoveAnchor)) break;
                 blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-                if (blockData == nullptr || blockData->specialChars.size()!=blockData->specialCharsPos.size()) break;
+                if (blockData == nullptr) break;
             } while(positionInBlock < 0);
         }
         if (foundPrefix && textCursor().block().text() != prefix + "}" && ((tabType == "spaces" && prefix.indexOf("\t") < 0) || (tabType == "tabs" && prefix.indexOf(" ") < 0))) {
@@ -2594,6 +2772,7 @@ void Editor::insertFromMimeData(const QMimeData *source)
                 modifiedLinesIterator = modifiedLines.find(cursor.block().blockNumber() + 1);
                 if (modifiedLinesIterator == modifiedLines.end()) {
                     modifiedLines[cursor.block().blockNumber() + 1] = cursor.block().blockNumber() + 1;
+                    gutterRevision++;
                     HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
                     if (blockData != nullptr) {
                         blockData->isModified = true;
@@ -2630,6 +2809,7 @@ void Editor::blockCountChanged(int /*blockCount*/)
     // updating mark points, modified lines
     markPoints.clear();
     modifiedLines.clear();
+    gutterRevision++;
     QTextCursor curs = textCursor();
     curs.movePosition(QTextCursor::Start, QTextCursor::MoveAnchor);
     do {
@@ -2731,8 +2911,13 @@ void Editor::wheelEvent(QWheelEvent *e)
 
 void Editor::contentsChange(int position, int charsRemoved, int charsAdded)
 {
-    if (!is_ready || isReadOnly()) return;
     QTextBlock block = document()->findBlock(position);
+    // cached layouts of changed and following blocks are dropped
+    if (!block.isValid()) blockLayouts.clear();
+    else if (block.blockNumber() < blockLayouts.size()) blockLayouts.resize(block.blockNumber());
+    // shared document is highlighted by its source editor
+    if (documentSource != nullptr) return;
+    if (!is_ready || isReadOnly()) return;
     if (!block.isValid()) return;
 
     highlight->resetHighlightBlock(block);
@@ -2758,8 +2943,85 @@ void Editor::contentsChange(int position, int charsRemoved, int charsAdded)
     }
 }
 
+void Editor::documentSizeChanged(const QSizeF & /*size*/)
+{
+    // block positions could be changed by relayout
+    blockLayouts.clear();
+}
+
+Editor::BlockLayout Editor::getBlockLayout(const QTextBlock & block)
+{
+    BlockLayout layout;
+    if (!block.isValid()) return layout;
+    int blockNumber = block.blockNumber();
+    if (blockNumber < blockLayouts.size() && blockLayouts.at(blockNumber).valid) return blockLayouts.at(blockNumber);
+    QRectF rect = document()->documentLayout()->blockBoundingRect(block);
+    layout.top = static_cast<int>(rect.y());
+    layout.height = static_cast<int>(rect.height());
+    QString blockText = block.text();
+    if (blockText.size() > 0) {
+        layout.indentSpaces = 0;
+        for (int i=0; i<blockText.size(); i++) {
+            QChar c = blockText[i];
+            if (!iswspace(c.toLatin1())) break;
+            if (c == '\t') layout.indentTabs++;
+            else layout.indentSpaces++;
+        }
+    }
+    layout.valid = true;
+    // layout could be cleared, while block rect is calculated
+    if (blockLayouts.size() <= blockNumber) blockLayouts.resize(qMax(blockNumber + 1, document()->blockCount()));
+    blockLayouts[blockNumber] = layout;
+    return layout;
+}
+
+int Editor::getBlockTop(int blockNumber)
+{
+    //int top = contentsMargins().top();
+    int top = 0; // widget has offset
+    if (blockNumber == 0) {
+        top += static_cast<int>(document()->documentMargin()) - verticalScrollBar()->sliderPosition();
+    } else {
+        BlockLayout prevLayout = getBlockLayout(document()->findBlockByNumber(blockNumber-1));
+        top += prevLayout.top + prevLayout.height - verticalScrollBar()->sliderPosition();
+    }
+    return top;
+}
+
+int Editor::getBlockGutterFlags(int blockNumber)
+{
+    int markRevision = static_cast<LineMark *>(lineMark)->getRevision();
+    if (blockNumber < 0 || blockNumber >= blockLayouts.size() || !blockLayouts.at(blockNumber).valid) return findGutterFlags(blockNumber + 1);
+    BlockLayout & layout = blockLayouts[blockNumber];
+    if (layout.gutterRevision != gutterRevision || layout.markRevision != markRevision) {
+        layout.gutterFlags = findGutterFlags(blockNumber + 1);
+        layout.gutterRevision = gutterRevision;
+        layout.markRevision = markRevision;
+    }
+    return layout.gutterFlags;
+}
+
+int Editor::findGutterFlags(int line)
+{
+    int flags = 0;
+    if (gitDiffLines.size() > 0 && gitDiffLines.contains(line)) {
+        flags |= GUTTER_FLAG_GIT_LINE;
+        Git::DiffLine mLine = gitDiffLines.value(line);
+        if (mLine.isModified) flags |= GUTTER_FLAG_GIT_MODIFIED;
+        if (mLine.isDeleted) flags |= GUTTER_FLAG_GIT_DELETED;
+    }
+    if (modifiedLines.find(line) != modifiedLines.end()) flags |= GUTTER_FLAG_MODIFIED;
+    if (markPoints.find(line) != markPoints.end()) flags |= GUTTER_FLAG_MARK_POINT;
+    LineMark * mark = static_cast<LineMark *>(lineMark);
+    if (mark->hasError(line)) flags |= GUTTER_FLAG_ERROR;
+    if (mark->hasWarning(line)) flags |= GUTTER_FLAG_WARNING;
+    if (mark->hasMark(line)) flags |= GUTTER_FLAG_MARK;
+    return flags;
+}
+
 void Editor::textChanged()
 {
+    contentRevision++;
     if (!is_ready || isReadOnly()) return;
     Qt::KeyboardModifiers modifiers  = QApplication::queryKeyboardModifiers();
     bool ctrl = modifiers & Qt::ControlModifier;
@@ -2802,6 +3064,7 @@ void Editor::textChanged()
         modifiedLinesIterator = modifiedLines.find(curs.block().blockNumber() + 1);
         if (modifiedLinesIterator == modifiedLines.end()) {
             modifiedLines[curs.block().blockNumber() + 1] = curs.block().blockNumber() + 1;
+            gutterRevision++;
             HighlightData * blockData = dynamic_cast<HighlightData *>(curs.block().userData());
             if (blockData != nullptr) {
                 blockData->isModified = true;
@@ -2813,6 +3076,7 @@ void Editor::textChanged()
         modifiedLinesIterator = modifiedLines.find(lastKeyPressedBlockNumber + 1);
         if (modifiedLinesIterator == modifiedLines.end()) {
             modifiedLines[lastKeyPressedBlockNumber + 1] = lastKeyPressedBlockNumber + 1;
+            gutterRevision++;
             if (lastKeyPressedBlockNumber == curs.block().blockNumber()-1) {
                 curs.movePosition(QTextCursor::PreviousBlock, QTextCursor::MoveAnchor);
             } else {
@@ -2905,39 +3169,90 @@ bool Editor::isKnownWord(QString word)
         }
     }
     if (!known) {
-        HW->phpwordsIterator = HW->phpwords.find(word.toLower().toStdString());
-        if (HW->phpwordsIterator != HW->phpwords.end()) {
+        if (HW->phpwords.contains(word)) {
             known = true;
         }
     }
     if (!known) {
-        HW->phpwordsCSIterator = HW->phpwordsCS.find(word.toStdString());
-        if (HW->phpwordsCSIterator != HW->phpwordsCS.end()) {
+        if (HW->phpwordsCS.contains(word)) {
             known = true;
         }
     }
     if (!known) {
-        HW->jswordsCSIterator = HW->jswordsCS.find(word.toStdString());
-        if (HW->jswordsCSIterator != HW->jswordsCS.end()) {
+        if (HW->jswordsCS.contains(word)) {
             known = true;
         }
     }
     if (!known) {
-        HW->csswordsIterator = HW->csswords.find(word.toLower().toStdString());
-        if (HW->csswordsIterator != HW->csswords.end()) {
+        if (HW->csswords.contains(word)) {
             known = true;
         }
     }
     if (!known) {
-        HW->htmlwordsIterator = HW->htmlwords.find(word.toLower().toStdString());
-        if (HW->htmlwordsIterator != HW->htmlwords.end()) {
+        if (HW->htmlwords.contains(word)) {
             known = true;
         }
     }
     return known;
 }
 
-void Editor::spellCheck(bool suggest, bool forceRehighlight)
+bool Editor::collectSpellWords(QTextBlock & block, SpellWorker::Block & snapshot)
+{
+    HighlightData * blockData = dynamic_cast<HighlightData *>(block.userData());
+    if (blockData == nullptr) return false;
+    snapshot.number = block.blockNumber();
+    snapshot.revision = block.revision();
+    snapshot.words.clear();
+    snapshot.suggestWord = -1;
+    QString blockText = block.text();
+    if (blockText.trimmed().size() == 0) return true;
+    QRegularExpressionMatch m;
+    int offset = 0;
+    do {
+        m = spellWordExpr.match(blockText, offset);
+        if (m.capturedStart() >= 0) {
+            offset = m.capturedStart() + m.capturedLength();
+            int start = m.capturedStart(1);
+            int length = m.capturedLength(1);
+            QString word = blockText.mid(start, length);
+            bool hasLetter = false;
+            for (int i=0; i<word.size(); i++) {
+                QChar c = word[i];
+                if (c.isLetter()) hasLetter = true;
+            }
+            if (!hasLetter) continue;
+            if (word.size() > 0 && word[0] == "$") continue;
+            if (word.size()>1 && word[0]=='\'' && word[word.size()-1]=='\'') {
+                word = word.mid(1,word.size()-2);
+                start += 1;
+                length -= 2;
+            }
+            if (word.size() > 1 && word[word.size()-1] == "$") {
+                word = word.mid(0, word.size()-1);
+                length -= 1;
+            }
+            if (word.size() < 2) continue;
+            std::string mode = highlight->findModeAtCursor(&block, start);
+            int state = highlight->findStateAtCursor(&block, start);
+            //if ((mode == MODE_PHP || mode == MODE_JS || mode == MODE_CSS) && state == STATE_NONE) continue;
+            if (mode == MODE_PHP && state != STATE_COMMENT_ML_PHP) continue;
+            if (mode == MODE_JS && state != STATE_COMMENT_ML_JS) continue;
+            if (mode == MODE_CSS && state != STATE_COMMENT_ML_CSS) continue;
+            if (mode == MODE_HTML && state != STATE_NONE) continue;
+            if (mode == MODE_UNKNOWN && !highlight->isTextMode() && state != STATE_COMMENT_ML_UNKNOWN) continue;
+            if (isKnownWord(word)) continue;
+            SpellWorker::Word spellWord;
+            spellWord.text = word;
+            spellWord.start = start;
+            spellWord.length = length;
+            spellWord.suggest = word.size() >= 4 && (mode == MODE_HTML || mode == MODE_UNKNOWN);
+            snapshot.words.append(spellWord);
+        }
+    } while(m.capturedStart() >= 0);
+    return true;
+}
+
+void Editor::spellCheck(bool suggest)
 {
     spellLocked = false;
     if (!spellCheckerEnabled || spellChecker == nullptr) return;
@@ -2955,9 +3270,9 @@ void Editor::spellCheck(bool suggest, bool forceRehighlight)
             cursorTextPos = i-1;
         }
     }
-    QRegularExpressionMatch m;
+    QVector<SpellWorker::Block> snapshots;
+    bool urgent = false;
     for (int i=0; i<spellBlocksQueue.size(); i++) {
-        bool misspelled = false;
         int blockNumber = spellBlocksQueue.at(i);
         if (blockNumber == cursor.block().blockNumber() + 1) {
             cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor);
@@ -2967,69 +3282,26 @@ void Editor::spellCheck(bool suggest, bool forceRehighlight)
         }
         QTextBlock block = cursor.block();
         if (block.blockNumber() != spellBlocksQueue.at(i)) continue;
-        HighlightData * blockData = dynamic_cast<HighlightData *>(block.userData());
-        if (blockData == nullptr) continue;
-        blockData->spellStarts.clear();
-        blockData->spellLengths.clear();
-        QString blockText = cursor.block().text();
-        if (blockText.trimmed().size() == 0) continue;
-        int offset = 0;
-        do {
-            m = spellWordExpr.match(blockText, offset);
-            if (m.capturedStart() >= 0) {
-                offset = m.capturedStart() + m.capturedLength();
-                int start = m.capturedStart(1);
-                int length = m.capturedLength(1);
-                QString word = blockText.mid(start, length);
-                bool hasLetter = false;
-                for (int i=0; i<word.size(); i++) {
-                    QChar c = word[i];
-                    if (c.isLetter()) hasLetter = true;
-                }
-                if (!hasLetter) continue;
-                if (word.size() > 0 && word[0] == "$") continue;
-                if (word.size()>1 && word[0]=='\'' && word[word.size()-1]=='\'') {
-                    word = word.mid(1,word.size()-2);
-                    start += 1;
-                    length -= 2;
-                }
-                if (word.size() > 1 && word[word.size()-1] == "$") {
-                    word = word.mid(0, word.size()-1);
-                    length -= 1;
-                }
-                if (word.size() < 2) continue;
-                std::string mode = highlight->findModeAtCursor(&block, start);
-                int state = highlight->findStateAtCursor(&block, start);
-                //if ((mode == MODE_PHP || mode == MODE_JS || mode == MODE_CSS) && state == STATE_NONE) continue;
-                if (mode == MODE_PHP && state != STATE_COMMENT_ML_PHP) continue;
-                if (mode == MODE_JS && state != STATE_COMMENT_ML_JS) continue;
-                if (mode == MODE_CSS && state != STATE_COMMENT_ML_CSS) continue;
-                if (mode == MODE_HTML && state != STATE_NONE) continue;
-                if (mode == MODE_UNKNOWN && !highlight->isTextMode() && state != STATE_COMMENT_ML_UNKNOWN) continue;
-                bool doSuggest = suggest;
-                if (word.size() < 4) doSuggest = false;
-                if (mode != MODE_HTML && mode != MODE_UNKNOWN) doSuggest = false;
-                if (lastKeyPressed == Qt::Key_Backspace || lastKeyPressed == Qt::Key_Delete) doSuggest = false;
-                if (!isKnownWord(word) && !spellChecker->check(word)) {
-                    misspelled = true;
-                    blockData->spellStarts.append(start);
-                    blockData->spellLengths.append(length);
-                    if (doSuggest && word == cursorText && start == cursorTextPos) {
-                        hideCompletePopup();
-                        QStringList suggestions = spellChecker->suggest(word);
-                        suggestWords(suggestions, cursorTextPos);
-                    }
-                }
+        SpellWorker::Block snapshot;
+        if (!collectSpellWords(block, snapshot)) continue;
+        snapshots.append(snapshot);
+        if (!suggest || lastKeyPressed == Qt::Key_Backspace || lastKeyPressed == Qt::Key_Delete) continue;
+        // suggestions for the word at cursor are looked up by the worker
+        for (int w=0; w<snapshot.words.size(); w++) {
+            const SpellWorker::Word & word = snapshot.words.at(w);
+            if (word.suggest && word.text == cursorText && word.start == cursorTextPos) {
+                snapshots.last().suggestWord = w;
+                urgent = true;
+                break;
             }
-        } while(m.capturedStart() >= 0);
-        block.setUserData(blockData);
-        if (forceRehighlight || misspelled) {
-            blockSignals(true);
-            highlight->rehighlightBlock(block);
-            blockSignals(false);
         }
     }
     spellBlocksQueue.clear();
+    if (snapshots.size() > 0) {
+        if (spellWorker == nullptr) spellWorker = new SpellWorker();
+        spellWorker->addBlocks(snapshots, urgent);
+        if (!spellTimer.isActive()) spellTimer.start();
+    }
 }
 
 QChar Editor::findPrevCharNonSpaceAtCursos(QTextCursor & curs)
@@ -3241,24 +3513,16 @@ void Editor::detectCompleteTextHTML(QString text, QChar cursorTextPrevChar, int
     if (state != STATE_TAG) return;
     if ((cursorTextPrevChar == "<" || cursorTextPrevChar == "/")  && completePopup->count() < completePopup->limit()) {
         // html tags
-        for (auto & it : CW->htmlAllTagsComplete) {
-            QString k = QString::fromStdString(it.first);
-            //if (k == text) continue;
-            if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->htmlAllTagsComplete, text)) {
+            completePopup->addItem(entry.key, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
     }
     // events
     if (state == STATE_TAG && completePopup->count() < completePopup->limit()) {
-        for (auto & it : CW->jsEventsComplete) {
-            QString k = QString::fromStdString(it.first);
-            //if (k == text) continue;
-            if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->jsEventsComplete, text)) {
+            completePopup->addItem(entry.key, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
     }
 }
@@ -3289,24 +3553,16 @@ void Editor::detectCompleteTextCSS(QString text, QChar cursorTextPrevChar)
     }
     if (((braces > 0 && !cssMediaScope) || (braces > 1 && cssMediaScope)) && colIndex < 0 && completePopup->count() < completePopup->limit()) {
         // css props
-        for (auto & it : CW->cssPropertiesComplete) {
-            QString k = QString::fromStdString(it.first);
-            //if (k == text) continue;
-            if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->cssPropertiesComplete, text)) {
+            completePopup->addItem(entry.key, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
     }
     if (colIndex >= 0 && completePopup->count() < completePopup->limit()) {
         // css vals
-        for (auto & it : CW->cssValuesComplete) {
-            QString k = QString::fromStdString(it.first);
-            //if (k == text) continue;
-            if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->cssValuesComplete, text)) {
+            completePopup->addItem(entry.key, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
     }
     if (completePopup->count() < completePopup->limit()) {
@@ -3322,24 +3578,16 @@ void Editor::detectCompleteTextCSS(QString text, QChar cursorTextPrevChar)
     }
     if (completePopup->count() < completePopup->limit()) {
         // html tags
-        for (auto & it : CW->htmlAllTagsComplete) {
-            QString k = QString::fromStdString(it.first);
-            //if (k == text) continue;
-            if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->htmlAllTagsComplete, text)) {
+            completePopup->addItem(entry.key, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
     }
     if (cursorTextPrevChar == ":" && completePopup->count() < completePopup->limit()) {
         // css pseudo
-        for (auto & it : CW->cssPseudoComplete) {
-            QString k = QString::fromStdString(it.first);
-            //if (k == text) continue;
-            if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->cssPseudoComplete, text)) {
+            completePopup->addItem(entry.key, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
     }
 }
@@ -3359,47 +3607,18 @@ void Editor::detectCompleteTextJS(QString text, int cursorTextPos, QChar cursorT
         }
         // js specials
         if (completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->jsSpecialsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->jsSpecialsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
         if (jsExtMode.isEmpty()) {
-            // js objects
+            // js objects, functions and interfaces ranked by fuzzy match
             if (completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->jsObjectsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        if (completePopup->count() >= completePopup->limit()) break;
-                    }
-                }
-            }
-            // js functions
-            if (completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->jsFunctionsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        if (completePopup->count() >= completePopup->limit()) break;
-                    }
-                }
-            }
-            // js interfaces
-            if (completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->jsInterfacesComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        if (completePopup->count() >= completePopup->limit()) break;
-                    }
+                std::vector<std::map<std::string, std::string> *> words = {& CW->jsObjectsComplete, & CW->jsFunctionsComplete, & CW->jsInterfacesComplete};
+                std::vector<CompleteIndex::Match> matches = CW->findFuzzy(words, text, completePopup->limit() - completePopup->count());
+                for (auto & match : matches) {
+                    completePopup->addItem(match.entry->key, match.entry->value);
                 }
             }
         } else {
@@ -3473,24 +3692,16 @@ void Editor::detectCompleteTextJS(QString text, int cursorTextPos, QChar cursorT
         }
         // methods
         if (completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->jsMethodsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->jsMethodsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
         // events
         if (completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->jsEventsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->jsEventsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
         // parsed functions
@@ -3532,46 +3743,30 @@ void Editor::detectCompleteTextJSExt(QString text, QString jsExtMode)
     if (jsExtMode == EXTENSION_DART) {
         // flutter classes
         if (completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->flutterObjectsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->flutterObjectsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
         // dart classes
         if (completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->dartObjectsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->dartObjectsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
         // flutter functions
         if (completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->flutterFunctionsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->flutterFunctionsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
         // dart functions
         if (completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->dartFunctionsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->dartFunctionsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
     }
@@ -3593,34 +3788,32 @@ void Editor::detectCompleteTextPHPGlobalContext(QString text, int cursorTextPos,
             }
             // php specials
             if (prevChar != "\\" && completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->phpSpecialsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        if (completePopup->count() >= completePopup->limit()) break;
-                    }
+                for (auto & entry : CW->findPrefix(CW->phpSpecialsComplete, text)) {
+                    completePopup->addItem(entry.key, entry.value);
+                    if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
-            // php functions
-            if (prevChar != "\\" && completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->phpFunctionsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second), TOOLTIP_DELIMITER);
-                        if (completePopup->count() >= completePopup->limit()) break;
-                    }
+            // classes of current namespace go first
+            QSet<QString> nsClasses;
+            if (prevChar != "\\" && nsName.size() > 0 && completePopup->count() < completePopup->limit()) {
+                for (auto & entry : CW->findPrefix(CW->phpClassesComplete, nsName + "\\" + text)) {
+                    completePopup->addItem(entry.key, "\\"+entry.key);
+                    nsClasses.insert(entry.key);
+                    if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
-            // php consts
+            // php functions, consts and classes ranked by fuzzy match
             if (prevChar != "\\" && completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->phpConstsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        if (completePopup->count() >= completePopup->limit()) break;
+                std::vector<std::map<std::string, std::string> *> words = {& CW->phpFunctionsComplete, & CW->phpConstsComplete, & CW->phpClassesComplete};
+                std::vector<CompleteIndex::Match> matches = CW->findFuzzy(words, text, completePopup->limit() - completePopup->count() + nsClasses.size());
+                for (auto & match : matches) {
+                    if (completePopup->count() >= completePopup->limit()) break;
+                    if (match.source == 0) {
+                        completePopup->addItem(match.entry->key, match.entry->value, TOOLTIP_DELIMITER);
+                    } else if (match.source == 1) {
+                        completePopup->addItem(match.entry->key, match.entry->value);
+                    } else if (!nsClasses.contains(match.entry->key)) {
+                        completePopup->addItem(match.entry->key, "\\"+match.entry->key);
                     }
                 }
             }
@@ -3630,30 +3823,25 @@ void Editor::detectCompleteTextPHPGlobalContext(QString text, int cursorTextPos,
                 _clsName = completeClassNamePHPAtCursor(curs, prevWord, nsName);
             }
             // php classes (without params)
-            if (completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->phpClassesComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    QString _text = nsName.size() > 0 ? nsName + "\\" + text : text;
-                    if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                        QString name = QString::fromStdString(it.first);
-                        if (_clsName.size() > 0 && name.indexOf(_clsName+"\\")==0) {
-                            name = name.mid(_clsName.size()+1);
-                            completePopup->addItem(name, name);
-                        } else if (_clsName.size() == 0) {
-                            completePopup->addItem(name, "\\"+name);
-                        }
-                        if (completePopup->count() >= completePopup->limit()) break;
+            if (prevChar == "\\" && completePopup->count() < completePopup->limit()) {
+                QString _text = nsName.size() > 0 ? nsName + "\\" + text : text;
+                for (auto & entry : CW->findPrefix(CW->phpClassesComplete, _text)) {
+                    QString name = entry.key;
+                    if (_clsName.size() > 0 && name.indexOf(_clsName+"\\")==0) {
+                        name = name.mid(_clsName.size()+1);
+                        completePopup->addItem(name, name);
+                    } else if (_clsName.size() == 0) {
+                        completePopup->addItem(name, "\\"+name);
                     }
+                    if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
-            if (completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->phpClassesComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    QString _text = nsName.size() > 0 ? nsName + "\\" + text : text;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)>=0 && k.indexOf(_text, 0, Qt::CaseInsensitive)!=0) {
-                        QString name = QString::fromStdString(it.first);
+            if (prevChar == "\\" && completePopup->count() < completePopup->limit()) {
+                QString _foldedText = text.toCaseFolded();
+                QString _foldedNsText = nsName.size() > 0 ? (nsName + "\\" + text).toCaseFolded() : _foldedText;
+                for (auto & entry : CW->findAll(CW->phpClassesComplete)) {
+                    if (entry.foldedKey.indexOf(_foldedText)>=0 && !entry.foldedKey.startsWith(_foldedNsText)) {
+                        QString name = entry.key;
                         if (_clsName.size() > 0 && name.indexOf(_clsName+"\\")==0) {
                             name = name.mid(_clsName.size()+1);
                             completePopup->addItem(name, name);
@@ -3667,22 +3855,17 @@ void Editor::detectCompleteTextPHPGlobalContext(QString text, int cursorTextPos,
             completeDetectedPHP = true;
         } else if (prevWord == "new") {
             // php classes (with params)
-            for (auto & it : CW->phpClassesComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                QString _text = nsName.size() > 0 ? nsName + "\\" + text : text;
-                if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second), TOOLTIP_DELIMITER);
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            QString _text = nsName.size() > 0 ? nsName + "\\" + text : text;
+            for (auto & entry : CW->findPrefix(CW->phpClassesComplete, _text)) {
+                completePopup->addItem(entry.key, entry.value, TOOLTIP_DELIMITER);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
             if (completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->phpClassesComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    QString _text = nsName.size() > 0 ? nsName + "\\" + text : text;
-                    if (k.indexOf(text, 0, Qt::CaseInsensitive)>=0 && k.indexOf(_text, 0, Qt::CaseInsensitive)!=0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second), TOOLTIP_DELIMITER);
+                QString _foldedText = text.toCaseFolded();
+                QString _foldedNsText = _text.toCaseFolded();
+                for (auto & entry : CW->findAll(CW->phpClassesComplete)) {
+                    if (entry.foldedKey.indexOf(_foldedText)>=0 && !entry.foldedKey.startsWith(_foldedNsText)) {
+                        completePopup->addItem(entry.key, entry.value, TOOLTIP_DELIMITER);
                         if (completePopup->count() >= completePopup->limit()) break;
                     }
                 }
@@ -3711,27 +3894,19 @@ void Editor::detectCompleteTextPHPGlobalContext(QString text, int cursorTextPos,
                 _clsName= completeClassNamePHPAtCursor(curs, prevWord, nsName);
             }
             // php class consts
-            for (auto & it : CW->phpClassConstsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(_clsName+"::"+text, 0, Qt::CaseInsensitive)==0) {
-                    //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    QString classConstComplete = getFixedCompleteClassConstName(QString::fromStdString(it.first));
-                    completePopup->addItem(classConstComplete, QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->phpClassConstsComplete, _clsName+"::"+text)) {
+                //completePopup->addItem(entry.key, entry.value);
+                QString classConstComplete = getFixedCompleteClassConstName(entry.key);
+                completePopup->addItem(classConstComplete, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
             if (completePopup->count() < completePopup->limit()) {
                 // php class methods
-                for (auto & it : CW->phpClassMethodsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    //if (k == text) continue;
-                    if (k.indexOf(_clsName+"::"+text, 0, Qt::CaseInsensitive)==0) {
-                        //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
-                        if (completePopup->count() >= completePopup->limit()) break;
-                    }
+                for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _clsName+"::"+text)) {
+                    //completePopup->addItem(entry.key, entry.value);
+                    QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                    completePopup->addItem(classMethodComplete, entry.value);
+                    if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
             completeDetectedPHP = true;
@@ -3741,13 +3916,9 @@ void Editor::detectCompleteTextPHPGlobalContext(QString text, int cursorTextPos,
         }
     } else if (text[0] == "_" && prevWord == "function") {
         // php magic methods
-        for (auto & it : CW->phpMagicComplete) {
-            QString k = QString::fromStdString(it.first);
-            //if (k == text) continue;
-            if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->phpMagicComplete, text)) {
+            completePopup->addItem(entry.key, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
     } else if (text[0] == "$") {
         std::unordered_map<std::string, std::string> vars;
@@ -3817,13 +3988,9 @@ void Editor::detectCompleteTextPHPGlobalContext(QString text, int cursorTextPos,
         }
         // php globals
         if (!isClass && completePopup->count() < completePopup->limit()) {
-            for (auto & it : CW->phpGlobalsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->phpGlobalsComplete, text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
             completeDetectedPHP = true;
         }
@@ -3849,13 +4016,9 @@ void Editor::detectCompleteTextPHPGlobalContext(QString text, int cursorTextPos,
                 _clsName= completeClassNamePHPAtCursor(curs, prevWord, nsName);
             }
             // php class vars
-            for (auto & it : CW->phpClassPropsComplete) {
-                QString k = QString::fromStdString(it.first);
-                //if (k == text) continue;
-                if (k.indexOf(_clsName+"::"+text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _clsName+"::"+text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
     } else {
@@ -3900,13 +4063,11 @@ void Editor::detectCompleteTextPHPObjectContext(QString text, int cursorTextPos,
         if (completePopup->count() < completePopup->limit()) {
             // $this->method()
             QString _text = ns + clsName + "::" + text;
-            for (auto & it : CW->phpClassMethodsComplete) {
-                QString k = "\\"+QString::fromStdString(it.first);
-                //if (k == _text) continue;
-                if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                    //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
+            if (_text.startsWith("\\")) {
+                for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _text.mid(1))) {
+                    //completePopup->addItem(entry.key, entry.value);
+                    QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                    completePopup->addItem(classMethodComplete, entry.value);
                     if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
@@ -3914,11 +4075,9 @@ void Editor::detectCompleteTextPHPObjectContext(QString text, int cursorTextPos,
         if (completePopup->count() < completePopup->limit()) {
             // $this->prop
             QString _text = ns + clsName + "::$" + text;
-            for (auto & it : CW->phpClassPropsComplete) {
-                QString k = "\\"+QString::fromStdString(it.first);
-                //if (k == _text) continue;
-                if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
+            if (_text.startsWith("\\")) {
+                for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _text.mid(1))) {
+                    completePopup->addItem(entry.key, entry.value);
                     if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
@@ -3948,24 +4107,20 @@ void Editor::detectCompleteTextPHPObjectContext(QString text, int cursorTextPos,
                 if (variable.name == prevWord && variable.type.size() > 0) {
                     // class methods
                     QString _text = variable.type + "::" + text;
-                    for (auto & it : CW->phpClassMethodsComplete) {
-                        QString k = "\\"+QString::fromStdString(it.first);
-                        //if (k == _text) continue;
-                        if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                            //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                            QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                            completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
+                    if (_text.startsWith("\\")) {
+                        for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _text.mid(1))) {
+                            //completePopup->addItem(entry.key, entry.value);
+                            QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                            completePopup->addItem(classMethodComplete, entry.value);
                             if (completePopup->count() >= completePopup->limit()) break;
                         }
                     }
                     if (completePopup->count() < completePopup->limit()) {
                         // class props
                         QString _text = variable.type + "::$" + text;
-                        for (auto & it : CW->phpClassPropsComplete) {
-                            QString k = "\\"+QString::fromStdString(it.first);
-                            //if (k == _text) continue;
-                            if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                                completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
+                        if (_text.startsWith("\\")) {
+                            for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _text.mid(1))) {
+                                completePopup->addItem(entry.key, entry.value);
                                 if (completePopup->count() >= completePopup->limit()) break;
                             }
                         }
@@ -3989,24 +4144,20 @@ void Editor::detectCompleteTextPHPObjectContext(QString text, int cursorTextPos,
             if (variable.name == prevWord && variable.type.size() > 0) {
                 // class methods
                 QString _text = variable.type + "::" + text;
-                for (auto & it : CW->phpClassMethodsComplete) {
-                    QString k = "\\"+QString::fromStdString(it.first);
-                    //if (k == _text) continue;
-                    if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                        //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
+                if (_text.startsWith("\\")) {
+                    for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _text.mid(1))) {
+                        //completePopup->addItem(entry.key, entry.value);
+                        QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                        completePopup->addItem(classMethodComplete, entry.value);
                         if (completePopup->count() >= completePopup->limit()) break;
                     }
                 }
                 if (completePopup->count() < completePopup->limit()) {
                     // class props
                     QString _text = variable.type + "::$" + text;
-                    for (auto & it : CW->phpClassPropsComplete) {
-                        QString k = "\\"+QString::fromStdString(it.first);
-                        //if (k == _text) continue;
-                        if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                            completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
+                    if (_text.startsWith("\\")) {
+                        for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _text.mid(1))) {
+                            completePopup->addItem(entry.key, entry.value);
                             if (completePopup->count() >= completePopup->limit()) break;
                         }
                     }
@@ -4034,24 +4185,20 @@ void Editor::detectCompleteTextPHPObjectContext(QString text, int cursorTextPos,
             if (variable.name == "$"+prevWord && variable.type.size() > 0) {
                 // class methods
                 QString _text = variable.type + "::" + text;
-                for (auto & it : CW->phpClassMethodsComplete) {
-                    QString k = "\\"+QString::fromStdString(it.first);
-                    //if (k == _text) continue;
-                    if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                        //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
+                if (_text.startsWith("\\")) {
+                    for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _text.mid(1))) {
+                        //completePopup->addItem(entry.key, entry.value);
+                        QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                        completePopup->addItem(classMethodComplete, entry.value);
                         if (completePopup->count() >= completePopup->limit()) break;
                     }
                 }
                 if (completePopup->count() < completePopup->limit()) {
                     // class props
                     QString _text = variable.type + "::$" + text;
-                    for (auto & it : CW->phpClassPropsComplete) {
-                        QString k = "\\"+QString::fromStdString(it.first);
-                        //if (k == _text) continue;
-                        if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                            completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
+                    if (_text.startsWith("\\")) {
+                        for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _text.mid(1))) {
+                            completePopup->addItem(entry.key, entry.value);
                             if (completePopup->count() >= completePopup->limit()) break;
                         }
                     }
@@ -4071,24 +4218,20 @@ void Editor::detectCompleteTextPHPObjectContext(QString text, int cursorTextPos,
             if (type[0] != "\\") type = "\\" + type;
             // class methods
             QString _text = type + "::" + text;
-            for (auto & it : CW->phpClassMethodsComplete) {
-                QString k = "\\"+QString::fromStdString(it.first);
-                //if (k == _text) continue;
-                if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                    //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
+            if (_text.startsWith("\\")) {
+                for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _text.mid(1))) {
+                    //completePopup->addItem(entry.key, entry.value);
+                    QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                    completePopup->addItem(classMethodComplete, entry.value);
                     if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
             if (completePopup->count() < completePopup->limit()) {
                 // class props
                 QString _text = type + "::$" + text;
-                for (auto & it : CW->phpClassPropsComplete) {
-                    QString k = "\\"+QString::fromStdString(it.first);
-                    //if (k == _text) continue;
-                    if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
+                if (_text.startsWith("\\")) {
+                    for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _text.mid(1))) {
+                        completePopup->addItem(entry.key, entry.value);
                         if (completePopup->count() >= completePopup->limit()) break;
                     }
                 }
@@ -4200,16 +4343,14 @@ QString Editor::detectCompleteTypeAtCursorPHP(QTextCursor & curs, QString nsName
         }
         if (prevWord.toLower() == "return" || prevWord.toLower() == "else" || prevWord.toLower() == "echo") break;
         /*
-        HW->phpwordsIterator = HW->phpwords.find(prevWord.toLower().toStdString());
-        if (HW->phpwordsIterator != HW->phpwords.end()) break;
+        if (HW->phpwords.contains(prevWord)) break;
         */
         if (prevChar == ")") {
             detectParsOpenAtCursor(curs);
             prevWord = findPrevWordNonSpaceAtCursor(curs, MODE_PHP);
             if (prevWord.toLower() == "if" || prevWord.toLower() == "echo") break;
             /*
-            HW->phpwordsIterator = HW->phpwords.find(prevWord.toLower().toStdString());
-            if (HW->phpwordsIterator != HW->phpwords.end()) break;
+            if (HW->phpwords.contains(prevWord)) break;
             */
             if (prevWord.size() > 0) {
                 keyW = prevWord;
@@ -4446,56 +4587,48 @@ void Editor::detectCompleteTextPHPNotFoundContext(QString text, QChar prevChar,
         std::unordered_map<std::string, std::string>::iterator addedClassMethodsIterator;
         if (prevType.size() > 0) {
             QString _text = prevType + "::" + text;
-            for (auto & it : CW->phpClassMethodsComplete) {
-                QString k = QString::fromStdString(it.first);
-                if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                    //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    addedClassMethodsIterator = addedClassMethods.find(classMethodComplete.toStdString());
-                    if (addedClassMethodsIterator != addedClassMethods.end()) continue;
-                    addedClassMethods[classMethodComplete.toStdString()] = classMethodComplete.toStdString();
-                    completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _text)) {
+                //completePopup->addItem(entry.key, entry.value);
+                QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                addedClassMethodsIterator = addedClassMethods.find(classMethodComplete.toStdString());
+                if (addedClassMethodsIterator != addedClassMethods.end()) continue;
+                addedClassMethods[classMethodComplete.toStdString()] = classMethodComplete.toStdString();
+                completePopup->addItem(classMethodComplete, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
             if (completePopup->count() < completePopup->limit()) {
                 // class props
                 QString _text = prevType + "::$" + text;
-                for (auto & it : CW->phpClassPropsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        if (completePopup->count() >= completePopup->limit()) break;
-                    }
+                for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _text)) {
+                    completePopup->addItem(entry.key, entry.value);
+                    if (completePopup->count() >= completePopup->limit()) break;
                 }
             }
         }
         if (text.size() > 0) {
-            QString _text = "::" + text;
+            QString _foldedText = ("::" + text).toCaseFolded();
+            QString _foldedPrevType = prevType.size() > 0 ? (prevType+"::").toCaseFolded() : "";
             if (completePopup->count() < completePopup->limit()) {
-                for (auto & it : CW->phpClassMethodsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    if (k.indexOf(_text, 0, Qt::CaseInsensitive)>0) {
-                        if (prevType.size() > 0 && k.indexOf(prevType+"::", 0, Qt::CaseInsensitive)==0) continue;
-                        //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                        QString _clsName = k.mid(0, k.indexOf(":"));
-                        QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
+                for (auto & entry : CW->findAll(CW->phpClassMethodsComplete)) {
+                    if (entry.foldedKey.indexOf(_foldedText)>0) {
+                        if (_foldedPrevType.size() > 0 && entry.foldedKey.startsWith(_foldedPrevType)) continue;
+                        //completePopup->addItem(entry.key, entry.value);
+                        QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
                         addedClassMethodsIterator = addedClassMethods.find(classMethodComplete.toStdString());
                         if (addedClassMethodsIterator != addedClassMethods.end()) continue;
                         addedClassMethods[classMethodComplete.toStdString()] = classMethodComplete.toStdString();
-                        completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
+                        completePopup->addItem(classMethodComplete, entry.value);
                         if (completePopup->count() >= completePopup->limit()) break;
                     }
                 }
             }
             if (completePopup->count() < completePopup->limit()) {
                 // class props
-                QString _text = "::$" + text;
-                for (auto & it : CW->phpClassPropsComplete) {
-                    QString k = QString::fromStdString(it.first);
-                    if (k.indexOf(_text, 0, Qt::CaseInsensitive)>0) {
-                        if (prevType.size() > 0 && k.indexOf(prevType+"::", 0, Qt::CaseInsensitive)==0) continue;
-                        completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
+                QString _foldedText = ("::$" + text).toCaseFolded();
+                for (auto & entry : CW->findAll(CW->phpClassPropsComplete)) {
+                    if (entry.foldedKey.indexOf(_foldedText)>0) {
+                        if (_foldedPrevType.size() > 0 && entry.foldedKey.startsWith(_foldedPrevType)) continue;
+                        completePopup->addItem(entry.key, entry.value);
                         if (completePopup->count() >= completePopup->limit()) break;
                     }
                 }
@@ -4504,37 +4637,28 @@ void Editor::detectCompleteTextPHPNotFoundContext(QString text, QChar prevChar,
     } else if (prevChar == ":" && prevPrevChar == ":" && text.size() > 0) {
         // class consts
         QString _text = text + "::";
-        for (auto & it : CW->phpClassConstsComplete) {
-            QString k = QString::fromStdString(it.first);
-            if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                QString classConstComplete = getFixedCompleteClassConstName(QString::fromStdString(it.first));
-                completePopup->addItem(classConstComplete, QString::fromStdString(it.second));
-                if (completePopup->count() >= completePopup->limit()) break;
-            }
+        for (auto & entry : CW->findPrefix(CW->phpClassConstsComplete, _text)) {
+            //completePopup->addItem(entry.key, entry.value);
+            QString classConstComplete = getFixedCompleteClassConstName(entry.key);
+            completePopup->addItem(classConstComplete, entry.value);
+            if (completePopup->count() >= completePopup->limit()) break;
         }
         if (completePopup->count() < completePopup->limit()) {
             // class methods
             QString _text = text + "::";
-            for (auto & it : CW->phpClassMethodsComplete) {
-                QString k = QString::fromStdString(it.first);
-                if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                    //completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    QString classMethodComplete = getFixedCompleteClassMethodName(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    completePopup->addItem(classMethodComplete, QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->phpClassMethodsComplete, _text)) {
+                //completePopup->addItem(entry.key, entry.value);
+                QString classMethodComplete = getFixedCompleteClassMethodName(entry.key, entry.value);
+                completePopup->addItem(classMethodComplete, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
         if (completePopup->count() < completePopup->limit()) {
             // class props
             QString _text = text+"::$";
-            for (auto & it : CW->phpClassPropsComplete) {
-                QString k = QString::fromStdString(it.first);
-                if (k.indexOf(_text, 0, Qt::CaseInsensitive)==0) {
-                    completePopup->addItem(QString::fromStdString(it.first), QString::fromStdString(it.second));
-                    if (completePopup->count() >= completePopup->limit()) break;
-                }
+            for (auto & entry : CW->findPrefix(CW->phpClassPropsComplete, _text)) {
+                completePopup->addItem(entry.key, entry.value);
+                if (completePopup->count() >= completePopup->limit()) break;
             }
         }
     }
@@ -4808,6 +4932,11 @@ void Editor::completePopupSelected(QString text, QString data)
 
 void Editor::parseResultChanged()
 {
+    // shared document is parsed by its source editor
+    if (documentSource != nullptr) {
+        parseLocked = false;
+        return;
+    }
     std::string modeType = highlight->getModeType();
     if (modeType == MODE_MIXED) {
         parseResultPHPChanged();
@@ -4821,14 +4950,16 @@ void Editor::parseResultChanged()
 void Editor::parseResultPHPChanged(bool async)
 {
     if (!parsePHPEnabled) return;
-    QTextCursor curs = textCursor();
+    // text could be changed in the view of the shared document
+    Editor * cursorEditor = (documentView != nullptr && documentView->focused) ? documentView : this;
+    QTextCursor curs = cursorEditor->textCursor();
     QTextBlock block = curs.block();
     int pos = curs.positionInBlock();
     std::string mode = highlight->findModeAtCursor(& block, pos);
     if (mode != MODE_PHP) return;
     QString content = getContent();
     if (!async) parseResultPHP = parserPHP.parse(content);
-    else emit parsePHP(getTabIndex(), content);
+    else if (isParseContentChanged(content)) emit parsePHP(getId(), updateParseRevision(), content);
 }
 
 void Editor::parseResultJSChanged(bool async)
@@ -4836,7 +4967,7 @@ void Editor::parseResultJSChanged(bool async)
     if (!parseJSEnabled) return;
     QString content = getContent();
     if (!async) parseResultJS = parserJS.parse(content);
-    else emit parseJS(getTabIndex(), content);
+    else if (isParseContentChanged(content)) emit parseJS(getId(), updateParseRevision(), content);
 }
 
 void Editor::parseResultCSSChanged(bool async)
@@ -4844,7 +4975,19 @@ void Editor::parseResultCSSChanged(bool async)
     if (!parseCSSEnabled) return;
     QString content = getContent();
     if (!async) parseResultCSS = parserCSS.parse(content);
-    else emit parseCSS(getTabIndex(), content);
+    else if (isParseContentChanged(content)) emit parseCSS(getId(), updateParseRevision(), content);
+}
+
+bool Editor::isParseContentChanged(const QString & content)
+{
+    // requested result is still valid, if the text was changed back
+    if (parseContentStored && content == parseContent) {
+        parseLocked = false;
+        return false;
+    }
+    parseContent = content;
+    parseContentStored = true;
+    return true;
 }
 
 void Editor::tooltip(int offset)
@@ -5412,56 +5555,35 @@ void Editor::lineMarkAreaPaintEvent(QPaintEvent *event)
     if (blockNumber>0) blockNumber--;
 
     QTextBlock block = document()->findBlockByNumber(blockNumber);
-    //int top = contentsMargins().top();
-    int top = 0; // widget has offset
-
-    if (blockNumber == 0) {
-        top += static_cast<int>(document()->documentMargin()) - verticalScrollBar()->sliderPosition();
-    } else {
-        QTextBlock prev_block = document()->findBlockByNumber(blockNumber-1);
-        int prev_y = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).y());
-        int prev_h = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).height());
-        top += prev_y + prev_h - verticalScrollBar()->sliderPosition();
-    }
-
-    int bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+    int top = getBlockTop(blockNumber);
+    int bottom = top + getBlockLayout(block).height;
 
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible()) {
-            int line = blockNumber + 1;
-            if (gitDiffLines.size() > 0 && gitDiffLines.contains(line)) {
-                Git::DiffLine mLine = gitDiffLines.value(line);
-                if (mLine.isModified) {
-                    painter.fillRect(0, top, markW, bottom - top, lineNumberModifiedBgColor);
-                }
-                if (mLine.isDeleted) {
-                    painter.fillRect(0, top, markW, 1, lineNumberDeletedBorderColor);
-                }
+            int flags = getBlockGutterFlags(blockNumber);
+            if (flags & GUTTER_FLAG_GIT_MODIFIED) {
+                painter.fillRect(0, top, markW, bottom - top, lineNumberModifiedBgColor);
             }
-            QString errorText = "", warningText = "", markText = "";
-            int error = static_cast<LineMark *>(lineMark)->getError(line, errorText);
-            int warning = static_cast<LineMark *>(lineMark)->getWarning(line, warningText);
-            int mark = static_cast<LineMark *>(lineMark)->getMark(line, markText);
-            if (error > 0 || warning > 0 || mark > 0) {
-                if (error > 0) {
-                    painter.fillRect(markW-LINE_MARK_WIDGET_RECT_WIDTH, top, LINE_MARK_WIDGET_RECT_WIDTH, fm.height(), lineErrorRectColor);
-                } else if (warning > 0) {
-                    painter.fillRect(markW-LINE_MARK_WIDGET_RECT_WIDTH, top, LINE_MARK_WIDGET_RECT_WIDTH, fm.height(), lineWarningRectColor);
-                }
-                if (mark > 0) {
-                    painter.fillRect(markW-LINE_MARK_WIDGET_LINE_WIDTH, top, LINE_MARK_WIDGET_LINE_WIDTH, bottom-top, lineMarkRectColor);
-                }
+            if (flags & GUTTER_FLAG_GIT_DELETED) {
+                painter.fillRect(0, top, markW, 1, lineNumberDeletedBorderColor);
+            }
+            if (flags & GUTTER_FLAG_ERROR) {
+                painter.fillRect(markW-LINE_MARK_WIDGET_RECT_WIDTH, top, LINE_MARK_WIDGET_RECT_WIDTH, fm.height(), lineErrorRectColor);
+            } else if (flags & GUTTER_FLAG_WARNING) {
+                painter.fillRect(markW-LINE_MARK_WIDGET_RECT_WIDTH, top, LINE_MARK_WIDGET_RECT_WIDTH, fm.height(), lineWarningRectColor);
+            }
+            if (flags & GUTTER_FLAG_MARK) {
+                painter.fillRect(markW-LINE_MARK_WIDGET_LINE_WIDTH, top, LINE_MARK_WIDGET_LINE_WIDTH, bottom-top, lineMarkRectColor);
             }
             int markRectWidth = LINE_MARK_WIDGET_RECT_WIDTH;
-            if (error >= 0 || warning >= 0) markRectWidth /= 2;
-            markPointsIterator = markPoints.find(line);
-            if (markPointsIterator != markPoints.end()) {
+            if (flags & (GUTTER_FLAG_ERROR | GUTTER_FLAG_WARNING)) markRectWidth /= 2;
+            if (flags & GUTTER_FLAG_MARK_POINT) {
                 painter.fillRect(markW-markRectWidth, top, markRectWidth, fm.height(), lineMarkRectColor);
             }
         }
         block = block.next();
         top = bottom;
-        bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+        bottom = top + getBlockLayout(block).height;
         blockNumber++;
     }
 }
@@ -5555,37 +5677,25 @@ void Editor::lineNumberAreaPaintEvent(QPaintEvent *event)
 
     QTextBlock block = document()->findBlockByNumber(blockNumber);
     QFontMetrics fm(editorFont);
-    //int top = contentsMargins().top();
-    int top = 0; // widget has offset
-
-    if (blockNumber == 0) {
-        top += static_cast<int>(document()->documentMargin()) - verticalScrollBar()->sliderPosition();
-    } else {
-        QTextBlock prev_block = document()->findBlockByNumber(blockNumber-1);
-        int prev_y = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).y());
-        int prev_h = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).height());
-        top += prev_y + prev_h - verticalScrollBar()->sliderPosition();
-    }
-
-    int bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+    int top = getBlockTop(blockNumber);
+    int bottom = top + getBlockLayout(block).height;
 
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible()) {
             QString number = QString::number(blockNumber + 1);
-            if (gitDiffLines.size() > 0 && gitDiffLines.contains(blockNumber + 1)) {
-                Git::DiffLine mLine = gitDiffLines.value(blockNumber + 1);
-                if (mLine.isModified) {
+            int flags = getBlockGutterFlags(blockNumber);
+            if (flags & GUTTER_FLAG_GIT_LINE) {
+                if (flags & GUTTER_FLAG_GIT_MODIFIED) {
                     painter.fillRect(0, top, lineNumber->width(), bottom - top, lineNumberModifiedBgColor);
                     painter.setPen(lineNumberModifiedColor);
                 } else {
                     painter.setPen(lineNumberColor);
                 }
-                if (mLine.isDeleted) {
+                if (flags & GUTTER_FLAG_GIT_DELETED) {
                     painter.fillRect(0, top, lineNumber->width(), 1, lineNumberDeletedBorderColor);
                 }
             } else {
-                modifiedLinesIterator = modifiedLines.find(blockNumber + 1);
-                if (modifiedLinesIterator != modifiedLines.end()) {
+                if (flags & GUTTER_FLAG_MODIFIED) {
                     painter.fillRect(0, top, LINE_NUMBER_WIDGET_PADDING / 2, bottom - top, lineNumberModifiedBgColor);
                 }
                 painter.setPen(lineNumberColor);
@@ -5594,7 +5704,7 @@ void Editor::lineNumberAreaPaintEvent(QPaintEvent *event)
         }
         block = block.next();
         top = bottom;
-        bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+        bottom = top + getBlockLayout(block).height;
         blockNumber++;
     }
 }
@@ -5604,25 +5714,25 @@ void Editor::highlightCloseCharPair(QChar openChar, QChar closeChar, QList<QText
     QTextCursor cursor = textCursor();
     int pos = cursor.positionInBlock()-1;
     HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-    if (blockData != nullptr && blockData->specialChars.size()>0 && blockData->specialCharsPos.size()>0 && blockData->specialChars.size()==blockData->specialCharsPos.size()) {
+    if (blockData != nullptr && blockData->specialCharsCount()>0) {
         bool sFound = false;
         int count = 0;
         int positionInBlock = -1;
         int iterations = 0;
         do {
-            if (blockData->specialChars.size()>0 && blockData->specialCharsPos.size()>0) {
-                for (int i=blockData->specialChars.size()-1; i>=0; i--) {
+            if (blockData->specialCharsCount()>0) {
+                for (int i=blockData->specialCharsCount()-1; i>=0; i--) {
                     iterations++;
                     if (iterations > SEARCH_LIMIT) break;
-                    QChar c = blockData->specialChars.at(i);
-                    if (!sFound && c == closeChar && blockData->specialCharsPos.at(i) == pos) {
+                    QChar c = blockData->specialCharAt(i);
+                    if (!sFound && c == closeChar && blockData->specialCharPosAt(i) == pos) {
                         sFound = true;
                     } else if (sFound && c == closeChar) {
                         count++;
                     } else if (sFound && c == openChar && count > 0) {
                         count--;
                     } else if (sFound && c == openChar && count == 0) {
-                        positionInBlock = blockData->specialCharsPos.at(i);
+                        positionInBlock = blockData->specialCharPosAt(i);
                         cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::MoveAnchor);
                         int absPos = cursor.position();
                         cursor.setPosition(absPos+positionInBlock, QTextCursor::MoveAnchor);
@@ -5691,7 +5801,7 @@ void Editor::highlightCloseCharPair(QChar openChar, QChar closeChar, QList<QText
             if (!sFound) break;
             if (!cursor.movePosition(QTextCursor::PreviousBlock, QTextCursor::MoveAnchor)) break;
             blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-            if (blockData == nullptr || blockData->specialChars.size()!=blockData->specialCharsPos.size()) break;
+            if (blockData == nullptr) break;
         } while(positionInBlock < 0);
     }
 }
@@ -5701,25 +5811,25 @@ void Editor::highlightOpenCharPair(QChar openChar, QChar closeChar, QList<QTextE
     QTextCursor cursor = textCursor();
     int pos = cursor.positionInBlock();
     HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-    if (blockData != nullptr && blockData->specialChars.size()>0 && blockData->specialCharsPos.size()>0 && blockData->specialChars.size()==blockData->specialCharsPos.size()) {
+    if (blockData != nullptr && blockData->specialCharsCount()>0) {
         bool sFound = false;
         int count = 0;
         int positionInBlock = -1;
         int iterations = 0;
         do {
-            if (blockData->specialChars.size()>0 && blockData->specialCharsPos.size()>0) {
-                for (int i=0; i<blockData->specialChars.size(); i++) {
+            if (blockData->specialCharsCount()>0) {
+                for (int i=0; i<blockData->specialCharsCount(); i++) {
                     iterations++;
                     if (iterations > SEARCH_LIMIT) break;
-                    QChar c = blockData->specialChars.at(i);
-                    if (!sFound && c == openChar && blockData->specialCharsPos.at(i) == pos) {
+                    QChar c = blockData->specialCharAt(i);
+                    if (!sFound && c == openChar && blockData->specialCharPosAt(i) == pos) {
                         sFound = true;
                     } else if (sFound && c == openChar) {
                         count++;
                     } else if (sFound && c == closeChar && count > 0) {
                         count--;
                     } else if (sFound && c == closeChar && count == 0) {
-                        positionInBlock = blockData->specialCharsPos.at(i);
+                        positionInBlock = blockData->specialCharPosAt(i);
 
                         cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::MoveAnchor);
                         int absPos = cursor.position();
@@ -5753,7 +5863,7 @@ void Editor::highlightOpenCharPair(QChar openChar, QChar closeChar, QList<QTextE
             if (!sFound) break;
             if (!cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor)) break;
             blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-            if (blockData == nullptr || blockData->specialChars.size()!=blockData->specialCharsPos.size()) break;
+            if (blockData == nullptr) break;
         } while(positionInBlock < 0);
     }
 }
@@ -5762,25 +5872,25 @@ void Editor::highlightCloseTagPair(QString tagName, int pos, QList<QTextEdit::Ex
 {
     QTextCursor cursor = textCursor();
     HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-    if (blockData != nullptr && blockData->specialWords.size()>0 && blockData->specialWordsPos.size()>0 && blockData->specialWords.size()==blockData->specialWordsPos.size()) {
+    if (blockData != nullptr && blockData->specialWordsCount()>0) {
         bool sFound = false;
         int count = 0;
         int positionInBlock = -1;
         int iterations = 0;
         do {
-            if (blockData->specialWords.size()>0 && blockData->specialWordsPos.size()>0) {
-                for (int i=blockData->specialWords.size()-1; i>=0; i--) {
+            if (blockData->specialWordsCount()>0) {
+                for (int i=blockData->specialWordsCount()-1; i>=0; i--) {
                     iterations++;
                     if (iterations > SEARCH_LIMIT) break;
-                    QString w = blockData->specialWords.at(i);
-                    if (!sFound && w == "/"+tagName && blockData->specialWordsPos.at(i) == pos) {
+                    QString w = blockData->specialWordAt(i);
+                    if (!sFound && w == "/"+tagName && blockData->specialWordPosAt(i) == pos) {
                         sFound = true;
                     } else if (sFound && w == "/"+tagName) {
                         count++;
                     } else if (sFound && w == tagName && count > 0) {
                         count--;
                     } else if (sFound && w == tagName && count == 0) {
-                        positionInBlock = blockData->specialWordsPos.at(i);
+                        positionInBlock = blockData->specialWordPosAt(i);
                         bool _found = false;
                         int _start = -1, _length = 0, _offset = 0;
                         QString blockText = cleanUpText(cursor.block().text());
@@ -5849,7 +5959,7 @@ void Editor::highlightCloseTagPair(QString tagName, int pos, QList<QTextEdit::Ex
             if (!sFound) break;
             if (!cursor.movePosition(QTextCursor::PreviousBlock, QTextCursor::MoveAnchor)) break;
             blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-            if (blockData == nullptr || blockData->specialWords.size()!=blockData->specialWordsPos.size()) break;
+            if (blockData == nullptr) break;
         } while(positionInBlock < 0);
     }
 }
@@ -5858,25 +5968,25 @@ void Editor::highlightOpenTagPair(QString tagName, int pos, QList<QTextEdit::Ext
 {
     QTextCursor cursor = textCursor();
     HighlightData * blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-    if (blockData != nullptr && blockData->specialWords.size()>0 && blockData->specialWordsPos.size()>0 && blockData->specialWords.size()==blockData->specialWordsPos.size()) {
+    if (blockData != nullptr && blockData->specialWordsCount()>0) {
         bool sFound = false;
         int count = 0;
         int positionInBlock = -1;
         int iterations = 0;
         do {
-            if (blockData->specialWords.size()>0 && blockData->specialWordsPos.size()>0) {
-                for (int i=0; i<blockData->specialWords.size(); i++) {
+            if (blockData->specialWordsCount()>0) {
+                for (int i=0; i<blockData->specialWordsCount(); i++) {
                     iterations++;
                     if (iterations > SEARCH_LIMIT) break;
-                    QString w = blockData->specialWords.at(i);
-                    if (!sFound && w == tagName && blockData->specialWordsPos.at(i) == pos) {
+                    QString w = blockData->specialWordAt(i);
+                    if (!sFound && w == tagName && blockData->specialWordPosAt(i) == pos) {
                         sFound = true;
                     } else if (sFound && w == tagName) {
                         count++;
                     } else if (sFound && w == "/"+tagName && count > 0) {
                         count--;
                     } else if (sFound && w == "/"+tagName && count == 0) {
-                        positionInBlock = blockData->specialWordsPos.at(i);
+                        positionInBlock = blockData->specialWordPosAt(i);
                         bool _found = false;
                         int _start = -1, _length = 0, _offset = 0;
                         QString blockText = cleanUpText(cursor.block().text());
@@ -5945,7 +6055,7 @@ void Editor::highlightOpenTagPair(QString tagName, int pos, QList<QTextEdit::Ext
             if (!sFound) break;
             if (!cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor)) break;
             blockData = dynamic_cast<HighlightData *>(cursor.block().userData());
-            if (blockData == nullptr || blockData->specialWords.size()!=blockData->specialWordsPos.size()) break;
+            if (blockData == nullptr) break;
         } while(positionInBlock < 0);
     }
 }
@@ -6581,6 +6691,7 @@ void Editor::replaceAllText(QString searchTxt, QString replaceTxt, bool CaSe, bo
             modifiedLinesIterator = modifiedLines.find(curs.block().blockNumber() + 1);
             if (modifiedLinesIterator == modifiedLines.end()) {
                 modifiedLines[curs.block().blockNumber() + 1] = curs.block().blockNumber() + 1;
+                gutterRevision++;
                 HighlightData * blockData = dynamic_cast<HighlightData *>(curs.block().userData());
                 if (blockData != nullptr) {
                     blockData->isModified = true;
@@ -6830,19 +6941,8 @@ void Editor::showLineMark(int y)
     if (blockNumber>0) blockNumber--;
 
     QTextBlock block = document()->findBlockByNumber(blockNumber);
-    //int top = contentsMargins().top();
-    int top = 0; // widget has offset
-
-    if (blockNumber == 0) {
-        top += static_cast<int>(document()->documentMargin()) - verticalScrollBar()->sliderPosition();
-    } else {
-        QTextBlock prev_block = document()->findBlockByNumber(blockNumber-1);
-        int prev_y = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).y());
-        int prev_h = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).height());
-        top += prev_y + prev_h - verticalScrollBar()->sliderPosition();
-    }
-
-    int bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+    int top = getBlockTop(blockNumber);
+    int bottom = top + getBlockLayout(block).height;
 
     QString tooltipText = "";
     while (block.isValid() && top < y) {
@@ -6865,7 +6965,7 @@ void Editor::showLineMark(int y)
         }
         block = block.next();
         top = bottom;
-        bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+        bottom = top + getBlockLayout(block).height;
         blockNumber++;
     }
 
@@ -6893,19 +6993,8 @@ void Editor::addLineMark(int y)
     if (blockNumber>0) blockNumber--;
 
     QTextBlock block = document()->findBlockByNumber(blockNumber);
-    //int top = contentsMargins().top();
-    int top = 0; // widget has offset
-
-    if (blockNumber == 0) {
-        top += static_cast<int>(document()->documentMargin()) - verticalScrollBar()->sliderPosition();
-    } else {
-        QTextBlock prev_block = document()->findBlockByNumber(blockNumber-1);
-        int prev_y = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).y());
-        int prev_h = static_cast<int>(document()->documentLayout()->blockBoundingRect(prev_block).height());
-        top += prev_y + prev_h - verticalScrollBar()->sliderPosition();
-    }
-
-    int bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+    int top = getBlockTop(blockNumber);
+    int bottom = top + getBlockLayout(block).height;
 
     bool changed = false;
     while (block.isValid() && top < y) {
@@ -6915,6 +7004,7 @@ void Editor::addLineMark(int y)
             markPointsIterator = markPoints.find(line);
             if (markPointsIterator == markPoints.end()) {
                 markPoints[line] = text.toStdString();
+                gutterRevision++;
                 HighlightData * blockData = dynamic_cast<HighlightData *>(block.userData());
                 if (blockData != nullptr) {
                     blockData->hasMarkPoint = true;
@@ -6922,6 +7012,7 @@ void Editor::addLineMark(int y)
                 }
             } else {
                 markPoints.erase(markPointsIterator);
+                gutterRevision++;
                 HighlightData * blockData = dynamic_cast<HighlightData *>(block.userData());
                 if (blockData != nullptr) {
                     blockData->hasMarkPoint = false;
@@ -6933,7 +7024,7 @@ void Editor::addLineMark(int y)
         }
         block = block.next();
         top = bottom;
-        bottom = top + static_cast<int>(document()->documentLayout()->blockBoundingRect(block).height());
+        bottom = top + getBlockLayout(block).height;
         blockNumber++;
     }
 
@@ -7082,6 +7173,8 @@ void Editor::save(QString name)
     emit modifiedStateChanged(tabIndex, modified);
     emit statusBarText(tabIndex, tr("Saved"));
     if (nameChanged) emit filenameChanged(tabIndex, fileName);
+    Editor * sharedEditor = getSharedDocumentEditor();
+    if (sharedEditor != nullptr) sharedEditor->sharedDocumentSaved(fileName);
     emit saved(tabIndex);
     if (highlight->getModeType() == MODE_MIXED) highlightUnusedVars(true);
 }
@@ -7511,6 +7604,10 @@ void Editor::forward()
 
 void Editor::reloadRequested()
 {
+    if (documentSource != nullptr) {
+        documentSource->reloadRequested();
+        return;
+    }
     if (fileName.size() == 0 || !Helper::fileExists(fileName)) return;
     if (!Helper::showQuestion(tr("Reload"), tr("Reload %1 ?").arg(fileName))) return;
     QString txt = Helper::loadFile(fileName, getEncoding(), getFallbackEncoding());
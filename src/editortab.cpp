@@ -8,7 +8,7 @@
 #include <QVBoxLayout>
 #include "helper.h"
 
-EditorTab::EditorTab(QWidget *parent) : QWidget(parent)
+EditorTab::EditorTab(QWidget *parent) : QWidget(parent), line(0)
 {
     QVBoxLayout * layout = new QVBoxLayout();
     layout->setContentsMargins(0, 0, 0, 0);
@@ -19,6 +19,8 @@ void EditorTab::setEditor(Editor * editor)
 {
     if (layout() == nullptr) return;
     layout()->addWidget(editor);
+    filePath = "";
+    line = 0;
 }
 
 Editor * EditorTab::getEditor()
@@ -31,3 +33,29 @@ Editor * EditorTab::getEditor()
     Editor * textEditor = static_cast<Editor *>(textEdit);
     return textEditor;
 }
+
+void EditorTab::setLazy(QString path)
+{
+    // lazy tab keeps only the path and the line, until editor is created
+    filePath = path;
+}
+
+bool EditorTab::isLazy()
+{
+    return filePath.size() > 0 && getEditor() == nullptr;
+}
+
+QString EditorTab::getFilePath()
+{
+    return filePath;
+}
+
+void EditorTab::setLine(int line)
+{
+    this->line = line;
+}
+
+int EditorTab::getLine()
+{
+    return line;
+}
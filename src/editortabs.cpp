@@ -13,6 +13,7 @@
 #include <QStandardPaths>
 #include <QFileDialog>
 #include <QShortcut>
+#include <QTimer>
 #include <iomanip>
 #include <sstream>
 #include "fileiconprovider.h"
@@ -50,6 +51,26 @@ Editor * EditorTabs::getTabEditor(int index)
     return editorTab->getEditor();
 }
 
+EditorTab * EditorTabs::getLazyTab(int index)
+{
+    QWidget * tab = tabWidget->widget(index);
+    if (tab == nullptr) return nullptr;
+    EditorTab * editorTab = static_cast<EditorTab *>(tab);
+    if (!editorTab->isLazy()) return nullptr;
+    return editorTab;
+}
+
+int EditorTabs::findTab(QString filepath)
+{
+    for (int i=0; i<tabWidget->count(); i++){
+        Editor * textEditor = getTabEditor(i);
+        if (textEditor != nullptr && textEditor->getFileName() == filepath) return i;
+        EditorTab * lazyTab = getLazyTab(i);
+        if (lazyTab != nullptr && lazyTab->getFilePath() == filepath) return i;
+    }
+    return -1;
+}
+
 QString EditorTabs::getTabNameFromPath(QString filepath)
 {
     QString tabName = filepath;
@@ -73,16 +94,87 @@ void EditorTabs::createTab(QString filepath, bool initHighlight)
     }
 
     EditorTab * tab = new EditorTab();
-    editor = new Editor();
-    tab->setEditor(editor);
+    QString tabName = getTabNameFromPath(filepath);
+    tabWidget->blockSignals(true);
+    int tabIndex = tabWidget->addTab(tab, tabName);
+    tabWidget->setTabToolTip(tabIndex, filepath);
+    tabWidget->setCurrentIndex(tabIndex);
+    tabWidget->blockSignals(false);
+
+    initTabEditor(tab, tabIndex, filepath, initHighlight);
+}
 
+int EditorTabs::createLazyTab(QString filepath)
+{
+    if (filepath.size() == 0 || !Helper::fileExists(filepath)) return -1;
+    // big files are confirmed when opened, so they are not deferred
+    if (Helper::getFileSize(filepath) >= TOO_BIG_FILE_SIZE) {
+        createTab(filepath, false);
+        return findTab(filepath);
+    }
+    EditorTab * tab = new EditorTab();
+    tab->setLazy(filepath);
     QString tabName = getTabNameFromPath(filepath);
     tabWidget->blockSignals(true);
     int tabIndex = tabWidget->addTab(tab, tabName);
     tabWidget->setTabToolTip(tabIndex, filepath);
+    tabWidget->blockSignals(false);
+    return tabIndex;
+}
+
+void EditorTabs::materializeTab(int index, bool initHighlight)
+{
+    EditorTab * tab = getLazyTab(index);
+    if (tab == nullptr) return;
+    QString filepath = tab->getFilePath();
+    int line = tab->getLine();
+    bool deleted = !Helper::fileExists(filepath);
+    initTabEditor(tab, index, filepath, initHighlight);
+    if (deleted) editor->setModified(true);
+    if (line > 0) {
+        editor->gotoLine(line);
+        editor->resetExtraSelections();
+    }
+}
+
+void EditorTabs::openSharedFile(Editor * sourceEditor)
+{
+    if (sourceEditor == nullptr) return;
+    QString filepath = sourceEditor->getFileName();
+    int tabIndex = findTab(filepath);
+    if (tabIndex >= 0) {
+        tabWidget->setCurrentIndex(tabIndex);
+        return;
+    }
+    // document is shared with one view only
+    if (sourceEditor->getSharedDocumentEditor() != nullptr) {
+        openFile(filepath);
+        return;
+    }
+    EditorTab * tab = new EditorTab();
+    QString tabName = getTabNameFromPath(filepath);
+    tabWidget->blockSignals(true);
+    tabIndex = tabWidget->addTab(tab, tabName);
+    tabWidget->setTabToolTip(tabIndex, filepath);
     tabWidget->setCurrentIndex(tabIndex);
     tabWidget->blockSignals(false);
 
+    createTabEditor(tab, tabIndex);
+    editor->setSharedDocument(sourceEditor);
+    editor->setFocus();
+
+    emit tabOpened(tabIndex);
+    Editor * currentEditor = editor;
+    QTimer::singleShot(INIT_HIGHLIGHTER_DELAY, currentEditor, ([currentEditor](){
+        currentEditor->initHighlighter();
+    }));
+}
+
+void EditorTabs::createTabEditor(EditorTab * tab, int tabIndex)
+{
+    editor = new Editor();
+    tab->setEditor(editor);
+
     editor->setTabIndex(tabIndex);
     editor->init();
     //editor->resetExtraSelections();
@@ -95,9 +187,9 @@ void EditorTabs::createTab(QString filepath, bool initHighlight)
     connect(editor, SIGNAL(ready(int)), this, SLOT(ready(int)));
     connect(editor, SIGNAL(showDeclaration(int,QString)), this, SLOT(showDeclaration(int,QString)));
     connect(editor, SIGNAL(showHelp(int,QString)), this, SLOT(showHelp(int,QString)));
-    connect(editor, SIGNAL(parsePHP(int,QString)), this, SLOT(parsePHP(int,QString)));
-    connect(editor, SIGNAL(parseJS(int,QString)), this, SLOT(parseJS(int,QString)));
-    connect(editor, SIGNAL(parseCSS(int,QString)), this, SLOT(parseCSS(int,QString)));
+    connect(editor, SIGNAL(parsePHP(int,int,QString)), this, SLOT(parsePHP(int,int,QString)));
+    connect(editor, SIGNAL(parseJS(int,int,QString)), this, SLOT(parseJS(int,int,QString)));
+    connect(editor, SIGNAL(parseCSS(int,int,QString)), this, SLOT(parseCSS(int,int,QString)));
     connect(editor, SIGNAL(undoRedoChanged(int)), this, SLOT(undoRedoChanged(int)));
     connect(editor, SIGNAL(backForwardChanged(int)), this, SLOT(backForwardChanged(int)));
     connect(editor, SIGNAL(searchInFiles(QString)), this, SLOT(searchInFiles(QString)));
@@ -106,6 +198,11 @@ void EditorTabs::createTab(QString filepath, bool initHighlight)
     connect(editor, SIGNAL(warning(int,QString,QString)), this, SLOT(warning(int,QString,QString)));
     connect(editor, SIGNAL(showPopupText(int,QString)), this, SLOT(showPopupText(int,QString)));
     connect(editor, SIGNAL(showPopupError(int,QString)), this, SLOT(showPopupError(int,QString)));
+}
+
+void EditorTabs::initTabEditor(EditorTab * tab, int tabIndex, QString filepath, bool initHighlight)
+{
+    createTabEditor(tab, tabIndex);
 
     QString txt = Helper::loadFile(filepath, editor->getEncoding(), editor->getFallbackEncoding());
     QString ext = "";
@@ -145,6 +242,7 @@ void EditorTabs::createTab(QString filepath, bool initHighlight)
 void EditorTabs::switchTab(int index)
 {
     if (index >= 0) {
+        materializeTab(index, true);
         editor = getTabEditor(index);
         if (editor != nullptr) {
             editor->updateSizes();
@@ -176,7 +274,10 @@ void EditorTabs::closeTab(int index)
     ) {
         return;
     }
-    if (textEditor != nullptr) textEditor->setTabIndex(-1);
+    if (textEditor != nullptr) {
+        textEditor->setTabIndex(-1);
+        emit editorClosed(textEditor->getId());
+    }
     blockSig = true;
     bool isSwitched = false;
     if (editor == textEditor) {
@@ -221,17 +322,39 @@ void EditorTabs::openFile(QString filepath, bool initHighlight)
 {
     if (!Helper::fileExists(filepath)) return;
     // check open tab
-    for (int i=0; i<tabWidget->count(); i++){
-        Editor * textEditor = getTabEditor(i);
-        if (textEditor != nullptr && textEditor->getFileName() == filepath) {
-            int tabIndex = textEditor->getTabIndex();
-            tabWidget->setCurrentIndex(tabIndex);
-            return;
-        }
+    int tabIndex = findTab(filepath);
+    if (tabIndex >= 0) {
+        tabWidget->setCurrentIndex(tabIndex);
+        return;
     }
     createTab(filepath, initHighlight);
 }
 
+void EditorTabs::openFiles(QStringList files)
+{
+    // editors are created when tabs are activated
+    int current = -1;
+    for (int i=0; i<files.size(); i++) {
+        QString filepath = files.at(i);
+        int tabIndex = findTab(filepath);
+        if (tabIndex < 0) tabIndex = createLazyTab(filepath);
+        if (tabIndex >= 0) current = tabIndex;
+    }
+    if (current < 0) return;
+    tabWidget->blockSignals(true);
+    tabWidget->setCurrentIndex(current);
+    tabWidget->blockSignals(false);
+    // the current tab could be changed again, before it is shown
+    QTimer::singleShot(0, this, SLOT(activateCurrentTab()));
+}
+
+void EditorTabs::activateCurrentTab()
+{
+    int index = tabWidget->currentIndex();
+    if (index < 0) return;
+    if (getLazyTab(index) != nullptr || getTabEditor(index) != editor) switchTab(index);
+}
+
 void EditorTabs::open(QString dir)
 {
     if (editor != nullptr) editor->hidePopups();
@@ -302,6 +425,10 @@ void EditorTabs::closeSaved()
             closeTab(tabIndex);
             continue;
         }
+        if (getLazyTab(i) != nullptr) {
+            closeTab(i);
+            continue;
+        }
         i++;
     }
 }
@@ -324,12 +451,13 @@ QStringList EditorTabs::getOpenTabFiles()
 {
     QStringList files;
     for (int i=0; i<tabWidget->count(); i++) {
+        QString file = "";
         Editor * tabEditor = getTabEditor(i);
-        if (tabEditor != nullptr) {
-            QString file = tabEditor->getFileName();
-            if (Helper::fileExists(file)) {
-                files.append(file);
-            }
+        EditorTab * lazyTab = getLazyTab(i);
+        if (tabEditor != nullptr) file = tabEditor->getFileName();
+        else if (lazyTab != nullptr) file = lazyTab->getFilePath();
+        if (file.size() > 0 && Helper::fileExists(file)) {
+            files.append(file);
         }
     }
     return files;
@@ -340,9 +468,12 @@ QList<int> EditorTabs::getOpenTabLines()
     QList<int> lines;
     for (int i=0; i<tabWidget->count(); i++) {
         Editor * tabEditor = getTabEditor(i);
+        EditorTab * lazyTab = getLazyTab(i);
         if (tabEditor != nullptr) {
             int line = tabEditor->getCursorLine();
             lines.append(line);
+        } else if (lazyTab != nullptr) {
+            lines.append(lazyTab->getLine());
         }
     }
     return lines;
@@ -352,10 +483,13 @@ void EditorTabs::setTabLines(QList<int> lines)
 {
     for (int i=0; i<lines.size(); i++) {
         Editor * tabEditor = getTabEditor(i);
+        EditorTab * lazyTab = getLazyTab(i);
         if (tabEditor != nullptr) {
             int line = lines.at(i);
             tabEditor->gotoLine(line);
             tabEditor->resetExtraSelections();
+        } else if (lazyTab != nullptr) {
+            lazyTab->setLine(lines.at(i));
         }
     }
 }
@@ -479,6 +613,12 @@ void EditorTabs::fileBrowserFileRenamed(QString oldpath, QString newpath)
             tabWidget->setTabText(tabIndex, tabName);
             tabWidget->setTabToolTip(tabIndex, newpath);
         }
+        EditorTab * lazyTab = getLazyTab(i);
+        if (lazyTab != nullptr && lazyTab->getFilePath() == oldpath) {
+            lazyTab->setLazy(newpath);
+            tabWidget->setTabText(i, getTabNameFromPath(newpath));
+            tabWidget->setTabToolTip(i, newpath);
+        }
     }
     if (doEmit) emit editorFilenameChanged(newpath);
 }
@@ -500,6 +640,13 @@ void EditorTabs::fileBrowserFolderRenamed(QString oldpath, QString newpath)
             tabWidget->setTabText(tabIndex, tabName);
             tabWidget->setTabToolTip(tabIndex, editorNewFilename);
         }
+        EditorTab * lazyTab = getLazyTab(i);
+        if (lazyTab != nullptr && lazyTab->getFilePath().indexOf(oldpath+"/") == 0) {
+            QString lazyNewFilename = newpath + lazyTab->getFilePath().mid(oldpath.size());
+            lazyTab->setLazy(lazyNewFilename);
+            tabWidget->setTabText(i, getTabNameFromPath(lazyNewFilename));
+            tabWidget->setTabToolTip(i, lazyNewFilename);
+        }
     }
     if (doEmit) emit editorFilenameChanged(editor->getFileName());
 }
@@ -517,6 +664,14 @@ void EditorTabs::fileBrowserDeleted(QString path)
             }
             break;
         }
+        EditorTab * lazyTab = getLazyTab(i);
+        if (lazyTab != nullptr && lazyTab->getFilePath() == path) {
+            // editor is marked modified, when the tab is activated
+            if (Helper::showQuestion(tr("Delete"), tr("Close tab with deleted file \"%1\" ?").arg(path))) {
+                closeTab(i);
+            }
+            break;
+        }
     }
     emit gitTabRefreshRequested();
 }
@@ -528,22 +683,22 @@ void EditorTabs::ready(int index)
     emit editorReady(index);
 }
 
-void EditorTabs::parsePHP(int index, QString text)
+void EditorTabs::parsePHP(int editorId, int revision, QString text)
 {
-    if (editor == nullptr || editor->getTabIndex() != index || !editor->isReady()) return;
-    emit editorParsePHPRequested(index, text);
+    if (editor == nullptr || editor->getId() != editorId || !editor->isReady()) return;
+    emit editorParsePHPRequested(editorId, revision, text);
 }
 
-void EditorTabs::parseJS(int index, QString text)
+void EditorTabs::parseJS(int editorId, int revision, QString text)
 {
-    if (editor == nullptr || editor->getTabIndex() != index || !editor->isReady()) return;
-    emit editorParseJSRequested(index, text);
+    if (editor == nullptr || editor->getId() != editorId || !editor->isReady()) return;
+    emit editorParseJSRequested(editorId, revision, text);
 }
 
-void EditorTabs::parseCSS(int index, QString text)
+void EditorTabs::parseCSS(int editorId, int revision, QString text)
 {
-    if (editor == nullptr || editor->getTabIndex() != index || !editor->isReady()) return;
-    emit editorParseCSSRequested(index, text);
+    if (editor == nullptr || editor->getId() != editorId || !editor->isReady()) return;
+    emit editorParseCSSRequested(editorId, revision, text);
 }
 
 void EditorTabs::undoRedoChanged(int index)
@@ -23,6 +23,7 @@
 #include "project.h"
 #include "icon.h"
 #include "scroller.h"
+#include "pathfilter.h"
 
 const QString FB_ACTION_NAME_CREATE_FILE = "fb_new_file";
 const QString FB_ACTION_NAME_CREATE_FOLDER = "fb_new_folder";
@@ -106,13 +107,15 @@ void FileBrowser::buildFileBrowserTree(QString startDir, QTreeWidgetItem * paren
     if (startDir.size() > 1 && startDir.at(startDir.size()-1) == "/") startDir = startDir.mid(0, startDir.size()-1);
     QFileInfo startDirInfo(startDir);
     if (!startDirInfo.exists() || !startDirInfo.isReadable() || !startDirInfo.isDir()) return;
+    // ignored directories are hidden, ignored files are still shown to be opened
+    PathFilter filter(parent == nullptr ? startDir : fbpath);
     QDirIterator it(startDir, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
     QStringList dirsList, filesList;
     while (it.hasNext()) {
         QString path = it.next();
-        QFileInfo fInfo(path);
+        QFileInfo fInfo = it.fileInfo();
         if (!fInfo.exists() || !fInfo.isReadable()) continue;
-        if (fInfo.isDir() && (fInfo.fileName() == ".git" || fInfo.fileName() == PROJECT_SUBDIR || fInfo.fileName() == ".idea" || fInfo.fileName() == ".vscode" || fInfo.fileName() == "nbproject")) continue;
+        if (fInfo.isDir() && filter.isIgnored(path, true)) continue;
         if (fInfo.isDir()) dirsList.append(path);
         else filesList.append(path);
     }
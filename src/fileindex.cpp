@@ -0,0 +1,262 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "fileindex.h"
+#include <QDirIterator>
+#include <QFileInfo>
+#include <algorithm>
+#include "completeindex.h"
+
+const int FILE_INDEX_EXPIRE_INTERVAL = 30000;
+const int FILE_INDEX_SCORE_NAME = 500;
+
+FileIndex::FileIndex(): built(false), fuzzyCached(false)
+{
+
+}
+
+bool FileIndex::compareMatches(const Match & a, const Match & b)
+{
+    if (a.score != b.score) return a.score > b.score;
+    if (a.entry->relativePath.size() != b.entry->relativePath.size()) return a.entry->relativePath.size() < b.entry->relativePath.size();
+    return a.entry->relativePath < b.entry->relativePath;
+}
+
+QString FileIndex::getParentPath(const QString & path)
+{
+    int p = path.lastIndexOf("/");
+    if (p < 0) return "";
+    if (p == 0) return "/";
+    return path.mid(0, p);
+}
+
+void FileIndex::build(QString dir)
+{
+    clear();
+    rootPath = dir;
+    rootPrefix = dir.endsWith("/") ? dir : dir + "/";
+    filter = PathFilter(dir);
+    addDirectory(dir);
+    builtTimer.start();
+    built = true;
+}
+
+void FileIndex::clear()
+{
+    rootPath = "";
+    rootPrefix = "";
+    entries.clear();
+    files.clear();
+    directories.clear();
+    children.clear();
+    built = false;
+    resetFuzzyCache();
+}
+
+bool FileIndex::isBuilt()
+{
+    return built;
+}
+
+bool FileIndex::isExpired()
+{
+    return !built || builtTimer.hasExpired(FILE_INDEX_EXPIRE_INTERVAL);
+}
+
+QString FileIndex::getPath()
+{
+    return rootPath;
+}
+
+int FileIndex::getFilesCount()
+{
+    return static_cast<int>(entries.size());
+}
+
+void FileIndex::addDirectory(QString dir)
+{
+    directories.insert(dir);
+    if (dir != rootPath) addChild(dir);
+    QDirIterator it(dir, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo fInfo = it.fileInfo();
+        if (!fInfo.exists() || !fInfo.isReadable()) continue;
+        if (fInfo.isDir()) {
+            if (directories.contains(path) || filter.isIgnored(path, true)) continue;
+            addDirectory(path);
+        } else if (fInfo.isFile() && !files.contains(path) && !filter.isIgnored(path, false)) {
+            addFile(path);
+        }
+    }
+}
+
+void FileIndex::addFile(QString path)
+{
+    Entry entry;
+    entry.path = path;
+    entry.relativePath = path.mid(rootPrefix.size());
+    entry.foldedPath = entry.relativePath.toCaseFolded();
+    int p = entry.relativePath.lastIndexOf("/");
+    entry.name = entry.relativePath.mid(p+1);
+    entry.foldedName = entry.foldedPath.mid(p+1);
+    entry.charsMask = CompleteIndex::getCharsMask(entry.foldedPath);
+    entries.push_back(entry);
+    files.insert(path);
+    addChild(path);
+}
+
+void FileIndex::addChild(QString path)
+{
+    children[getParentPath(path)].insert(path);
+}
+
+void FileIndex::removePaths(QStringList paths)
+{
+    if (paths.size() == 0) return;
+    QStringList prefixes;
+    for (int i=0; i<paths.size(); i++) {
+        QString path = paths.at(i);
+        prefixes.append(path + "/");
+        QHash<QString, QSet<QString>>::iterator parent = children.find(getParentPath(path));
+        if (parent != children.end()) parent->remove(path);
+    }
+    // removed paths and their subtrees are dropped in one pass
+    size_t to = 0;
+    for (size_t i=0; i<entries.size(); i++) {
+        const QString & entryPath = entries[i].path;
+        bool removed = false;
+        for (int y=0; y<paths.size(); y++) {
+            if (entryPath == paths.at(y) || entryPath.startsWith(prefixes.at(y))) {
+                removed = true;
+                break;
+            }
+        }
+        if (removed) {
+            files.remove(entryPath);
+            continue;
+        }
+        if (to != i) entries[to] = entries[i];
+        to++;
+    }
+    entries.resize(to);
+    QSet<QString>::iterator it = directories.begin();
+    while (it != directories.end()) {
+        bool removed = false;
+        for (int y=0; y<paths.size(); y++) {
+            if (*it == paths.at(y) || it->startsWith(prefixes.at(y))) {
+                removed = true;
+                break;
+            }
+        }
+        if (removed) {
+            children.remove(*it);
+            it = directories.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FileIndex::updateDirectory(QString dir)
+{
+    // only the changed directory is listed, indexed children missing from it are removed
+    QSet<QString> found;
+    QDirIterator it(dir, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo fInfo = it.fileInfo();
+        if (!fInfo.exists() || !fInfo.isReadable()) continue;
+        found.insert(path);
+        if (fInfo.isDir()) {
+            if (directories.contains(path) || filter.isIgnored(path, true)) continue;
+            addDirectory(path);
+        } else if (fInfo.isFile() && !files.contains(path) && !filter.isIgnored(path, false)) {
+            addFile(path);
+        }
+    }
+    QStringList removed;
+    QHash<QString, QSet<QString>>::const_iterator dirChildren = children.constFind(dir);
+    if (dirChildren != children.constEnd()) {
+        for (QSet<QString>::const_iterator child = dirChildren->constBegin(); child != dirChildren->constEnd(); ++child) {
+            if (!found.contains(*child)) removed.append(*child);
+        }
+    }
+    removePaths(removed);
+}
+
+void FileIndex::update(QStringList paths)
+{
+    if (!built) return;
+    QStringList removed;
+    for (int i=0; i<paths.size(); i++) {
+        QString path = paths.at(i);
+        if (path != rootPath && !path.startsWith(rootPrefix)) continue;
+        QFileInfo fInfo(path);
+        if (!fInfo.exists()) {
+            removed.append(path);
+        } else if (fInfo.isDir()) {
+            // ignored directories are not indexed, so they are not updated
+            if (directories.contains(path)) updateDirectory(path);
+        } else if (fInfo.isFile() && !files.contains(path) && directories.contains(getParentPath(path)) && !filter.isIgnored(path, false)) {
+            addFile(path);
+        }
+    }
+    removePaths(removed);
+    resetFuzzyCache();
+}
+
+void FileIndex::resetFuzzyCache()
+{
+    fuzzyCached = false;
+    fuzzyPattern = "";
+    fuzzyCandidates.clear();
+}
+
+int FileIndex::score(const Entry & entry, const QString & foldedPattern)
+{
+    // matches in file name are ranked above matches spread over the path
+    int nameScore = CompleteIndex::fuzzyScore(entry.name, entry.foldedName, foldedPattern);
+    if (nameScore >= 0) return nameScore + FILE_INDEX_SCORE_NAME;
+    return CompleteIndex::fuzzyScore(entry.relativePath, entry.foldedPath, foldedPattern);
+}
+
+void FileIndex::find(QString pattern, std::vector<Match> & matches, int limit)
+{
+    if (entries.size() == 0 || limit <= 0) return;
+    QString foldedPattern = pattern.toCaseFolded();
+    if (foldedPattern.size() == 0) return;
+    quint64 mask = CompleteIndex::getCharsMask(foldedPattern);
+    std::vector<int> candidates;
+    std::vector<Match> found;
+    // a path matching the longer pattern also matches its prefix,
+    // so the previous candidates are refined instead of scanning all
+    if (fuzzyCached && foldedPattern.startsWith(fuzzyPattern)) {
+        for (int i : fuzzyCandidates) {
+            const Entry & entry = entries[static_cast<size_t>(i)];
+            if ((entry.charsMask & mask) != mask) continue;
+            int s = score(entry, foldedPattern);
+            if (s < 0) continue;
+            candidates.push_back(i);
+            found.push_back(Match{& entry, s});
+        }
+    } else {
+        for (size_t i=0; i<entries.size(); i++) {
+            const Entry & entry = entries[i];
+            if ((entry.charsMask & mask) != mask) continue;
+            int s = score(entry, foldedPattern);
+            if (s < 0) continue;
+            candidates.push_back(static_cast<int>(i));
+            found.push_back(Match{& entry, s});
+        }
+    }
+    fuzzyPattern = foldedPattern;
+    fuzzyCandidates.swap(candidates);
+    fuzzyCached = true;
+    size_t count = std::min(found.size(), static_cast<size_t>(limit));
+    std::partial_sort(found.begin(), found.begin() + static_cast<long>(count), found.end(), compareMatches);
+    matches.insert(matches.end(), found.begin(), found.begin() + static_cast<long>(count));
+}
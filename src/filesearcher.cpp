@@ -0,0 +1,292 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "filesearcher.h"
+#include <QThread>
+#include <QFile>
+#include <QTextCodec>
+#include <QMutexLocker>
+#include <cstring>
+#include "helper.h"
+#include "workerlanes.h"
+
+const int SEARCH_FILE_MAX_RESULTS = 1000;
+const int SEARCH_BINARY_CHECK_SIZE = 8000;
+const QString SEARCH_ASCII_SAMPLE = "<?php echo $_a[0] + 1; // ~\t\n";
+const QByteArray SEARCH_FOLDING_KELVIN = "\xE2\x84\xAA";
+const QByteArray SEARCH_FOLDING_LONG_S = "\xC5\xBF";
+
+FileSearcher::FileSearcher(QString searchText, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp, std::string encoding, std::string encodingFallback):
+    searchedCount(0),
+    cancelled(0),
+    searchIndex(0),
+    takeIndex(0),
+    finished(false),
+    searchText(searchText),
+    searchOptionCase(searchOptionCase),
+    searchOptionWord(searchOptionWord),
+    searchOptionRegexp(searchOptionRegexp),
+    literalFolding(false),
+    asciiCompatible(false),
+    encoding(encoding),
+    encodingFallback(encodingFallback)
+{
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    QRegularExpression::PatternOptions opt = QRegularExpression::NoPatternOption;
+    if (!searchOptionCase) opt = QRegularExpression::CaseInsensitiveOption;
+    if (searchOptionWord) {
+        searchExpression = QRegularExpression("\\b"+QRegularExpression::escape(searchText)+"\\b", opt);
+    } else if (searchOptionRegexp) {
+        searchExpression = QRegularExpression(searchText, opt);
+    }
+    asciiCompatible = isAsciiCompatible(encoding) && isAsciiCompatible(encodingFallback);
+    bool isAscii = searchText.size() > 0;
+    for (int i=0; i<searchText.size(); i++) {
+        ushort c = searchText[i].unicode();
+        if (c == 0 || c >= 128) {
+            isAscii = false;
+            break;
+        }
+    }
+    // ascii text has the same bytes in both encodings, so raw file data can be checked before decoding
+    if (asciiCompatible && isAscii && !searchOptionRegexp) {
+        literal = searchOptionCase ? searchText.toLatin1() : searchText.toLower().toLatin1();
+        // kelvin sign and long s are case folded to latin letters
+        literalFolding = !searchOptionCase && (literal.contains('k') || literal.contains('s'));
+    }
+}
+
+FileSearcher::~FileSearcher()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+bool FileSearcher::isAsciiCompatible(std::string encoding)
+{
+    QTextCodec * codec = QTextCodec::codecForName(encoding.c_str());
+    if (codec == nullptr) return false;
+    return codec->fromUnicode(SEARCH_ASCII_SAMPLE) == SEARCH_ASCII_SAMPLE.toLatin1();
+}
+
+void FileSearcher::start()
+{
+    for (int i=0; i<pool.maxThreadCount(); i++) {
+        pool.start(new Task(this));
+    }
+}
+
+void FileSearcher::addFile(QString file)
+{
+    QMutexLocker locker(&mutex);
+    files.append(file);
+    results.append(Results());
+    readyList.append(false);
+    fileCondition.wakeOne();
+}
+
+void FileSearcher::finish()
+{
+    QMutexLocker locker(&mutex);
+    finished = true;
+    fileCondition.wakeAll();
+    readyCondition.wakeAll();
+}
+
+void FileSearcher::cancel()
+{
+    cancelled.storeRelease(1);
+    QMutexLocker locker(&mutex);
+    fileCondition.wakeAll();
+    readyCondition.wakeAll();
+}
+
+int FileSearcher::getSearchedCount()
+{
+    return searchedCount.loadAcquire();
+}
+
+int FileSearcher::getFilesCount()
+{
+    QMutexLocker locker(&mutex);
+    return files.size();
+}
+
+bool FileSearcher::isDone()
+{
+    QMutexLocker locker(&mutex);
+    return finished && takeIndex >= files.size();
+}
+
+void FileSearcher::wait(int msecs)
+{
+    QMutexLocker locker(&mutex);
+    bool waiting = takeIndex < readyList.size() ? !readyList.at(takeIndex) : !finished;
+    if (waiting && !cancelled.loadAcquire()) {
+        readyCondition.wait(&mutex, static_cast<unsigned long>(msecs));
+    }
+}
+
+bool FileSearcher::takeNext(QString & file, Results & fileResults)
+{
+    // results are taken in the order of added files
+    QMutexLocker locker(&mutex);
+    if (takeIndex >= readyList.size() || !readyList.at(takeIndex)) return false;
+    file = files.at(takeIndex);
+    fileResults.clear();
+    fileResults.swap(results[takeIndex]);
+    takeIndex++;
+    return true;
+}
+
+bool FileSearcher::takeFile(int & index, QString & file)
+{
+    QMutexLocker locker(&mutex);
+    while (!cancelled.loadAcquire() && !finished && searchIndex >= files.size()) {
+        fileCondition.wait(&mutex);
+    }
+    if (cancelled.loadAcquire() || searchIndex >= files.size()) return false;
+    index = searchIndex++;
+    file = files.at(index);
+    return true;
+}
+
+void FileSearcher::run()
+{
+    QRegularExpression regexp = searchExpression;
+    Parse parser;
+    int index;
+    QString file;
+    while (takeFile(index, file)) {
+        WorkerLanes::yield(WORKER_LANE_INDEX, cancelled);
+        Results fileResults;
+        searchInFile(file, fileResults, regexp, parser);
+        QMutexLocker locker(&mutex);
+        results[index].swap(fileResults);
+        readyList[index] = true;
+        searchedCount.fetchAndAddOrdered(1);
+        readyCondition.wakeAll();
+    }
+}
+
+bool FileSearcher::isBinary(const char * data, qint64 size)
+{
+    qint64 checkSize = std::min(size, static_cast<qint64>(SEARCH_BINARY_CHECK_SIZE));
+    return std::memchr(data, 0, static_cast<size_t>(checkSize)) != nullptr;
+}
+
+bool FileSearcher::findLiteral(const char * data, qint64 size)
+{
+    qint64 literalSize = literal.size();
+    if (size < literalSize) return false;
+    const char * literalData = literal.constData();
+    const char * end = data + size - literalSize + 1;
+    if (searchOptionCase) {
+        // memchr jumps over the bytes that can not start a match
+        const char * p = data;
+        while (p < end) {
+            p = static_cast<const char *>(std::memchr(p, literalData[0], static_cast<size_t>(end - p)));
+            if (p == nullptr) return false;
+            if (std::memcmp(p, literalData, static_cast<size_t>(literalSize)) == 0) return true;
+            p++;
+        }
+        return false;
+    }
+    // both cases of the first letter are looked up, the rest is compared folded
+    char lower = literalData[0];
+    char upper = (lower >= 'a' && lower <= 'z') ? static_cast<char>(lower - 32) : lower;
+    const char * nextLower = static_cast<const char *>(std::memchr(data, lower, static_cast<size_t>(end - data)));
+    const char * nextUpper = nullptr;
+    if (upper != lower) nextUpper = static_cast<const char *>(std::memchr(data, upper, static_cast<size_t>(end - data)));
+    while (nextLower != nullptr || nextUpper != nullptr) {
+        const char * p = nextLower;
+        if (p == nullptr || (nextUpper != nullptr && nextUpper < p)) p = nextUpper;
+        qint64 i = 1;
+        for (; i<literalSize; i++) {
+            char c = p[i];
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c + 32);
+            if (c != literalData[i]) break;
+        }
+        if (i == literalSize) return true;
+        if (p == nextLower) {
+            nextLower = p + 1 < end ? static_cast<const char *>(std::memchr(p + 1, lower, static_cast<size_t>(end - p - 1))) : nullptr;
+        } else {
+            nextUpper = p + 1 < end ? static_cast<const char *>(std::memchr(p + 1, upper, static_cast<size_t>(end - p - 1))) : nullptr;
+        }
+    }
+    return false;
+}
+
+bool FileSearcher::isCandidate(const char * data, qint64 size)
+{
+    if (isBinary(data, size)) return false;
+    if (literal.size() == 0) return true;
+    if (findLiteral(data, size)) return true;
+    if (literalFolding) {
+        QByteArray bytes = QByteArray::fromRawData(data, static_cast<int>(size));
+        if (bytes.indexOf(SEARCH_FOLDING_KELVIN) >= 0 || bytes.indexOf(SEARCH_FOLDING_LONG_S) >= 0) return true;
+    }
+    return false;
+}
+
+void FileSearcher::searchInFile(QString file, Results & fileResults, QRegularExpression & regexp, Parse & parser)
+{
+    if (cancelled.loadAcquire()) return;
+    QFile f(file);
+    if (!f.open(QIODevice::ReadOnly)) return;
+    qint64 size = f.size();
+    if (size <= 0) return;
+    if (asciiCompatible) {
+        // most files are rejected by the raw bytes check without decoding
+        uchar * data = f.map(0, size);
+        QByteArray buffer;
+        const char * bytes = reinterpret_cast<const char *>(data);
+        if (data == nullptr) {
+            buffer = f.readAll();
+            bytes = buffer.constData();
+            size = buffer.size();
+        }
+        bool candidate = isCandidate(bytes, size);
+        if (data != nullptr) f.unmap(data);
+        if (!candidate) return;
+    }
+    f.close();
+    QString content = Helper::loadTextFile(file, encoding, encodingFallback, true);
+    parser.buildLineIndex(content);
+    int p = -1, offset = 0;
+    do {
+        if (cancelled.loadAcquire() || fileResults.size() >= SEARCH_FILE_MAX_RESULTS) break;
+        int length = 0;
+        if (!searchOptionWord && !searchOptionRegexp) {
+            p = content.indexOf(searchText, offset, searchOptionCase ? Qt::CaseSensitive : Qt::CaseInsensitive);
+            length = searchText.size();
+        } else {
+            if (!regexp.isValid()) break;
+            QRegularExpressionMatch match = regexp.match(content, offset);
+            p = match.capturedStart();
+            length = match.capturedLength();
+        }
+        if (p >= 0) {
+            offset = p + std::max(length, 1);
+            Result result;
+            result.file = file;
+            result.lineText = parser.findLineText(content, p);
+            result.line = parser.findLine(p);
+            result.symbol = p;
+            fileResults.append(result);
+        }
+    } while (p >= 0 && offset <= content.size());
+}
+
+FileSearcher::Task::Task(FileSearcher * searcher): searcher(searcher)
+{
+    setAutoDelete(true);
+}
+
+void FileSearcher::Task::run()
+{
+    searcher->run();
+}
@@ -0,0 +1,436 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "highlightbenchmark.h"
+#include <cstdlib>
+#include <algorithm>
+#include <QtGlobal>
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QTextCursor>
+#include <QTextBlock>
+#include "settings.h"
+#include "highlightwords.h"
+#include "completewords.h"
+#include "highlightdata.h"
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+const QString HIGHLIGHT_BENCHMARK_ARGUMENT = "--benchmark-highlight";
+
+const int BENCHMARK_RUNS = 3;
+const int BENCHMARK_CORPUS_LINES = 20000;
+const int BENCHMARK_KEYSTROKES = 200;
+
+const QString BENCHMARK_CORPUS_PHP =
+    "<?php\n"
+    "class UserController extends BaseController\n"
+    "{\n"
+    "    const LIMIT = 20;\n"
+    "    protected $users = [];\n"
+    "\n"
+    "    // lists users page by page\n"
+    "    public function indexAction($page = 1) {\n"
+    "        $offset = ($page - 1) * self::LIMIT;\n"
+    "        $this->users = User::find(['limit' => self::LIMIT, 'offset' => $offset]);\n"
+    "        foreach ($this->users as $user) {\n"
+    "            if (strlen($user->name) > 0 && !in_array($user->id, $this->users)) {\n"
+    "                echo htmlspecialchars($user->name) . \"\\n\";\n"
+    "            }\n"
+    "        }\n"
+    "        return $this->render('index', ['users' => $this->users, 'page' => $page]);\n"
+    "    }\n"
+    "}\n"
+    "?>\n"
+    "<div class=\"users\">\n"
+    "    <ul id=\"list\">\n"
+    "        <?php foreach ($users as $user): ?>\n"
+    "        <li data-id=\"<?= $user->id ?>\"><?= $user->name ?></li>\n"
+    "        <?php endforeach; ?>\n"
+    "    </ul>\n"
+    "</div>\n"
+    "<style>\n"
+    "    .users ul { margin: 0; padding: 0 10px; border: 1px solid #ccc; }\n"
+    "</style>\n"
+    "<script>\n"
+    "    document.getElementById('list').addEventListener('click', function(e) {\n"
+    "        console.log(e.target.getAttribute('data-id'));\n"
+    "    });\n"
+    "</script>\n";
+
+const QString BENCHMARK_CORPUS_JS =
+    "// renders a list of items\n"
+    "function renderList(items, container) {\n"
+    "    var html = '';\n"
+    "    for (var i = 0; i < items.length; i++) {\n"
+    "        if (typeof items[i].title === 'undefined') continue;\n"
+    "        html += '<li data-index=\"' + i + '\">' + items[i].title + '</li>';\n"
+    "    }\n"
+    "    container.innerHTML = '<ul>' + html + '</ul>';\n"
+    "    return container.querySelectorAll('li').length;\n"
+    "}\n"
+    "\n"
+    "class ListView {\n"
+    "    constructor(element) {\n"
+    "        this.element = element;\n"
+    "        this.items = [];\n"
+    "    }\n"
+    "    load(url) {\n"
+    "        return fetch(url).then(response => response.json()).then(data => {\n"
+    "            this.items = data.filter(item => item.visible === true);\n"
+    "            renderList(this.items, this.element);\n"
+    "        });\n"
+    "    }\n"
+    "}\n"
+    "\n";
+
+const QString BENCHMARK_CORPUS_CSS =
+    ".users {\n"
+    "    margin: 0 auto;\n"
+    "    padding: 10px 20px;\n"
+    "    font-family: \"Source Code Pro\", monospace;\n"
+    "    background: url(\"images/bg.png\") no-repeat #fafafa;\n"
+    "}\n"
+    "\n"
+    ".users ul li:hover, .users ul li.active > a {\n"
+    "    color: #336699;\n"
+    "    border-bottom: 1px solid rgba(0, 0, 0, 0.2);\n"
+    "    transition: color 0.2s ease-in-out;\n"
+    "}\n"
+    "\n"
+    "@media screen and (max-width: 600px) {\n"
+    "    #list { display: none !important; }\n"
+    "}\n"
+    "\n";
+
+const QString BENCHMARK_CORPUS_DART =
+    "// displays a list of users\n"
+    "class UserList extends StatelessWidget {\n"
+    "  final List<User> users;\n"
+    "\n"
+    "  const UserList({Key key, this.users}) : super(key: key);\n"
+    "\n"
+    "  @override\n"
+    "  Widget build(BuildContext context) {\n"
+    "    return ListView.builder(\n"
+    "      itemCount: users.length,\n"
+    "      itemBuilder: (context, index) {\n"
+    "        final user = users[index];\n"
+    "        return ListTile(\n"
+    "          title: Text(user.name, style: TextStyle(fontSize: 16.0)),\n"
+    "          subtitle: Text('id: ${user.id}'),\n"
+    "          onTap: () => Navigator.pushNamed(context, '/user', arguments: user),\n"
+    "        );\n"
+    "      },\n"
+    "    );\n"
+    "  }\n"
+    "}\n"
+    "\n";
+
+bool HighlightBenchmark::isRequested(int argc, char *argv[])
+{
+    for (int i=1; i<argc; i++) {
+        if (QString(argv[i]) == HIGHLIGHT_BENCHMARK_ARGUMENT) return true;
+    }
+    return false;
+}
+
+int HighlightBenchmark::run(QStringList args)
+{
+    QTextStream out(stdout);
+    QStringList files;
+    bool found = false;
+    for (int i=1; i<args.size(); i++) {
+        if (args.at(i) == HIGHLIGHT_BENCHMARK_ARGUMENT) {
+            found = true;
+            continue;
+        }
+        if (found) files.append(args.at(i));
+    }
+    Settings::load();
+    loadWords();
+    out << "Highlighter benchmark, best of " << BENCHMARK_RUNS << " runs" << endl;
+    if (files.size() == 0) {
+        QStringList extensions;
+        extensions << "php" << "js" << "css" << "dart";
+        for (QString extension : extensions) {
+            benchmark(out, "built-in " + extension, extension, generateCorpus(extension));
+        }
+    } else {
+        for (QString path : files) {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                out << "Could not open file: " << path << endl;
+                return 1;
+            }
+            QTextStream in(&file);
+            in.setCodec("UTF-8");
+            QString text = in.readAll();
+            file.close();
+            benchmark(out, path, QFileInfo(path).suffix(), text);
+        }
+    }
+    out << "Peak RSS: " << formatBytes(getPeakRSS()) << endl;
+    return 0;
+}
+
+void HighlightBenchmark::loadWords()
+{
+    HighlightWords::setColors();
+    HighlightWords::load();
+    CompleteWords::load();
+}
+
+QString HighlightBenchmark::generateCorpus(QString extension)
+{
+    QString snippet;
+    if (extension == "php") snippet = BENCHMARK_CORPUS_PHP;
+    else if (extension == "js") snippet = BENCHMARK_CORPUS_JS;
+    else if (extension == "css") snippet = BENCHMARK_CORPUS_CSS;
+    else if (extension == "dart") snippet = BENCHMARK_CORPUS_DART;
+    if (snippet.size() == 0) return "";
+    int snippetLines = snippet.count("\n");
+    QString text = "";
+    // one block comment at the top, so that an unterminated comment is not closed later
+    text += "/**\n * Benchmark corpus\n */\n";
+    for (int lines=0; lines<BENCHMARK_CORPUS_LINES; lines+=snippetLines) {
+        text += snippet;
+    }
+    return text;
+}
+
+void HighlightBenchmark::benchmark(QTextStream & out, QString name, QString extension, QString text)
+{
+    qint64 heapBefore = getHeapUsage();
+    QTextDocument doc;
+    doc.setPlainText(text);
+    Highlight highlight(&doc);
+    highlight.initMode(extension, -1);
+    int blocksCount = doc.blockCount();
+    out << endl << name << ": " << blocksCount << " blocks, " << formatBytes(text.size() * 2) << endl;
+    if (highlight.getModeType() == MODE_UNKNOWN) {
+        out << "  unknown extension, generic highlighting" << endl;
+    }
+
+    QElapsedTimer timer;
+
+    // full rehighlight, like on file opening
+    qint64 rehighlightTime = -1;
+    for (int i=0; i<BENCHMARK_RUNS; i++) {
+        timer.start();
+        highlight.setFirstRunMode(true);
+        highlight.rehighlight();
+        highlight.setFirstRunMode(false);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (rehighlightTime < 0 || elapsed < rehighlightTime) rehighlightTime = elapsed;
+    }
+    qint64 heapAfter = getHeapUsage();
+    out << "  rehighlight: " << formatMsecs(rehighlightTime) << ", " << formatRate(blocksCount, rehighlightTime) << endl;
+
+    // block data size, with shared buffers counted once and with a copy per block
+    qint64 blockDataSize = 0, blockDataUnsharedSize = 0;
+    QSet<const void *> sharedData;
+    for (QTextBlock block = doc.begin(); block.isValid(); block = block.next()) {
+        HighlightData * blockData = dynamic_cast<HighlightData *>(block.userData());
+        if (blockData == nullptr) continue;
+        blockDataSize += blockData->getMemoryUsage(&sharedData);
+        blockDataUnsharedSize += blockData->getMemoryUsage();
+    }
+    if (blocksCount > 0) {
+        out << "  block data: " << formatBytes(blockDataSize / blocksCount) << " per block shared, "
+            << formatBytes(blockDataUnsharedSize / blocksCount) << " per block unshared" << endl;
+    }
+
+    // typing a char at the end of lines across the document and removing it
+    qint64 keystrokeTime = -1;
+    int keystrokeBlocks = 0;
+    int keystrokes = 0;
+    for (int i=0; i<BENCHMARK_RUNS; i++) {
+        int blocks = 0;
+        keystrokes = 0;
+        qint64 elapsed = 0;
+        int step = std::max(1, blocksCount / BENCHMARK_KEYSTROKES);
+        for (int b=0; b<blocksCount; b+=step) {
+            QTextBlock block = doc.findBlockByNumber(b);
+            if (!block.isValid()) break;
+            int pos = block.position() + block.length() - 1;
+            QTextCursor curs(&doc);
+            curs.setPosition(pos);
+            curs.insertText("x");
+            timer.start();
+            blocks += contentsChange(&highlight, &doc, pos, 0, 1);
+            elapsed += timer.nsecsElapsed();
+            curs.setPosition(pos);
+            curs.setPosition(pos + 1, QTextCursor::KeepAnchor);
+            curs.removeSelectedText();
+            timer.start();
+            blocks += contentsChange(&highlight, &doc, pos, 1, 0);
+            elapsed += timer.nsecsElapsed();
+            keystrokes += 2;
+        }
+        if (keystrokeTime < 0 || elapsed < keystrokeTime) {
+            keystrokeTime = elapsed;
+            keystrokeBlocks = blocks;
+        }
+    }
+    if (keystrokes > 0) {
+        out << "  keystroke: " << formatMsecs(keystrokeTime / keystrokes) << " avg, "
+            << keystrokes << " edits, " << keystrokeBlocks << " blocks, "
+            << formatRate(keystrokeBlocks, keystrokeTime) << endl;
+    }
+
+    // opening an unterminated comment and closing it again
+    int commentPos = findCommentPosition(&doc, extension);
+    QString comment = getUnterminatedComment(extension);
+    if (commentPos >= 0) {
+        qint64 commentTime = -1;
+        int commentBlocks = 0;
+        for (int i=0; i<BENCHMARK_RUNS; i++) {
+            QTextCursor curs(&doc);
+            curs.setPosition(commentPos);
+            curs.insertText(comment);
+            timer.start();
+            int blocks = contentsChange(&highlight, &doc, commentPos, 0, comment.size());
+            qint64 elapsed = timer.nsecsElapsed();
+            curs.setPosition(commentPos);
+            curs.setPosition(commentPos + comment.size(), QTextCursor::KeepAnchor);
+            curs.removeSelectedText();
+            timer.start();
+            blocks += contentsChange(&highlight, &doc, commentPos, comment.size(), 0);
+            elapsed += timer.nsecsElapsed();
+            if (commentTime < 0 || elapsed < commentTime) {
+                commentTime = elapsed;
+                commentBlocks = blocks;
+            }
+        }
+        out << "  unterminated comment: " << formatMsecs(commentTime) << ", "
+            << commentBlocks << " blocks, " << formatRate(commentBlocks, commentTime) << endl;
+    } else {
+        out << "  unterminated comment: skipped, no code block found" << endl;
+    }
+
+    if (heapBefore >= 0 && heapAfter >= 0) {
+        out << "  heap after rehighlight: +" << formatBytes(heapAfter - heapBefore) << endl;
+    }
+}
+
+int HighlightBenchmark::contentsChange(Highlight * highlight, QTextDocument * doc, int position, int charsRemoved, int charsAdded)
+{
+    // same cascade as Editor::contentsChange
+    QTextBlock block = doc->findBlock(position);
+    if (!block.isValid()) return 0;
+
+    highlight->resetHighlightBlock(block);
+
+    QTextBlock lastBlock = doc->findBlock(position + charsAdded + (charsRemoved > 0 ? 1 : 0));
+    if (!lastBlock.isValid()) {
+        QTextCursor curs = QTextCursor(block);
+        return highlight->highlightChanges(curs);
+    }
+
+    int blocksCount = 0;
+    int endPosition = lastBlock.position() + lastBlock.length();
+    bool forceHighlightOfNextBlock = false;
+    while (block.isValid() && (block.position() < endPosition)) {
+        const int stateBeforeHighlight = block.userState();
+        highlight->rehighlightBlock(block);
+        blocksCount++;
+        forceHighlightOfNextBlock = (block.userState() != stateBeforeHighlight);
+        block = block.next();
+    }
+    if (forceHighlightOfNextBlock && block.isValid()) {
+        QTextCursor curs = QTextCursor(block);
+        blocksCount += highlight->highlightChanges(curs);
+    }
+    return blocksCount;
+}
+
+QString HighlightBenchmark::getUnterminatedComment(QString extension)
+{
+    if (extension == "html" || extension == "xml") return "<!--";
+    return "/*";
+}
+
+int HighlightBenchmark::findCommentPosition(QTextDocument * doc, QString extension)
+{
+    // comment is opened before the first declaration, so that it is in code mode
+    QStringList markers;
+    if (extension == "css" || extension == "less" || extension == "scss" || extension == "sass") {
+        markers << "{";
+    } else if (extension == "html" || extension == "xml") {
+        markers << "<";
+    } else {
+        markers << "class " << "function ";
+    }
+    QTextBlock block = doc->begin();
+    while (block.isValid()) {
+        QString text = block.text();
+        for (QString marker : markers) {
+            if (text.indexOf(marker) >= 0) {
+                int indent = 0;
+                while (indent < text.size() && text[indent].isSpace()) indent++;
+                return block.position() + indent;
+            }
+        }
+        block = block.next();
+    }
+    return -1;
+}
+
+qint64 HighlightBenchmark::getHeapUsage()
+{
+    #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<qint64>(info.uordblks + info.hblkhd);
+    #elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return static_cast<qint64>(static_cast<unsigned int>(info.uordblks)) + static_cast<qint64>(static_cast<unsigned int>(info.hblkhd));
+    #else
+    return -1;
+    #endif
+}
+
+qint64 HighlightBenchmark::getPeakRSS()
+{
+    #if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    #if defined(Q_OS_MACOS)
+    return static_cast<qint64>(usage.ru_maxrss);
+    #else
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+    #endif
+    #else
+    return -1;
+    #endif
+}
+
+QString HighlightBenchmark::formatRate(int blocks, qint64 nsecs)
+{
+    if (nsecs <= 0) return "n/a";
+    double rate = static_cast<double>(blocks) * 1000000000.0 / static_cast<double>(nsecs);
+    return QString::number(rate, 'f', 0) + " blocks/sec";
+}
+
+QString HighlightBenchmark::formatMsecs(qint64 nsecs)
+{
+    return QString::number(static_cast<double>(nsecs) / 1000000.0, 'f', 3) + " ms";
+}
+
+QString HighlightBenchmark::formatBytes(qint64 bytes)
+{
+    if (bytes < 0) return "n/a";
+    if (bytes < 1024) return QString::number(bytes) + " B";
+    if (bytes < 1024 * 1024) return QString::number(static_cast<double>(bytes) / 1024.0, 'f', 1) + " KB";
+    return QString::number(static_cast<double>(bytes) / (1024.0 * 1024.0), 'f', 1) + " MB";
+}
@@ -5,6 +5,20 @@
  *******************************************/
 
 #include "highlightdata.h"
+#include "highlight.h"
+
+const int INTERN_POOL_MAX_SIZE = 65536;
+
+const quint8 MODE_ID_NONE = 0;
+const quint8 MODE_ID_PHP = 1;
+const quint8 MODE_ID_JS = 2;
+const quint8 MODE_ID_CSS = 3;
+const quint8 MODE_ID_HTML = 4;
+const quint8 MODE_ID_MIXED = 5;
+const quint8 MODE_ID_UNKNOWN = 6;
+
+// each thread has its own pool, so that interning is lock-free
+thread_local QSet<QString> internPool;
 
 HighlightData::HighlightData()
 {
@@ -14,15 +28,15 @@ HighlightData::HighlightData()
 void HighlightData::reset()
 {
     stringBlock = "";
-    mode = "";
-    prevMode = "";
-    modeExpect = "";
-    modeExpectC = "";
+    modeId = MODE_ID_NONE;
+    prevModeId = MODE_ID_NONE;
+    modeExpectId = MODE_ID_NONE;
+    modeExpectCId = MODE_ID_NONE;
     modeString = "";
     modeStringC = "";
-    prevModeExpect = "";
+    prevModeExpectId = MODE_ID_NONE;
     prevModeString = "";
-    prevModeExpectC = "";
+    prevModeExpectCId = MODE_ID_NONE;
     prevModeStringC = "";
     prevModeSkip = false;
     prevModeSkipC = false;
@@ -30,7 +44,7 @@ void HighlightData::reset()
     prevState = -1;
     prevPrevState = -1;
     stringEscStringCSS = "";
-    stringEscStringJS = "";
+    stringEscCountJS = 0;
     regexpEscStringJS = "";
     regexpPrevCharJS = "";
     bracesCSS = 0;
@@ -45,15 +59,9 @@ void HighlightData::reset()
     exprEscStringJS = "";
     stringEscVariableJS = "";
     specialChars.clear();
-    specialCharsPos.clear();
     specialWords.clear();
-    specialWordsPos.clear();
-    modeStarts.clear();
-    modeEnds.clear();
-    modeTags.clear();
-    stateStarts.clear();
-    stateEnds.clear();
-    stateIds.clear();
+    modeSpans.clear();
+    stateSpans.clear();
     hasMarkPoint = false;
     isModified = false;
     nsNamePHP = "";
@@ -79,8 +87,6 @@ void HighlightData::reset()
     expectedFuncNamePHP = "";
     expectedFuncParsPHP = -1;
     expectedFuncArgsPHP.clear();
-    expectedFuncArgsPHPPositions.clear();
-    expectedFuncArgsPHPBlocks.clear();
     nsScopePHP = -1;
     clsScopePHP = -1;
     funcScopePHP = -1;
@@ -107,7 +113,7 @@ void HighlightData::reset()
     expectedFuncParsJS = -1;
     funcScopeJS = -1;
     varsChainJS = "";
-    expectedFuncArgsJS.clear();
+    expectedFuncArgsChainJS = "";
     mediaNameCSS = "";
     mediaStartsCSS.clear();
     mediaEndsCSS.clear();
@@ -141,3 +147,392 @@ void HighlightData::reset()
     clsOpenJS = false;
     isNewBlock = true;
 }
+
+QString HighlightData::intern(const QString & str)
+{
+    // blocks share one copy of repeated names
+    if (str.isEmpty()) return QString();
+    QSet<QString>::const_iterator it = internPool.constFind(str);
+    if (it != internPool.constEnd()) return * it;
+    if (internPool.size() >= INTERN_POOL_MAX_SIZE) internPool.clear();
+    internPool.insert(str);
+    return str;
+}
+
+quint8 HighlightData::modeToId(const std::string & mode)
+{
+    if (mode == MODE_PHP) return MODE_ID_PHP;
+    if (mode == MODE_JS) return MODE_ID_JS;
+    if (mode == MODE_CSS) return MODE_ID_CSS;
+    if (mode == MODE_HTML) return MODE_ID_HTML;
+    if (mode == MODE_MIXED) return MODE_ID_MIXED;
+    if (mode == MODE_UNKNOWN) return MODE_ID_UNKNOWN;
+    return MODE_ID_NONE;
+}
+
+const std::string & HighlightData::idToMode(quint8 id)
+{
+    static const std::string none = "";
+    switch (id) {
+        case MODE_ID_PHP: return MODE_PHP;
+        case MODE_ID_JS: return MODE_JS;
+        case MODE_ID_CSS: return MODE_CSS;
+        case MODE_ID_HTML: return MODE_HTML;
+        case MODE_ID_MIXED: return MODE_MIXED;
+        case MODE_ID_UNKNOWN: return MODE_UNKNOWN;
+    }
+    return none;
+}
+
+const std::string & HighlightData::getMode()
+{
+    return idToMode(modeId);
+}
+
+void HighlightData::setMode(const std::string & mode)
+{
+    modeId = modeToId(mode);
+}
+
+const std::string & HighlightData::getPrevMode()
+{
+    return idToMode(prevModeId);
+}
+
+void HighlightData::setPrevMode(const std::string & mode)
+{
+    prevModeId = modeToId(mode);
+}
+
+const std::string & HighlightData::getModeExpect()
+{
+    return idToMode(modeExpectId);
+}
+
+void HighlightData::setModeExpect(const std::string & mode)
+{
+    modeExpectId = modeToId(mode);
+}
+
+const std::string & HighlightData::getModeExpectC()
+{
+    return idToMode(modeExpectCId);
+}
+
+void HighlightData::setModeExpectC(const std::string & mode)
+{
+    modeExpectCId = modeToId(mode);
+}
+
+const std::string & HighlightData::getPrevModeExpect()
+{
+    return idToMode(prevModeExpectId);
+}
+
+void HighlightData::setPrevModeExpect(const std::string & mode)
+{
+    prevModeExpectId = modeToId(mode);
+}
+
+const std::string & HighlightData::getPrevModeExpectC()
+{
+    return idToMode(prevModeExpectCId);
+}
+
+void HighlightData::setPrevModeExpectC(const std::string & mode)
+{
+    prevModeExpectCId = modeToId(mode);
+}
+
+void HighlightData::setModeSpans(const QVector<int> & starts, const QVector<int> & ends, const QVector<std::string> & modes)
+{
+    modeSpans.clear();
+    // unfinished spans are dropped
+    if (starts.size() != ends.size() || starts.size() != modes.size()) return;
+    modeSpans.reserve(starts.size());
+    for (int i=0; i<starts.size(); i++) {
+        modeSpans.append(Span{starts.at(i), ends.at(i), modeToId(modes.at(i))});
+    }
+    modeSpans.squeeze();
+}
+
+bool HighlightData::findModeSpan(int pos, std::string & mode)
+{
+    for (int i=0; i<modeSpans.size(); i++) {
+        const Span & span = modeSpans.at(i);
+        if (span.start <= pos && span.end >= pos) {
+            mode = idToMode(static_cast<quint8>(span.id));
+            return true;
+        }
+    }
+    return false;
+}
+
+void HighlightData::setStateSpans(const QVector<int> & starts, const QVector<int> & ends, const QVector<int> & states)
+{
+    stateSpans.clear();
+    // unfinished spans are dropped
+    if (starts.size() != ends.size() || starts.size() != states.size()) return;
+    stateSpans.reserve(starts.size());
+    for (int i=0; i<starts.size(); i++) {
+        stateSpans.append(Span{starts.at(i), ends.at(i), states.at(i)});
+    }
+    stateSpans.squeeze();
+}
+
+bool HighlightData::findStateSpan(int pos, int & state)
+{
+    for (int i=0; i<stateSpans.size(); i++) {
+        const Span & span = stateSpans.at(i);
+        if (span.start <= pos && span.end >= pos) {
+            state = span.id;
+            return true;
+        }
+    }
+    return false;
+}
+
+void HighlightData::setSpecialChars(const QVector<QChar> & chars, const QVector<int> & positions)
+{
+    specialChars.clear();
+    if (chars.size() != positions.size()) return;
+    specialChars.reserve(chars.size());
+    for (int i=0; i<chars.size(); i++) {
+        specialChars.append(SpecialChar{positions.at(i), chars.at(i)});
+    }
+    specialChars.squeeze();
+}
+
+int HighlightData::specialCharsCount()
+{
+    return specialChars.size();
+}
+
+QChar HighlightData::specialCharAt(int i)
+{
+    return specialChars.at(i).c;
+}
+
+int HighlightData::specialCharPosAt(int i)
+{
+    return specialChars.at(i).pos;
+}
+
+void HighlightData::setSpecialWords(const QVector<QString> & words, const QVector<int> & positions)
+{
+    specialWords.clear();
+    if (words.size() != positions.size()) return;
+    specialWords.reserve(words.size());
+    for (int i=0; i<words.size(); i++) {
+        specialWords.append(SpecialWord{positions.at(i), intern(words.at(i))});
+    }
+    specialWords.squeeze();
+}
+
+int HighlightData::specialWordsCount()
+{
+    return specialWords.size();
+}
+
+QString HighlightData::specialWordAt(int i)
+{
+    return specialWords.at(i).word;
+}
+
+int HighlightData::specialWordPosAt(int i)
+{
+    return specialWords.at(i).pos;
+}
+
+void HighlightData::setExpectedFuncArgsPHP(const QStringList & names, const QVector<int> & positions, const QVector<int> & blocks)
+{
+    expectedFuncArgsPHP.clear();
+    if (names.size() == 0) return;
+    expectedFuncArgsPHP.reserve(names.size());
+    for (int i=0; i<names.size(); i++) {
+        int pos = positions.size() == names.size() ? positions.at(i) : -1;
+        int block = blocks.size() == names.size() ? blocks.at(i) : -1;
+        expectedFuncArgsPHP.append(ExpectedArg{pos, block, intern(names.at(i))});
+    }
+    expectedFuncArgsPHP.squeeze();
+}
+
+void HighlightData::getExpectedFuncArgsPHP(QStringList & names, QVector<int> & positions, QVector<int> & blocks)
+{
+    names.clear();
+    positions.clear();
+    blocks.clear();
+    for (int i=0; i<expectedFuncArgsPHP.size(); i++) {
+        const ExpectedArg & arg = expectedFuncArgsPHP.at(i);
+        names.append(arg.name);
+        positions.append(arg.pos);
+        blocks.append(arg.block);
+    }
+}
+
+QString HighlightData::getExpectedFuncArgsPHPChain()
+{
+    QString chain = "";
+    for (int i=0; i<expectedFuncArgsPHP.size(); i++) {
+        if (i > 0) chain += ",";
+        chain += expectedFuncArgsPHP.at(i).name;
+    }
+    return chain;
+}
+
+qint64 stringMemoryUsage(const QString & str, QSet<const void *> * sharedData)
+{
+    // empty strings use static shared data
+    if (str.capacity() == 0) return 0;
+    if (sharedData != nullptr) {
+        if (sharedData->contains(str.constData())) return 0;
+        sharedData->insert(str.constData());
+    }
+    return static_cast<qint64>(sizeof(QArrayData) + (str.capacity() + 1) * sizeof(QChar));
+}
+
+template<typename T>
+qint64 vectorMemoryUsage(const QVector<T> & vec, QSet<const void *> * sharedData)
+{
+    if (vec.capacity() == 0) return 0;
+    if (sharedData != nullptr) {
+        if (sharedData->contains(vec.constData())) return 0;
+        sharedData->insert(vec.constData());
+    }
+    return static_cast<qint64>(sizeof(QArrayData) + vec.capacity() * sizeof(T));
+}
+
+template<typename T>
+qint64 listMemoryUsage(const QList<T> & list, QSet<const void *> * sharedData)
+{
+    if (list.isEmpty()) return 0;
+    if (sharedData != nullptr) {
+        if (sharedData->contains(&list.at(0))) return 0;
+        sharedData->insert(&list.at(0));
+    }
+    return static_cast<qint64>(sizeof(QListData::Data) + list.size() * sizeof(void *));
+}
+
+qint64 stringsMemoryUsage(const QVector<QString> & strings, QSet<const void *> * sharedData)
+{
+    qint64 size = vectorMemoryUsage(strings, sharedData);
+    for (int i=0; i<strings.size(); i++) {
+        size += stringMemoryUsage(strings.at(i), sharedData);
+    }
+    return size;
+}
+
+qint64 stringsMemoryUsage(const QStringList & strings, QSet<const void *> * sharedData)
+{
+    qint64 size = listMemoryUsage(strings, sharedData);
+    for (int i=0; i<strings.size(); i++) {
+        size += stringMemoryUsage(strings.at(i), sharedData);
+    }
+    return size;
+}
+
+qint64 operatorsMemoryUsage(const std::unordered_map<int, std::string> & operators)
+{
+    qint64 size = static_cast<qint64>(operators.bucket_count() * sizeof(void *));
+    for (auto & it : operators) {
+        size += static_cast<qint64>(sizeof(std::pair<const int, std::string>) + sizeof(void *) + it.second.capacity());
+    }
+    return size;
+}
+
+qint64 HighlightData::getMemoryUsage(QSet<const void *> * sharedData)
+{
+    // approximate heap size of block data, shared buffers are counted once if sharedData is set
+    qint64 size = sizeof(HighlightData);
+    size += stringMemoryUsage(stringBlock, sharedData);
+    size += stringMemoryUsage(modeString, sharedData);
+    size += stringMemoryUsage(modeStringC, sharedData);
+    size += stringMemoryUsage(prevModeString, sharedData);
+    size += stringMemoryUsage(prevModeStringC, sharedData);
+    size += stringMemoryUsage(stringEscStringCSS, sharedData);
+    size += stringMemoryUsage(regexpEscStringJS, sharedData);
+    size += stringMemoryUsage(regexpPrevCharJS, sharedData);
+    size += stringMemoryUsage(exprEscStringJS, sharedData);
+    size += stringMemoryUsage(stringEscVariableJS, sharedData);
+    size += stringMemoryUsage(nsNamePHP, sharedData);
+    size += listMemoryUsage(nsScopeChainPHP, sharedData);
+    size += stringMemoryUsage(nsChainPHP, sharedData);
+    size += vectorMemoryUsage(nsStartsPHP, sharedData);
+    size += vectorMemoryUsage(nsEndsPHP, sharedData);
+    size += stringsMemoryUsage(nsNamesPHP, sharedData);
+    size += stringMemoryUsage(clsNamePHP, sharedData);
+    size += listMemoryUsage(clsScopeChainPHP, sharedData);
+    size += stringMemoryUsage(clsChainPHP, sharedData);
+    size += vectorMemoryUsage(clsStartsPHP, sharedData);
+    size += vectorMemoryUsage(clsEndsPHP, sharedData);
+    size += stringsMemoryUsage(clsNamesPHP, sharedData);
+    size += stringMemoryUsage(funcNamePHP, sharedData);
+    size += listMemoryUsage(funcScopeChainPHP, sharedData);
+    size += stringMemoryUsage(funcChainPHP, sharedData);
+    size += vectorMemoryUsage(funcStartsPHP, sharedData);
+    size += vectorMemoryUsage(funcEndsPHP, sharedData);
+    size += stringsMemoryUsage(funcNamesPHP, sharedData);
+    size += stringMemoryUsage(expectedNsNamePHP, sharedData);
+    size += stringMemoryUsage(expectedClsNamePHP, sharedData);
+    size += stringMemoryUsage(expectedFuncNamePHP, sharedData);
+    size += stringsMemoryUsage(varsChainsPHP, sharedData);
+    size += stringsMemoryUsage(usedVarsChainsPHP, sharedData);
+    size += stringMemoryUsage(varsGlobChainPHP, sharedData);
+    size += stringMemoryUsage(usedVarsGlobChainPHP, sharedData);
+    size += stringMemoryUsage(varsClsChainPHP, sharedData);
+    size += stringMemoryUsage(varsChainPHP, sharedData);
+    size += stringMemoryUsage(usedVarsChainPHP, sharedData);
+    size += vectorMemoryUsage(clsOpensPHP, sharedData);
+    size += stringMemoryUsage(varsClsOpenChainPHP, sharedData);
+    size += stringsMemoryUsage(clsPropsChainPHP, sharedData);
+    size += stringMemoryUsage(funcNameJS, sharedData);
+    size += listMemoryUsage(funcScopeChainJS, sharedData);
+    size += stringMemoryUsage(funcChainJS, sharedData);
+    size += vectorMemoryUsage(funcStartsJS, sharedData);
+    size += vectorMemoryUsage(funcEndsJS, sharedData);
+    size += stringsMemoryUsage(funcNamesJS, sharedData);
+    size += stringMemoryUsage(expectedFuncNameJS, sharedData);
+    size += stringMemoryUsage(expectedFuncVarJS, sharedData);
+    size += stringMemoryUsage(varsChainJS, sharedData);
+    size += stringMemoryUsage(expectedFuncArgsChainJS, sharedData);
+    size += stringMemoryUsage(mediaNameCSS, sharedData);
+    size += vectorMemoryUsage(mediaStartsCSS, sharedData);
+    size += vectorMemoryUsage(mediaEndsCSS, sharedData);
+    size += stringsMemoryUsage(mediaNamesCSS, sharedData);
+    size += stringMemoryUsage(expectedMediaNameCSS, sharedData);
+    size += stringMemoryUsage(cssNamesChain, sharedData);
+    size += stringMemoryUsage(tagChainHTML, sharedData);
+    size += vectorMemoryUsage(tagChainStartsHTML, sharedData);
+    size += vectorMemoryUsage(tagChainEndsHTML, sharedData);
+    size += stringsMemoryUsage(tagChainsHTML, sharedData);
+    size += stringMemoryUsage(keywordPHPprevString, sharedData);
+    size += stringMemoryUsage(keywordPHPprevStringPrevChar, sharedData);
+    size += stringMemoryUsage(keywordJSprevString, sharedData);
+    size += stringMemoryUsage(keywordJSprevStringPrevChar, sharedData);
+    size += vectorMemoryUsage(spellStarts, sharedData);
+    size += vectorMemoryUsage(spellLengths, sharedData);
+    size += stringMemoryUsage(operatorsChainPHP, sharedData);
+    size += operatorsMemoryUsage(operatorsPHP);
+    size += stringMemoryUsage(operatorsChainJS, sharedData);
+    size += operatorsMemoryUsage(operatorsJS);
+    size += stringMemoryUsage(expectedClsNameJS, sharedData);
+    size += stringMemoryUsage(clsNameJS, sharedData);
+    size += stringMemoryUsage(clsChainJS, sharedData);
+    size += stringsMemoryUsage(clsNamesJS, sharedData);
+    size += vectorMemoryUsage(clsStartsJS, sharedData);
+    size += vectorMemoryUsage(clsEndsJS, sharedData);
+    size += listMemoryUsage(clsScopeChainJS, sharedData);
+    size += vectorMemoryUsage(clsOpensJS, sharedData);
+    size += vectorMemoryUsage(modeSpans, sharedData);
+    size += vectorMemoryUsage(stateSpans, sharedData);
+    size += vectorMemoryUsage(specialChars, sharedData);
+    size += vectorMemoryUsage(specialWords, sharedData);
+    for (int i=0; i<specialWords.size(); i++) {
+        size += stringMemoryUsage(specialWords.at(i).word, sharedData);
+    }
+    size += vectorMemoryUsage(expectedFuncArgsPHP, sharedData);
+    for (int i=0; i<expectedFuncArgsPHP.size(); i++) {
+        size += stringMemoryUsage(expectedFuncArgsPHP.at(i).name, sharedData);
+    }
+    return size;
+}
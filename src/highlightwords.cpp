@@ -12,7 +12,33 @@
 
 const int LOAD_DELAY = 250; // should not be less then PROJECT_LOAD_DELAY
 
-HighlightWords::HighlightWords(){}
+const int HIGHLIGHT_FORMAT_KEYWORD = 0;
+const int HIGHLIGHT_FORMAT_CLASS = 1;
+const int HIGHLIGHT_FORMAT_KNOWN_FUNCTION = 2;
+const int HIGHLIGHT_FORMAT_KNOWN_VARIABLE = 3;
+const int HIGHLIGHT_FORMAT_CONST = 4;
+const int HIGHLIGHT_FORMAT_KNOWN = 5;
+const int HIGHLIGHT_FORMAT_CSS_SPECIAL = 6;
+const int HIGHLIGHT_FORMAT_PSEUDO_CLASS = 7;
+
+HighlightWordsData::HighlightWordsData():
+    phpwords(false),
+    phpwordsCS(true),
+    phpClassWordsCS(true),
+    jswordsCS(true),
+    jsExtDartWordsCS(true),
+    csswords(false),
+    htmlwords(false),
+    htmlshorts(false),
+    generalwords(false)
+{
+
+}
+
+HighlightWords::HighlightWords()
+{
+
+}
 
 HighlightWords& HighlightWords::instance()
 {
@@ -70,6 +96,21 @@ void HighlightWords::_reset()
     htmlshorts.clear();
 }
 
+const QTextCharFormat & HighlightWordsData::getFormat(int formatId) const
+{
+    // tables keep format ids, so that formats are not copied for every word
+    switch (formatId) {
+        case HIGHLIGHT_FORMAT_CLASS: return classFormat;
+        case HIGHLIGHT_FORMAT_KNOWN_FUNCTION: return knownFunctionFormat;
+        case HIGHLIGHT_FORMAT_KNOWN_VARIABLE: return knownVariableFormat;
+        case HIGHLIGHT_FORMAT_CONST: return constFormat;
+        case HIGHLIGHT_FORMAT_KNOWN: return knownFormat;
+        case HIGHLIGHT_FORMAT_CSS_SPECIAL: return cssSpecialFormat;
+        case HIGHLIGHT_FORMAT_PSEUDO_CLASS: return pseudoClassFormat;
+        default: return keywordFormat;
+    }
+}
+
 void HighlightWords::setColors()
 {
     instance()._setColors();
@@ -189,7 +230,7 @@ void HighlightWords::loadPHPWords()
     while (!kin.atEnd()) {
         k = kin.readLine();
         if (k == "") continue;
-        phpwords[k.toStdString()] = keywordFormat;
+        phpwords.addStatic(k, HIGHLIGHT_FORMAT_KEYWORD);
     }
     kf.close();
 
@@ -200,7 +241,7 @@ void HighlightWords::loadPHPWords()
     while (!cin.atEnd()) {
         k = cin.readLine();
         if (k == "") continue;
-        phpwordsCS[k.toStdString()] = keywordFormat;
+        phpwordsCS.addStatic(k, HIGHLIGHT_FORMAT_KEYWORD);
     }
     cf.close();
 
@@ -211,7 +252,7 @@ void HighlightWords::loadPHPWords()
     while (!tin.atEnd()) {
         k = tin.readLine();
         if (k == "") continue;
-        phpwords[k.toStdString()] = knownFormat;
+        phpwords.addStatic(k, HIGHLIGHT_FORMAT_KNOWN);
     }
     tf.close();
 
@@ -222,9 +263,12 @@ void HighlightWords::loadPHPWords()
     while (!clin.atEnd()) {
         k = clin.readLine();
         if (k == "") continue;
-        phpwords[k.toStdString()] = knownFormat;
+        phpwords.addStatic(k, HIGHLIGHT_FORMAT_KNOWN);
     }
     clf.close();
+
+    phpwords.build();
+    phpwordsCS.build();
 }
 
 void HighlightWords::loadJSWords()
@@ -238,9 +282,11 @@ void HighlightWords::loadJSWords()
     while (!kin.atEnd()) {
         k = kin.readLine();
         if (k == "") continue;
-        jswordsCS[k.toStdString()] = keywordFormat;
+        jswordsCS.addStatic(k, HIGHLIGHT_FORMAT_KEYWORD);
     }
     kf.close();
+
+    jswordsCS.build();
 }
 
 void HighlightWords::loadCSSWords()
@@ -254,7 +300,7 @@ void HighlightWords::loadCSSWords()
     while (!kin.atEnd()) {
         k = kin.readLine();
         if (k == "") continue;
-        csswords[k.toStdString()] = keywordFormat;
+        csswords.addStatic(k, HIGHLIGHT_FORMAT_KEYWORD);
     }
     kf.close();
 
@@ -265,7 +311,7 @@ void HighlightWords::loadCSSWords()
     while (!sin.atEnd()) {
         k = sin.readLine();
         if (k == "") continue;
-        csswords[k.toStdString()] = cssSpecialFormat;
+        csswords.addStatic(k, HIGHLIGHT_FORMAT_CSS_SPECIAL);
     }
     sf.close();
 
@@ -276,9 +322,11 @@ void HighlightWords::loadCSSWords()
     while (!tin.atEnd()) {
         k = tin.readLine();
         if (k == "") continue;
-        csswords[k.toStdString()] = pseudoClassFormat;
+        csswords.addStatic(k, HIGHLIGHT_FORMAT_PSEUDO_CLASS);
     }
     tf.close();
+
+    csswords.build();
 }
 
 void HighlightWords::loadGeneralWords()
@@ -292,9 +340,11 @@ void HighlightWords::loadGeneralWords()
     while (!kin.atEnd()) {
         k = kin.readLine();
         if (k == "") continue;
-        generalwords[k.toStdString()] = keywordFormat;
+        generalwords.addStatic(k, HIGHLIGHT_FORMAT_KEYWORD);
     }
     kf.close();
+
+    generalwords.build();
 }
 
 void HighlightWords::addPHPClass(QString k)
@@ -304,7 +354,7 @@ void HighlightWords::addPHPClass(QString k)
 
 void HighlightWords::_addPHPClass(QString k)
 {
-    phpwords[k.toLower().toStdString()] = classFormat;
+    phpwords.add(k, HIGHLIGHT_FORMAT_CLASS);
 }
 
 void HighlightWords::addPHPFunction(QString k)
@@ -314,7 +364,7 @@ void HighlightWords::addPHPFunction(QString k)
 
 void HighlightWords::_addPHPFunction(QString k)
 {
-    phpwords[k.toLower().toStdString()] = knownFunctionFormat;
+    phpwords.add(k, HIGHLIGHT_FORMAT_KNOWN_FUNCTION);
 }
 
 void HighlightWords::addPHPVariable(QString k)
@@ -324,7 +374,7 @@ void HighlightWords::addPHPVariable(QString k)
 
 void HighlightWords::_addPHPVariable(QString k)
 {
-    phpwordsCS[k.toStdString()] = knownVariableFormat;
+    phpwordsCS.add(k, HIGHLIGHT_FORMAT_KNOWN_VARIABLE);
 }
 
 void HighlightWords::addPHPConstant(QString k)
@@ -334,7 +384,7 @@ void HighlightWords::addPHPConstant(QString k)
 
 void HighlightWords::_addPHPConstant(QString k)
 {
-    phpwordsCS[k.toStdString()] = constFormat;
+    phpwordsCS.add(k, HIGHLIGHT_FORMAT_CONST);
 }
 
 void HighlightWords::addPHPClassConstant(QString cls, QString c)
@@ -346,7 +396,7 @@ void HighlightWords::_addPHPClassConstant(QString cls, QString c)
 {
     if (cls.indexOf("\\") >= 0) cls = cls.mid(cls.lastIndexOf("\\")+1);
     QString k = cls.toLower() + "::" + c;
-    phpClassWordsCS[k.toStdString()] = constFormat;
+    phpClassWordsCS.add(k, HIGHLIGHT_FORMAT_CONST);
 }
 
 void HighlightWords::addJSFunction(QString k)
@@ -356,7 +406,7 @@ void HighlightWords::addJSFunction(QString k)
 
 void HighlightWords::_addJSFunction(QString k)
 {
-    jswordsCS[k.toStdString()] = knownFunctionFormat;
+    jswordsCS.add(k, HIGHLIGHT_FORMAT_KNOWN_FUNCTION);
 }
 
 void HighlightWords::addJSInterface(QString k)
@@ -366,7 +416,7 @@ void HighlightWords::addJSInterface(QString k)
 
 void HighlightWords::_addJSInterface(QString k)
 {
-    jswordsCS[k.toStdString()] = classFormat;
+    jswordsCS.add(k, HIGHLIGHT_FORMAT_CLASS);
 }
 
 void HighlightWords::addJSObject(QString k)
@@ -376,7 +426,7 @@ void HighlightWords::addJSObject(QString k)
 
 void HighlightWords::_addJSObject(QString k)
 {
-    jswordsCS[k.toStdString()] = classFormat;
+    jswordsCS.add(k, HIGHLIGHT_FORMAT_CLASS);
 }
 
 void HighlightWords::addJSExtDartObject(QString k)
@@ -386,7 +436,7 @@ void HighlightWords::addJSExtDartObject(QString k)
 
 void HighlightWords::_addJSExtDartObject(QString k)
 {
-    jsExtDartWordsCS[k.toStdString()] = classFormat;
+    jsExtDartWordsCS.add(k, HIGHLIGHT_FORMAT_CLASS);
 }
 
 void HighlightWords::addJSExtDartFunction(QString k)
@@ -396,7 +446,7 @@ void HighlightWords::addJSExtDartFunction(QString k)
 
 void HighlightWords::_addJSExtDartFunction(QString k)
 {
-    jsExtDartWordsCS[k.toStdString()] = knownFunctionFormat;
+    jsExtDartWordsCS.add(k, HIGHLIGHT_FORMAT_KNOWN_FUNCTION);
 }
 
 void HighlightWords::addCSSProperty(QString k)
@@ -406,7 +456,7 @@ void HighlightWords::addCSSProperty(QString k)
 
 void HighlightWords::_addCSSProperty(QString k)
 {
-    csswords[k.toStdString()] = knownFormat;
+    csswords.add(k, HIGHLIGHT_FORMAT_KNOWN);
 }
 
 void HighlightWords::addHTMLTag(QString k)
@@ -416,7 +466,7 @@ void HighlightWords::addHTMLTag(QString k)
 
 void HighlightWords::_addHTMLTag(QString k)
 {
-    htmlwords[k.toStdString()] = knownFormat;
+    htmlwords.add(k, HIGHLIGHT_FORMAT_KNOWN);
 }
 
 void HighlightWords::addHTMLShortTag(QString k)
@@ -426,5 +476,5 @@ void HighlightWords::addHTMLShortTag(QString k)
 
 void HighlightWords::_addHTMLShortTag(QString k)
 {
-    htmlshorts[k.toStdString()] = knownFormat;
+    htmlshorts.add(k, HIGHLIGHT_FORMAT_KNOWN);
 }
@@ -0,0 +1,95 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "highlightworker.h"
+#include <QMutexLocker>
+#include <QThread>
+
+const int HIGHLIGHT_WORKER_QUEUE_MAX_SIZE = 2000;
+const int HIGHLIGHT_WORKER_WAIT_MILLISECONDS = 100;
+
+HighlightWorker::HighlightWorker(QStringList lines, QString extension, QString fileName, int firstBlockNumber, HighlightData * prevData):
+    cancelled(0),
+    words(HighlightWords::instance()),
+    tokenizer(&words),
+    lines(lines),
+    firstBlockNumber(firstBlockNumber),
+    prevData(nullptr)
+{
+    // highlight words are copied, so that the worker never reads the tables changed by editor
+    // state of the previous block is copied, because editor document can change
+    if (prevData != nullptr) this->prevData = new HighlightData(* prevData);
+    tokenizer.setFileName(fileName);
+    tokenizer.initMode(extension, -1);
+    tokenizer.setFirstRunMode(true);
+    pool.setMaxThreadCount(1);
+}
+
+HighlightWorker::~HighlightWorker()
+{
+    cancel();
+    pool.waitForDone();
+    while (!results.isEmpty()) {
+        Result result = results.dequeue();
+        if (result.data != nullptr) delete result.data;
+    }
+    if (prevData != nullptr) delete prevData;
+}
+
+void HighlightWorker::start()
+{
+    pool.start(new Task(this));
+}
+
+void HighlightWorker::cancel()
+{
+    cancelled.storeRelease(1);
+    QMutexLocker locker(&mutex);
+    takenCondition.wakeAll();
+}
+
+bool HighlightWorker::isAvailable()
+{
+    return QThread::idealThreadCount() > 1;
+}
+
+bool HighlightWorker::takeNext(Result & result)
+{
+    QMutexLocker locker(&mutex);
+    if (results.isEmpty()) return false;
+    result = results.dequeue();
+    takenCondition.wakeAll();
+    return true;
+}
+
+void HighlightWorker::run()
+{
+    // only plain text is parsed here, formats and block data are applied by editor
+    for (int i=0; i<lines.size() && cancelled.loadAcquire() == 0; i++) {
+        Result result;
+        result.blockNumber = firstBlockNumber + i;
+        HighlightData * data = tokenizer.tokenizeBlock(lines.at(i), result.blockNumber, prevData, result.formats);
+        result.data = data != nullptr ? new HighlightData(* data) : nullptr;
+        if (prevData != nullptr) delete prevData;
+        prevData = data;
+        QMutexLocker locker(&mutex);
+        results.enqueue(result);
+        while (results.size() >= HIGHLIGHT_WORKER_QUEUE_MAX_SIZE && cancelled.loadAcquire() == 0) {
+            takenCondition.wait(&mutex, static_cast<unsigned long>(HIGHLIGHT_WORKER_WAIT_MILLISECONDS));
+        }
+    }
+    lines.clear();
+}
+
+HighlightWorker::Task::Task(HighlightWorker * worker): worker(worker)
+{
+
+}
+
+void HighlightWorker::Task::run()
+{
+    worker->run();
+}
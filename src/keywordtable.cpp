@@ -0,0 +1,209 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "keywordtable.h"
+#include <QThread>
+#include <algorithm>
+
+const int KEYWORD_TABLE_BUCKET_SIZE = 2;
+const int KEYWORD_TABLE_MAX_LOAD_FACTOR = 8;
+const uint KEYWORD_TABLE_MAX_SEED = 65536;
+const int KEYWORD_TABLE_DYNAMIC_MIN_SIZE = 64;
+const int KEYWORD_TABLE_NOT_FOUND = -1;
+
+KeywordTable::KeywordTable(bool caseSensitive): caseSensitive(caseSensitive), ownerThread(QThread::currentThread()), dynamicCount(0)
+{
+
+}
+
+QChar KeywordTable::fold(QChar c)
+{
+    ushort u = c.unicode();
+    if (u < 128) return (u >= 'A' && u <= 'Z') ? QChar(static_cast<ushort>(u + 32)) : c;
+    return c.toLower();
+}
+
+QString KeywordTable::foldWord(const QString & word) const
+{
+    if (caseSensitive) return word;
+    QString folded = word;
+    for (int i=0; i<folded.size(); i++) {
+        folded[i] = fold(folded[i]);
+    }
+    return folded;
+}
+
+uint KeywordTable::hash(QStringView word, uint seed) const
+{
+    // words are folded while hashing, so that lookups never allocate
+    uint h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (int i=0; i<word.size(); i++) {
+        h ^= caseSensitive ? word[i].unicode() : fold(word[i]).unicode();
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+bool KeywordTable::equals(const QString & key, QStringView word) const
+{
+    if (key.size() != word.size()) return false;
+    for (int i=0; i<key.size(); i++) {
+        QChar c = caseSensitive ? word[i] : fold(word[i]);
+        if (key[i] != c) return false;
+    }
+    return true;
+}
+
+void KeywordTable::add(const QString & word, int formatId)
+{
+    Q_ASSERT_X(QThread::currentThread() == ownerThread, "KeywordTable", "table is changed outside of its thread");
+    if (word.size() == 0) return;
+    insertDynamic(Entry{foldWord(word), formatId});
+}
+
+void KeywordTable::insertDynamic(const Entry & entry)
+{
+    // open addressing with linear probing, table is kept at most half full
+    if ((dynamicCount + 1) * 2 > dynamicSlots.size()) {
+        QVector<Entry> slots = dynamicSlots;
+        dynamicSlots = QVector<Entry>(std::max(KEYWORD_TABLE_DYNAMIC_MIN_SIZE, dynamicSlots.size() * 2), Entry{QString(), KEYWORD_TABLE_NOT_FOUND});
+        dynamicCount = 0;
+        for (const Entry & slot : slots) {
+            if (slot.formatId != KEYWORD_TABLE_NOT_FOUND) insertDynamic(slot);
+        }
+    }
+    uint mask = static_cast<uint>(dynamicSlots.size()) - 1;
+    uint i = hash(entry.word, 0) & mask;
+    while (dynamicSlots.at(static_cast<int>(i)).formatId != KEYWORD_TABLE_NOT_FOUND) {
+        if (dynamicSlots.at(static_cast<int>(i)).word == entry.word) {
+            dynamicSlots[static_cast<int>(i)].formatId = entry.formatId;
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+    dynamicSlots[static_cast<int>(i)] = entry;
+    dynamicCount++;
+}
+
+void KeywordTable::addStatic(const QString & word, int formatId)
+{
+    Q_ASSERT_X(QThread::currentThread() == ownerThread, "KeywordTable", "table is changed outside of its thread");
+    if (word.size() == 0) return;
+    staticWords.insert(foldWord(word), formatId);
+}
+
+void KeywordTable::build()
+{
+    Q_ASSERT_X(QThread::currentThread() == ownerThread, "KeywordTable", "table is changed outside of its thread");
+    // words of the previous build are kept in slots only
+    for (QVector<Entry>::const_iterator it = staticSlots.constBegin(); it != staticSlots.constEnd(); ++it) {
+        if (it->formatId != KEYWORD_TABLE_NOT_FOUND && !staticWords.contains(it->word)) staticWords.insert(it->word, it->formatId);
+    }
+    QVector<Entry> entries;
+    for (QHash<QString, int>::const_iterator it = staticWords.constBegin(); it != staticWords.constEnd(); ++it) {
+        entries.append(Entry{it.key(), it.value()});
+    }
+    // slots are added until every bucket finds a seed without collisions
+    int slotsCount = entries.size() + entries.size() / 4 + 1;
+    while (!buildSlots(entries, slotsCount)) {
+        slotsCount += slotsCount / 4 + 1;
+        if (slotsCount <= entries.size() * KEYWORD_TABLE_MAX_LOAD_FACTOR) continue;
+        staticSeeds.clear();
+        staticSlots.clear();
+        for (const Entry & entry : entries) {
+            insertDynamic(entry);
+        }
+        break;
+    }
+    staticWords.clear();
+}
+
+bool KeywordTable::buildSlots(const QVector<Entry> & entries, int slotsCount)
+{
+    // hash and displace: words are split into buckets,
+    // then each bucket gets a seed, that puts its words into free slots
+    int bucketsCount = entries.size() / KEYWORD_TABLE_BUCKET_SIZE + 1;
+    QVector<QVector<int>> buckets(bucketsCount);
+    for (int i=0; i<entries.size(); i++) {
+        buckets[static_cast<int>(hash(entries.at(i).word, 0) % static_cast<uint>(bucketsCount))].append(i);
+    }
+    // large buckets are placed first, while most of the slots are free
+    QVector<int> order;
+    for (int i=0; i<bucketsCount; i++) {
+        if (buckets.at(i).size() > 0) order.append(i);
+    }
+    std::sort(order.begin(), order.end(), [&buckets](int a, int b){
+        return buckets.at(a).size() > buckets.at(b).size();
+    });
+    QVector<Entry> slots(slotsCount, Entry{QString(), KEYWORD_TABLE_NOT_FOUND});
+    QVector<uint> seeds(bucketsCount, 0);
+    QVector<int> bucketSlots;
+    for (int b : order) {
+        const QVector<int> & bucket = buckets.at(b);
+        bool placed = false;
+        for (uint seed=1; seed<KEYWORD_TABLE_MAX_SEED && !placed; seed++) {
+            bucketSlots.clear();
+            placed = true;
+            for (int i : bucket) {
+                int slot = static_cast<int>(hash(entries.at(i).word, seed) % static_cast<uint>(slotsCount));
+                if (slots.at(slot).formatId != KEYWORD_TABLE_NOT_FOUND || bucketSlots.contains(slot)) {
+                    placed = false;
+                    break;
+                }
+                bucketSlots.append(slot);
+            }
+            if (placed) {
+                seeds[b] = seed;
+                for (int i=0; i<bucket.size(); i++) {
+                    slots[bucketSlots.at(i)] = entries.at(bucket.at(i));
+                }
+            }
+        }
+        if (!placed) return false;
+    }
+    staticSeeds = seeds;
+    staticSlots = slots;
+    return true;
+}
+
+void KeywordTable::clear()
+{
+    Q_ASSERT_X(QThread::currentThread() == ownerThread, "KeywordTable", "table is changed outside of its thread");
+    staticWords.clear();
+    staticSeeds.clear();
+    staticSlots.clear();
+    dynamicSlots.clear();
+    dynamicCount = 0;
+}
+
+int KeywordTable::find(QStringView word) const
+{
+    if (word.size() == 0) return KEYWORD_TABLE_NOT_FOUND;
+    uint h = hash(word, 0);
+    // added words take precedence over the static ones
+    if (dynamicCount > 0) {
+        uint mask = static_cast<uint>(dynamicSlots.size()) - 1;
+        for (uint i = h & mask; dynamicSlots.at(static_cast<int>(i)).formatId != KEYWORD_TABLE_NOT_FOUND; i = (i + 1) & mask) {
+            const Entry & entry = dynamicSlots.at(static_cast<int>(i));
+            if (equals(entry.word, word)) return entry.formatId;
+        }
+    }
+    if (staticSeeds.size() > 0) {
+        uint seed = staticSeeds.at(static_cast<int>(h % static_cast<uint>(staticSeeds.size())));
+        if (seed == 0) return KEYWORD_TABLE_NOT_FOUND;
+        const Entry & entry = staticSlots.at(static_cast<int>(hash(word, seed) % static_cast<uint>(staticSlots.size())));
+        if (entry.formatId != KEYWORD_TABLE_NOT_FOUND && equals(entry.word, word)) return entry.formatId;
+    }
+    return KEYWORD_TABLE_NOT_FOUND;
+}
+
+bool KeywordTable::contains(QStringView word) const
+{
+    return find(word) != KEYWORD_TABLE_NOT_FOUND;
+}
@@ -9,6 +9,7 @@
 LineMark::LineMark(Editor * codeEditor) : QWidget(codeEditor)
 {
     editor = codeEditor;
+    revision = 0;
     setCursor(Qt::ArrowCursor);
     setMouseTracking(true);
 }
@@ -25,6 +26,7 @@ void LineMark::paintEvent(QPaintEvent *event)
 void LineMark::addMark(int line, QString text)
 {
     marks[line] = text.toStdString();
+    revision++;
 }
 
 int LineMark::getMark(int line, QString & text)
@@ -40,11 +42,13 @@ int LineMark::getMark(int line, QString & text)
 void LineMark::clearMarks()
 {
     marks.clear();
+    revision++;
 }
 
 void LineMark::addError(int line, QString text)
 {
     errors[line] = text.toStdString();
+    revision++;
 }
 
 int LineMark::getError(int line, QString & text)
@@ -60,11 +64,13 @@ int LineMark::getError(int line, QString & text)
 void LineMark::clearErrors()
 {
     errors.clear();
+    revision++;
 }
 
 void LineMark::addWarning(int line, QString text)
 {
     warnings[line] = text.toStdString();
+    revision++;
 }
 
 int LineMark::getWarning(int line, QString & text)
@@ -80,6 +86,7 @@ int LineMark::getWarning(int line, QString & text)
 void LineMark::clearWarnings()
 {
     warnings.clear();
+    revision++;
 }
 
 void LineMark::clear()
@@ -110,3 +117,24 @@ int LineMark::getWarningsCount() {
 int LineMark::getMarksCount() {
     return static_cast<int>(marks.size());
 }
+
+bool LineMark::hasMark(int line)
+{
+    return marks.find(line) != marks.end();
+}
+
+bool LineMark::hasError(int line)
+{
+    return errors.find(line) != errors.end();
+}
+
+bool LineMark::hasWarning(int line)
+{
+    return warnings.find(line) != warnings.end();
+}
+
+int LineMark::getRevision()
+{
+    // changes with every added or cleared line, so that editor can cache gutter state
+    return revision;
+}
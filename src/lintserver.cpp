@@ -0,0 +1,127 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "lintserver.h"
+#include <QStringList>
+
+const int LINT_SERVER_START_TIMEOUT = 5000;
+const int LINT_SERVER_EXIT_TIMEOUT = 1000;
+const int LINT_SERVER_REQUEST_TIMEOUT = 30000;
+const int LINT_SERVER_ATTEMPTS = 2;
+const QByteArray LINT_SERVER_READY = "ready";
+const int LINT_SERVER_UNSUPPORTED_EXIT_CODE = 1;
+
+// reads "<path>\n<size>\n<code>" requests from stdin and replies with "<size>\n<errors>",
+// the code is only tokenized, so it is never executed
+const QString LINT_SERVER_SCRIPT =
+    "if (!function_exists('token_get_all') || !defined('TOKEN_PARSE')) exit(1);"
+    "set_error_handler(function() { return true; });"
+    "echo 'ready', PHP_EOL;"
+    "flush();"
+    "while (($file = fgets(STDIN)) !== false) {"
+    "    $file = rtrim($file);"
+    "    $size = (int) fgets(STDIN);"
+    "    $code = '';"
+    "    while (strlen($code) < $size && !feof(STDIN)) $code .= fread(STDIN, $size - strlen($code));"
+    "    $output = '';"
+    "    try {"
+    "        token_get_all($code, TOKEN_PARSE);"
+    "    } catch (ParseError $e) {"
+    "        $output = 'PHP Parse error:  ' . $e->getMessage() . ' in ' . $file . ' on line ' . $e->getLine();"
+    "    } catch (Throwable $e) {"
+    "        $output = 'PHP Fatal error:  ' . $e->getMessage() . ' in ' . $file . ' on line ' . $e->getLine();"
+    "    }"
+    "    echo strlen($output), PHP_EOL, $output;"
+    "    flush();"
+    "}";
+
+LintServer::LintServer(QString phpPath): phpPath(phpPath), process(nullptr), unsupported(false)
+{
+
+}
+
+LintServer::~LintServer()
+{
+    stop();
+}
+
+bool LintServer::lint(QString path, QString content, QString & output)
+{
+    if (unsupported || phpPath.size() == 0) return false;
+    QByteArray code = content.toUtf8();
+    QByteArray data = path.replace("\n", " ").toUtf8() + "\n" + QByteArray::number(code.size()) + "\n" + code;
+    QByteArray response;
+    // crashed or stuck server is started again
+    for (int i=0; i<LINT_SERVER_ATTEMPTS; i++) {
+        if (process == nullptr && !start()) return false;
+        if (request(data, response)) {
+            output = QString::fromUtf8(response).trimmed();
+            return true;
+        }
+        stop();
+    }
+    return false;
+}
+
+bool LintServer::start()
+{
+    process = new QProcess();
+    process->setStandardErrorFile(QProcess::nullDevice());
+    process->start(phpPath, QStringList() << "-d" << "display_errors=0" << "-r" << LINT_SERVER_SCRIPT);
+    QByteArray line;
+    if (!process->waitForStarted(LINT_SERVER_START_TIMEOUT) || !readLine(line, LINT_SERVER_START_TIMEOUT) || line != LINT_SERVER_READY) {
+        // php without tokenizer or parse exceptions is checked by php -l,
+        // other failures are retried with the next request
+        if (process->state() != QProcess::NotRunning) process->waitForFinished(LINT_SERVER_EXIT_TIMEOUT);
+        if (process->state() == QProcess::NotRunning && process->exitStatus() == QProcess::NormalExit && process->exitCode() == LINT_SERVER_UNSUPPORTED_EXIT_CODE) {
+            unsupported = true;
+        }
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void LintServer::stop()
+{
+    if (process == nullptr) return;
+    if (process->state() != QProcess::NotRunning) {
+        process->kill();
+        process->waitForFinished(LINT_SERVER_START_TIMEOUT);
+    }
+    delete process;
+    process = nullptr;
+}
+
+bool LintServer::request(const QByteArray & data, QByteArray & response)
+{
+    if (process->state() != QProcess::Running) return false;
+    if (process->write(data) != data.size()) return false;
+    QByteArray line;
+    if (!readLine(line, LINT_SERVER_REQUEST_TIMEOUT)) return false;
+    bool ok = false;
+    int size = line.toInt(&ok);
+    if (!ok || size < 0) return false;
+    return readData(size, response);
+}
+
+bool LintServer::readLine(QByteArray & line, int msecs)
+{
+    while (!process->canReadLine()) {
+        if (!process->waitForReadyRead(msecs)) return false;
+    }
+    line = process->readLine().trimmed();
+    return true;
+}
+
+bool LintServer::readData(int size, QByteArray & data)
+{
+    while (process->bytesAvailable() < size) {
+        if (!process->waitForReadyRead(LINT_SERVER_REQUEST_TIMEOUT)) return false;
+    }
+    data = process->read(size);
+    return true;
+}
@@ -62,6 +62,8 @@ MainWindow::MainWindow(QWidget *parent) :
     qRegisterMetaType<ParseJS::ParseResult>();
     qRegisterMetaType<ParseCSS::ParseResult>();
     qRegisterMetaType<WordsMapList>();
+    qRegisterMetaType<FileSearcher::Results>();
+    qRegisterMetaType<FileIndex>();
 
     Settings::load();
     connect(&Settings::instance(), SIGNAL(restartApp()), this, SLOT(restartApp()));
@@ -183,9 +185,9 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(editorTabs, SIGNAL(editorReady(int)), this, SLOT(editorReady(int)));
     connect(editorTabs, SIGNAL(editorShowDeclaration(QString)), this, SLOT(editorShowDeclaration(QString)));
     connect(editorTabs, SIGNAL(editorShowHelp(QString)), this, SLOT(editorShowHelp(QString)));
-    connect(editorTabs, SIGNAL(editorParsePHPRequested(int,QString)), this, SLOT(editorParsePHPRequested(int,QString)));
-    connect(editorTabs, SIGNAL(editorParseJSRequested(int,QString)), this, SLOT(editorParseJSRequested(int,QString)));
-    connect(editorTabs, SIGNAL(editorParseCSSRequested(int,QString)), this, SLOT(editorParseCSSRequested(int,QString)));
+    connect(editorTabs, SIGNAL(editorParsePHPRequested(int,int,QString)), this, SLOT(editorParsePHPRequested(int,int,QString)));
+    connect(editorTabs, SIGNAL(editorParseJSRequested(int,int,QString)), this, SLOT(editorParseJSRequested(int,int,QString)));
+    connect(editorTabs, SIGNAL(editorParseCSSRequested(int,int,QString)), this, SLOT(editorParseCSSRequested(int,int,QString)));
     connect(editorTabs, SIGNAL(editorUndoRedoChanged()), this, SLOT(editorUndoRedoChanged()));
     connect(editorTabs, SIGNAL(editorBackForwardChanged()), this, SLOT(editorBackForwardChanged()));
     connect(editorTabs, SIGNAL(editorSearchInFilesRequested(QString)), this, SLOT(editorSearchInFilesRequested(QString)));
@@ -299,8 +301,12 @@ MainWindow::MainWindow(QWidget *parent) :
 
     // progress line
     progressLine = new ProgressLine(this);
+    progressLineCount = 0;
     progressInfo = new ProgressInfo(this);
 
+    // project watcher
+    projectWatcher = new ProjectWatcher(this);
+
     // enable php lint & cs
     parsePHPLintEnabled = false;
     std::string parsePHPLintEnabledStr = Settings::get("parser_enable_php_lint");
@@ -323,6 +329,9 @@ MainWindow::MainWindow(QWidget *parent) :
     serverCommandsEnabled = false;
     std::string serverCommandsEnabledStr = Settings::get("parser_enable_servers");
     if (serverCommandsEnabledStr == "yes") serverCommandsEnabled = true;
+    projectWatchEnabled = false;
+    std::string projectWatchEnabledStr = Settings::get("parser_enable_project_watch");
+    if (projectWatchEnabledStr == "yes") projectWatchEnabled = true;
 
     // disable server commands on Android
     #if defined(Q_OS_ANDROID)
@@ -331,50 +340,54 @@ MainWindow::MainWindow(QWidget *parent) :
 
     // parser
     parserWorker = new ParserWorker();
-    parserWorker->moveToThread(&parserThread);
-    connect(&parserThread, &QThread::finished, parserWorker, &QObject::deleteLater);
-    connect(this, SIGNAL(initWorker()), parserWorker, SLOT(init()));
-    connect(this, SIGNAL(disableWorker()), parserWorker, SLOT(disable()));
-    connect(this, SIGNAL(parseLint(int,QString)), parserWorker, SLOT(lint(int,QString)));
-    connect(this, SIGNAL(execPHP(int,QString)), parserWorker, SLOT(execPHP(int,QString)));
-    connect(this, SIGNAL(execSelection(int,QString)), parserWorker, SLOT(execSelection(int,QString)));
-    connect(this, SIGNAL(startPHPWebServer(QString)), parserWorker, SLOT(startPHPWebServer(QString)));
-    connect(this, SIGNAL(stopPHPWebServer()), parserWorker, SLOT(stopPHPWebServer()));
-    connect(this, SIGNAL(parsePHPCS(int,QString)), parserWorker, SLOT(phpcs(int,QString)));
-    connect(this, SIGNAL(parseMixed(int,QString)), parserWorker, SLOT(parseMixed(int,QString)));
-    connect(this, SIGNAL(parseJS(int,QString)), parserWorker, SLOT(parseJS(int,QString)));
-    connect(this, SIGNAL(parseCSS(int,QString)), parserWorker, SLOT(parseCSS(int,QString)));
-    connect(this, SIGNAL(parseProject(QString)), parserWorker, SLOT(parseProject(QString)));
-    connect(this, SIGNAL(searchInFiles(QString,QString,QString,bool,bool,bool,QStringList)), parserWorker, SLOT(searchInFiles(QString,QString,QString,bool,bool,bool,QStringList)));
-    connect(this, SIGNAL(gitCommand(QString, QString, QStringList, bool, bool)), parserWorker, SLOT(gitCommand(QString, QString, QStringList, bool, bool)));
-    connect(this, SIGNAL(serversCommand(QString, QString)), parserWorker, SLOT(serversCommand(QString,QString)));
-    connect(this, SIGNAL(sassCommand(QString, QString)), parserWorker, SLOT(sassCommand(QString,QString)));
-    connect(this, SIGNAL(quickFind(QString, QString, WordsMapList, QStringList)), parserWorker, SLOT(quickFind(QString, QString, WordsMapList, QStringList)));
-    connect(this, SIGNAL(installAndroidPack()), parserWorker, SLOT(installAndroidPack()));
-    connect(progressInfo, SIGNAL(cancelTriggered()), parserWorker, SLOT(cancelRequested()));
-    connect(parserWorker, SIGNAL(lintFinished(int,QStringList,QStringList,QString)), this, SLOT(parseLintFinished(int,QStringList,QStringList,QString)));
-    connect(parserWorker, SIGNAL(execPHPFinished(int,QString)), this, SLOT(execPHPFinished(int,QString)));
-    connect(parserWorker, SIGNAL(execPHPWebServerFinished(bool,QString)), this, SLOT(execPHPWebServerFinished(bool,QString)));
-    connect(parserWorker, SIGNAL(phpcsFinished(int,QStringList,QStringList)), this, SLOT(parsePHPCSFinished(int,QStringList,QStringList)));
-    connect(parserWorker, SIGNAL(parseMixedFinished(int,ParsePHP::ParseResult)), this, SLOT(parseMixedFinished(int,ParsePHP::ParseResult)));
-    connect(parserWorker, SIGNAL(parseJSFinished(int,ParseJS::ParseResult)), this, SLOT(parseJSFinished(int,ParseJS::ParseResult)));
-    connect(parserWorker, SIGNAL(parseCSSFinished(int,ParseCSS::ParseResult)), this, SLOT(parseCSSFinished(int,ParseCSS::ParseResult)));
-    connect(parserWorker, SIGNAL(parseProjectFinished(bool,bool)), this, SLOT(parseProjectFinished(bool,bool)));
-    connect(parserWorker, SIGNAL(parseProjectProgress(int)), this, SLOT(sidebarProgressChanged(int)));
-    connect(parserWorker, SIGNAL(searchInFilesFound(QString,QString,int,int)), this, SLOT(searchInFilesFound(QString,QString,int,int)));
-    connect(parserWorker, SIGNAL(searchInFilesFinished()), this, SLOT(searchInFilesFinished()));
-    connect(parserWorker, SIGNAL(message(QString)), this, SLOT(workerMessage(QString)));
-    connect(parserWorker, SIGNAL(gitCommandFinished(QString,QString,bool)), this, SLOT(gitCommandFinished(QString,QString,bool)));
-    connect(parserWorker, SIGNAL(serversCommandFinished(QString)), this, SLOT(serversCommandFinished(QString)));
-    connect(parserWorker, SIGNAL(sassCommandFinished(QString,QString)), this, SLOT(sassCommandFinished(QString,QString)));
-    connect(parserWorker, SIGNAL(quickFound(QString,QString,QString,int)), qa, SLOT(quickFound(QString,QString,QString,int)));
-    connect(parserWorker, SIGNAL(activateProgress()), this, SLOT(activateProgressLine()));
-    connect(parserWorker, SIGNAL(deactivateProgress()), this, SLOT(deactivateProgressLine()));
-    connect(parserWorker, SIGNAL(activateProgressInfo(QString)), this, SLOT(activateProgressInfo(QString)));
-    connect(parserWorker, SIGNAL(deactivateProgressInfo()), this, SLOT(deactivateProgressInfo()));
-    connect(parserWorker, SIGNAL(updateProgressInfo(QString)), this, SLOT(updateProgressInfo(QString)));
-    connect(parserWorker, SIGNAL(installAndroidPackFinished(QString)), this, SLOT(installAndroidPackFinished(QString)));
+    lintWorker = new ParserWorker();
+    processWorker = new ParserWorker();
+    indexWorker = new ParserWorker();
+    processWorker->restorePHPWebServerPid();
+    progressInfoWorker = nullptr;
+    connectParserWorker(parserWorker, &parserThread);
+    connectParserWorker(lintWorker, &lintThread);
+    connectParserWorker(processWorker, &processThread);
+    connectParserWorker(indexWorker, &indexThread);
+    // interactive lane
+    connect(this, SIGNAL(parseMixed(int,int,QString)), parserWorker, SLOT(parseMixed(int,int,QString)));
+    connect(this, SIGNAL(parseJS(int,int,QString)), parserWorker, SLOT(parseJS(int,int,QString)));
+    connect(this, SIGNAL(parseCSS(int,int,QString)), parserWorker, SLOT(parseCSS(int,int,QString)));
+    connect(editorTabs, SIGNAL(editorClosed(int)), parserWorker, SLOT(releaseEditor(int)));
+    connect(this, SIGNAL(quickFind(QString, QString, WordsMapList, QStringList, bool)), parserWorker, SLOT(quickFind(QString, QString, WordsMapList, QStringList, bool)));
+    connect(projectWatcher, SIGNAL(changesDetected(QString,QStringList)), parserWorker, SLOT(updateFileIndex(QString,QStringList)));
+    connect(parserWorker, SIGNAL(fileIndexRequested(QString)), indexWorker, SLOT(buildFileIndex(QString)));
+    connect(indexWorker, SIGNAL(fileIndexBuilt(FileIndex)), parserWorker, SLOT(setFileIndex(FileIndex)));
+    // lint lane
+    connect(this, SIGNAL(parseLint(int,QString,QString)), lintWorker, SLOT(lint(int,QString,QString)));
+    connect(this, SIGNAL(parsePHPCS(int,QString)), lintWorker, SLOT(phpcs(int,QString)));
+    // external processes lane
+    connect(this, SIGNAL(execPHP(int,QString)), processWorker, SLOT(execPHP(int,QString)));
+    connect(this, SIGNAL(execSelection(int,QString)), processWorker, SLOT(execSelection(int,QString)));
+    connect(this, SIGNAL(startPHPWebServer(QString)), processWorker, SLOT(startPHPWebServer(QString)));
+    connect(this, SIGNAL(stopPHPWebServer()), processWorker, SLOT(stopPHPWebServer()));
+    connect(this, SIGNAL(gitCommand(QString, QString, QStringList, bool, bool)), processWorker, SLOT(gitCommand(QString, QString, QStringList, bool, bool)));
+    connect(this, SIGNAL(serversCommand(QString, QString)), processWorker, SLOT(serversCommand(QString,QString)));
+    connect(this, SIGNAL(sassCommand(QString, QString)), processWorker, SLOT(sassCommand(QString,QString)));
+    connect(this, SIGNAL(installAndroidPack()), processWorker, SLOT(installAndroidPack()));
+    // tools are detected on external processes lane and shared with other lanes
+    connect(this, SIGNAL(initWorker()), processWorker, SLOT(init()));
+    connect(processWorker, SIGNAL(toolPathsDetected(QString,QString,QString,QString,QString)), parserWorker, SLOT(setToolPaths(QString,QString,QString,QString,QString)));
+    connect(processWorker, SIGNAL(toolPathsDetected(QString,QString,QString,QString,QString)), lintWorker, SLOT(setToolPaths(QString,QString,QString,QString,QString)));
+    connect(processWorker, SIGNAL(toolPathsDetected(QString,QString,QString,QString,QString)), indexWorker, SLOT(setToolPaths(QString,QString,QString,QString,QString)));
+    // indexing and search lane
+    connect(this, SIGNAL(parseProject(QString)), indexWorker, SLOT(parseProject(QString)));
+    connect(this, SIGNAL(updateProjectFile(QString,QString,ParsePHP::ParseResult)), indexWorker, SLOT(updateProjectFile(QString,QString,ParsePHP::ParseResult)));
+    connect(projectWatcher, SIGNAL(changesDetected(QString,QStringList)), indexWorker, SLOT(checkProjectChanges(QString,QStringList)));
+    connect(this, SIGNAL(checkProjectChanges(QString,QStringList)), indexWorker, SLOT(checkProjectChanges(QString,QStringList)));
+    connect(this, SIGNAL(searchInFiles(QString,QString,QString,bool,bool,bool,QStringList)), indexWorker, SLOT(searchInFiles(QString,QString,QString,bool,bool,bool,QStringList)));
+    // only the lane that shows progress info is cancelled
+    connect(progressInfo, SIGNAL(cancelTriggered()), this, SLOT(progressInfoCancelled()));
     parserThread.start();
+    lintThread.start();
+    processThread.start();
+    indexThread.start(QThread::LowPriority);
+    emit initWorker();
 
     tmpDisableParser = false;
 
@@ -690,7 +703,13 @@ MainWindow::MainWindow(QWidget *parent) :
 MainWindow::~MainWindow()
 {
     parserThread.quit();
+    lintThread.quit();
+    processThread.quit();
+    indexThread.quit();
     parserThread.wait();
+    lintThread.wait();
+    processThread.wait();
+    indexThread.wait();
     delete filebrowser;
     delete navigator;
     delete editorTabs;
@@ -1102,7 +1121,8 @@ void MainWindow::on_actionSplitTab_triggered()
                     int w = ui->centralWidget->geometry().width() / 2;
                     editorsSplitter->setSizes(QList<int>() << w << w);
                 }
-                editorTabsSplit->openFile(fileName);
+                // split view renders the same document
+                editorTabsSplit->openSharedFile(textEditor);
                 textEditorSplit = editorTabsSplit->getActiveEditor();
                 if (textEditorSplit != nullptr && textEditorSplit->getFileName() == fileName) {
                     textEditorSplit->gotoLine(textEditor->getCursorLine());
@@ -1187,6 +1207,7 @@ void MainWindow::on_actionCloseProject_triggered()
 {
     project->save(editorTabs->getOpenTabFiles(), editorTabs->getOpenTabLines(), editorTabs->getCurrentTabIndex(), ui->todoEdit->toPlainText());
     project->close();
+    projectWatcher->unwatch();
     reloadWords();
     disableActionsForEmptyProject();
     filebrowser->rebuildFileBrowserTree(filebrowser->getHomeDir());
@@ -1985,6 +2006,14 @@ void MainWindow::searchInFilesFound(QString file, QString lineText, int line, in
     ui->searchListWidget->addItem(item);
 }
 
+void MainWindow::searchInFilesResultsFound(FileSearcher::Results results)
+{
+    for (int i=0; i<results.size(); i++) {
+        FileSearcher::Result result = results.at(i);
+        searchInFilesFound(result.file, result.lineText, result.line, result.symbol);
+    }
+}
+
 void MainWindow::searchInFilesFinished()
 {
     ui->outputTabWidget->setTabText(OUTPUT_TAB_SEARCH_INDEX, tr("Search")+"("+Helper::intToStr(ui->searchListWidget->count())+")");
@@ -2164,7 +2193,8 @@ void MainWindow::quickFindRequested(QString text)
         words.push_back(project->phpFunctionDeclarations);
         wordPrefixes.append("function: ");
     }
-    emit quickFind(dir, text, words, wordPrefixes);
+    bool dirWatched = project->isOpen() && projectWatcher->getPath() == dir;
+    emit quickFind(dir, text, words, wordPrefixes, dirWatched);
 }
 
 void MainWindow::editorFilenameChanged(QString name)
@@ -2268,13 +2298,24 @@ void MainWindow::editorModifiedStateChanged(bool m)
 void MainWindow::editorSaved(int index)
 {
     Editor * textEditor = editorTabs->getActiveEditor();
-    if (textEditor == nullptr || textEditor->getTabIndex() != index) return;
+    if (textEditor == nullptr || textEditor->getTabIndex() != index) {
+        // inactive tabs are not parsed, index re-reads the file from disk
+        Editor * savedEditor = editorTabs->getTabEditor(index);
+        if (savedEditor != nullptr) checkProjectFileSaved(savedEditor->getFileName());
+        return;
+    }
 
     Editor * textEditorSplit = editorTabsSplit->getActiveEditor();
-    if (textEditorSplit != nullptr && textEditorSplit->getFileName() == textEditor->getFileName()) {
+    if (textEditorSplit != nullptr && textEditorSplit->getFileName() == textEditor->getFileName() && textEditorSplit->getSharedDocumentEditor() != textEditor) {
         textEditorSplit->setFileIsOutdated();
     }
 
+    // project index is updated with the parse result of saved file
+    QString fileName = textEditor->getFileName();
+    if (project->isOpen() && parsePHPEnabled && textEditor->getModeType() == MODE_MIXED && fileName.startsWith(project->getPath() + "/") && Project::isProjectFile(fileName)) {
+        if (!projectUpdateFiles.contains(fileName)) projectUpdateFiles.append(fileName);
+    }
+
     parseTab();
     gitTabRefreshRequested();
     filesHistory[textEditor->getFileName()] = textEditor->getCursorLine();
@@ -2287,12 +2328,22 @@ void MainWindow::editorSplitSaved(int index)
 
     Editor * textEditor = editorTabs->getActiveEditor();
     if (textEditor != nullptr && textEditor->getFileName() == textEditorSplit->getFileName()) {
-        textEditor->setFileIsOutdated();
+        // shared document is parsed in the main pane
+        if (textEditorSplit->getSharedDocumentEditor() == textEditor) parseTab();
+        else textEditor->setFileIsOutdated();
     }
 
     parseTabSplit();
     gitTabRefreshRequested();
     filesHistory[textEditorSplit->getFileName()] = textEditorSplit->getCursorLine();
+    checkProjectFileSaved(textEditorSplit->getFileName());
+}
+
+void MainWindow::checkProjectFileSaved(QString fileName)
+{
+    if (!project->isOpen() || !parsePHPEnabled) return;
+    if (!fileName.startsWith(project->getPath() + "/") || !Project::isProjectFile(fileName)) return;
+    emit checkProjectChanges(project->getPath(), QStringList() << fileName);
 }
 
 void MainWindow::editorReady(int index)
@@ -2325,11 +2376,11 @@ void MainWindow::parseTab()
     clearMessagesTabText();
     //if (modeType == MODE_UNKNOWN) return;
     if (modeType == MODE_MIXED) {
-        if ((!project->isOpen() && parsePHPLintEnabled) || (project->isOpen() && project->isPHPLintEnabled())) emit parseLint(tabIndex, path);
-        if (textEditor->isReady() && parsePHPEnabled) emit parseMixed(tabIndex, textEditor->getContent());
+        if ((!project->isOpen() && parsePHPLintEnabled) || (project->isOpen() && project->isPHPLintEnabled())) emit parseLint(tabIndex, path, textEditor->getContent());
+        if (textEditor->isReady() && parsePHPEnabled) emit parseMixed(textEditor->getId(), textEditor->updateParseRevision(), textEditor->getContent());
     }
-    if (modeType == MODE_JS && textEditor->isReady() && parseJSEnabled) emit parseJS(tabIndex, textEditor->getContent());
-    if (modeType == MODE_CSS && textEditor->isReady() && parseCSSEnabled) emit parseCSS(tabIndex, textEditor->getContent());
+    if (modeType == MODE_JS && textEditor->isReady() && parseJSEnabled) emit parseJS(textEditor->getId(), textEditor->updateParseRevision(), textEditor->getContent());
+    if (modeType == MODE_CSS && textEditor->isReady() && parseCSSEnabled) emit parseCSS(textEditor->getId(), textEditor->updateParseRevision(), textEditor->getContent());
     if ((!project->isOpen() && parsePHPCSEnabled) || (project->isOpen() && project->isPHPCSEnabled())) emit parsePHPCS(tabIndex, path);
     if (gitCommandsEnabled && textEditor->isReady()) {
         gitAnnotationRequested(textEditor->getFileName());
@@ -2347,7 +2398,7 @@ void MainWindow::parseTabSplit()
     std::string modeType = textEditor->getModeType();
     //if (modeType == MODE_UNKNOWN) return;
     if (modeType == MODE_MIXED) {
-        if ((!project->isOpen() && parsePHPLintEnabled) || (project->isOpen() && project->isPHPLintEnabled())) emit parseLint(tabIndex, path);
+        if ((!project->isOpen() && parsePHPLintEnabled) || (project->isOpen() && project->isPHPLintEnabled())) emit parseLint(tabIndex, path, textEditor->getContent());
     }
     if ((!project->isOpen() && parsePHPCSEnabled) || (project->isOpen() && project->isPHPCSEnabled())) emit parsePHPCS(tabIndex, path);
     if (gitCommandsEnabled && textEditor->isReady()) {
@@ -2409,11 +2460,12 @@ void MainWindow::parsePHPCSFinished(int tabIndex, QStringList errorTexts, QStrin
     if (editorTabs->getActiveEditor() == textEditor) scrollMessagesTabToTop();
 }
 
-void MainWindow::parseMixedFinished(int tabIndex, ParsePHP::ParseResult result)
+void MainWindow::parseMixedFinished(int editorId, int revision, ParsePHP::ParseResult result)
 {
     Editor * textEditor = editorTabs->getActiveEditor();
     if (textEditor == nullptr) return;
-    if (tabIndex != textEditor->getTabIndex()) return;
+    if (editorId != textEditor->getId()) return;
+    if (revision < textEditor->getParseRevision()) return;
     if (!textEditor->getParseError()) {
         textEditor->clearErrors();
         if (result.errors.size()) {
@@ -2428,13 +2480,20 @@ void MainWindow::parseMixedFinished(int tabIndex, ParsePHP::ParseResult result)
     textEditor->setParseResult(result);
     navigator->build(result);
     qa->setParseResult(result, textEditor->getFileName());
+    QString fileName = textEditor->getFileName();
+    if (projectUpdateFiles.contains(fileName)) {
+        projectUpdateFiles.removeAll(fileName);
+        if (project->isOpen() && !textEditor->isModified()) emit updateProjectFile(project->getPath(), fileName, result);
+        else checkProjectFileSaved(fileName);
+    }
 }
 
-void MainWindow::parseJSFinished(int tabIndex, ParseJS::ParseResult result)
+void MainWindow::parseJSFinished(int editorId, int revision, ParseJS::ParseResult result)
 {
     Editor * textEditor = editorTabs->getActiveEditor();
     if (textEditor == nullptr) return;
-    if (tabIndex != textEditor->getTabIndex()) return;
+    if (editorId != textEditor->getId()) return;
+    if (revision < textEditor->getParseRevision()) return;
     textEditor->clearErrors();
     if (result.errors.size()) {
         for (int i=0; i<result.errors.size(); i++) {
@@ -2449,11 +2508,12 @@ void MainWindow::parseJSFinished(int tabIndex, ParseJS::ParseResult result)
     qa->setParseResult(result, textEditor->getFileName());
 }
 
-void MainWindow::parseCSSFinished(int tabIndex, ParseCSS::ParseResult result)
+void MainWindow::parseCSSFinished(int editorId, int revision, ParseCSS::ParseResult result)
 {
     Editor * textEditor = editorTabs->getActiveEditor();
     if (textEditor == nullptr) return;
-    if (tabIndex != textEditor->getTabIndex()) return;
+    if (editorId != textEditor->getId()) return;
+    if (revision < textEditor->getParseRevision()) return;
     textEditor->clearErrors();
     if (result.errors.size()) {
         for (int i=0; i<result.errors.size(); i++) {
@@ -2479,6 +2539,14 @@ void MainWindow::parseProjectFinished(bool success, bool isModified)
     if (ui->sidebarProgressBarWrapperWidget->isVisible()) ui->sidebarProgressBarWrapperWidget->hide();
     editorTabs->initHighlighters();
     if (success && isModified) showPopupText(tr("Project '%1' updated").arg(project->getName()));
+    if (success && projectWatchEnabled && project->isOpen() && projectWatcher->getPath() != project->getPath()) {
+        projectWatcher->watch(project->getPath());
+    }
+}
+
+void MainWindow::updateProjectFileFinished(QVariantMap oldMap, QVariantMap newMap)
+{
+    project->updateWords(oldMap, newMap);
 }
 
 void MainWindow::projectCreateRequested(QString name, QString path, bool lintEnabled, bool csEnabled)
@@ -2519,6 +2587,7 @@ void MainWindow::projectOpenRequested(QString path)
     }
     project->save(editorTabs->getOpenTabFiles(), editorTabs->getOpenTabLines(), editorTabs->getCurrentTabIndex(), ui->todoEdit->toPlainText());
     closeAllTabsRequested();
+    projectWatcher->unwatch();
     if (!project->open(path)) {
         Helper::showMessage(QObject::tr("Could not open the project."));
         return;
@@ -2536,12 +2605,10 @@ void MainWindow::projectOpenRequested(QString path)
     }
 }
 
-void MainWindow::openTabsRequested(QStringList files, bool initHighlight)
+void MainWindow::openTabsRequested(QStringList files, bool /*initHighlight*/)
 {
-    for (int i=0; i<files.size(); i++) {
-        QString file = files.at(i);
-        editorTabs->openFile(file, initHighlight);
-    }
+    // only the active tab is loaded, others wait until they are switched to
+    editorTabs->openFiles(files);
 }
 
 void MainWindow::gotoTabLinesRequested(QList<int> lines)
@@ -2637,22 +2704,22 @@ void MainWindow::editorShowHelp(QString name)
     }
 }
 
-void MainWindow::editorParsePHPRequested(int index, QString text)
+void MainWindow::editorParsePHPRequested(int editorId, int revision, QString text)
 {
     if (!parsePHPEnabled) return;
-    emit parseMixed(index, text);
+    emit parseMixed(editorId, revision, text);
 }
 
-void MainWindow::editorParseJSRequested(int index, QString text)
+void MainWindow::editorParseJSRequested(int editorId, int revision, QString text)
 {
     if (!parseJSEnabled) return;
-    emit parseJS(index, text);
+    emit parseJS(editorId, revision, text);
 }
 
-void MainWindow::editorParseCSSRequested(int index, QString text)
+void MainWindow::editorParseCSSRequested(int editorId, int revision, QString text)
 {
     if (!parseCSSEnabled) return;
-    emit parseCSS(index, text);
+    emit parseCSS(editorId, revision, text);
 }
 
 void MainWindow::clearMessagesTabText()
@@ -2954,27 +3021,70 @@ void MainWindow::applyThemeIcons()
     if (!gitRefreshIcon.isNull()) ui->gitTabRefreshButton->setIcon(gitRefreshIcon);
 }
 
+void MainWindow::connectParserWorker(ParserWorker * worker, QThread * thread)
+{
+    worker->moveToThread(thread);
+    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, SIGNAL(disableWorker()), worker, SLOT(disable()));
+    connect(worker, SIGNAL(lintFinished(int,QStringList,QStringList,QString)), this, SLOT(parseLintFinished(int,QStringList,QStringList,QString)));
+    connect(worker, SIGNAL(execPHPFinished(int,QString)), this, SLOT(execPHPFinished(int,QString)));
+    connect(worker, SIGNAL(execPHPWebServerFinished(bool,QString)), this, SLOT(execPHPWebServerFinished(bool,QString)));
+    connect(worker, SIGNAL(phpcsFinished(int,QStringList,QStringList)), this, SLOT(parsePHPCSFinished(int,QStringList,QStringList)));
+    connect(worker, SIGNAL(parseMixedFinished(int,int,ParsePHP::ParseResult)), this, SLOT(parseMixedFinished(int,int,ParsePHP::ParseResult)));
+    connect(worker, SIGNAL(parseJSFinished(int,int,ParseJS::ParseResult)), this, SLOT(parseJSFinished(int,int,ParseJS::ParseResult)));
+    connect(worker, SIGNAL(parseCSSFinished(int,int,ParseCSS::ParseResult)), this, SLOT(parseCSSFinished(int,int,ParseCSS::ParseResult)));
+    connect(worker, SIGNAL(parseProjectFinished(bool,bool)), this, SLOT(parseProjectFinished(bool,bool)));
+    connect(worker, SIGNAL(parseProjectProgress(int)), this, SLOT(sidebarProgressChanged(int)));
+    connect(worker, SIGNAL(updateProjectFileFinished(QVariantMap,QVariantMap)), this, SLOT(updateProjectFileFinished(QVariantMap,QVariantMap)));
+    connect(worker, SIGNAL(searchInFilesFound(QString,QString,int,int)), this, SLOT(searchInFilesFound(QString,QString,int,int)));
+    connect(worker, SIGNAL(searchInFilesResultsFound(FileSearcher::Results)), this, SLOT(searchInFilesResultsFound(FileSearcher::Results)));
+    connect(worker, SIGNAL(searchInFilesFinished()), this, SLOT(searchInFilesFinished()));
+    connect(worker, SIGNAL(message(QString)), this, SLOT(workerMessage(QString)));
+    connect(worker, SIGNAL(gitCommandFinished(QString,QString,bool)), this, SLOT(gitCommandFinished(QString,QString,bool)));
+    connect(worker, SIGNAL(serversCommandFinished(QString)), this, SLOT(serversCommandFinished(QString)));
+    connect(worker, SIGNAL(sassCommandFinished(QString,QString)), this, SLOT(sassCommandFinished(QString,QString)));
+    connect(worker, SIGNAL(quickFound(QString,QString,QString,int)), qa, SLOT(quickFound(QString,QString,QString,int)));
+    connect(worker, SIGNAL(activateProgress()), this, SLOT(activateProgressLine()));
+    connect(worker, SIGNAL(deactivateProgress()), this, SLOT(deactivateProgressLine()));
+    connect(worker, SIGNAL(activateProgressInfo(QString)), this, SLOT(activateProgressInfo(QString)));
+    connect(worker, SIGNAL(deactivateProgressInfo()), this, SLOT(deactivateProgressInfo()));
+    connect(worker, SIGNAL(updateProgressInfo(QString)), this, SLOT(updateProgressInfo(QString)));
+    connect(worker, SIGNAL(installAndroidPackFinished(QString)), this, SLOT(installAndroidPackFinished(QString)));
+}
+
 void MainWindow::activateProgressLine()
 {
+    // workers run in parallel, so the line is hidden when the last one is done
+    progressLineCount++;
     progressLine->activate();
 }
 
 void MainWindow::deactivateProgressLine()
 {
-    progressLine->deactivate();
+    if (progressLineCount > 0) progressLineCount--;
+    if (progressLineCount == 0) progressLine->deactivate();
 }
 
 void MainWindow::activateProgressInfo(QString text)
 {
+    progressInfoWorker = qobject_cast<ParserWorker *>(sender());
     progressInfo->setText(text);
     progressInfo->activate();
 }
 
 void MainWindow::deactivateProgressInfo()
 {
+    if (sender() != progressInfoWorker) return;
+    progressInfoWorker = nullptr;
     progressInfo->deactivate();
 }
 
+void MainWindow::progressInfoCancelled()
+{
+    // called directly, so that a lane blocked by a process sees it too
+    if (progressInfoWorker != nullptr) progressInfoWorker->cancelRequested();
+}
+
 void MainWindow::updateProgressInfo(QString text)
 {
     progressInfo->setText(text);
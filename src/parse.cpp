@@ -7,6 +7,7 @@
 #include "parse.h"
 #include "helper.h"
 #include <QVector>
+#include <algorithm>
 
 Parse::Parse()
 {
@@ -34,41 +35,53 @@ QString Parse::strip(QRegularExpressionMatch & match, QString & text, int group)
     QString stripped = "";
     if (match.capturedStart(group) >= 0) {
         QString r = match.captured(group);
-        r.replace(QRegularExpression("[^\n]"), " ");
+        // length is kept, so that offsets in stripped text are valid in original text
+        for (int i=0; i<r.size(); i++) {
+            if (r[i] != '\n') r[i] = ' ';
+        }
         stripped = text.mid(match.capturedStart(group), match.capturedLength(group));
         text.replace(match.capturedStart(group), match.capturedLength(group), r);
     }
     return stripped;
 }
 
-int Parse::getLine(QString & text, int offset)
+void Parse::buildLineIndex(QString & text)
+{
+    lineStarts.clear();
+    lineStarts.append(0);
+    int p = -1;
+    while ((p = text.indexOf('\n', p + 1)) >= 0) {
+        lineStarts.append(p + 1);
+    }
+}
+
+int Parse::findLine(int offset)
 {
-    QString textPart = text.mid(0, offset);
-    return textPart.count("\n") + 1;
+    if (offset < 0) return lineStarts.size();
+    return static_cast<int>(std::upper_bound(lineStarts.constBegin(), lineStarts.constEnd(), offset) - lineStarts.constBegin());
 }
 
-QString Parse::getLineText(QString & text, int offset)
+QString Parse::findLineText(QString & text, int offset)
 {
-    int preP = text.lastIndexOf("\n", offset-text.size());
-    int postP = text.indexOf("\n", offset);
-    if (postP < 0) postP = text.size();
-    return text.mid(preP + 1, postP - preP - 1);
+    int line = findLine(offset);
+    if (line <= 0) return "";
+    int start = lineStarts.at(line - 1);
+    int end = line < lineStarts.size() ? lineStarts.at(line) - 1 : text.size();
+    return text.mid(start, end - start);
 }
 
-int Parse::getFirstNotEmptyLineTo(QString & text, int offset)
+int Parse::findFirstNotEmptyLineTo(QString & text, int offset)
 {
-    QString textPart = text.mid(0, offset);
-    int offsetPart = textPart.lastIndexOf("\n");
-    int line = 0;
+    int line = findLine(offset);
+    if (line <= 0) return 0;
+    int offsetPart = lineStarts.at(line - 1) - 1;
     while(offsetPart > 0) {
         offsetPart--;
-        QChar c = textPart[offsetPart];
-        if (!c.isSpace()) {
-            line = getLine(textPart, offsetPart+1);
-            break;
+        if (!text[offsetPart].isSpace()) {
+            return findLine(offsetPart);
         }
     }
-    return line;
+    return 0;
 }
 
 int Parse::findOpenScope(QVector<int> list)
@@ -0,0 +1,497 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "parsebenchmark.h"
+#include <algorithm>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+
+const QString PARSE_BENCHMARK_ARGUMENT = "--benchmark-parse";
+
+const int PARSE_BENCHMARK_RUNS = 3;
+const int PARSE_BENCHMARK_CORPUS_LINES = 20000;
+const int PARSE_BENCHMARK_SNIPPETS = 100000;
+const int PARSE_BENCHMARK_SNIPPET_PARTS = 30;
+const unsigned int PARSE_BENCHMARK_SEED = 2019;
+const int PARSE_BENCHMARK_EDITS = 2000;
+const int PARSE_BENCHMARK_EDIT_MAX_DELETE = 40;
+
+const QString PARSE_BENCHMARK_CORPUS =
+    "<?php\n"
+    "/**\n"
+    " * Users list\n"
+    " */\n"
+    "class UserController extends BaseController\n"
+    "{\n"
+    "    const LIMIT = 20; // page size\n"
+    "    protected $query = 'SELECT * FROM `users` WHERE name <> \\'\\' ';\n"
+    "\n"
+    "    # lists users page by page\n"
+    "    public function indexAction($page = 1) {\n"
+    "        $offset = ($page - 1) * self::LIMIT;\n"
+    "        $title = \"Page {$page} of \\\"users\\\"\";\n"
+    "        $html = <<<HTML\n"
+    "<h1>$title</h1>\n"
+    "<p>// not a comment</p>\n"
+    "HTML;\n"
+    "        $raw = <<<'RAW'\n"
+    "/* not a comment either */\n"
+    "RAW;\n"
+    "        $files = `ls -la`;\n"
+    "        return $this->render('index', ['html' => $html, 'offset' => $offset]);\n"
+    "    }\n"
+    "}\n"
+    "?>\n"
+    "<div class=\"users\"><?= $title ?></div>\n";
+
+const QString PARSE_BENCHMARK_INCREMENTAL_CORPUS =
+    "<?php\n"
+    "namespace App\\Model;\n"
+    "\n"
+    "use App\\Base\\Entity;\n"
+    "use function App\\Helpers\\format;\n"
+    "\n"
+    "const VERSION = '1.0';\n"
+    "$registry = [];\n"
+    "\n"
+    "interface Storable extends \\Countable\n"
+    "{\n"
+    "    public function store(array $data): bool;\n"
+    "}\n"
+    "\n"
+    "trait Timestamps\n"
+    "{\n"
+    "    protected $createdAt;\n"
+    "    public function touch() { $this->createdAt = time(); }\n"
+    "}\n"
+    "\n"
+    "/**\n"
+    " * Product entity\n"
+    " */\n"
+    "abstract class Product extends Entity implements Storable\n"
+    "{\n"
+    "    use Timestamps;\n"
+    "    const TYPE = 'product';\n"
+    "    public static $count = 0;\n"
+    "    private $price = 0.0;\n"
+    "\n"
+    "    // returns formatted price\n"
+    "    public function getPrice($currency = 'USD', $precision = 2): string {\n"
+    "        $value = round($this->price, $precision);\n"
+    "        return format($value) . ' ' . $currency;\n"
+    "    }\n"
+    "\n"
+    "    abstract protected function validate();\n"
+    "}\n"
+    "\n"
+    "function createProduct(string $name, $price = null) {\n"
+    "    global $registry;\n"
+    "    $product = new Product();\n"
+    "    $registry[$name] = $product;\n"
+    "    return $product;\n"
+    "}\n"
+    "\n"
+    "namespace App\\Service;\n"
+    "\n"
+    "class Cart\n"
+    "{\n"
+    "    private $items = [];\n"
+    "    public function add($item, int $quantity = 1) {\n"
+    "        $this->items[] = [$item, $quantity];\n"
+    "    }\n"
+    "}\n";
+
+// edits applied to the incremental corpus, including ones that break declarations
+const QStringList PARSE_BENCHMARK_EDIT_FRAGMENTS = QStringList()
+    << "\n" << " " << ";" << "{" << "}" << "(" << ")" << "'" << "\"" << "/*" << "*/" << "// note\n" << "#"
+    << "$tmp = 1;\n" << "function helper($x) {\n    return $x;\n}\n" << "public function extra() {}\n"
+    << "private $field;\n" << "const LIMIT = 10;\n" << "class Extra {}\n" << "interface Marker {}\n"
+    << "namespace Other;\n" << "use Other\\Thing;\n" << "/** doc */\n" << "static " << "abstract " << "?>" << "<?php ";
+
+// fragments of generated snippets, chosen to hit the edge cases of both implementations
+const QStringList PARSE_BENCHMARK_FRAGMENTS = QStringList()
+    << "<?php " << "<?php\n" << "<?= " << "?>" << "\n" << " " << ";" << "$a" << "echo" << "html"
+    << "\"" << "'" << "`" << "\\" << "\\\\" << "\"\"" << "''"
+    << "//" << "#" << "/*" << "*/" << "/**/" << "*"
+    << "<<<EOT\n" << "<<<'EOT'\n" << "<<<\"EOT\"\n" << "\nEOT;\n" << "\nEOT;" << "EOT" << "<<<";
+
+bool ParseBenchmark::isRequested(int argc, char *argv[])
+{
+    for (int i=1; i<argc; i++) {
+        if (QString(argv[i]) == PARSE_BENCHMARK_ARGUMENT) return true;
+    }
+    return false;
+}
+
+int ParseBenchmark::run(QStringList args)
+{
+    QTextStream out(stdout);
+    QStringList files;
+    bool found = false;
+    for (int i=1; i<args.size(); i++) {
+        if (args.at(i) == PARSE_BENCHMARK_ARGUMENT) {
+            found = true;
+            continue;
+        }
+        if (found) files.append(args.at(i));
+    }
+    bool success = true;
+    out << "PHP parser benchmark, best of " << PARSE_BENCHMARK_RUNS << " runs" << endl;
+    if (files.size() == 0) {
+        if (!checkSnippets(out)) success = false;
+        if (!benchmark(out, "built-in php", generateCorpus())) success = false;
+        if (!checkIncremental(out, "built-in php", PARSE_BENCHMARK_INCREMENTAL_CORPUS + "?>\n" + PARSE_BENCHMARK_CORPUS)) success = false;
+    } else {
+        for (QString path : files) {
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                out << "Could not open file: " << path << endl;
+                return 1;
+            }
+            QTextStream in(&file);
+            in.setCodec("UTF-8");
+            QString text = in.readAll();
+            file.close();
+            if (!benchmark(out, path, text)) success = false;
+            if (!checkIncremental(out, path, text)) success = false;
+        }
+    }
+    return success ? 0 : 1;
+}
+
+QString ParseBenchmark::generateCorpus()
+{
+    int snippetLines = PARSE_BENCHMARK_CORPUS.count("\n");
+    QString text = "";
+    for (int lines=0; lines<PARSE_BENCHMARK_CORPUS_LINES; lines+=snippetLines) {
+        text += PARSE_BENCHMARK_CORPUS;
+    }
+    return text;
+}
+
+QString ParseBenchmark::generateSnippet(std::mt19937 & random)
+{
+    std::uniform_int_distribution<int> partsDistribution(1, PARSE_BENCHMARK_SNIPPET_PARTS);
+    std::uniform_int_distribution<int> fragmentDistribution(0, PARSE_BENCHMARK_FRAGMENTS.size() - 1);
+    QString snippet = "";
+    int parts = partsDistribution(random);
+    for (int i=0; i<parts; i++) {
+        snippet += PARSE_BENCHMARK_FRAGMENTS.at(fragmentDistribution(random));
+    }
+    return snippet;
+}
+
+bool ParseBenchmark::checkSnippets(QTextStream & out)
+{
+    // generated snippets are cleaned by both implementations, results must be equal
+    std::mt19937 random(PARSE_BENCHMARK_SEED);
+    ParsePHP parser;
+    QString error;
+    for (int i=0; i<PARSE_BENCHMARK_SNIPPETS; i++) {
+        QString snippet = generateSnippet(random);
+        if (!compare(parser, snippet, error)) {
+            QString escaped = snippet;
+            escaped.replace("\\", "\\\\").replace("\n", "\\n");
+            out << endl << "generated snippets: mismatch, " << error << endl;
+            out << "  snippet: " << escaped << endl;
+            return false;
+        }
+    }
+    out << endl << "generated snippets: " << PARSE_BENCHMARK_SNIPPETS << " checked, no differences" << endl;
+    return true;
+}
+
+bool ParseBenchmark::benchmark(QTextStream & out, QString name, QString text)
+{
+    ParsePHP parser;
+    out << endl << name << ": " << (text.count("\n") + 1) << " lines" << endl;
+    QString error;
+    bool success = compare(parser, text, error);
+    if (success) out << "  result: no differences" << endl;
+    else out << "  result: mismatch, " << error << endl;
+
+    QElapsedTimer timer;
+    qint64 cleanUpTime = -1, legacyTime = -1;
+    for (int i=0; i<PARSE_BENCHMARK_RUNS; i++) {
+        parser.buildLineIndex(text);
+        timer.start();
+        parser.cleanUp(text);
+        qint64 elapsed = timer.nsecsElapsed();
+        if (cleanUpTime < 0 || elapsed < cleanUpTime) cleanUpTime = elapsed;
+        timer.start();
+        cleanUpLegacy(parser, text);
+        elapsed = timer.nsecsElapsed();
+        if (legacyTime < 0 || elapsed < legacyTime) legacyTime = elapsed;
+    }
+    out << "  cleanUp: " << formatMsecs(cleanUpTime) << endl;
+    out << "  regexp cleanUp: " << formatMsecs(legacyTime) << endl;
+    return success;
+}
+
+bool ParseBenchmark::compare(ParsePHP & parser, QString text, QString & error)
+{
+    parser.buildLineIndex(text);
+    QString cleanText = parser.cleanUp(text);
+    std::unordered_map<int, std::string> comments = parser.comments;
+    QString legacyText = cleanUpLegacy(parser, text);
+    if (cleanText != legacyText) {
+        int pos = 0;
+        while (pos < cleanText.size() && pos < legacyText.size() && cleanText[pos] == legacyText[pos]) pos++;
+        error = "cleaned text differs at line " + QString::number(parser.findLine(pos)) + ", offset " + QString::number(pos);
+        return false;
+    }
+    if (comments != parser.comments) {
+        error = "comments differ";
+        return false;
+    }
+    return true;
+}
+
+QString ParseBenchmark::cleanUpLegacy(ParsePHP & parser, QString text)
+{
+    // regexp loop that was used before the single pass scanner
+    static const QRegularExpression phpEndExpression("[?][>]", QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression stringHeredocExpression("[<][<][<]([_a-zA-Z][_a-zA-Z0-9]*)[\n](.+?)[\n](\\1)[;]([\n]|$)", QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression stringHeredocDQExpression("[<][<][<][\"]([_a-zA-Z][_a-zA-Z0-9]*)[\"][\n](.+?)[\n](\\1)[;]([\n]|$)", QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression stringNowdocExpression("[<][<][<][']([_a-zA-Z][_a-zA-Z0-9]*)['][\n](.+?)[\n](\\1)[;]([\n]|$)", QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression commentSLExpression("[/][/]([^\n]+?)([?][>]|[\n]|$)", QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression commentSLAExpression("[#]([^\n]+?)([?][>]|[\n]|$)", QRegularExpression::DotMatchesEverythingOption);
+    parser.comments.clear();
+    parser.prepare(text);
+    bool phpOpened = false;
+    int offset = 0;
+    QRegularExpressionMatch phpEndMatch;
+    QRegularExpressionMatch stringDQMatch;
+    QRegularExpressionMatch stringSQMatch;
+    QRegularExpressionMatch stringHeredocMatch;
+    QRegularExpressionMatch stringHeredocDQMatch;
+    QRegularExpressionMatch stringNowdocMatch;
+    QRegularExpressionMatch commentMLMatch;
+    QRegularExpressionMatch commentSLMatch;
+    QRegularExpressionMatch commentSLAMatch;
+    QRegularExpressionMatch backtickMatch;
+    QList<int> matchesPos;
+    int phpEndPos = -2,
+        stringDQPos = -2,
+        stringSQPos = -2,
+        stringHeredocPos = -2,
+        stringHeredocDQPos = -2,
+        stringNowdocPos = -2,
+        commentMLPos = -2,
+        commentSLPos = -2,
+        commentSLAPos = -2,
+        backtickPos = -2;
+    do {
+        if (!phpOpened) {
+            QRegularExpressionMatch match = parser.phpStartExpression.match(text, offset);
+            if (match.capturedStart() < 0) break;
+            offset = match.capturedStart() + match.capturedLength();
+            phpOpened = true;
+        }
+        matchesPos.clear();
+        if (phpEndPos != -1 && phpEndPos < offset) {
+            phpEndMatch = phpEndExpression.match(text, offset);
+            phpEndPos = phpEndMatch.capturedStart();
+        }
+        if (phpEndPos >= 0) matchesPos.append(phpEndPos);
+        if (stringDQPos != -1 && stringDQPos < offset) {
+            stringDQMatch = parser.stringDQExpression.match(text, offset);
+            stringDQPos = stringDQMatch.capturedStart(1)-1;
+        }
+        if (stringDQPos >= 0) matchesPos.append(stringDQPos);
+        if (stringSQPos != -1 && stringSQPos < offset) {
+            stringSQMatch = parser.stringSQExpression.match(text, offset);
+            stringSQPos = stringSQMatch.capturedStart(1)-1;
+        }
+        if (stringSQPos >= 0) matchesPos.append(stringSQPos);
+        if (stringHeredocPos != -1 && stringHeredocPos < offset) {
+            stringHeredocMatch = stringHeredocExpression.match(text, offset);
+            stringHeredocPos = stringHeredocMatch.capturedStart();
+        }
+        if (stringHeredocPos >= 0) matchesPos.append(stringHeredocPos);
+        if (stringHeredocDQPos != -1 && stringHeredocDQPos < offset) {
+            stringHeredocDQMatch = stringHeredocDQExpression.match(text, offset);
+            stringHeredocDQPos = stringHeredocDQMatch.capturedStart();
+        }
+        if (stringHeredocDQPos >= 0) matchesPos.append(stringHeredocDQPos);
+        if (stringNowdocPos != -1 && stringNowdocPos < offset) {
+            stringNowdocMatch = stringNowdocExpression.match(text, offset);
+            stringNowdocPos = stringNowdocMatch.capturedStart();
+        }
+        if (stringNowdocPos >= 0) matchesPos.append(stringNowdocPos);
+        if (commentMLPos != -1 && commentMLPos < offset) {
+            commentMLMatch = parser.commentMLExpression.match(text, offset);
+            commentMLPos = commentMLMatch.capturedStart();
+        }
+        if (commentMLPos >= 0) matchesPos.append(commentMLPos);
+        if (commentSLPos != -1 && commentSLPos < offset) {
+            commentSLMatch = commentSLExpression.match(text, offset);
+            commentSLPos = commentSLMatch.capturedStart();
+        }
+        if (commentSLPos >= 0) matchesPos.append(commentSLPos);
+        if (commentSLAPos != -1 && commentSLAPos < offset) {
+            commentSLAMatch = commentSLAExpression.match(text, offset);
+            commentSLAPos = commentSLAMatch.capturedStart();
+        }
+        if (commentSLAPos >= 0) matchesPos.append(commentSLAPos);
+        if (backtickPos != -1 && backtickPos < offset) {
+            backtickMatch = parser.backtickExpression.match(text, offset);
+            backtickPos = backtickMatch.capturedStart(1)-1;
+        }
+        if (backtickPos >= 0) matchesPos.append(backtickPos);
+        if (matchesPos.size() == 0) break;
+        std::sort(matchesPos.begin(), matchesPos.end());
+        int pos = matchesPos.at(0);
+        if (phpEndPos == pos) {
+            offset = phpEndMatch.capturedStart() + phpEndMatch.capturedLength();
+            phpOpened = false;
+            continue;
+        }
+        if (stringDQPos == pos) {
+            offset = stringDQMatch.capturedStart() + stringDQMatch.capturedLength();
+            parser.strip(stringDQMatch, text, 1);
+            continue;
+        }
+        if (stringSQPos == pos) {
+            offset = stringSQMatch.capturedStart() + stringSQMatch.capturedLength();
+            parser.strip(stringSQMatch, text, 1);
+            continue;
+        }
+        if (stringHeredocPos == pos) {
+            offset = stringHeredocMatch.capturedStart() + stringHeredocMatch.capturedLength();
+            parser.strip(stringHeredocMatch, text, 2);
+            continue;
+        }
+        if (stringHeredocDQPos == pos) {
+            offset = stringHeredocDQMatch.capturedStart() + stringHeredocDQMatch.capturedLength();
+            parser.strip(stringHeredocDQMatch, text, 2);
+            continue;
+        }
+        if (stringNowdocPos == pos) {
+            offset = stringNowdocMatch.capturedStart() + stringNowdocMatch.capturedLength();
+            parser.strip(stringNowdocMatch, text, 2);
+            continue;
+        }
+        if (commentMLPos == pos) {
+            offset = commentMLMatch.capturedStart() + commentMLMatch.capturedLength();
+            QString stripped = parser.strip(commentMLMatch, text, 0); // group 0
+            parser.comments[parser.findLine(offset)] = stripped.toStdString();
+            continue;
+        }
+        if (commentSLPos == pos) {
+            offset = commentSLMatch.capturedStart(1) + commentSLMatch.capturedLength(1);
+            QString stripped = parser.strip(commentSLMatch, text, 0); // group 0
+            parser.comments[parser.findLine(offset)] = stripped.toStdString();
+            continue;
+        }
+        if (commentSLAPos == pos) {
+            offset = commentSLAMatch.capturedStart(1) + commentSLAMatch.capturedLength(1);
+            QString stripped = parser.strip(commentSLAMatch, text, 0); // group 0
+            parser.comments[parser.findLine(offset)] = stripped.toStdString();
+            continue;
+        }
+        if (backtickPos == pos) {
+            offset = backtickMatch.capturedStart() + backtickMatch.capturedLength();
+            parser.strip(backtickMatch, text, 1);
+            continue;
+        }
+    } while (matchesPos.size() > 0);
+    return text;
+}
+
+bool ParseBenchmark::checkIncremental(QTextStream & out, QString name, QString text)
+{
+    // editor parser keeps its declarations between edits, result must be equal to full parse
+    out << endl << name << ": incremental parse of " << PARSE_BENCHMARK_EDITS << " random edits" << endl;
+    std::mt19937 random(PARSE_BENCHMARK_SEED);
+    ParsePHP incrementalParser;
+    QElapsedTimer timer;
+    qint64 incrementalTime = 0, fullTime = 0;
+    for (int i=0; i<=PARSE_BENCHMARK_EDITS; i++) {
+        if (i > 0) text = generateEdit(random, text);
+        timer.start();
+        QStringList incrementalResult = describeResult(incrementalParser.parseIncremental(text));
+        incrementalTime += timer.nsecsElapsed();
+        ParsePHP parser;
+        timer.start();
+        QStringList fullResult = describeResult(parser.parse(text));
+        fullTime += timer.nsecsElapsed();
+        if (incrementalResult == fullResult) continue;
+        int y = 0;
+        while (y < incrementalResult.size() && y < fullResult.size() && incrementalResult.at(y) == fullResult.at(y)) y++;
+        out << "  result: mismatch after edit " << i << endl;
+        out << "  incremental: " << (y < incrementalResult.size() ? incrementalResult.at(y) : "(none)") << endl;
+        out << "  full: " << (y < fullResult.size() ? fullResult.at(y) : "(none)") << endl;
+        return false;
+    }
+    out << "  result: no differences" << endl;
+    out << "  parseIncremental: " << formatMsecs(incrementalTime) << endl;
+    out << "  parse: " << formatMsecs(fullTime) << endl;
+    return true;
+}
+
+QString ParseBenchmark::generateEdit(std::mt19937 & random, QString text)
+{
+    std::uniform_int_distribution<int> positionDistribution(0, text.size());
+    std::uniform_int_distribution<int> operationDistribution(0, 2);
+    std::uniform_int_distribution<int> deleteDistribution(1, PARSE_BENCHMARK_EDIT_MAX_DELETE);
+    std::uniform_int_distribution<int> fragmentDistribution(0, PARSE_BENCHMARK_EDIT_FRAGMENTS.size() - 1);
+    int pos = positionDistribution(random);
+    int operation = operationDistribution(random);
+    // insert, delete or replace
+    if (operation != 0) text.remove(pos, deleteDistribution(random));
+    if (operation != 1) text.insert(pos, PARSE_BENCHMARK_EDIT_FRAGMENTS.at(fragmentDistribution(random)));
+    return text;
+}
+
+QStringList ParseBenchmark::describeResult(const ParsePHP::ParseResult & result)
+{
+    QStringList lines;
+    for (const ParsePHP::ParseResultImport & import : result.imports) {
+        lines.append("import " + import.name + " " + import.path + " " + import.type + " line " + QString::number(import.line));
+    }
+    for (const ParsePHP::ParseResultNamespace & ns : result.namespaces) {
+        QStringList imports;
+        for (int index : ns.importsIndexes) imports.append(QString::number(index));
+        lines.append("namespace " + ns.name + " imports [" + imports.join(",") + "] line " + QString::number(ns.line));
+    }
+    for (const ParsePHP::ParseResultClass & cls : result.classes) {
+        QStringList functions, variables, constants;
+        for (int index : cls.functionIndexes) functions.append(QString::number(index));
+        for (int index : cls.variableIndexes) variables.append(QString::number(index));
+        for (int index : cls.constantIndexes) constants.append(QString::number(index));
+        lines.append("class " + cls.name + " abstract " + QString::number(cls.isAbstract) + " interface " + QString::number(cls.isInterface) + " trait " + QString::number(cls.isTrait) +
+                     " parent " + cls.parent + " implements [" + cls.interfaces.join(",") + "] functions [" + functions.join(",") + "] variables [" + variables.join(",") +
+                     "] constants [" + constants.join(",") + "] line " + QString::number(cls.line));
+    }
+    for (const ParsePHP::ParseResultFunction & func : result.functions) {
+        QStringList variables;
+        for (int index : func.variableIndexes) variables.append(QString::number(index));
+        lines.append("function " + func.clsName + "::" + func.name + "(" + func.args + ") static " + QString::number(func.isStatic) + " abstract " + QString::number(func.isAbstract) +
+                     " " + func.visibility + " args " + QString::number(func.minArgs) + "-" + QString::number(func.maxArgs) + " returns " + func.returnType +
+                     " variables [" + variables.join(",") + "] line " + QString::number(func.line) + " comment " + func.comment);
+    }
+    for (const ParsePHP::ParseResultVariable & variable : result.variables) {
+        lines.append("variable " + variable.clsName + "::" + variable.funcName + "::" + variable.name + " static " + QString::number(variable.isStatic) +
+                     " " + variable.visibility + " type " + variable.type + " line " + QString::number(variable.line));
+    }
+    for (const ParsePHP::ParseResultConstant & constant : result.constants) {
+        lines.append("constant " + constant.clsName + "::" + constant.name + " = " + constant.value + " line " + QString::number(constant.line));
+    }
+    for (const ParsePHP::ParseResultComment & comment : result.comments) {
+        lines.append("comment " + comment.name + " " + comment.text + " line " + QString::number(comment.line));
+    }
+    for (const ParsePHP::ParseResultError & error : result.errors) {
+        lines.append("error " + error.text + " line " + QString::number(error.line) + " symbol " + QString::number(error.symbol));
+    }
+    return lines;
+}
+
+QString ParseBenchmark::formatMsecs(qint64 nsecs)
+{
+    return QString::number(static_cast<double>(nsecs) / 1000000.0, 'f', 3) + " ms";
+}
@@ -83,7 +83,7 @@ QString ParseCSS::cleanUp(QString text)
         if (commentMLPos == pos) {
             offset = commentMLMatch.capturedStart() + commentMLMatch.capturedLength();
             QString stripped = strip(commentMLMatch, text, 0); // group 0
-            comments[getLine(text, offset)] = stripped.toStdString();
+            comments[findLine(offset)] = stripped.toStdString();
             continue;
         }
     } while (matchesPos.size() > 0);
@@ -232,7 +232,7 @@ void ParseCSS::parseCode(QString & code, QString & origText)
         } else if (expect == EXPECT_SELECTOR && expectName.size() > 0 && k == "{" && mediaArgPars < 0) {
             current_selector = expectName;
             int line = 0;
-            if (selectorStart >= 0) line = getLine(origText, selectorStart);
+            if (selectorStart >= 0) line = findLine(selectorStart);
             addSelector(current_selector, line);
             selectorScope = scope;
             expect = -1;
@@ -241,7 +241,7 @@ void ParseCSS::parseCode(QString & code, QString & origText)
 
         // ids & classes
         if ((prevK == "#" || prevK == ".") && k.size() > 0 && pars == 0) {
-            int line = getLine(origText, m.capturedStart(1));
+            int line = findLine(m.capturedStart(1));
             QString name = prevK + k;
             addName(name, line);
         }
@@ -260,7 +260,7 @@ void ParseCSS::parseCode(QString & code, QString & origText)
         } else if (expect == EXPECT_MEDIA && expectName.size() > 0 && k == "{" && mediaArgPars < 0) {
             current_media = expectName;
             int line = 0;
-            if (mediaStart >= 0) line = getLine(origText, mediaStart);
+            if (mediaStart >= 0) line = findLine(mediaStart);
             addMedia(current_media, line);
             mediaScope = scope;
             mediaArgPars = -1;
@@ -278,7 +278,7 @@ void ParseCSS::parseCode(QString & code, QString & origText)
         } else if (expect == EXPECT_KEYFRAMES && expectName.size() > 0 && k == "{" && mediaArgPars < 0) {
             current_keyframe = expectName;
             int line = 0;
-            if (keyframeStart >= 0) line = getLine(origText, keyframeStart);
+            if (keyframeStart >= 0) line = findLine(keyframeStart);
             addKeyframe(current_keyframe, line);
             keyframeScope = scope;
             expect = -1;
@@ -299,7 +299,7 @@ void ParseCSS::parseCode(QString & code, QString & origText)
         } else if (expect == EXPECT_FONT_FAMILY && current_font.size() == 0 && k == ";" && fontFamilyStart >= 0 &&  mediaArgPars < 0) {
             current_font = origText.mid(fontFamilyStart+1, m.capturedStart(1)-fontFamilyStart-1).trimmed().replace("\"","").replace("'","").replace(QRegularExpression("[\\s]+"), " ");
             int line = 0;
-            if (fontStart >= 0) line = getLine(origText, fontStart);
+            if (fontStart >= 0) line = findLine(fontStart);
             addFont(current_font, line);
             expect = -1;
             expectName = "";
@@ -381,34 +381,34 @@ void ParseCSS::parseCode(QString & code, QString & origText)
     if (curlyBrackets > 0) {
         int offset = findOpenScope(curlyBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Unclosed brace"), line, offset);
     } else if (curlyBrackets < 0) {
         int offset = findCloseScope(curlyBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Excess brace"), line, offset);
     }
     if (roundBrackets > 0) {
         int offset = findOpenScope(roundBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Unclosed parenthesis"), line, offset);
     } else if (roundBrackets < 0) {
         int offset = findCloseScope(roundBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Excess parenthesis"), line, offset);
     }
     if (squareBrackets > 0) {
         int offset = findOpenScope(squareBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Unclosed bracket"), line, offset);
     } else if (squareBrackets < 0) {
         int offset = findCloseScope(squareBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Excess bracket"), line, offset);
     }
 }
@@ -426,6 +426,7 @@ ParseCSS::ParseResult ParseCSS::parse(QString text)
 {
     result = ParseResult();
     reset();
+    buildLineIndex(text);
     QString cleanText = cleanUp(text);
     parseCode(cleanText, text);
     // comments
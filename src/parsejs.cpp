@@ -90,13 +90,13 @@ QString ParseJS::cleanUp(QString text)
         if (commentMLPos == pos) {
             offset = commentMLMatch.capturedStart() + commentMLMatch.capturedLength();
             QString stripped = strip(commentMLMatch, text, 0); // group 0
-            comments[getLine(text, offset)] = stripped.toStdString();
+            comments[findLine(offset)] = stripped.toStdString();
             continue;
         }
         if (commentSLPos == pos) {
             offset = commentSLMatch.capturedStart(1) + commentSLMatch.capturedLength(1);
             QString stripped = strip(commentSLMatch, text, 0); // group 0
-            comments[getLine(text, offset)] = stripped.toStdString();
+            comments[findLine(offset)] = stripped.toStdString();
             continue;
         }
         if (regexpPos == pos) {
@@ -337,7 +337,7 @@ void ParseJS::parseCode(QString & code, QString & origText)
         } else if ((expect == EXPECT_CLASS_ES6 || expect == EXPECT_CLASS_ES6_EXTENDED) && (expectName.size() > 0 || expected_class_es6_name.size() > 0) && k == "{") {
             current_class_es6 = expectName.size() > 0 ? expectName : expected_class_es6_name;
             int line = 0;
-            if (classES6Start >= 0) line = getLine(origText, classES6Start);
+            if (classES6Start >= 0) line = findLine(classES6Start);
             addClass(current_class_es6, line);
             classES6Scope = scope;
             expect = -1;
@@ -402,9 +402,9 @@ void ParseJS::parseCode(QString & code, QString & origText)
         } else if (expect == EXPECT_FUNCTION && (expectName.size() > 0 || expected_function_name.size() > 0) && k == "{" && functionArgsStart < 0) {
             current_function = expectName.size() > 0 ? expectName : expected_function_name;
             int line = 0;
-            if (functionStart >= 0) line = getLine(origText, functionStart);
+            if (functionStart >= 0) line = findLine(functionStart);
             QString current_comment = "";
-            int comment_line = getFirstNotEmptyLineTo(origText, functionStart);
+            int comment_line = findFirstNotEmptyLineTo(origText, functionStart);
             if (comment_line > 0) {
                 commentsIterator = comments.find(comment_line);
                 if (commentsIterator != comments.end()) {
@@ -522,7 +522,7 @@ void ParseJS::parseCode(QString & code, QString & origText)
         } else if (expect == EXPECT_VARIABLE && expectName.size() > 0 && current_variable.size() == 0 && prevK == "=" && k.size() > 0 && (k != "function" || current_function.size() > 0) && (k != "class" || current_function.size() > 0)) {
             current_variable = expectName;
             int line = 0;
-            if (variableStart >= 0) line = getLine(origText, variableStart);
+            if (variableStart >= 0) line = findLine(variableStart);
             QString cls = current_class_es6.size() > 0 ? current_class_es6 : current_class;
             addVariable(cls, current_function, current_variable, current_variable_type, line);
             expect = -1;
@@ -530,13 +530,13 @@ void ParseJS::parseCode(QString & code, QString & origText)
             class_variable = "";
         } else if (functionScope >= 0 && functionScope == scope - 1 && functionArgPars < 0 && current_function.size() > 0 && prevK == "function" && k.size() > 0 && k != "(" && k != ")" && k != "{") {
             QString cls = current_class_es6.size() > 0 ? current_class_es6 : current_class;
-            addVariable(cls, current_function, k, "", getLine(origText, m.capturedStart(1)));
+            addVariable(cls, current_function, k, "", findLine(m.capturedStart(1)));
         } else if (functionScope >= 0 && functionScope == scope - 1 && functionArgPars < 0 && current_function.size() > 0 && prevK == "class" && k.size() > 0 && k != "(" && k != ")" && k != "{") {
             QString cls = current_class_es6.size() > 0 ? current_class_es6 : current_class;
-            addVariable(cls, current_function, k, "", getLine(origText, m.capturedStart(1)));
+            addVariable(cls, current_function, k, "", findLine(m.capturedStart(1)));
         } else if (scope == 0 && (prevPrevPrevK.size() == 0 || prevPrevPrevK == ";" || prevPrevPrevK == "{" || prevPrevPrevK == "}") && prevPrevK.size() > 0 && prevK == "=" && k.size() > 0 && k != "function" && k != "class") {
             current_variable = prevPrevK;
-            int line = getLine(origText, m.capturedStart(1));
+            int line = findLine(m.capturedStart(1));
             addVariable("", "", current_variable, "", line);
             expect = -1;
             expectName = "";
@@ -561,7 +561,7 @@ void ParseJS::parseCode(QString & code, QString & origText)
                 class_variable = prevK;
                 current_variable = "";
                 current_variable_type = "";
-                addVariable(current_function, "", class_variable, "", getLine(origText, m.capturedStart(1)));
+                addVariable(current_function, "", class_variable, "", findLine(m.capturedStart(1)));
             }
         } else if (class_variable.size() == 0 && functionArgPars < 0 && k == "=" && prevK.size() > 0 && prevPrevK == "." && prevPrevPrevK == "this" && current_class_es6.size() > 0 && current_function.size() > 0 && current_function == "constructor" && functionArgsStart < 0 && functionScope == scope - 1) {
             variableIndexesIterator = variableIndexes.find(current_class_es6.toStdString() + "::" + "::" + prevK.toStdString());
@@ -569,7 +569,7 @@ void ParseJS::parseCode(QString & code, QString & origText)
                 class_variable = prevK;
                 current_variable = "";
                 current_variable_type = "";
-                addVariable(current_class_es6, "", class_variable, "", getLine(origText, m.capturedStart(1)));
+                addVariable(current_class_es6, "", class_variable, "", findLine(m.capturedStart(1)));
             }
         }
 
@@ -598,7 +598,7 @@ void ParseJS::parseCode(QString & code, QString & origText)
             current_constant = expectName;
             current_constant_value = origText.mid(constantValueStart, m.capturedStart(1)-constantValueStart).trimmed();
             int line = 0;
-            if (constantStart >= 0) line = getLine(origText, constantStart);
+            if (constantStart >= 0) line = findLine(constantStart);
             addConstant(current_class, current_function, current_constant, current_constant_value, line);
             expect = -1;
             expectName = "";
@@ -731,34 +731,34 @@ void ParseJS::parseCode(QString & code, QString & origText)
     if (curlyBrackets > 0) {
         int offset = findOpenScope(curlyBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Unclosed brace"), line, offset);
     } else if (curlyBrackets < 0) {
         int offset = findCloseScope(curlyBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Excess brace"), line, offset);
     }
     if (roundBrackets > 0) {
         int offset = findOpenScope(roundBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Unclosed parenthesis"), line, offset);
     } else if (roundBrackets < 0) {
         int offset = findCloseScope(roundBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Excess parenthesis"), line, offset);
     }
     if (squareBrackets > 0) {
         int offset = findOpenScope(squareBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Unclosed bracket"), line, offset);
     } else if (squareBrackets < 0) {
         int offset = findCloseScope(squareBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, offset);
+        int line = findLine(offset);
         addError(QObject::tr("Excess bracket"), line, offset);
     }
 }
@@ -776,6 +776,7 @@ ParseJS::ParseResult ParseJS::parse(QString text)
 {
     result = ParseResult();
     reset();
+    buildLineIndex(text);
     QString cleanText = cleanUp(text);
     parseCode(cleanText, text);
     // comments
@@ -8,6 +8,7 @@
 #include <QVector>
 #include <QFile>
 #include <QTextStream>
+#include <QHash>
 #include "helper.h"
 
 const int EXPECT_NAMESPACE = 0;
@@ -31,20 +32,96 @@ const QString IMPORT_TYPE_CLASS = "class";
 const QString IMPORT_TYPE_FUNCTION = "function";
 const QString IMPORT_TYPE_CONSTANT = "constant";
 
+const int CLEANUP_QUOTES_COUNT = 3;
+
+const int DECLARATION_STATEMENT = 0;
+const int DECLARATION_CLASS_HEADER = 1;
+const int DECLARATION_CLASS_MEMBER = 2;
+
+const int DEPENDENCY_VARIABLE = 0;
+const int DEPENDENCY_FUNCTION = 1;
+const int DEPENDENCY_CLASS = 2;
+const int DEPENDENCY_NAMESPACE = 3;
+const int DEPENDENCY_COMMENT = 4;
+
+const int EFFECT_NAMESPACE_IMPORT = 0;
+const int EFFECT_CLASS_FUNCTION = 1;
+const int EFFECT_CLASS_VARIABLE = 2;
+const int EFFECT_CLASS_CONSTANT = 3;
+const int EFFECT_FUNCTION_VARIABLE = 4;
+const int EFFECT_FUNCTION_RETURN_TYPE = 5;
+const int EFFECT_VARIABLE_TYPE = 6;
+
+const int KEYWORD_NONE = 0;
+const int KEYWORD_ABSTRACT = 1;
+const int KEYWORD_AS = 2;
+const int KEYWORD_CLASS = 3;
+const int KEYWORD_CONST = 4;
+const int KEYWORD_EXTENDS = 5;
+const int KEYWORD_FINAL = 6;
+const int KEYWORD_FUNCTION = 7;
+const int KEYWORD_IMPLEMENTS = 8;
+const int KEYWORD_INTERFACE = 9;
+const int KEYWORD_NAMESPACE = 10;
+const int KEYWORD_NEW = 11;
+const int KEYWORD_PRIVATE = 12;
+const int KEYWORD_PROTECTED = 13;
+const int KEYWORD_PUBLIC = 14;
+const int KEYWORD_RETURN = 15;
+const int KEYWORD_SELF = 16;
+const int KEYWORD_STATIC = 17;
+const int KEYWORD_TRAIT = 18;
+const int KEYWORD_USE = 19;
+const int KEYWORD_MIN_LENGTH = 2;
+const int KEYWORD_MAX_LENGTH = 10;
+
+struct ParseKeyword {
+    const char * name;
+    int id;
+};
+
+const ParseKeyword PARSE_KEYWORDS[] = {
+    {"abstract", KEYWORD_ABSTRACT},
+    {"as", KEYWORD_AS},
+    {"class", KEYWORD_CLASS},
+    {"const", KEYWORD_CONST},
+    {"extends", KEYWORD_EXTENDS},
+    {"final", KEYWORD_FINAL},
+    {"function", KEYWORD_FUNCTION},
+    {"implements", KEYWORD_IMPLEMENTS},
+    {"interface", KEYWORD_INTERFACE},
+    {"namespace", KEYWORD_NAMESPACE},
+    {"new", KEYWORD_NEW},
+    {"private", KEYWORD_PRIVATE},
+    {"protected", KEYWORD_PROTECTED},
+    {"public", KEYWORD_PUBLIC},
+    {"return", KEYWORD_RETURN},
+    {"self", KEYWORD_SELF},
+    {"static", KEYWORD_STATIC},
+    {"trait", KEYWORD_TRAIT},
+    {"use", KEYWORD_USE}
+};
+const int PARSE_KEYWORDS_COUNT = sizeof(PARSE_KEYWORDS) / sizeof(ParseKeyword);
+
 std::unordered_map<std::string, std::string> ParsePHP::dataTypes = {};
 
-ParsePHP::ParsePHP()
+ParsePHP::ParsePHP():
+    recordDeclaration(nullptr),
+    classDeclarationSkipped(false),
+    declarationLine(0),
+    importsBase(0),
+    namespacesBase(0),
+    classesBase(0),
+    functionsBase(0),
+    variablesBase(0),
+    constantsBase(0),
+    commentsBase(0),
+    errorsBase(0)
 {
     phpExpression = QRegularExpression("[<][?](?:php)?[\\s](.+?)([?][>]|$)", QRegularExpression::DotMatchesEverythingOption);
     phpStartExpression = QRegularExpression("[<][?](php)?[\\s]", QRegularExpression::DotMatchesEverythingOption);
-    phpEndExpression = QRegularExpression("[?][>]", QRegularExpression::DotMatchesEverythingOption);
-    stringHeredocExpression = QRegularExpression("[<][<][<]([_a-zA-Z][_a-zA-Z0-9]*)[\n](.+?)[\n](\\1)[;]([\n]|$)", QRegularExpression::DotMatchesEverythingOption);
-    stringHeredocDQExpression = QRegularExpression("[<][<][<][\"]([_a-zA-Z][_a-zA-Z0-9]*)[\"][\n](.+?)[\n](\\1)[;]([\n]|$)", QRegularExpression::DotMatchesEverythingOption);
-    stringNowdocExpression = QRegularExpression("[<][<][<][']([_a-zA-Z][_a-zA-Z0-9]*)['][\n](.+?)[\n](\\1)[;]([\n]|$)", QRegularExpression::DotMatchesEverythingOption);
-    commentSLExpression = QRegularExpression("[/][/]([^\n]+?)([?][>]|[\n]|$)", QRegularExpression::DotMatchesEverythingOption);
-    commentSLAExpression = QRegularExpression("[#]([^\n]+?)([?][>]|[\n]|$)", QRegularExpression::DotMatchesEverythingOption);
-    parseExpression = QRegularExpression("([a-zA-Z0-9_\\$\\\\]+|[\\(\\)\\{\\}\\[\\],=;:!@#%^&*\\-+/\\|<>\\?])", QRegularExpression::DotMatchesEverythingOption);
     nameExpression = QRegularExpression("^[\\$\\\\]?[a-zA-Z_][a-zA-Z0-9_\\\\]*$");
+    classHeaderExpression = QRegularExpression("^\\s*(?:(?:abstract|final)\\s+)*(?:class|interface|trait)\\s+[a-zA-Z_][a-zA-Z0-9_]*(?:\\s+(?:extends|implements)\\s+[^{;]*)?\\s*$", QRegularExpression::CaseInsensitiveOption);
 
     if (dataTypes.size() == 0) {
         QFile tf(":/highlight/php_types");
@@ -60,150 +137,211 @@ ParsePHP::ParsePHP()
     }
 }
 
+int ParsePHP::getQuoteIndex(QChar c)
+{
+    if (c == '"') return 0;
+    if (c == '\'') return 1;
+    if (c == '`') return 2;
+    return -1;
+}
+
+bool ParsePHP::isStringStart(const QString & text, int pos)
+{
+    // quote should follow a non-backslash char found by the last string search
+    int q = getQuoteIndex(text[pos]);
+    if (q < 0 || pos < 1) return false;
+    return pos - 1 >= quoteOrigins.at(q) && text[pos - 1] != '\\' && quoteLastCloses.at(q) >= pos + 2;
+}
+
+void ParsePHP::skipRegion(const QString & text, int start, int end)
+{
+    // strings starting inside a skipped region are looked up again after it
+    int foundMask = 0;
+    for (int i=start; i<end; i++) {
+        int q = getQuoteIndex(text[i]);
+        if (q < 0 || (foundMask & (1 << q))) continue;
+        if (isStringStart(text, i)) foundMask |= (1 << q);
+    }
+    for (int q=0; q<CLEANUP_QUOTES_COUNT; q++) {
+        if (foundMask & (1 << q)) quoteOrigins[q] = end;
+    }
+}
+
+int ParsePHP::findStringEnd(const QString & text, int pos)
+{
+    QChar quote = text[pos];
+    for (int i=pos+2; i<text.size(); i++) {
+        if (text[i] == quote && text[i-1] != '\\') return i;
+    }
+    return -1;
+}
+
+bool ParsePHP::matchHeredoc(const QString & text, int pos, int & contentStart, int & contentEnd, int & end)
+{
+    int size = text.size();
+    int i = pos + 3;
+    QChar quote;
+    bool quoted = false;
+    if (i < size && (text[i] == '"' || text[i] == '\'')) {
+        quote = text[i];
+        quoted = true;
+        i++;
+    }
+    if (i >= size || !isHeredocNameChar(text[i], true)) return false;
+    int nameStart = i;
+    while (i < size && isHeredocNameChar(text[i], false)) i++;
+    QStringRef name = text.midRef(nameStart, i - nameStart);
+    if (quoted) {
+        if (i >= size || text[i] != quote) return false;
+        i++;
+    }
+    if (i >= size || text[i] != '\n') return false;
+    contentStart = i + 1;
+    int k = contentStart + 1;
+    while ((k = text.indexOf('\n', k)) >= 0) {
+        int e = k + 1 + name.size();
+        if (e < size && text[e] == ';' && text.midRef(k + 1, name.size()) == name) {
+            if (e + 1 == size) {
+                contentEnd = k;
+                end = e + 1;
+                return true;
+            }
+            if (text[e + 1] == '\n') {
+                contentEnd = k;
+                end = e + 2;
+                return true;
+            }
+        }
+        k++;
+    }
+    return false;
+}
+
+bool ParsePHP::isHeredocNameChar(QChar c, bool first)
+{
+    ushort u = c.unicode();
+    if (u == '_' || (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z')) return true;
+    return !first && u >= '0' && u <= '9';
+}
+
+bool ParsePHP::matchCommentSL(const QString & text, int contentStart, int & contentEnd, int & end)
+{
+    // comment ends before new line or php closing tag, it should not be empty
+    int size = text.size();
+    if (contentStart >= size || text[contentStart] == '\n') return false;
+    for (int k=contentStart+1; k<size; k++) {
+        if (text[k] == '?' && k + 1 < size && text[k + 1] == '>') {
+            contentEnd = k;
+            end = k + 2;
+            return true;
+        }
+        if (text[k] == '\n') {
+            contentEnd = k;
+            end = k + 1;
+            return true;
+        }
+    }
+    contentEnd = size;
+    end = size;
+    return true;
+}
+
+void ParsePHP::blank(QString & text, int start, int end)
+{
+    QChar * data = text.data();
+    for (int i=start; i<end; i++) {
+        if (data[i] != '\n') data[i] = ' ';
+    }
+}
+
 QString ParsePHP::cleanUp(QString text)
 {
     comments.clear();
     prepare(text);
-    // strip strings & comments
-    bool phpOpened = false;
-    int offset = 0;
-    QRegularExpressionMatch phpEndMatch;
-    QRegularExpressionMatch stringDQMatch;
-    QRegularExpressionMatch stringSQMatch;
-    QRegularExpressionMatch stringHeredocMatch;
-    QRegularExpressionMatch stringHeredocDQMatch;
-    QRegularExpressionMatch stringNowdocMatch;
-    QRegularExpressionMatch commentMLMatch;
-    QRegularExpressionMatch commentSLMatch;
-    QRegularExpressionMatch commentSLAMatch;
-    QRegularExpressionMatch backtickMatch;
-    QList<int> matchesPos;
-    int phpEndPos = -2,
-        stringDQPos = -2,
-        stringSQPos = -2,
-        stringHeredocPos = -2,
-        stringHeredocDQPos = -2,
-        stringNowdocPos = -2,
-        commentMLPos = -2,
-        commentSLPos = -2,
-        commentSLAPos = -2,
-        backtickPos = -2;
+    // strip strings & comments in a single pass, offsets are kept
+    QString cleanText = text;
+    int size = text.size();
+    quoteOrigins.fill(-1, CLEANUP_QUOTES_COUNT);
+    quoteLastCloses.fill(-1, CLEANUP_QUOTES_COUNT);
+    for (int i=1; i<size; i++) {
+        int q = getQuoteIndex(text[i]);
+        if (q >= 0 && text[i-1] != '\\') quoteLastCloses[q] = i;
+    }
+    bool phpOpened = false, commentMLUnterminated = false;
+    int offset = 0, phpEndPos = -1, ignoreEndPos = -1;
     do {
         if (!phpOpened) {
             QRegularExpressionMatch match = phpStartExpression.match(text, offset);
             if (match.capturedStart() < 0) break;
-            offset = match.capturedStart() + match.capturedLength();
+            int phpStartEnd = match.capturedStart() + match.capturedLength();
+            if (phpEndPos >= 0) {
+                skipRegion(text, phpEndPos, phpStartEnd);
+            } else {
+                for (int q=0; q<CLEANUP_QUOTES_COUNT; q++) quoteOrigins[q] = phpStartEnd;
+            }
+            offset = phpStartEnd;
             phpOpened = true;
         }
-        matchesPos.clear();
-        if (phpEndPos != -1 && phpEndPos < offset) {
-            phpEndMatch = phpEndExpression.match(text, offset);
-            phpEndPos = phpEndMatch.capturedStart();
-        }
-        if (phpEndPos >= 0) matchesPos.append(phpEndPos);
-        if (stringDQPos != -1 && stringDQPos < offset) {
-            stringDQMatch = stringDQExpression.match(text, offset);
-            stringDQPos = stringDQMatch.capturedStart(1)-1;
-        }
-        if (stringDQPos >= 0) matchesPos.append(stringDQPos);
-        if (stringSQPos != -1 && stringSQPos < offset) {
-            stringSQMatch = stringSQExpression.match(text, offset);
-            stringSQPos = stringSQMatch.capturedStart(1)-1;
-        }
-        if (stringSQPos >= 0) matchesPos.append(stringSQPos);
-        if (stringHeredocPos != -1 && stringHeredocPos < offset) {
-            stringHeredocMatch = stringHeredocExpression.match(text, offset);
-            stringHeredocPos = stringHeredocMatch.capturedStart();
-        }
-        if (stringHeredocPos >= 0) matchesPos.append(stringHeredocPos);
-        if (stringHeredocDQPos != -1 && stringHeredocDQPos < offset) {
-            stringHeredocDQMatch = stringHeredocDQExpression.match(text, offset);
-            stringHeredocDQPos = stringHeredocDQMatch.capturedStart();
-        }
-        if (stringHeredocDQPos >= 0) matchesPos.append(stringHeredocDQPos);
-        if (stringNowdocPos != -1 && stringNowdocPos < offset) {
-            stringNowdocMatch = stringNowdocExpression.match(text, offset);
-            stringNowdocPos = stringNowdocMatch.capturedStart();
-        }
-        if (stringNowdocPos >= 0) matchesPos.append(stringNowdocPos);
-        if (commentMLPos != -1 && commentMLPos < offset) {
-            commentMLMatch = commentMLExpression.match(text, offset);
-            commentMLPos = commentMLMatch.capturedStart();
-        }
-        if (commentMLPos >= 0) matchesPos.append(commentMLPos);
-        if (commentSLPos != -1 && commentSLPos < offset) {
-            commentSLMatch = commentSLExpression.match(text, offset);
-            commentSLPos = commentSLMatch.capturedStart();
-        }
-        if (commentSLPos >= 0) matchesPos.append(commentSLPos);
-        if (commentSLAPos != -1 && commentSLAPos < offset) {
-            commentSLAMatch = commentSLAExpression.match(text, offset);
-            commentSLAPos = commentSLAMatch.capturedStart();
-        }
-        if (commentSLAPos >= 0) matchesPos.append(commentSLAPos);
-        if (backtickPos != -1 && backtickPos < offset) {
-            backtickMatch = backtickExpression.match(text, offset);
-            backtickPos = backtickMatch.capturedStart(1)-1;
-        }
-        if (backtickPos >= 0) matchesPos.append(backtickPos);
-        if (matchesPos.size() == 0) break;
-        std::sort(matchesPos.begin(), matchesPos.end());
-        int pos = matchesPos.at(0);
-        if (phpEndPos == pos) {
-            offset = phpEndMatch.capturedStart() + phpEndMatch.capturedLength();
-            phpOpened = false;
-            continue;
-        }
-        if (stringDQPos == pos) {
-            offset = stringDQMatch.capturedStart() + stringDQMatch.capturedLength();
-            strip(stringDQMatch, text, 1);
-            continue;
-        }
-        if (stringSQPos == pos) {
-            offset = stringSQMatch.capturedStart() + stringSQMatch.capturedLength();
-            strip(stringSQMatch, text, 1);
-            continue;
-        }
-        if (stringHeredocPos == pos) {
-            offset = stringHeredocMatch.capturedStart() + stringHeredocMatch.capturedLength();
-            strip(stringHeredocMatch, text, 2);
-            continue;
-        }
-        if (stringHeredocDQPos == pos) {
-            offset = stringHeredocDQMatch.capturedStart() + stringHeredocDQMatch.capturedLength();
-            strip(stringHeredocDQMatch, text, 2);
-            continue;
-        }
-        if (stringNowdocPos == pos) {
-            offset = stringNowdocMatch.capturedStart() + stringNowdocMatch.capturedLength();
-            strip(stringNowdocMatch, text, 2);
-            continue;
-        }
-        if (commentMLPos == pos) {
-            offset = commentMLMatch.capturedStart() + commentMLMatch.capturedLength();
-            QString stripped = strip(commentMLMatch, text, 0); // group 0
-            comments[getLine(text, offset)] = stripped.toStdString();
-            continue;
-        }
-        if (commentSLPos == pos) {
-            offset = commentSLMatch.capturedStart(1) + commentSLMatch.capturedLength(1);
-            QString stripped = strip(commentSLMatch, text, 0); // group 0
-            comments[getLine(text, offset)] = stripped.toStdString();
-            continue;
-        }
-        if (commentSLAPos == pos) {
-            offset = commentSLAMatch.capturedStart(1) + commentSLAMatch.capturedLength(1);
-            QString stripped = strip(commentSLAMatch, text, 0); // group 0
-            comments[getLine(text, offset)] = stripped.toStdString();
-            continue;
-        }
-        if (backtickPos == pos) {
-            offset = backtickMatch.capturedStart() + backtickMatch.capturedLength();
-            strip(backtickMatch, text, 1);
-            continue;
+        bool found = false;
+        for (int i=offset; i<size; i++) {
+            QChar c = text[i];
+            if (c == '?' && i + 1 < size && text[i + 1] == '>' && i != ignoreEndPos) {
+                phpEndPos = i;
+                offset = i + 2;
+                phpOpened = false;
+                found = true;
+                break;
+            }
+            if ((c == '"' || c == '\'' || c == '`') && isStringStart(text, i)) {
+                int stringEnd = findStringEnd(text, i);
+                blank(cleanText, i + 1, stringEnd);
+                skipRegion(text, i, stringEnd + 1);
+                offset = stringEnd + 1;
+                found = true;
+                break;
+            }
+            if (c == '<' && i + 2 < size && text[i + 1] == '<' && text[i + 2] == '<') {
+                int contentStart = -1, contentEnd = -1, end = -1;
+                if (matchHeredoc(text, i, contentStart, contentEnd, end)) {
+                    blank(cleanText, contentStart, contentEnd);
+                    skipRegion(text, i, end);
+                    offset = end;
+                    found = true;
+                    break;
+                }
+            }
+            if (c == '/' && i + 1 < size && text[i + 1] == '*' && !commentMLUnterminated) {
+                // text is scanned to the end once, later comments are not closed either
+                int end = text.indexOf("*/", i + 3);
+                if (end < 0) commentMLUnterminated = true;
+                if (end >= 0) {
+                    end += 2;
+                    blank(cleanText, i, end);
+                    comments[findLine(end)] = text.mid(i, end - i).toStdString();
+                    skipRegion(text, i, end);
+                    offset = end;
+                    found = true;
+                    break;
+                }
+            }
+            if ((c == '/' && i + 1 < size && text[i + 1] == '/') || c == '#') {
+                int contentEnd = -1, end = -1;
+                if (matchCommentSL(text, c == '#' ? i + 1 : i + 2, contentEnd, end)) {
+                    // closing tag after the comment is stripped too,
+                    // it is not recognized if the comment contains another one
+                    if (end == contentEnd + 2 && text.indexOf("?>", i) < contentEnd) ignoreEndPos = contentEnd;
+                    blank(cleanText, i, end);
+                    comments[findLine(contentEnd)] = text.mid(i, end - i).toStdString();
+                    skipRegion(text, i, contentEnd);
+                    offset = contentEnd;
+                    found = true;
+                    break;
+                }
+            }
         }
-    } while (matchesPos.size() > 0);
-    return text;
+        if (!found) break;
+    } while (true);
+    return cleanText;
 }
 
 bool ParsePHP::isValidName(QString name)
@@ -266,14 +404,12 @@ void ParsePHP::addImport(QString nsName, QString name, QString path, QString typ
     result.imports.append(imp);
     importIndexes[name.toStdString()] = result.imports.size() - 1;
     if (nsName.size() > 0) {
-        namespaceIndexesIterator = namespaceIndexes.find(nsName.toStdString());
-        if (namespaceIndexesIterator != namespaceIndexes.end()) {
-            int i = namespaceIndexesIterator->second;
-            if (result.namespaces.size() > i) {
-                ParsePHP::ParseResultNamespace ns = result.namespaces.at(i);
-                ns.importsIndexes.append(result.imports.size() - 1);
-                result.namespaces.replace(i, ns);
-            }
+        int i = findNamespaceIndex(nsName.toStdString());
+        if (i >= 0) {
+            ParsePHP::ParseResultNamespace ns = result.namespaces.at(i);
+            ns.importsIndexes.append(result.imports.size() - 1);
+            result.namespaces.replace(i, ns);
+            if (i < namespacesBase) recordEffect(EFFECT_NAMESPACE_IMPORT, nsName.toStdString(), result.imports.size() - 1 - importsBase);
         }
     }
 }
@@ -288,7 +424,7 @@ void ParsePHP::addNamespace(QString name, int line) {
 }
 
 void ParsePHP::addClass(QString name, bool isAbstract, QString extend, QStringList implements, int line) {
-    if (!isValidName(name)) return;
+    if (!isValidName(name) || classDeclarationSkipped) return;
     ParseResultClass cls;
     cls.name = name;
     cls.isAbstract = isAbstract;
@@ -302,7 +438,7 @@ void ParsePHP::addClass(QString name, bool isAbstract, QString extend, QStringLi
 }
 
 void ParsePHP::addInterface(QString name, QString extend, int line) {
-    if (!isValidName(name)) return;
+    if (!isValidName(name) || classDeclarationSkipped) return;
     ParseResultClass cls;
     cls.name = name;
     cls.isAbstract = false;
@@ -316,7 +452,7 @@ void ParsePHP::addInterface(QString name, QString extend, int line) {
 }
 
 void ParsePHP::addTrait(QString name, int line) {
-    if (!isValidName(name)) return;
+    if (!isValidName(name) || classDeclarationSkipped) return;
     ParseResultClass cls;
     cls.name = name;
     cls.isAbstract = false;
@@ -346,36 +482,31 @@ void ParsePHP::addFunction(QString clsName, QString name, QString args, bool isS
     result.functions.append(func);
     functionIndexes[clsName.toStdString() + "::" + name.toStdString()] = result.functions.size() - 1;
     if (clsName.size() > 0) {
-        classIndexesIterator = classIndexes.find(clsName.toStdString());
-        if (classIndexesIterator != classIndexes.end()) {
-            int i = classIndexesIterator->second;
-            if (result.classes.size() > i) {
-                ParsePHP::ParseResultClass cls = result.classes.at(i);
-                cls.functionIndexes.append(result.functions.size() - 1);
-                result.classes.replace(i, cls);
-            }
+        int i = findClassIndex(clsName.toStdString());
+        if (i >= 0) {
+            ParsePHP::ParseResultClass cls = result.classes.at(i);
+            cls.functionIndexes.append(result.functions.size() - 1);
+            result.classes.replace(i, cls);
+            if (i < classesBase) recordEffect(EFFECT_CLASS_FUNCTION, clsName.toStdString(), result.functions.size() - 1 - functionsBase);
         }
     }
 }
 
 void ParsePHP::updateFunctionReturnType(QString clsName, QString funcName, QString returnType)
 {
-    functionIndexesIterator = functionIndexes.find(clsName.toStdString() + "::" + funcName.toStdString());
-    if (functionIndexesIterator != functionIndexes.end()) {
-        int i = functionIndexesIterator->second;
-        if (result.functions.size() > i) {
-            ParseResultFunction func = result.functions.at(i);
-            func.returnType = returnType;
-            result.functions.replace(i, func);
-        }
+    int i = findFunctionIndex(clsName.toStdString() + "::" + funcName.toStdString());
+    if (i >= 0) {
+        ParseResultFunction func = result.functions.at(i);
+        func.returnType = returnType;
+        result.functions.replace(i, func);
+        if (i < functionsBase) recordEffect(EFFECT_FUNCTION_RETURN_TYPE, clsName.toStdString() + "::" + funcName.toStdString(), 0, returnType);
     }
 }
 
 void ParsePHP::addVariable(QString clsName, QString funcName, QString name, bool isStatic, QString visibility, QString type, int line)
 {
     if (!isValidName(name)) return;
-    variableIndexesIterator = variableIndexes.find(clsName.toStdString() + "::" + funcName.toStdString() + "::" + name.toStdString());
-    if (variableIndexesIterator != variableIndexes.end()) return;
+    if (findVariableIndex(clsName.toStdString() + "::" + funcName.toStdString() + "::" + name.toStdString()) >= 0) return;
     ParseResultVariable variable;
     variable.name = name;
     variable.clsName = clsName;
@@ -387,38 +518,32 @@ void ParsePHP::addVariable(QString clsName, QString funcName, QString name, bool
     result.variables.append(variable);
     variableIndexes[clsName.toStdString() + "::" + funcName.toStdString() + "::" + name.toStdString()] = result.variables.size() - 1;
     if (clsName.size() > 0 && funcName.size() == 0) {
-        classIndexesIterator = classIndexes.find(clsName.toStdString());
-        if (classIndexesIterator != classIndexes.end()) {
-            int i = classIndexesIterator->second;
-            if (result.classes.size() > i) {
-                ParsePHP::ParseResultClass cls = result.classes.at(i);
-                cls.variableIndexes.append(result.variables.size() - 1);
-                result.classes.replace(i, cls);
-            }
+        int i = findClassIndex(clsName.toStdString());
+        if (i >= 0) {
+            ParsePHP::ParseResultClass cls = result.classes.at(i);
+            cls.variableIndexes.append(result.variables.size() - 1);
+            result.classes.replace(i, cls);
+            if (i < classesBase) recordEffect(EFFECT_CLASS_VARIABLE, clsName.toStdString(), result.variables.size() - 1 - variablesBase);
         }
     } else if (funcName.size() > 0) {
-        functionIndexesIterator = functionIndexes.find(clsName.toStdString() + "::" + funcName.toStdString());
-        if (functionIndexesIterator != functionIndexes.end()) {
-            int i = functionIndexesIterator->second;
-            if (result.functions.size() > i) {
-                ParsePHP::ParseResultFunction func = result.functions.at(i);
-                func.variableIndexes.append(result.variables.size() - 1);
-                result.functions.replace(i, func);
-            }
+        int i = findFunctionIndex(clsName.toStdString() + "::" + funcName.toStdString());
+        if (i >= 0) {
+            ParsePHP::ParseResultFunction func = result.functions.at(i);
+            func.variableIndexes.append(result.variables.size() - 1);
+            result.functions.replace(i, func);
+            if (i < functionsBase) recordEffect(EFFECT_FUNCTION_VARIABLE, clsName.toStdString() + "::" + funcName.toStdString(), result.variables.size() - 1 - variablesBase);
         }
     }
 }
 
 void ParsePHP::updateVariableType(QString clsName, QString funcName, QString varName, QString type)
 {
-    variableIndexesIterator = variableIndexes.find(clsName.toStdString() + "::" + funcName.toStdString() + "::" + varName.toStdString());
-    if (variableIndexesIterator != variableIndexes.end()) {
-        int i = variableIndexesIterator->second;
-        if (result.variables.size() > i) {
-            ParseResultVariable variable = result.variables.at(i);
-            variable.type = type;
-            result.variables.replace(i, variable);
-        }
+    int i = findVariableIndex(clsName.toStdString() + "::" + funcName.toStdString() + "::" + varName.toStdString());
+    if (i >= 0) {
+        ParseResultVariable variable = result.variables.at(i);
+        variable.type = type;
+        result.variables.replace(i, variable);
+        if (i < variablesBase) recordEffect(EFFECT_VARIABLE_TYPE, clsName.toStdString() + "::" + funcName.toStdString() + "::" + varName.toStdString(), 0, type);
     }
 }
 
@@ -433,14 +558,12 @@ void ParsePHP::addConstant(QString clsName, QString name, QString value, int lin
     result.constants.append(constant);
     constantIndexes[clsName.toStdString() + "::" + name.toStdString()] = result.constants.size() - 1;
     if (clsName.size() > 0) {
-        classIndexesIterator = classIndexes.find(clsName.toStdString());
-        if (classIndexesIterator != classIndexes.end()) {
-            int i = classIndexesIterator->second;
-            if (result.classes.size() > i) {
-                ParsePHP::ParseResultClass cls = result.classes.at(i);
-                cls.constantIndexes.append(result.constants.size() - 1);
-                result.classes.replace(i, cls);
-            }
+        int i = findClassIndex(clsName.toStdString());
+        if (i >= 0) {
+            ParsePHP::ParseResultClass cls = result.classes.at(i);
+            cls.constantIndexes.append(result.constants.size() - 1);
+            result.classes.replace(i, cls);
+            if (i < classesBase) recordEffect(EFFECT_CLASS_CONSTANT, clsName.toStdString(), result.constants.size() - 1 - constantsBase);
         }
     }
 }
@@ -478,10 +601,64 @@ void ParsePHP::addError(QString text, int line, int symbol) {
     result.errors.append(error);
 }
 
-void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
+bool ParsePHP::isTokenWordChar(QChar c)
+{
+    ushort u = c.unicode();
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '_' || u == '$' || u == '\\';
+}
+
+bool ParsePHP::isTokenPunctuation(QChar c)
+{
+    switch (c.unicode()) {
+        case '(': case ')': case '{': case '}': case '[': case ']':
+        case ',': case '=': case ';': case ':': case '!': case '@':
+        case '#': case '%': case '^': case '&': case '*': case '-':
+        case '+': case '/': case '|': case '<': case '>': case '?':
+            return true;
+        default:
+            return false;
+    }
+}
+
+int ParsePHP::getKeyword(const QStringRef & text)
+{
+    int size = text.size();
+    if (size < KEYWORD_MIN_LENGTH || size > KEYWORD_MAX_LENGTH) return KEYWORD_NONE;
+    for (int i=0; i<PARSE_KEYWORDS_COUNT; i++) {
+        QLatin1String keyword(PARSE_KEYWORDS[i].name);
+        if (keyword.size() != size) continue;
+        if (text.compare(keyword, Qt::CaseInsensitive) == 0) return PARSE_KEYWORDS[i].id;
+    }
+    return KEYWORD_NONE;
+}
+
+bool ParsePHP::nextToken(const QString & code, int & offset, Token & token)
+{
+    // tokens are views of the code, keywords are classified once
+    int size = code.size();
+    while (offset < size) {
+        QChar c = code[offset];
+        if (isTokenWordChar(c)) {
+            int start = offset;
+            while (offset < size && isTokenWordChar(code[offset])) offset++;
+            token.text = code.midRef(start, offset - start);
+            token.keyword = getKeyword(token.text);
+            return true;
+        }
+        offset++;
+        if (isTokenPunctuation(c)) {
+            token.text = code.midRef(offset - 1, 1);
+            token.keyword = KEYWORD_NONE;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ParsePHP::parseCode(QString & code, QString & origText, int textOffset, QString namespaceName)
 {
     // parse data
-    QString current_namespace = "";
+    QString current_namespace = namespaceName;
     QString current_class = "";
     bool current_class_is_abstract = false;
     QString current_class_parent = "";
@@ -521,34 +698,31 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
     bool functionParsFound = false, classParsFound = false;
     int expect = -1;
     QString expectName = "";
-    QString prevK = "", prevPrevK = "", prevPrevPrevK = "", prevPrevPrevPrevK = "", prevPrevPrevPrevPrevK = "", prevPrevPrevPrevPrevPrevK = "", prevPrevPrevPrevPrevPrevPrevK = "", prevPrevPrevPrevPrevPrevPrevPrevK = "";
+    Token prevK, prevPrevK, prevPrevPrevK, prevPrevPrevPrevK, prevPrevPrevPrevPrevK, prevPrevPrevPrevPrevPrevK, prevPrevPrevPrevPrevPrevPrevK, prevPrevPrevPrevPrevPrevPrevPrevK;
     int useStart = -1, namespaceStart = -1, classStart = -1, interfaceStart = -1, traitStart = -1, functionStart = -1, variableStart = -1, constantStart = -1;
     QString class_static_variable = "", class_variable = "";
     QStringList functionChainList, classChainList, traitChainList;
 
-    QRegularExpressionMatchIterator mi = parseExpression.globalMatch(code);
-    while(mi.hasNext()){
-        QRegularExpressionMatch m = mi.next();
-        if (m.capturedStart(1) < 0) continue;
-        QString k = m.captured(1).trimmed();
-        if (k.size() == 0) continue;
+    Token k;
+    int tokenOffset = 0;
+    while(nextToken(code, tokenOffset, k)) {
 
         // uses
-        if (expect < 0 && (((namespaceScope < 0 && scope == 0) || scope == namespaceScope+1) && (prevK == ";" || prevK == "{" || prevK == "}" || prevK.size() == 0)) && k.toLower() == "use" && current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0 && current_function.size() == 0 && anonymFunctionScope < 0) {
+        if (expect < 0 && (((namespaceScope < 0 && scope == 0) || scope == namespaceScope+1) && (prevK.is(";") || prevK.is("{") || prevK.is("}") || prevK.text.size() == 0)) && k.keyword == KEYWORD_USE && current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0 && current_function.size() == 0 && anonymFunctionScope < 0) {
             expect = EXPECT_USE;
             expectName = "";
-            useStart = m.capturedStart(1);
-        } else if (expect == EXPECT_USE && expectName.size() == 0 && k.toLower() == "function") {
+            useStart = k.text.position();
+        } else if (expect == EXPECT_USE && expectName.size() == 0 && k.keyword == KEYWORD_FUNCTION) {
             expect = EXPECT_USE_FUNCTION;
-        } else if (expect == EXPECT_USE && expectName.size() == 0 && k.toLower() == "const") {
+        } else if (expect == EXPECT_USE && expectName.size() == 0 && k.keyword == KEYWORD_CONST) {
             expect = EXPECT_USE_CONSTANT;
         } else if ((expect == EXPECT_USE || expect == EXPECT_USE_FUNCTION || expect == EXPECT_USE_CONSTANT) && expectName.size() == 0) {
-            expectName = k;
-        } else if ((expect == EXPECT_USE || expect == EXPECT_USE_FUNCTION || expect == EXPECT_USE_CONSTANT) && expectName.size() > 0 && k.toLower() == "as") {
+            expectName = k.text.toString();
+        } else if ((expect == EXPECT_USE || expect == EXPECT_USE_FUNCTION || expect == EXPECT_USE_CONSTANT) && expectName.size() > 0 && k.keyword == KEYWORD_AS) {
             expectName += " as ";
-        } else if ((expect == EXPECT_USE || expect == EXPECT_USE_FUNCTION || expect == EXPECT_USE_CONSTANT) && expectName.size() > 0 && k != ";") {
-            expectName += k;
-        } else if ((expect == EXPECT_USE || expect == EXPECT_USE_FUNCTION || expect == EXPECT_USE_CONSTANT) && expectName.size() > 0 && k == ";") {
+        } else if ((expect == EXPECT_USE || expect == EXPECT_USE_FUNCTION || expect == EXPECT_USE_CONSTANT) && expectName.size() > 0 && !k.is(";")) {
+            expectName += k.text;
+        } else if ((expect == EXPECT_USE || expect == EXPECT_USE_FUNCTION || expect == EXPECT_USE_CONSTANT) && expectName.size() > 0 && k.is(";")) {
             QString useType = IMPORT_TYPE_CLASS;
             if (expect == EXPECT_USE_FUNCTION) useType = IMPORT_TYPE_FUNCTION;
             else if (expect == EXPECT_USE_CONSTANT) useType = IMPORT_TYPE_CONSTANT;
@@ -591,8 +765,8 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                         constantAliases[useName.toStdString()] = usePath.toStdString();
                     }
                     int line = 0;
-                    //if (useStart >= 0) line = getLine(origText, textOffset + useStart);
-                    if (useStart >= 0) line = getLine(origText, textOffset + m.capturedStart(1)); // line at end
+                    //if (useStart >= 0) line = findLine(textOffset + useStart);
+                    if (useStart >= 0) line = findLine(textOffset + k.text.position()); // line at end
                     addImport(current_namespace, useName, usePath, useType, line);
                 }
             }
@@ -601,13 +775,13 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         }
 
         // namespaces
-        if (expect < 0 && k.toLower() == "namespace") {
+        if (expect < 0 && k.keyword == KEYWORD_NAMESPACE) {
             expect = EXPECT_NAMESPACE;
             expectName = "";
-            namespaceStart = m.capturedStart(1);
+            namespaceStart = k.text.position();
         } else if (expect == EXPECT_NAMESPACE && expectName.size() == 0) {
-            expectName = k;
-        } else if (expect == EXPECT_NAMESPACE && expectName.size() > 0 && (k == ";" || k == "{")) {
+            expectName = k.text.toString();
+        } else if (expect == EXPECT_NAMESPACE && expectName.size() > 0 && (k.is(";") || k.is("{"))) {
             QString parent = "";
             if (namespaceScope >= 0 && current_namespace.size() > 0) {
                 parent_namespaces.append(current_namespace);
@@ -618,13 +792,13 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
             current_namespace = parent + expectName;
             if (current_namespace[0] == "\\") current_namespace = current_namespace.mid(1);
             int line = 0;
-            //if (namespaceStart >= 0) line = getLine(origText, textOffset + namespaceStart);
-            if (namespaceStart >= 0) line = getLine(origText, textOffset + m.capturedStart(1)); // line at end
+            //if (namespaceStart >= 0) line = findLine(textOffset + namespaceStart);
+            if (namespaceStart >= 0) line = findLine(textOffset + k.text.position()); // line at end
             addNamespace(current_namespace, line);
             expect = -1;
             expectName = "";
-            if (k == "{") namespaceScope = scope;
-            if (k == ";") {
+            if (k.is("{")) namespaceScope = scope;
+            if (k.is(";")) {
                 parent_namespaces.clear();
                 parent_namespace_scopes.clear();
             }
@@ -635,39 +809,39 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         }
 
         // classes
-        if ((((prevPrevPrevK.size() == 0 || prevPrevPrevK == ";" || prevPrevPrevK == "{" || prevPrevPrevK == "}" || prevPrevPrevK == ">" || prevPrevPrevK == ":") && prevPrevK.size() > 0 && prevK == "=") || prevK.toLower() == "return") && k == "new" && anonymClassScope < 0) {
-            expected_class_name = prevPrevK;
+        if ((((prevPrevPrevK.text.size() == 0 || prevPrevPrevK.is(";") || prevPrevPrevK.is("{") || prevPrevPrevK.is("}") || prevPrevPrevK.is(">") || prevPrevPrevK.is(":")) && prevPrevK.text.size() > 0 && prevK.is("=")) || prevK.keyword == KEYWORD_RETURN) && k.is("new") && anonymClassScope < 0) {
+            expected_class_name = prevPrevK.text.toString();
         }
-        if (expect < 0 && k.toLower() == "class" && (prevK == ";" || prevK == "{" || prevK == "}" || prevK == "=" || prevK.size() == 0 || prevK.toLower() == "new" || prevK.toLower() == "abstract" || prevK.toLower() == "final") && anonymClassScope < 0) {
+        if (expect < 0 && k.keyword == KEYWORD_CLASS && (prevK.is(";") || prevK.is("{") || prevK.is("}") || prevK.is("=") || prevK.text.size() == 0 || prevK.keyword == KEYWORD_NEW || prevK.keyword == KEYWORD_ABSTRACT || prevK.keyword == KEYWORD_FINAL) && anonymClassScope < 0) {
             expect = EXPECT_CLASS;
             expectName = "";
-            current_class_is_abstract = (prevK.toLower() == "abstract");
+            current_class_is_abstract = (prevK.keyword == KEYWORD_ABSTRACT);
             current_class_parent = "";
             current_class_interfaces.clear();
-            classStart =  m.capturedStart(1);
+            classStart =  k.text.position();
             classParsFound = false;
-        } else if (expect == EXPECT_CLASS && expectName.size() == 0 && k != "{" && !classParsFound) {
-            if (k != "(" && k != ")" && k != "{" && k != "extends" && k != "implements" && k.indexOf("$") < 0 && (current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0)) {
-                expectName = k;
+        } else if (expect == EXPECT_CLASS && expectName.size() == 0 && !k.is("{") && !classParsFound) {
+            if (!k.is("(") && !k.is(")") && !k.is("{") && !k.is("extends") && !k.is("implements") && k.text.indexOf('$') < 0 && (current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0)) {
+                expectName = k.text.toString();
             } else {
                 classParsFound = true;
             }
-        } else if (expect == EXPECT_CLASS && expectName.size() > 0 && k.toLower() == "extends") {
+        } else if (expect == EXPECT_CLASS && expectName.size() > 0 && k.keyword == KEYWORD_EXTENDS) {
             expect = EXPECT_CLASS_EXTENDED;
-        } else if (expect == EXPECT_CLASS_EXTENDED && expectName.size() > 0 && current_class_parent.size() == 0 && k != "{") {
-            current_class_parent = toAbs(current_namespace, k);
-        } else if ((expect == EXPECT_CLASS || expect == EXPECT_CLASS_EXTENDED) && expectName.size() > 0 && k.toLower() == "implements") {
+        } else if (expect == EXPECT_CLASS_EXTENDED && expectName.size() > 0 && current_class_parent.size() == 0 && !k.is("{")) {
+            current_class_parent = toAbs(current_namespace, k.text.toString());
+        } else if ((expect == EXPECT_CLASS || expect == EXPECT_CLASS_EXTENDED) && expectName.size() > 0 && k.keyword == KEYWORD_IMPLEMENTS) {
             if (expect == EXPECT_CLASS) expect = EXPECT_CLASS_IMPLEMENTED;
             if (expect == EXPECT_CLASS_EXTENDED) expect = EXPECT_CLASS_EXTENDED_IMPLEMENTED;
-        } else if ((expect == EXPECT_CLASS_IMPLEMENTED || expect == EXPECT_CLASS_EXTENDED_IMPLEMENTED) && expectName.size() > 0 && k != "{" && k != ",") {
-            current_class_interfaces.append(toAbs(current_namespace, k));
-        } else if ((expect == EXPECT_CLASS || expect == EXPECT_CLASS_EXTENDED || expect == EXPECT_CLASS_IMPLEMENTED || expect == EXPECT_CLASS_EXTENDED_IMPLEMENTED) && (expectName.size() > 0 || expected_class_name.size() > 0) && k == "{") {
+        } else if ((expect == EXPECT_CLASS_IMPLEMENTED || expect == EXPECT_CLASS_EXTENDED_IMPLEMENTED) && expectName.size() > 0 && !k.is("{") && !k.is(",")) {
+            current_class_interfaces.append(toAbs(current_namespace, k.text.toString()));
+        } else if ((expect == EXPECT_CLASS || expect == EXPECT_CLASS_EXTENDED || expect == EXPECT_CLASS_IMPLEMENTED || expect == EXPECT_CLASS_EXTENDED_IMPLEMENTED) && (expectName.size() > 0 || expected_class_name.size() > 0) && k.is("{")) {
             if (expectName.size() > 0 && (current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0)) {
                 QString ns = "\\";
                 if (current_namespace.size() > 0) ns += current_namespace + "\\";
                 current_class = ns + expectName;
                 int line = 0;
-                if (classStart >= 0) line = getLine(origText, textOffset + classStart);
+                if (classStart >= 0) line = findLine(textOffset + classStart);
                 addClass(current_class, current_class_is_abstract, current_class_parent, current_class_interfaces, line);
                 classScope = scope;
             } else {
@@ -689,23 +863,23 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         }
 
         // interfaces
-        if (expect < 0 && k.toLower() == "interface" && (current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0)) {
+        if (expect < 0 && k.keyword == KEYWORD_INTERFACE && (current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0)) {
             expect = EXPECT_INTERFACE;
             expectName = "";
             current_interface_parent = "";
-            interfaceStart = m.capturedStart(1);
+            interfaceStart = k.text.position();
         } else if (expect == EXPECT_INTERFACE && expectName.size() == 0) {
-            expectName = k;
-        } else if (expect == EXPECT_INTERFACE && expectName.size() > 0 && k.toLower() == "extends") {
+            expectName = k.text.toString();
+        } else if (expect == EXPECT_INTERFACE && expectName.size() > 0 && k.keyword == KEYWORD_EXTENDS) {
             expect = EXPECT_INTERFACE_EXTENDED;
-        } else if (expect == EXPECT_INTERFACE_EXTENDED && expectName.size() > 0 && current_interface_parent.size() == 0 && k != "{") {
-            current_interface_parent = toAbs(current_namespace, k);
-        } else if ((expect == EXPECT_INTERFACE || expect == EXPECT_INTERFACE_EXTENDED) && expectName.size() > 0 && k == "{") {
+        } else if (expect == EXPECT_INTERFACE_EXTENDED && expectName.size() > 0 && current_interface_parent.size() == 0 && !k.is("{")) {
+            current_interface_parent = toAbs(current_namespace, k.text.toString());
+        } else if ((expect == EXPECT_INTERFACE || expect == EXPECT_INTERFACE_EXTENDED) && expectName.size() > 0 && k.is("{")) {
             QString ns = "\\";
             if (current_namespace.size() > 0) ns += current_namespace + "\\";
             current_interface = ns + expectName;
             int line = 0;
-            if (interfaceStart >= 0) line = getLine(origText, textOffset + interfaceStart);
+            if (interfaceStart >= 0) line = findLine(textOffset + interfaceStart);
             addInterface(current_interface, current_interface_parent, line);
             expect = -1;
             expectName = "";
@@ -715,18 +889,18 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         }
 
         // traits
-        if (expect < 0 && k.toLower() == "trait" && (current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0) && anonymClassScope < 0) {
+        if (expect < 0 && k.keyword == KEYWORD_TRAIT && (current_class.size() == 0 && current_interface.size() == 0 && current_trait.size() == 0) && anonymClassScope < 0) {
             expect = EXPECT_TRAIT;
             expectName = "";
-            traitStart = m.capturedStart(1);
+            traitStart = k.text.position();
         } else if (expect == EXPECT_TRAIT && expectName.size() == 0) {
-            expectName = k;
-        } else if (expect == EXPECT_TRAIT && expectName.size() > 0 && k == "{") {
+            expectName = k.text.toString();
+        } else if (expect == EXPECT_TRAIT && expectName.size() > 0 && k.is("{")) {
             QString ns = "\\";
             if (current_namespace.size() > 0) ns += current_namespace + "\\";
             current_trait = ns + expectName;
             int line = 0;
-            if (traitStart >= 0) line = getLine(origText, textOffset + traitStart);
+            if (traitStart >= 0) line = findLine(textOffset + traitStart);
             addTrait(current_trait, line);
             expect = -1;
             expectName = "";
@@ -736,20 +910,20 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         }
 
         // functions
-        if ((prevPrevK.size() == 0 || prevPrevK == ";" || prevPrevK == "{" || prevPrevK == "}" || prevPrevK == ">" || prevPrevK == ":") && prevK.size() > 0 && k == "=" && functionArgsStart < 0 && anonymFunctionScope < 0) {
-            expected_function_name = prevK;
+        if ((prevPrevK.text.size() == 0 || prevPrevK.is(";") || prevPrevK.is("{") || prevPrevK.is("}") || prevPrevK.is(">") || prevPrevK.is(":")) && prevK.text.size() > 0 && k.is("=") && functionArgsStart < 0 && anonymFunctionScope < 0) {
+            expected_function_name = prevK.text.toString();
         }
-        if (expect < 0 && k.toLower() == "function" && (prevK == ";" || prevK == "{" || prevK == "}" || prevK == "=" || prevK.size() == 0 || prevK.toLower() == "public" || prevK.toLower() == "protected" || prevK.toLower() == "private" || prevK.toLower() == "static" || prevK.toLower() == "abstract") && functionArgsStart < 0 && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        if (expect < 0 && k.keyword == KEYWORD_FUNCTION && (prevK.is(";") || prevK.is("{") || prevK.is("}") || prevK.is("=") || prevK.text.size() == 0 || prevK.keyword == KEYWORD_PUBLIC || prevK.keyword == KEYWORD_PROTECTED || prevK.keyword == KEYWORD_PRIVATE || prevK.keyword == KEYWORD_STATIC || prevK.keyword == KEYWORD_ABSTRACT) && functionArgsStart < 0 && anonymFunctionScope < 0 && anonymClassScope < 0) {
             expect = EXPECT_FUNCTION;
             current_function_args = "";
             expected_function_args.clear();
             expected_function_arg_types.clear();
-            current_function_is_static = (prevK.toLower() == "static" || (prevK.size() > 1 && prevPrevK.toLower() == "static") || (prevK.size() > 1 && prevPrevK.size() > 1 && prevPrevPrevK.toLower() == "static"));
-            current_function_is_abstract = (prevK.toLower() == "abstract" || (prevK.size() > 1 && prevPrevK.toLower() == "abstract") || (prevK.size() > 1 && prevPrevK.size() > 1 && prevPrevPrevK.toLower() == "abstract"));
+            current_function_is_static = (prevK.keyword == KEYWORD_STATIC || (prevK.text.size() > 1 && prevPrevK.keyword == KEYWORD_STATIC) || (prevK.text.size() > 1 && prevPrevK.text.size() > 1 && prevPrevPrevK.keyword == KEYWORD_STATIC));
+            current_function_is_abstract = (prevK.keyword == KEYWORD_ABSTRACT || (prevK.text.size() > 1 && prevPrevK.keyword == KEYWORD_ABSTRACT) || (prevK.text.size() > 1 && prevPrevK.text.size() > 1 && prevPrevPrevK.keyword == KEYWORD_ABSTRACT));
             current_function_visibility = "";
-            if (prevK.toLower() == "public" || prevK.toLower() == "protected" || prevK.toLower() == "private") current_function_visibility = prevK.toLower();
-            if (prevK.size() > 1 && (prevPrevK.toLower() == "public" || prevPrevK.toLower() == "protected" || prevPrevK.toLower() == "private")) current_function_visibility = prevPrevK.toLower();
-            if (prevK.size() > 1 && prevPrevK.size() > 1 && (prevPrevPrevK.toLower() == "public" || prevPrevPrevK.toLower() == "protected" || prevPrevPrevK.toLower() == "private")) current_function_visibility = prevPrevPrevK.toLower();
+            if (prevK.keyword == KEYWORD_PUBLIC || prevK.keyword == KEYWORD_PROTECTED || prevK.keyword == KEYWORD_PRIVATE) current_function_visibility = prevK.text.toString().toLower();
+            if (prevK.text.size() > 1 && (prevPrevK.keyword == KEYWORD_PUBLIC || prevPrevK.keyword == KEYWORD_PROTECTED || prevPrevK.keyword == KEYWORD_PRIVATE)) current_function_visibility = prevPrevK.text.toString().toLower();
+            if (prevK.text.size() > 1 && prevPrevK.text.size() > 1 && (prevPrevPrevK.keyword == KEYWORD_PUBLIC || prevPrevPrevK.keyword == KEYWORD_PROTECTED || prevPrevPrevK.keyword == KEYWORD_PRIVATE)) current_function_visibility = prevPrevPrevK.text.toString().toLower();
             current_function_min_args = 0;
             current_function_max_args = 0;
             current_function_return_type = "";
@@ -757,19 +931,19 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
             functionArgPars = -1;
             functionArgsStart = -1;
             functionParsFound = false;
-            functionStart = m.capturedStart(1);
-        } else if (expect == EXPECT_FUNCTION && expectName.size() == 0 && k != "&" && k != "(" && k != ")" && k != "{" && k != "use" && functionArgsStart < 0 && current_function_args.size() == 0 && !functionParsFound) {
-            expectName = k;
-        } else if (expect == EXPECT_FUNCTION && functionArgPars < 0 && k == "(" && !functionParsFound) {
+            functionStart = k.text.position();
+        } else if (expect == EXPECT_FUNCTION && expectName.size() == 0 && !k.is("&") && !k.is("(") && !k.is(")") && !k.is("{") && !k.is("use") && functionArgsStart < 0 && current_function_args.size() == 0 && !functionParsFound) {
+            expectName = k.text.toString();
+        } else if (expect == EXPECT_FUNCTION && functionArgPars < 0 && k.is("(") && !functionParsFound) {
             functionArgPars = pars;
-            functionArgsStart = m.capturedStart(1);
+            functionArgsStart = k.text.position();
             functionParsFound = true;
-        } else if (expect == EXPECT_FUNCTION && expectName.size() > 0 && functionArgPars < 0 && k == ":") {
+        } else if (expect == EXPECT_FUNCTION && expectName.size() > 0 && functionArgPars < 0 && k.is(":")) {
             expect = EXPECT_FUNCTION_RETURN_TYPE;
-        } else if (expect == EXPECT_FUNCTION_RETURN_TYPE && expectName.size() > 0 && (current_function_return_type.size() == 0 || current_function_return_type == "?") && k != "{" && k != ";") {
-            if (current_function_return_type == "?") current_function_return_type += k;
-            else current_function_return_type = k;
-        } else if ((expect == EXPECT_FUNCTION || expect == EXPECT_FUNCTION_RETURN_TYPE) && (expectName.size() > 0 || expected_function_name.size() > 0) && (k == "{" || (current_interface.size() > 0 && k == ";") || (current_function_is_abstract && k == ";")) && functionArgsStart < 0) {
+        } else if (expect == EXPECT_FUNCTION_RETURN_TYPE && expectName.size() > 0 && (current_function_return_type.size() == 0 || current_function_return_type == "?") && !k.is("{") && !k.is(";")) {
+            if (current_function_return_type == "?") current_function_return_type += k.text;
+            else current_function_return_type = k.text.toString();
+        } else if ((expect == EXPECT_FUNCTION || expect == EXPECT_FUNCTION_RETURN_TYPE) && (expectName.size() > 0 || expected_function_name.size() > 0) && (k.is("{") || (current_interface.size() > 0 && k.is(";")) || (current_function_is_abstract && k.is(";"))) && functionArgsStart < 0) {
             if (expectName.size() > 0) {
                 current_function = expectName;
                 QString current_function_return_type_clean = current_function_return_type;
@@ -790,15 +964,8 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 else if (current_trait.size() > 0) clsName = current_trait;
                 if (current_function_visibility.size() == 0 && clsName.size() > 0) current_function_visibility = "public";
                 int line = 0;
-                if (functionStart >= 0) line = getLine(origText, textOffset + functionStart);
-                QString current_comment = "";
-                int comment_line = getFirstNotEmptyLineTo(origText, textOffset + functionStart);
-                if (comment_line > 0) {
-                    commentsIterator = comments.find(comment_line);
-                    if (commentsIterator != comments.end()) {
-                        current_comment = QString::fromStdString(commentsIterator->second);
-                    }
-                }
+                if (functionStart >= 0) line = findLine(textOffset + functionStart);
+                QString current_comment = findComment(origText, textOffset + functionStart);
                 if (current_comment.size() > 0) {
                     if (current_comment.indexOf("//")==0) current_comment = current_comment.mid(2);
                     else if (current_comment.indexOf("#")==0) current_comment = current_comment.mid(1);
@@ -832,7 +999,7 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                     }
                 }
                 functionScope = scope;
-                if ((current_interface.size() > 0 && k == ";") || (current_function_is_abstract && k == ";")) {
+                if ((current_interface.size() > 0 && k.is(";")) || (current_function_is_abstract && k.is(";"))) {
                     current_function = "";
                     current_function_args = "";
                     current_function_is_static = false;
@@ -868,55 +1035,50 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         bool wantFunctionReturnType = current_function_return_type.size() == 0 && current_function.size() > 0;
 
         // class method return "$this" type
-        if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevK.toLower() == "return" && prevK == "$this" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevK.keyword == KEYWORD_RETURN && prevK.is("$this") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             current_function_return_type = current_class;
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
             updateFunctionReturnType(clsName, current_function, current_function_return_type);
-        } else if (wantFunctionReturnType && prevPrevK.toLower() == "return" && prevK.indexOf("$") == 0 && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && prevPrevK.keyword == KEYWORD_RETURN && prevK.text.indexOf('$') == 0 && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "$var" type
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            variableIndexesIterator = variableIndexes.find(clsName.toStdString() + "::" + current_function.toStdString() + "::" + prevK.toStdString());
-            if (variableIndexesIterator != variableIndexes.end()) {
-                int i = variableIndexesIterator->second;
-                if (result.variables.size() > i) {
-                    ParseResultVariable variable = result.variables.at(i);
-                    if (variable.type.size() > 0) {
-                        current_function_return_type = variable.type;
-                        updateFunctionReturnType(clsName, current_function, current_function_return_type);
-                    }
+            int i = findVariableIndex(clsName.toStdString() + "::" + current_function.toStdString() + "::" + prevK.text.toString().toStdString());
+            if (i >= 0) {
+                ParseResultVariable variable = result.variables.at(i);
+                if (variable.type.size() > 0) {
+                    current_function_return_type = variable.type;
+                    updateFunctionReturnType(clsName, current_function, current_function_return_type);
                 }
             }
-        } else if (wantFunctionReturnType && prevPrevPrevPrevK.toLower() == "return" && prevPrevPrevK.size() > 0 && prevPrevK == "(" && prevK == ")" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && prevPrevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevPrevK.text.size() > 0 && prevPrevK.is("(") && prevK.is(")") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "function()" type
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            if (prevPrevPrevK[0] != "\\") {
+            QString functionName = prevPrevPrevK.text.toString();
+            if (functionName[0] != "\\") {
                 QString ns = "\\";
                 if (current_namespace.size() > 0) ns += current_namespace + "\\";
-                prevPrevPrevK = ns + prevPrevPrevK;
+                functionName = ns + functionName;
             }
-            functionIndexesIterator = functionIndexes.find("::" + prevPrevPrevK.toStdString());
-            if (functionIndexesIterator != functionIndexes.end()) {
-                int i = functionIndexesIterator->second;
-                if (result.functions.size() > i) {
-                    ParseResultFunction func = result.functions.at(i);
-                    if (func.returnType.size() > 0) {
-                        current_function_return_type = func.returnType;
-                        updateFunctionReturnType(clsName, current_function, current_function_return_type);
-                    }
+            int i = findFunctionIndex("::" + functionName.toStdString());
+            if (i >= 0) {
+                ParseResultFunction func = result.functions.at(i);
+                if (func.returnType.size() > 0) {
+                    current_function_return_type = func.returnType;
+                    updateFunctionReturnType(clsName, current_function, current_function_return_type);
                 }
             }
-        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevK.toLower() == "return" && prevPrevPrevPrevK == "new" && prevPrevPrevK.size() > 0 && prevPrevK == "(" && prevK == ")" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevPrevPrevK.is("new") && prevPrevPrevK.text.size() > 0 && prevPrevK.is("(") && prevK.is(")") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "new Class()" type
-            QString type = prevPrevPrevK;
+            QString type = prevPrevPrevK.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -929,9 +1091,9 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 type = toAbs(current_namespace, type);
             }
             updateFunctionReturnType(clsName, current_function, type);
-        } else if (wantFunctionReturnType && prevPrevPrevK.toLower() == "return" && prevPrevK == "new" && prevK.size() > 0 && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && prevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevK.is("new") && prevK.text.size() > 0 && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "new Class" type
-            QString type = prevK;
+            QString type = prevK.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -944,9 +1106,9 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 type = toAbs(current_namespace, type);
             }
             updateFunctionReturnType(clsName, current_function, type);
-        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevPrevK.toLower() == "return" && prevPrevPrevPrevPrevK == "new" && prevPrevPrevPrevK.size() > 0 && prevPrevPrevK == "(" && prevPrevK.size() > 0 && prevK == ")" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevPrevPrevPrevK.is("new") && prevPrevPrevPrevK.text.size() > 0 && prevPrevPrevK.is("(") && prevPrevK.text.size() > 0 && prevK.is(")") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "new Class($var)" type
-            QString type = prevPrevPrevPrevK;
+            QString type = prevPrevPrevPrevK.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -959,9 +1121,9 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 type = toAbs(current_namespace, type);
             }
             updateFunctionReturnType(clsName, current_function, type);
-        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevPrevPrevPrevK.toLower() == "return" && prevPrevPrevPrevPrevPrevPrevK == "new" && prevPrevPrevPrevPrevPrevK.size() > 0 && prevPrevPrevPrevPrevK == "(" && prevPrevPrevPrevK.size() > 0 && prevPrevPrevK == "," && prevPrevK.size() > 0 && prevK == ")" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevPrevPrevPrevPrevPrevK.is("new") && prevPrevPrevPrevPrevPrevK.text.size() > 0 && prevPrevPrevPrevPrevK.is("(") && prevPrevPrevPrevK.text.size() > 0 && prevPrevPrevK.is(",") && prevPrevK.text.size() > 0 && prevK.is(")") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "new Class($var1, $var2)" type
-            QString type = prevPrevPrevPrevPrevPrevK;
+            QString type = prevPrevPrevPrevPrevPrevK.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -974,9 +1136,9 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 type = toAbs(current_namespace, type);
             }
             updateFunctionReturnType(clsName, current_function, type);
-        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevPrevPrevPrevK.toLower() == "return" && prevPrevPrevPrevPrevPrevPrevK == "new" && prevPrevPrevPrevPrevPrevK.size() > 0 && prevPrevPrevPrevPrevK == "(" && prevPrevPrevPrevK.size() > 0 && prevPrevPrevK == "(" && prevPrevK == ")" && prevK == ")" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && prevPrevPrevPrevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevPrevPrevPrevPrevPrevK.is("new") && prevPrevPrevPrevPrevPrevK.text.size() > 0 && prevPrevPrevPrevPrevK.is("(") && prevPrevPrevPrevK.text.size() > 0 && prevPrevPrevK.is("(") && prevPrevK.is(")") && prevK.is(")") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "new Class(func())" type
-            QString type = prevPrevPrevPrevPrevPrevK;
+            QString type = prevPrevPrevPrevPrevPrevK.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -989,102 +1151,90 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 type = toAbs(current_namespace, type);
             }
             updateFunctionReturnType(clsName, current_function, type);
-        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevK.toLower() == "return" && (prevPrevPrevPrevK.toLower() == "self" || prevPrevPrevPrevK.toLower() == "static") && prevPrevPrevK == ":" && prevPrevK == ":" && prevK.indexOf("$") == 0 && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && (prevPrevPrevPrevK.keyword == KEYWORD_SELF || prevPrevPrevPrevK.keyword == KEYWORD_STATIC) && prevPrevPrevK.is(":") && prevPrevK.is(":") && prevK.text.indexOf('$') == 0 && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "self::$var" type
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            variableIndexesIterator = variableIndexes.find(clsName.toStdString() + "::" + "::" + prevK.toStdString());
-            if (variableIndexesIterator != variableIndexes.end()) {
-                int i = variableIndexesIterator->second;
-                if (result.variables.size() > i) {
-                    ParseResultVariable variable = result.variables.at(i);
-                    if (variable.isStatic && variable.type.size() > 0) {
-                        current_function_return_type = variable.type;
-                        updateFunctionReturnType(clsName, current_function, current_function_return_type);
-                    }
+            int i = findVariableIndex(clsName.toStdString() + "::" + "::" + prevK.text.toString().toStdString());
+            if (i >= 0) {
+                ParseResultVariable variable = result.variables.at(i);
+                if (variable.isStatic && variable.type.size() > 0) {
+                    current_function_return_type = variable.type;
+                    updateFunctionReturnType(clsName, current_function, current_function_return_type);
                 }
             }
-        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevK.toLower() == "return" && prevPrevPrevPrevK == "$this" && prevPrevPrevK == "-" && prevPrevK == ">" && prevK.indexOf("$") < 0 && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevPrevPrevK.is("$this") && prevPrevPrevK.is("-") && prevPrevK.is(">") && prevK.text.indexOf('$') < 0 && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "$this->var" type
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            variableIndexesIterator = variableIndexes.find(clsName.toStdString() + "::" + "::" + "$" + prevK.toStdString());
-            if (variableIndexesIterator != variableIndexes.end()) {
-                int i = variableIndexesIterator->second;
-                if (result.variables.size() > i) {
-                    ParseResultVariable variable = result.variables.at(i);
-                    if (variable.type.size() > 0) {
-                        current_function_return_type = variable.type;
-                        updateFunctionReturnType(clsName, current_function, current_function_return_type);
-                    }
+            int i = findVariableIndex(clsName.toStdString() + "::" + "::" + "$" + prevK.text.toString().toStdString());
+            if (i >= 0) {
+                ParseResultVariable variable = result.variables.at(i);
+                if (variable.type.size() > 0) {
+                    current_function_return_type = variable.type;
+                    updateFunctionReturnType(clsName, current_function, current_function_return_type);
                 }
             }
-        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevPrevPrevK.toLower() == "return" && (prevPrevPrevPrevPrevPrevK.toLower() == "self" || prevPrevPrevPrevPrevPrevK.toLower() == "static") && prevPrevPrevPrevPrevK == ":" && prevPrevPrevPrevK == ":" && prevPrevPrevK.size() > 0 && prevPrevK == "(" && prevK == ")" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && (prevPrevPrevPrevPrevPrevK.keyword == KEYWORD_SELF || prevPrevPrevPrevPrevPrevK.keyword == KEYWORD_STATIC) && prevPrevPrevPrevPrevK.is(":") && prevPrevPrevPrevK.is(":") && prevPrevPrevK.text.size() > 0 && prevPrevK.is("(") && prevK.is(")") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "self::function()" type
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            functionIndexesIterator = functionIndexes.find(clsName.toStdString() + "::" + prevPrevPrevK.toStdString());
-            if (functionIndexesIterator != functionIndexes.end()) {
-                int i = functionIndexesIterator->second;
-                if (result.functions.size() > i) {
-                    ParseResultFunction func = result.functions.at(i);
-                    if (func.isStatic && func.returnType.size() > 0) {
-                        current_function_return_type = func.returnType;
-                        updateFunctionReturnType(clsName, current_function, current_function_return_type);
-                    }
+            int i = findFunctionIndex(clsName.toStdString() + "::" + prevPrevPrevK.text.toString().toStdString());
+            if (i >= 0) {
+                ParseResultFunction func = result.functions.at(i);
+                if (func.isStatic && func.returnType.size() > 0) {
+                    current_function_return_type = func.returnType;
+                    updateFunctionReturnType(clsName, current_function, current_function_return_type);
                 }
             }
-        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevPrevPrevK.toLower() == "return" && prevPrevPrevPrevPrevPrevK == "$this" && prevPrevPrevPrevPrevK == "-" && prevPrevPrevPrevK == ">" && prevPrevPrevK.size() > 0 && prevPrevK == "(" && prevK == ")" && k == ";" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (wantFunctionReturnType && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevPrevPrevPrevPrevPrevK.keyword == KEYWORD_RETURN && prevPrevPrevPrevPrevPrevK.is("$this") && prevPrevPrevPrevPrevK.is("-") && prevPrevPrevPrevK.is(">") && prevPrevPrevK.text.size() > 0 && prevPrevK.is("(") && prevK.is(")") && k.is(";") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // function return "$this->function()" type
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            functionIndexesIterator = functionIndexes.find(clsName.toStdString() + "::" + prevPrevPrevK.toStdString());
-            if (functionIndexesIterator != functionIndexes.end()) {
-                int i = functionIndexesIterator->second;
-                if (result.functions.size() > i) {
-                    ParseResultFunction func = result.functions.at(i);
-                    if (func.returnType.size() > 0) {
-                        current_function_return_type = func.returnType;
-                        updateFunctionReturnType(clsName, current_function, current_function_return_type);
-                    }
+            int i = findFunctionIndex(clsName.toStdString() + "::" + prevPrevPrevK.text.toString().toStdString());
+            if (i >= 0) {
+                ParseResultFunction func = result.functions.at(i);
+                if (func.returnType.size() > 0) {
+                    current_function_return_type = func.returnType;
+                    updateFunctionReturnType(clsName, current_function, current_function_return_type);
                 }
             }
         }
 
         // variables
-        if (expect < 0 && functionArgPars < 0 && k.indexOf("$") == 0 && prevK != ":" && prevK != ">" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        if (expect < 0 && functionArgPars < 0 && k.text.indexOf('$') == 0 && !prevK.is(":") && !prevK.is(">") && anonymFunctionScope < 0 && anonymClassScope < 0) {
             expect = EXPECT_VARIABLE;
-            expectName = k;
+            expectName = k.text.toString();
             current_variable = "";
             current_variable_type = "";
             class_static_variable = "";
             class_variable = "";
             if ((current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && current_function.size() == 0) {
-                current_variable_is_static = (prevK.toLower() == "static" || (prevK.size() > 1 && prevPrevK.toLower() == "static"));
+                current_variable_is_static = (prevK.keyword == KEYWORD_STATIC || (prevK.text.size() > 1 && prevPrevK.keyword == KEYWORD_STATIC));
                 current_variable_visibility = "public";
-                if (prevK.toLower() == "public" || prevK.toLower() == "protected" || prevK.toLower() == "private") current_variable_visibility = prevK.toLower();
-                if (prevK.size() > 1 && (prevPrevK.toLower() == "public" || prevPrevK.toLower() == "protected" || prevPrevK.toLower() == "private")) current_variable_visibility = prevPrevK.toLower();
+                if (prevK.keyword == KEYWORD_PUBLIC || prevK.keyword == KEYWORD_PROTECTED || prevK.keyword == KEYWORD_PRIVATE) current_variable_visibility = prevK.text.toString().toLower();
+                if (prevK.text.size() > 1 && (prevPrevK.keyword == KEYWORD_PUBLIC || prevPrevK.keyword == KEYWORD_PROTECTED || prevPrevK.keyword == KEYWORD_PRIVATE)) current_variable_visibility = prevPrevK.text.toString().toLower();
             } else {
                 current_variable_is_static = false;
                 current_variable_visibility = "";
             }
-            variableStart = m.capturedStart(1);
-        } else if (expect == EXPECT_VARIABLE && expectName.size() > 0 && current_variable.size() == 0 && (k == "=" || (k == ";" && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && current_function.size() == 0))) {
+            variableStart = k.text.position();
+        } else if (expect == EXPECT_VARIABLE && expectName.size() > 0 && current_variable.size() == 0 && (k.is("=") || (k.is(";") && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && current_function.size() == 0))) {
             current_variable = expectName;
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
             int line = 0;
-            if (variableStart >= 0) line = getLine(origText, textOffset + variableStart);
+            if (variableStart >= 0) line = findLine(textOffset + variableStart);
             addVariable(clsName, current_function, current_variable, current_variable_is_static, current_variable_visibility, current_variable_type, line);
             expect = -1;
             expectName = "";
@@ -1093,48 +1243,42 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         }
 
         // class static variable
-        if (class_static_variable.size() == 0 && functionArgPars < 0 && k.indexOf("$") == 0 && prevK == ":" && prevPrevK == ":" && (prevPrevPrevK.toLower() == "self" || prevPrevPrevK.toLower() == "static") && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        if (class_static_variable.size() == 0 && functionArgPars < 0 && k.text.indexOf('$') == 0 && prevK.is(":") && prevPrevK.is(":") && (prevPrevPrevK.keyword == KEYWORD_SELF || prevPrevPrevK.keyword == KEYWORD_STATIC) && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && anonymFunctionScope < 0 && anonymClassScope < 0) {
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            variableIndexesIterator = variableIndexes.find(clsName.toStdString() + "::" + "::" + k.toStdString());
-            if (variableIndexesIterator != variableIndexes.end()) {
-                int i = variableIndexesIterator->second;
-                if (result.variables.size() > i) {
-                    ParseResultVariable variable = result.variables.at(i);
-                    if (variable.isStatic && variable.type.size() == 0) {
-                        class_static_variable = k;
-                        current_variable = "";
-                        current_variable_type = "";
-                    }
+            int i = findVariableIndex(clsName.toStdString() + "::" + "::" + k.text.toString().toStdString());
+            if (i >= 0) {
+                ParseResultVariable variable = result.variables.at(i);
+                if (variable.isStatic && variable.type.size() == 0) {
+                    class_static_variable = k.text.toString();
+                    current_variable = "";
+                    current_variable_type = "";
                 }
             }
         }
 
         // class property
-        if (class_variable.size() == 0 && functionArgPars < 0 && k.indexOf("$") < 0 && prevK == ">" && prevPrevK == "-" && prevPrevPrevK == "$this" && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        if (class_variable.size() == 0 && functionArgPars < 0 && k.text.indexOf('$') < 0 && prevK.is(">") && prevPrevK.is("-") && prevPrevPrevK.is("$this") && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && anonymFunctionScope < 0 && anonymClassScope < 0) {
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
-            variableIndexesIterator = variableIndexes.find(clsName.toStdString() + "::" + "::" + "$" + k.toStdString());
-            if (variableIndexesIterator != variableIndexes.end()) {
-                int i = variableIndexesIterator->second;
-                if (result.variables.size() > i) {
-                    ParseResultVariable variable = result.variables.at(i);
-                    if (variable.type.size() == 0) {
-                        class_variable = k;
-                        current_variable = "";
-                        current_variable_type = "";
-                    }
+            int i = findVariableIndex(clsName.toStdString() + "::" + "::" + "$" + k.text.toString().toStdString());
+            if (i >= 0) {
+                ParseResultVariable variable = result.variables.at(i);
+                if (variable.type.size() == 0) {
+                    class_variable = k.text.toString();
+                    current_variable = "";
+                    current_variable_type = "";
                 }
             }
         }
 
         // variable type
-        if (current_variable.size() > 0 && prevPrevK == "=" && prevK.toLower() == "new" && anonymFunctionScope < 0 && anonymClassScope < 0) {
-            current_variable_type = k;
+        if (current_variable.size() > 0 && prevPrevK.is("=") && prevK.keyword == KEYWORD_NEW && anonymFunctionScope < 0 && anonymClassScope < 0) {
+            current_variable_type = k.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -1147,9 +1291,9 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 current_variable_type = toAbs(current_namespace, current_variable_type);
             }
             updateVariableType(clsName, current_function, current_variable, current_variable_type);
-        } else if (class_static_variable.size() > 0 && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevK == "=" && prevK.toLower() == "new" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (class_static_variable.size() > 0 && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevK.is("=") && prevK.keyword == KEYWORD_NEW && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // class static variable type
-            QString class_static_variable_type = k;
+            QString class_static_variable_type = k.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -1162,9 +1306,9 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
                 class_static_variable_type = toAbs(current_namespace, class_static_variable_type);
             }
             updateVariableType(clsName, "", class_static_variable, class_static_variable_type);
-        } else if (class_variable.size() > 0 && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevK == "=" && prevK.toLower() == "new" && anonymFunctionScope < 0 && anonymClassScope < 0) {
+        } else if (class_variable.size() > 0 && (current_class.size() > 0 || current_interface.size() > 0 || current_trait.size() > 0) && prevPrevK.is("=") && prevK.keyword == KEYWORD_NEW && anonymFunctionScope < 0 && anonymClassScope < 0) {
             // class property type
-            QString class_variable_type = k;
+            QString class_variable_type = k.text.toString();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
@@ -1180,27 +1324,27 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
         }
 
         // constants
-        if (expect < 0 && k.toLower() == "const" && functionArgsStart < 0 && (prevK == ";" || prevK == "{" || prevK == "}" || prevK.size() == 0) && anonymFunctionScope < 0 && (((namespaceScope < 0 && scope == 0) || scope == namespaceScope+1) || (current_class.size() > 0 && scope == classScope + 1) || (current_interface.size() > 0 && scope == interfaceScope + 1) || (current_trait.size() > 0 && scope == traitScope + 1))) {
+        if (expect < 0 && k.keyword == KEYWORD_CONST && functionArgsStart < 0 && (prevK.is(";") || prevK.is("{") || prevK.is("}") || prevK.text.size() == 0) && anonymFunctionScope < 0 && (((namespaceScope < 0 && scope == 0) || scope == namespaceScope+1) || (current_class.size() > 0 && scope == classScope + 1) || (current_interface.size() > 0 && scope == interfaceScope + 1) || (current_trait.size() > 0 && scope == traitScope + 1))) {
             expect = EXPECT_CONST;
             expectName = "";
             current_constant = "";
             current_constant_value = "";
             constantValueStart = -1;
-            constantStart = m.capturedStart(1);
-        } else if (expect == EXPECT_CONST && expectName.size() == 0 && k.size() > 0) {
-            expectName = k;
-        } else if (expect == EXPECT_CONST && expectName.size() > 0 && k == "=") {
+            constantStart = k.text.position();
+        } else if (expect == EXPECT_CONST && expectName.size() == 0 && k.text.size() > 0) {
+            expectName = k.text.toString();
+        } else if (expect == EXPECT_CONST && expectName.size() > 0 && k.is("=")) {
             expect = EXPECT_CONST_VALUE;
-            constantValueStart = m.capturedStart(1) + 1;
-        } else if (expect == EXPECT_CONST_VALUE && expectName.size() > 0 && k == ";") {
+            constantValueStart = k.text.position() + 1;
+        } else if (expect == EXPECT_CONST_VALUE && expectName.size() > 0 && k.is(";")) {
             current_constant = expectName;
-            current_constant_value = origText.mid(textOffset+constantValueStart, m.capturedStart(1)-constantValueStart).trimmed();
+            current_constant_value = origText.mid(textOffset+constantValueStart, k.text.position()-constantValueStart).trimmed();
             QString clsName = "";
             if (current_class.size() > 0) clsName = current_class;
             else if (current_interface.size() > 0) clsName = current_interface;
             else if (current_trait.size() > 0) clsName = current_trait;
             int line = 0;
-            if (constantStart >= 0) line = getLine(origText, textOffset + constantStart);
+            if (constantStart >= 0) line = findLine(textOffset + constantStart);
             if (clsName.size() == 0) {
                 QString ns = "\\";
                 if (current_namespace.size() > 0) ns += current_namespace + "\\";
@@ -1224,7 +1368,7 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
              expect == EXPECT_INTERFACE_EXTENDED ||
              expect == EXPECT_TRAIT ||
              class_static_variable.size() > 0 || class_variable.size() > 0
-             ) && (k == "-" || k == "+" || k == "*" || k == "/" || k == "%" || k == "&" || k == "|" || k == ":" || k == ">" || k == "<" || k == "?" || k == "[" || k == "]" || k == "(" || k == ")") && functionArgsStart < 0
+             ) && (k.is("-") || k.is("+") || k.is("*") || k.is("/") || k.is("%") || k.is("&") || k.is("|") || k.is(":") || k.is(">") || k.is("<") || k.is("?") || k.is("[") || k.is("]") || k.is("(") || k.is(")")) && functionArgsStart < 0
         ) {
             expect = -1;
             expectName = "";
@@ -1232,7 +1376,7 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
             class_variable = "";
         }
 
-        if ((k == ";" || ((k == "{" || k == "}") && expect != EXPECT_USE)) && functionArgsStart < 0) {
+        if ((k.is(";") || ((k.is("{") || k.is("}")) && expect != EXPECT_USE)) && functionArgsStart < 0) {
             expect = -1;
             expectName = "";
             class_static_variable = "";
@@ -1241,16 +1385,16 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
             expected_class_name = "";
         }
         // braces
-        if (k == "{") {
+        if (k.is("{")) {
             scope++;
             curlyBrackets++;
-            curlyBracketsList.append(m.capturedStart(1)+1);
+            curlyBracketsList.append(k.text.position()+1);
         }
-        if (k == "}") {
+        if (k.is("}")) {
             scope--;
             if (scope < 0) scope = 0;
             curlyBrackets--;
-            curlyBracketsList.append(-1 * (m.capturedStart(1)+1));
+            curlyBracketsList.append(-1 * (k.text.position()+1));
             // namespace close
             if (current_namespace.size() > 0 && namespaceScope >= 0 && namespaceScope == scope) {
                 current_namespace = "";
@@ -1327,19 +1471,19 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
             }
         }
         // parens
-        if (k == "(") {
+        if (k.is("(")) {
             pars++;
             roundBrackets++;
-            roundBracketsList.append(m.capturedStart(1)+1);
+            roundBracketsList.append(k.text.position()+1);
         }
-        if (k == ")") {
+        if (k.is(")")) {
             pars--;
             if (pars < 0) pars = 0;
             roundBrackets--;
-            roundBracketsList.append(-1 * (m.capturedStart(1)+1));
+            roundBracketsList.append(-1 * (k.text.position()+1));
             // function args
             if (functionArgPars >= 0 && functionArgPars == pars && functionArgsStart >= 0) {
-                current_function_args = origText.mid(textOffset+functionArgsStart+1, m.capturedStart(1)-functionArgsStart-1).trimmed();
+                current_function_args = origText.mid(textOffset+functionArgsStart+1, k.text.position()-functionArgsStart-1).trimmed();
                 current_function_args = Helper::stripScopedText(current_function_args);
                 if (current_function_args.size() > 0) {
                     QString current_function_args_cleaned = "";
@@ -1398,13 +1542,13 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
             }
         }
         // brackets
-        if (k == "[") {
+        if (k.is("[")) {
             squareBrackets++;
-            squareBracketsList.append(m.capturedStart(1)+1);
+            squareBracketsList.append(k.text.position()+1);
         }
-        if (k == "]") {
+        if (k.is("]")) {
             squareBrackets--;
-            squareBracketsList.append(-1 * (m.capturedStart(1)+1));
+            squareBracketsList.append(-1 * (k.text.position()+1));
         }
         prevPrevPrevPrevPrevPrevPrevPrevK = prevPrevPrevPrevPrevPrevPrevK;
         prevPrevPrevPrevPrevPrevPrevK = prevPrevPrevPrevPrevPrevK;
@@ -1418,36 +1562,37 @@ void ParsePHP::parseCode(QString & code, QString & origText, int textOffset)
     if (curlyBrackets > 0) {
         int offset = findOpenScope(curlyBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, textOffset + offset);
+        int line = findLine(textOffset + offset);
         addError(QObject::tr("Unclosed brace"), line, textOffset + offset);
     } else if (curlyBrackets < 0) {
         int offset = findCloseScope(curlyBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, textOffset + offset);
+        int line = findLine(textOffset + offset);
         addError(QObject::tr("Excess brace"), line, textOffset + offset);
     }
     if (roundBrackets > 0) {
         int offset = findOpenScope(roundBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, textOffset + offset);
+        int line = findLine(textOffset + offset);
         addError(QObject::tr("Unclosed parenthesis"), line, textOffset + offset);
     } else if (roundBrackets < 0) {
         int offset = findCloseScope(roundBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, textOffset + offset);
+        int line = findLine(textOffset + offset);
         addError(QObject::tr("Excess parenthesis"), line, textOffset + offset);
     }
     if (squareBrackets > 0) {
         int offset = findOpenScope(squareBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, textOffset + offset);
+        int line = findLine(textOffset + offset);
         addError(QObject::tr("Unclosed bracket"), line, textOffset + offset);
     } else if (squareBrackets < 0) {
         int offset = findCloseScope(squareBracketsList);
         if (offset != 0) offset = abs(offset) - 1;
-        int line = getLine(origText, textOffset + offset);
+        int line = findLine(textOffset + offset);
         addError(QObject::tr("Excess bracket"), line, textOffset + offset);
     }
+    parsedNamespace = current_namespace;
 }
 
 void ParsePHP::reset()
@@ -1462,13 +1607,21 @@ void ParsePHP::reset()
     importIndexes.clear();
     classIndexes.clear();
     comments.clear();
+    recordDeclaration = nullptr;
+    recordedKeys.clear();
+    classDeclarationSkipped = false;
+    importsBase = 0;
+    namespacesBase = 0;
+    classesBase = 0;
+    functionsBase = 0;
+    variablesBase = 0;
+    constantsBase = 0;
+    commentsBase = 0;
+    errorsBase = 0;
 }
 
-ParsePHP::ParseResult ParsePHP::parse(QString text)
+void ParsePHP::parseText(QString & text, QString & cleanText)
 {
-    result = ParseResult();
-    reset();
-    QString cleanText = cleanUp(text);
     QRegularExpressionMatchIterator mi = phpExpression.globalMatch(cleanText);
     while(mi.hasNext()){
         QRegularExpressionMatch m = mi.next();
@@ -1482,5 +1635,486 @@ ParsePHP::ParseResult ParsePHP::parse(QString text)
     for (auto & commentsIterator : orderedComments) {
         addComment(QString::fromStdString(commentsIterator.second), commentsIterator.first);
     }
+}
+
+ParsePHP::ParseResult ParsePHP::parse(QString text)
+{
+    result = ParseResult();
+    reset();
+    declarations.clear();
+    declarationsText = "";
+    declarationsCleanText = "";
+    buildLineIndex(text);
+    QString cleanText = cleanUp(text);
+    parseText(text, cleanText);
+    return result;
+}
+
+ParsePHP::ParseResult ParsePHP::parseIncremental(QString text)
+{
+    result = ParseResult();
+    reset();
+    buildLineIndex(text);
+    QString cleanText = cleanUp(text);
+    QVector<Declaration> oldDeclarations;
+    oldDeclarations.swap(declarations);
+    QString oldText = declarationsText;
+    QString oldCleanText = declarationsCleanText;
+    declarationsText = text;
+    declarationsCleanText = cleanText;
+    QVector<Declaration> list;
+    if (!splitDeclarations(text, cleanText, list)) {
+        // mixed html and unbalanced code are parsed as a whole
+        declarationsText = "";
+        declarationsCleanText = "";
+        parseText(text, cleanText);
+        return result;
+    }
+    // unchanged declarations are matched from both ends of the text
+    int prefix = 0, suffix = 0;
+    int count = std::min(list.size(), oldDeclarations.size());
+    while (prefix < count && isSameDeclaration(text, cleanText, list.at(prefix), oldText, oldCleanText, oldDeclarations.at(prefix))) prefix++;
+    while (suffix < count - prefix && isSameDeclaration(text, cleanText, list.at(list.size() - suffix - 1), oldText, oldCleanText, oldDeclarations.at(oldDeclarations.size() - suffix - 1))) suffix++;
+    std::map<int, std::string> orderedComments(comments.begin(), comments.end());
+    uint context = 0, classContext = 0;
+    QString ns = "";
+    int commentsLine = 0;
+    for (int i=0; i<list.size(); i++) {
+        Declaration & declaration = list[i];
+        declaration.context = declaration.type == DECLARATION_CLASS_MEMBER ? classContext : context;
+        declarationLine = findLine(declaration.keyStart);
+        int oldIndex = -1;
+        if (i < prefix) oldIndex = i;
+        else if (i >= list.size() - suffix) oldIndex = oldDeclarations.size() - list.size() + i;
+        // namespaces and imports are short, they are always parsed again
+        if (oldIndex >= 0 && !declaration.changesContext && isValidDeclaration(oldDeclarations.at(oldIndex), declaration.context)) {
+            Declaration & oldDeclaration = oldDeclarations[oldIndex];
+            shiftDeclaration(oldDeclaration, declarationLine - oldDeclaration.resultLine, declaration.keyStart - oldDeclaration.resultStart);
+            appendDeclaration(oldDeclaration);
+            declaration.result = oldDeclaration.result;
+            declaration.dependencies = oldDeclaration.dependencies;
+            declaration.effects = oldDeclaration.effects;
+        } else {
+            int toLine = i < list.size() - 1 ? findLine(declaration.end - 1) : lineStarts.size();
+            parseDeclaration(text, cleanText, declaration, ns, orderedComments, commentsLine, toLine);
+        }
+        declaration.resultLine = declarationLine;
+        declaration.resultStart = declaration.keyStart;
+        commentsLine = findLine(declaration.end - 1);
+        if (declaration.changesContext) {
+            context = qHash(text.midRef(declaration.start, declaration.end - declaration.start), context);
+            ns = parsedNamespace;
+        }
+        if (declaration.type == DECLARATION_CLASS_HEADER) {
+            classContext = qHash(text.midRef(declaration.start, declaration.end - declaration.start), context);
+        }
+    }
+    declarations.swap(list);
     return result;
 }
+
+int ParsePHP::findStatementEnd(const QString & cleanText, int offset, int end)
+{
+    // statement ends with a semicolon or a closing brace outside of brackets,
+    // -1 is returned at the end of the code and -2 if brackets are not balanced
+    int curlyBrackets = 0, roundBrackets = 0, squareBrackets = 0;
+    for (int i=offset; i<end; i++) {
+        switch (cleanText[i].unicode()) {
+            case '{': curlyBrackets++; break;
+            case '(': roundBrackets++; break;
+            case ')': roundBrackets--; break;
+            case '[': squareBrackets++; break;
+            case ']': squareBrackets--; break;
+            case '}':
+                curlyBrackets--;
+                if (curlyBrackets == 0 && roundBrackets == 0 && squareBrackets == 0) return i + 1;
+                break;
+            case ';':
+                if (curlyBrackets == 0 && roundBrackets == 0 && squareBrackets == 0) return i + 1;
+                break;
+        }
+        if (curlyBrackets < 0 || roundBrackets < 0 || squareBrackets < 0) return -2;
+    }
+    if (curlyBrackets != 0 || roundBrackets != 0 || squareBrackets != 0) return -2;
+    return -1;
+}
+
+bool ParsePHP::splitDeclarations(const QString & text, const QString & cleanText, QVector<Declaration> & list)
+{
+    // only a single php block is split into top level statements
+    QRegularExpressionMatchIterator mi = phpExpression.globalMatch(cleanText);
+    if (!mi.hasNext()) return false;
+    QRegularExpressionMatch m = mi.next();
+    if (m.capturedStart(1) < 0 || m.captured(1).trimmed().size() == 0 || mi.hasNext()) return false;
+    int offset = m.capturedStart(1);
+    int end = m.capturedEnd(1);
+    while (offset < end) {
+        int statementEnd = findStatementEnd(cleanText, offset, end);
+        if (statementEnd == -2) return false;
+        if (statementEnd < 0) {
+            addDeclaration(list, text, cleanText, DECLARATION_STATEMENT, offset, end);
+            break;
+        }
+        if (cleanText[statementEnd - 1] != '}' || !splitClassDeclaration(text, cleanText, offset, statementEnd, list)) {
+            addDeclaration(list, text, cleanText, DECLARATION_STATEMENT, offset, statementEnd);
+        }
+        offset = statementEnd;
+    }
+    return list.size() > 0;
+}
+
+bool ParsePHP::splitClassDeclaration(const QString & text, const QString & cleanText, int start, int end, QVector<Declaration> & list)
+{
+    // class body is split into members, each of them is parsed after the class header
+    int braceStart = cleanText.indexOf('{', start);
+    if (braceStart < 0 || braceStart >= end) return false;
+    if (!classHeaderExpression.match(cleanText.midRef(start, braceStart - start)).hasMatch()) return false;
+    int headerEnd = braceStart + 1;
+    QVector<int> memberEnds;
+    int offset = headerEnd;
+    while (offset < end - 1) {
+        int memberEnd = findStatementEnd(cleanText, offset, end - 1);
+        if (memberEnd == -2) return false;
+        if (memberEnd < 0) break;
+        memberEnds.append(memberEnd);
+        offset = memberEnd;
+    }
+    if (memberEnds.size() == 0) return false;
+    // the last member holds the rest of the body with the closing brace
+    memberEnds.last() = end;
+    addDeclaration(list, text, cleanText, DECLARATION_CLASS_HEADER, start, headerEnd, start, headerEnd);
+    int memberStart = headerEnd;
+    for (int i=0; i<memberEnds.size(); i++) {
+        addDeclaration(list, text, cleanText, DECLARATION_CLASS_MEMBER, memberStart, memberEnds.at(i), start, headerEnd);
+        memberStart = memberEnds.at(i);
+    }
+    list.last().last = true;
+    return true;
+}
+
+void ParsePHP::addDeclaration(QVector<Declaration> & list, const QString & text, const QString & cleanText, int type, int start, int end, int headerStart, int headerEnd)
+{
+    // declarations are compared by whole lines
+    Declaration declaration;
+    declaration.type = type;
+    declaration.start = start;
+    declaration.end = end;
+    declaration.keyStart = lineStarts.at(findLine(start) - 1);
+    int line = findLine(end - 1);
+    declaration.keyEnd = line < lineStarts.size() ? lineStarts.at(line) - 1 : text.size();
+    declaration.headerStart = headerStart;
+    declaration.headerEnd = headerEnd;
+    declaration.last = false;
+    declaration.changesContext = type == DECLARATION_STATEMENT && isContextStatement(cleanText, start, end);
+    declaration.context = 0;
+    declaration.resultLine = 0;
+    declaration.resultStart = 0;
+    list.append(declaration);
+}
+
+bool ParsePHP::isContextStatement(const QString & cleanText, int start, int end)
+{
+    // namespaces and imports change the names resolved in the next declarations
+    int i = start;
+    while (i < end && cleanText[i].isSpace()) i++;
+    int wordStart = i;
+    while (i < end && isTokenWordChar(cleanText[i])) i++;
+    QStringRef word = cleanText.midRef(wordStart, i - wordStart);
+    return word.compare(QLatin1String("namespace"), Qt::CaseInsensitive) == 0 || word.compare(QLatin1String("use"), Qt::CaseInsensitive) == 0;
+}
+
+bool ParsePHP::isSameDeclaration(const QString & text, const QString & cleanText, const Declaration & declaration, const QString & oldText, const QString & oldCleanText, const Declaration & oldDeclaration)
+{
+    if (declaration.type != oldDeclaration.type || declaration.last != oldDeclaration.last) return false;
+    int size = declaration.keyEnd - declaration.keyStart;
+    if (size != oldDeclaration.keyEnd - oldDeclaration.keyStart) return false;
+    if (declaration.start - declaration.keyStart != oldDeclaration.start - oldDeclaration.keyStart) return false;
+    if (declaration.end - declaration.keyStart != oldDeclaration.end - oldDeclaration.keyStart) return false;
+    if (text.midRef(declaration.keyStart, size) != oldText.midRef(oldDeclaration.keyStart, size)) return false;
+    return cleanText.midRef(declaration.keyStart, size) == oldCleanText.midRef(oldDeclaration.keyStart, size);
+}
+
+bool ParsePHP::isValidDeclaration(const Declaration & declaration, uint context)
+{
+    // lookups made while parsing should give the same results
+    if (declaration.context != context) return false;
+    for (const DeclarationDependency & dependency : declaration.dependencies) {
+        bool found = false;
+        QString value = "";
+        getDependencyValue(dependency.type, dependency.key, found, value);
+        if (found != dependency.found || value != dependency.value) return false;
+    }
+    return true;
+}
+
+QString ParsePHP::getDeclarationCode(const QString & cleanText, const Declaration & declaration, int & textOffset)
+{
+    if (declaration.type == DECLARATION_CLASS_HEADER) {
+        textOffset = declaration.start;
+        return cleanText.mid(declaration.start, declaration.end - declaration.start) + "}";
+    }
+    if (declaration.type == DECLARATION_CLASS_MEMBER) {
+        // header is put right before the member, so member tokens keep their positions
+        QString code = cleanText.mid(declaration.headerStart, declaration.headerEnd - declaration.headerStart);
+        textOffset = declaration.start - code.size();
+        code += cleanText.midRef(declaration.start, declaration.end - declaration.start);
+        if (!declaration.last) code += "}";
+        return code;
+    }
+    textOffset = declaration.start;
+    return cleanText.mid(declaration.start, declaration.end - declaration.start);
+}
+
+void ParsePHP::parseDeclaration(QString & text, const QString & cleanText, Declaration & declaration, QString ns, const std::map<int, std::string> & orderedComments, int fromLine, int toLine)
+{
+    importsBase = result.imports.size();
+    namespacesBase = result.namespaces.size();
+    classesBase = result.classes.size();
+    functionsBase = result.functions.size();
+    variablesBase = result.variables.size();
+    constantsBase = result.constants.size();
+    commentsBase = result.comments.size();
+    errorsBase = result.errors.size();
+    declaration.dependencies.clear();
+    declaration.effects.clear();
+    recordedKeys.clear();
+    recordDeclaration = &declaration;
+    // class of a member is added by the class header
+    classDeclarationSkipped = declaration.type == DECLARATION_CLASS_MEMBER;
+    int textOffset = 0;
+    QString code = getDeclarationCode(cleanText, declaration, textOffset);
+    parseCode(code, text, textOffset, ns);
+    classDeclarationSkipped = false;
+    recordDeclaration = nullptr;
+    for (auto it = orderedComments.upper_bound(fromLine); it != orderedComments.end() && it->first <= toLine; ++it) {
+        addComment(QString::fromStdString(it->second), it->first);
+    }
+    declaration.result = getDeclarationResult();
+}
+
+ParsePHP::ParseResult ParsePHP::getDeclarationResult()
+{
+    // indexes of own items are stored relative to the declaration
+    ParseResult declarationResult;
+    declarationResult.imports = result.imports.mid(importsBase);
+    declarationResult.namespaces = result.namespaces.mid(namespacesBase);
+    for (int i=0; i<declarationResult.namespaces.size(); i++) {
+        shiftIndexes(declarationResult.namespaces[i].importsIndexes, -importsBase);
+    }
+    declarationResult.classes = result.classes.mid(classesBase);
+    for (int i=0; i<declarationResult.classes.size(); i++) {
+        shiftIndexes(declarationResult.classes[i].functionIndexes, -functionsBase);
+        shiftIndexes(declarationResult.classes[i].variableIndexes, -variablesBase);
+        shiftIndexes(declarationResult.classes[i].constantIndexes, -constantsBase);
+    }
+    declarationResult.functions = result.functions.mid(functionsBase);
+    for (int i=0; i<declarationResult.functions.size(); i++) {
+        shiftIndexes(declarationResult.functions[i].variableIndexes, -variablesBase);
+    }
+    declarationResult.variables = result.variables.mid(variablesBase);
+    declarationResult.constants = result.constants.mid(constantsBase);
+    declarationResult.comments = result.comments.mid(commentsBase);
+    declarationResult.errors = result.errors.mid(errorsBase);
+    return declarationResult;
+}
+
+void ParsePHP::shiftIndexes(QVector<int> & indexes, int delta)
+{
+    if (delta == 0) return;
+    for (int i=0; i<indexes.size(); i++) {
+        indexes[i] += delta;
+    }
+}
+
+void ParsePHP::shiftDeclaration(Declaration & declaration, int lineDelta, int offsetDelta)
+{
+    if (lineDelta == 0 && offsetDelta == 0) return;
+    ParseResult & declarationResult = declaration.result;
+    for (int i=0; i<declarationResult.imports.size(); i++) declarationResult.imports[i].line += lineDelta;
+    for (int i=0; i<declarationResult.namespaces.size(); i++) declarationResult.namespaces[i].line += lineDelta;
+    for (int i=0; i<declarationResult.classes.size(); i++) declarationResult.classes[i].line += lineDelta;
+    for (int i=0; i<declarationResult.functions.size(); i++) declarationResult.functions[i].line += lineDelta;
+    for (int i=0; i<declarationResult.variables.size(); i++) declarationResult.variables[i].line += lineDelta;
+    for (int i=0; i<declarationResult.constants.size(); i++) declarationResult.constants[i].line += lineDelta;
+    for (int i=0; i<declarationResult.comments.size(); i++) declarationResult.comments[i].line += lineDelta;
+    for (int i=0; i<declarationResult.errors.size(); i++) {
+        declarationResult.errors[i].line += lineDelta;
+        declarationResult.errors[i].symbol += offsetDelta;
+    }
+}
+
+void ParsePHP::appendDeclaration(const Declaration & declaration)
+{
+    const ParseResult & declarationResult = declaration.result;
+    int importsStart = result.imports.size();
+    int functionsStart = result.functions.size();
+    int variablesStart = result.variables.size();
+    int constantsStart = result.constants.size();
+    int namespacesStart = result.namespaces.size();
+    int classesStart = result.classes.size();
+    result.imports += declarationResult.imports;
+    result.namespaces += declarationResult.namespaces;
+    for (int i=namespacesStart; i<result.namespaces.size(); i++) {
+        shiftIndexes(result.namespaces[i].importsIndexes, importsStart);
+    }
+    result.classes += declarationResult.classes;
+    for (int i=classesStart; i<result.classes.size(); i++) {
+        shiftIndexes(result.classes[i].functionIndexes, functionsStart);
+        shiftIndexes(result.classes[i].variableIndexes, variablesStart);
+        shiftIndexes(result.classes[i].constantIndexes, constantsStart);
+    }
+    result.functions += declarationResult.functions;
+    for (int i=functionsStart; i<result.functions.size(); i++) {
+        shiftIndexes(result.functions[i].variableIndexes, variablesStart);
+    }
+    result.variables += declarationResult.variables;
+    result.constants += declarationResult.constants;
+    result.comments += declarationResult.comments;
+    result.errors += declarationResult.errors;
+    // changes of earlier declarations are applied to the items found by the same names
+    for (const DeclarationEffect & effect : declaration.effects) {
+        if (effect.type == EFFECT_NAMESPACE_IMPORT) {
+            namespaceIndexesIterator = namespaceIndexes.find(effect.key);
+            if (namespaceIndexesIterator == namespaceIndexes.end() || namespaceIndexesIterator->second >= result.namespaces.size()) continue;
+            result.namespaces[namespaceIndexesIterator->second].importsIndexes.append(importsStart + effect.index);
+        } else if (effect.type == EFFECT_CLASS_FUNCTION || effect.type == EFFECT_CLASS_VARIABLE || effect.type == EFFECT_CLASS_CONSTANT) {
+            classIndexesIterator = classIndexes.find(effect.key);
+            if (classIndexesIterator == classIndexes.end() || classIndexesIterator->second >= result.classes.size()) continue;
+            ParseResultClass & cls = result.classes[classIndexesIterator->second];
+            if (effect.type == EFFECT_CLASS_FUNCTION) cls.functionIndexes.append(functionsStart + effect.index);
+            else if (effect.type == EFFECT_CLASS_VARIABLE) cls.variableIndexes.append(variablesStart + effect.index);
+            else cls.constantIndexes.append(constantsStart + effect.index);
+        } else if (effect.type == EFFECT_FUNCTION_VARIABLE || effect.type == EFFECT_FUNCTION_RETURN_TYPE) {
+            functionIndexesIterator = functionIndexes.find(effect.key);
+            if (functionIndexesIterator == functionIndexes.end() || functionIndexesIterator->second >= result.functions.size()) continue;
+            ParseResultFunction & func = result.functions[functionIndexesIterator->second];
+            if (effect.type == EFFECT_FUNCTION_VARIABLE) func.variableIndexes.append(variablesStart + effect.index);
+            else func.returnType = effect.value;
+        } else if (effect.type == EFFECT_VARIABLE_TYPE) {
+            variableIndexesIterator = variableIndexes.find(effect.key);
+            if (variableIndexesIterator == variableIndexes.end() || variableIndexesIterator->second >= result.variables.size()) continue;
+            result.variables[variableIndexesIterator->second].type = effect.value;
+        }
+    }
+    // name indexes are updated as the add methods do
+    for (int i=0; i<declarationResult.imports.size(); i++) {
+        importIndexes[declarationResult.imports.at(i).name.toStdString()] = importsStart + i;
+    }
+    for (int i=0; i<declarationResult.namespaces.size(); i++) {
+        namespaceIndexes[declarationResult.namespaces.at(i).name.toStdString()] = namespacesStart + i;
+    }
+    for (int i=0; i<declarationResult.classes.size(); i++) {
+        classIndexes[declarationResult.classes.at(i).name.toStdString()] = classesStart + i;
+    }
+    for (int i=0; i<declarationResult.functions.size(); i++) {
+        const ParseResultFunction & func = declarationResult.functions.at(i);
+        functionIndexes[func.clsName.toStdString() + "::" + func.name.toStdString()] = functionsStart + i;
+    }
+    for (int i=0; i<declarationResult.variables.size(); i++) {
+        const ParseResultVariable & variable = declarationResult.variables.at(i);
+        variableIndexes[variable.clsName.toStdString() + "::" + variable.funcName.toStdString() + "::" + variable.name.toStdString()] = variablesStart + i;
+    }
+    for (int i=0; i<declarationResult.constants.size(); i++) {
+        const ParseResultConstant & constant = declarationResult.constants.at(i);
+        constantIndexes[constant.clsName.toStdString() + "::" + constant.name.toStdString()] = constantsStart + i;
+    }
+}
+
+int ParsePHP::findVariableIndex(const std::string & key)
+{
+    variableIndexesIterator = variableIndexes.find(key);
+    int i = variableIndexesIterator != variableIndexes.end() ? variableIndexesIterator->second : -1;
+    // lookups of earlier declarations are checked before a declaration is reused
+    if (recordDeclaration != nullptr && i < variablesBase) recordDependency(DEPENDENCY_VARIABLE, key);
+    return i < result.variables.size() ? i : -1;
+}
+
+int ParsePHP::findFunctionIndex(const std::string & key)
+{
+    functionIndexesIterator = functionIndexes.find(key);
+    int i = functionIndexesIterator != functionIndexes.end() ? functionIndexesIterator->second : -1;
+    if (recordDeclaration != nullptr && i < functionsBase) recordDependency(DEPENDENCY_FUNCTION, key);
+    return i < result.functions.size() ? i : -1;
+}
+
+int ParsePHP::findClassIndex(const std::string & key)
+{
+    classIndexesIterator = classIndexes.find(key);
+    int i = classIndexesIterator != classIndexes.end() ? classIndexesIterator->second : -1;
+    if (recordDeclaration != nullptr && i < classesBase) recordDependency(DEPENDENCY_CLASS, key);
+    return i < result.classes.size() ? i : -1;
+}
+
+int ParsePHP::findNamespaceIndex(const std::string & key)
+{
+    namespaceIndexesIterator = namespaceIndexes.find(key);
+    int i = namespaceIndexesIterator != namespaceIndexes.end() ? namespaceIndexesIterator->second : -1;
+    if (recordDeclaration != nullptr && i < namespacesBase) recordDependency(DEPENDENCY_NAMESPACE, key);
+    return i < result.namespaces.size() ? i : -1;
+}
+
+QString ParsePHP::findComment(QString & text, int offset)
+{
+    int line = findLine(offset);
+    // comment can be found above the declaration lines
+    if (recordDeclaration != nullptr) recordDependency(DEPENDENCY_COMMENT, std::to_string(line - declarationLine));
+    return getComment(text, line);
+}
+
+QString ParsePHP::getComment(QString & text, int line)
+{
+    if (line <= 0 || line > lineStarts.size()) return "";
+    int commentLine = findFirstNotEmptyLineTo(text, lineStarts.at(line - 1));
+    if (commentLine <= 0) return "";
+    commentsIterator = comments.find(commentLine);
+    if (commentsIterator == comments.end()) return "";
+    return QString::fromStdString(commentsIterator->second);
+}
+
+void ParsePHP::getDependencyValue(int type, const std::string & key, bool & found, QString & value)
+{
+    found = false;
+    value = "";
+    if (type == DEPENDENCY_VARIABLE) {
+        variableIndexesIterator = variableIndexes.find(key);
+        if (variableIndexesIterator == variableIndexes.end() || variableIndexesIterator->second >= result.variables.size()) return;
+        const ParseResultVariable & variable = result.variables.at(variableIndexesIterator->second);
+        value = (variable.isStatic ? "static " : "") + variable.type;
+    } else if (type == DEPENDENCY_FUNCTION) {
+        functionIndexesIterator = functionIndexes.find(key);
+        if (functionIndexesIterator == functionIndexes.end() || functionIndexesIterator->second >= result.functions.size()) return;
+        const ParseResultFunction & func = result.functions.at(functionIndexesIterator->second);
+        value = (func.isStatic ? "static " : "") + func.returnType;
+    } else if (type == DEPENDENCY_CLASS) {
+        classIndexesIterator = classIndexes.find(key);
+        if (classIndexesIterator == classIndexes.end() || classIndexesIterator->second >= result.classes.size()) return;
+    } else if (type == DEPENDENCY_NAMESPACE) {
+        namespaceIndexesIterator = namespaceIndexes.find(key);
+        if (namespaceIndexesIterator == namespaceIndexes.end() || namespaceIndexesIterator->second >= result.namespaces.size()) return;
+    } else if (type == DEPENDENCY_COMMENT) {
+        value = getComment(declarationsText, declarationLine + std::stoi(key));
+    }
+    found = true;
+}
+
+void ParsePHP::recordDependency(int type, const std::string & key)
+{
+    // first lookup of a name is made before the declaration changes it
+    if (!recordedKeys.insert(std::to_string(type) + ":" + key).second) return;
+    DeclarationDependency dependency;
+    dependency.type = type;
+    dependency.key = key;
+    getDependencyValue(type, key, dependency.found, dependency.value);
+    recordDeclaration->dependencies.append(dependency);
+}
+
+void ParsePHP::recordEffect(int type, const std::string & key, int index, QString value)
+{
+    if (recordDeclaration == nullptr) return;
+    DeclarationEffect effect;
+    effect.type = type;
+    effect.key = key;
+    effect.index = index;
+    effect.value = value;
+    recordDeclaration->effects.append(effect);
+}
@@ -16,6 +16,8 @@
 #include "project.h"
 #include "servers.h"
 #include "git.h"
+#include "projectindexer.h"
+#include "workerlanes.h"
 
 const QString ANDROID_PACK_SUBDIR = "packages";
 const QString ANDROID_BIN_DIR = "bin";
@@ -24,6 +26,17 @@ const QString ANDROID_GIT_TEMPLATES_DIR = "templates";
 const QString ANDROID_PHP_TMP_DIR = "tmp";
 const QString ANDROID_INSTALL_RESULT_LINE_TEMPLATE = "<p>%1</p>";
 const QString PHP_WEBSERVER_URI = "127.0.0.1:8000";
+const int PARSE_PROJECT_PARALLEL_MIN_FILES = 16;
+const int PARSE_PROJECT_PARALLEL_WAIT_INTERVAL = 50;
+const int PARSE_PROJECT_WATCH_MAX_FILES = 50;
+const int QUICK_FIND_FILES_LIMIT = 100;
+const int SEARCH_IN_FILES_MAX_RESULTS = 1000;
+const int SEARCH_IN_FILES_WAIT_INTERVAL = 50;
+const int SEARCH_IN_FILES_TAKE_INTERVAL = 256;
+const int PARSE_REQUEST_MIXED = 0;
+const int PARSE_REQUEST_JS = 1;
+const int PARSE_REQUEST_CSS = 2;
+const int PROCESS_WAIT_INTERVAL = 100;
 
 const QString ZIRA_DEV_PACK_PATH = "/data/data/com.github.ziracms.devpack/files/bin";
 
@@ -36,16 +49,23 @@ ParserWorker::ParserWorker(QObject *parent) : QObject(parent){
     if (phpcsWarningSeverity < 0) phpcsWarningSeverity = 0;
     encoding = Settings::get("editor_encoding");
     encodingFallback = Settings::get("editor_fallback_encoding");
+    parallelIndexingEnabled = Settings::get("parser_enable_parallel_indexing") == "yes";
     enabled = true;
     searchResultsCount = 0;
     searchBreaked = false;
     isBusy = false;
-    quickResultsCount = 0;
-    quickBreaked = false;
-    wantStop = false;
+    wantStop.storeRelease(0);
+    watchPending = false;
+    quickFindFilesMissed = false;
+    parseScheduled = false;
     phpWebServerPid = 0;
-    init();
+    lintServer = nullptr;
+    // tools are detected by one worker, see init()
+}
 
+void ParserWorker::restorePHPWebServerPid()
+{
+    // only the worker that starts web server owns its pid
     QSettings windowSettings;
     if (windowSettings.allKeys().size() > 0 && windowSettings.contains("php_webserver_pid")) {
         int _phpWebServerPid = windowSettings.value("php_webserver_pid").toInt();
@@ -56,6 +76,11 @@ ParserWorker::ParserWorker(QObject *parent) : QObject(parent){
 void ParserWorker::init()
 {   
     phpPath = "";
+    // lint server is started again with the new php path
+    if (lintServer != nullptr) {
+        delete lintServer;
+        lintServer = nullptr;
+    }
     gitPath = "";
     bashPath = "";
     sasscPath = "";
@@ -155,6 +180,39 @@ void ParserWorker::init()
         sasscPath = ZIRA_DEV_PACK_PATH+"/sassc";
     }
     #endif
+
+    // other lanes use the same paths
+    emit toolPathsDetected(phpPath, gitPath, bashPath, sasscPath, phpcsPath);
+}
+
+void ParserWorker::setToolPaths(QString phpPath, QString gitPath, QString bashPath, QString sasscPath, QString phpcsPath)
+{
+    if (phpPath != this->phpPath && lintServer != nullptr) {
+        // lint server is started again with the new php path
+        delete lintServer;
+        lintServer = nullptr;
+    }
+    this->phpPath = phpPath;
+    this->gitPath = gitPath;
+    this->bashPath = bashPath;
+    this->sasscPath = sasscPath;
+    this->phpcsPath = phpcsPath;
+}
+
+bool ParserWorker::waitForProcess(QProcess & process, int msecs)
+{
+    // process is killed on cancel
+    int elapsed = 0;
+    while (!process.waitForFinished(PROCESS_WAIT_INTERVAL)) {
+        elapsed += PROCESS_WAIT_INTERVAL;
+        if (process.state() == QProcess::NotRunning) return false;
+        if (!enabled || wantStop.loadAcquire() || (msecs >= 0 && elapsed >= msecs)) {
+            process.kill();
+            process.waitForFinished();
+            return false;
+        }
+    }
+    return true;
 }
 
 ParserWorker::~ParserWorker()
@@ -163,6 +221,7 @@ ParserWorker::~ParserWorker()
     if (phpWebServerPid != 0) {
         stopPHPWebServer();
     }
+    if (lintServer != nullptr) delete lintServer;
 }
 
 void ParserWorker::disable()
@@ -170,15 +229,28 @@ void ParserWorker::disable()
     enabled = false;
 }
 
-void ParserWorker::lint(int tabIndex, QString path)
+void ParserWorker::lint(int tabIndex, QString path, QString content)
 {
+    wantStop.storeRelease(0); // cancel applies to running process only
     if (phpPath.size() == 0) return; // silence
+    // lint waits for tab parsing, indexing waits for lint
+    WorkerLanes::yield(WORKER_LANE_LINT, wantStop);
+    WorkerLanes::acquire(WORKER_LANE_LINT);
     QStringList errorTexts, errorLines;
-    QProcess process(this);
-    process.start(phpPath, QStringList() << "-n" << "-l" << "-f" << path);
-    if (!process.waitForFinished()) return;
-    QByteArray result = process.readAllStandardOutput();
-    QString errors = QString(result).trimmed();
+    QString errors;
+    if (lintServer == nullptr) lintServer = new LintServer(phpPath);
+    if (!lintServer->lint(path, content, errors)) {
+        // saved file is checked instead of the buffer
+        QProcess process(this);
+        process.start(phpPath, QStringList() << "-n" << "-l" << "-f" << path);
+        if (!waitForProcess(process)) {
+            WorkerLanes::release(WORKER_LANE_LINT);
+            return;
+        }
+        QByteArray result = process.readAllStandardOutput();
+        errors = QString(result).trimmed();
+    }
+    WorkerLanes::release(WORKER_LANE_LINT);
     if (errors.size() > 0 && errors.indexOf("No syntax errors")==0) errors = "";
     if (errors.size() > 0) {
         QRegularExpression errReg = QRegularExpression("(.+?)[ ][i][n][ ].+?[ ][o][n][ ][l][i][n][e][ ](\\d+)");
@@ -198,6 +270,7 @@ void ParserWorker::lint(int tabIndex, QString path)
 
 void ParserWorker::execPHP(int tabIndex, QString path)
 {
+    wantStop.storeRelease(0);
     if (phpPath.size() == 0)  {
         QString msgSuffix = "";
         #if defined(Q_OS_ANDROID)
@@ -208,7 +281,7 @@ void ParserWorker::execPHP(int tabIndex, QString path)
     }
     QProcess process(this);
     process.start(phpPath, QStringList() << "-d" << "max_execution_time=30" << "-f" << path);
-    if (!process.waitForFinished(60000)) return;
+    if (!waitForProcess(process, 60000)) return;
     QString result = QString(process.readAllStandardOutput());
     if (result.size() == 0) result = QString(process.readAllStandardError());
     QString output = QString(result).trimmed();
@@ -217,6 +290,7 @@ void ParserWorker::execPHP(int tabIndex, QString path)
 
 void ParserWorker::execSelection(int tabIndex, QString text)
 {
+    wantStop.storeRelease(0);
     if (phpPath.size() == 0)  {
         QString msgSuffix = "";
         #if defined(Q_OS_ANDROID)
@@ -227,7 +301,7 @@ void ParserWorker::execSelection(int tabIndex, QString text)
     }
     QProcess process(this);
     process.start(phpPath, QStringList() << "-d" << "max_execution_time=30" << "-r" << text);
-    if (!process.waitForFinished(60000)) return;
+    if (!waitForProcess(process, 60000)) return;
     QString result = QString(process.readAllStandardOutput());
     if (result.size() == 0) result = QString(process.readAllStandardError());
     QString output = QString(result).trimmed();
@@ -279,11 +353,13 @@ void ParserWorker::stopPHPWebServer()
 
 void ParserWorker::phpcs(int tabIndex, QString path)
 {
+    wantStop.storeRelease(0);
     if (phpcsPath.size() == 0) return; //silence
+    WorkerLanes::yield(WORKER_LANE_LINT, wantStop);
     QStringList errorTexts, errorLines;
     QProcess process(this);
     process.start(phpcsPath, QStringList() << "--standard="+phpcsStandard << "--error-severity="+Helper::intToStr(phpcsErrorSeverity) << "--warning-severity="+Helper::intToStr(phpcsWarningSeverity) << "--report=csv" << path);
-    if (!process.waitForFinished()) return;
+    if (!waitForProcess(process)) return;
     QByteArray result = process.readAllStandardOutput();
     QString errors = QString(result).trimmed();
     if (errors.indexOf("ERROR:")==0) return;
@@ -321,25 +397,113 @@ void ParserWorker::phpcs(int tabIndex, QString path)
     emit phpcsFinished(tabIndex, errorTexts, errorLines);
 }
 
-void ParserWorker::parseMixed(int tabIndex, QString text)
+void ParserWorker::parseMixed(int editorId, int revision, QString text)
 {
-    ParsePHP parser;
-    ParsePHP::ParseResult result = parser.parse(text);
-    emit parseMixedFinished(tabIndex, result);
+    queueParseRequest(PARSE_REQUEST_MIXED, editorId, revision, text);
 }
 
-void ParserWorker::parseJS(int tabIndex, QString text)
+void ParserWorker::parseJS(int editorId, int revision, QString text)
 {
-    ParseJS parser;
-    ParseJS::ParseResult result = parser.parse(text);
-    emit parseJSFinished(tabIndex, result);
+    queueParseRequest(PARSE_REQUEST_JS, editorId, revision, text);
 }
 
-void ParserWorker::parseCSS(int tabIndex, QString text)
+void ParserWorker::parseCSS(int editorId, int revision, QString text)
 {
-    ParseCSS parser;
-    ParseCSS::ParseResult result = parser.parse(text);
-    emit parseCSSFinished(tabIndex, result);
+    queueParseRequest(PARSE_REQUEST_CSS, editorId, revision, text);
+}
+
+void ParserWorker::queueParseRequest(int type, int editorId, int revision, QString text)
+{
+    // newer request of the same editor replaces the queued one
+    bool found = false;
+    for (int i=0; i<parseRequests.size(); i++) {
+        if (parseRequests.at(i).editorId != editorId) continue;
+        if (parseRequests.at(i).revision <= revision) {
+            parseRequests[i].type = type;
+            parseRequests[i].revision = revision;
+            parseRequests[i].text = text;
+        }
+        found = true;
+        break;
+    }
+    if (!found) {
+        ParseRequest request;
+        request.type = type;
+        request.editorId = editorId;
+        request.revision = revision;
+        request.text = text;
+        parseRequests.append(request);
+    }
+    WorkerLanes::setPending(WORKER_LANE_INTERACTIVE, parseRequests.size());
+    scheduleParseRequests();
+}
+
+void ParserWorker::scheduleParseRequests()
+{
+    if (parseScheduled || parseRequests.size() == 0) return;
+    parseScheduled = true;
+    // runs after the requests already queued to this thread are collected
+    QMetaObject::invokeMethod(this, "processParseRequests", Qt::QueuedConnection);
+}
+
+quint64 hashParseText(const QString & text)
+{
+    // 64-bit FNV-1a, collisions are unlikely enough to skip comparing the text
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    const ushort * data = text.utf16();
+    for (int i=0; i<text.size(); i++) {
+        hash ^= data[i];
+        hash *= Q_UINT64_C(1099511628211);
+    }
+    return hash;
+}
+
+bool ParserWorker::takeCachedParseResult(const ParseRequest & request, quint64 textHash)
+{
+    // unchanged text is not parsed again, e.g. when switching tabs
+    QHash<int, ParseCache>::const_iterator it = parseCache.constFind(request.editorId);
+    if (it == parseCache.constEnd()) return false;
+    const ParseCache & cache = it.value();
+    if (cache.type != request.type || cache.textLength != request.text.size() || cache.textHash != textHash) return false;
+    if (request.type == PARSE_REQUEST_MIXED) {
+        emit parseMixedFinished(request.editorId, request.revision, cache.phpResult);
+    } else if (request.type == PARSE_REQUEST_JS) {
+        emit parseJSFinished(request.editorId, request.revision, cache.jsResult);
+    } else if (request.type == PARSE_REQUEST_CSS) {
+        emit parseCSSFinished(request.editorId, request.revision, cache.cssResult);
+    }
+    return true;
+}
+
+void ParserWorker::processParseRequests()
+{
+    parseScheduled = false;
+    if (!enabled || parseRequests.size() == 0) return;
+    ParseRequest request = parseRequests.takeFirst();
+    quint64 textHash = hashParseText(request.text);
+    if (!takeCachedParseResult(request, textHash)) {
+        // cache holds one result per open editor, the text itself is not kept
+        ParseCache cache;
+        cache.type = request.type;
+        cache.textHash = textHash;
+        cache.textLength = request.text.size();
+        if (request.type == PARSE_REQUEST_MIXED) {
+            // parser of the editor keeps its declarations, unchanged ones are not parsed again
+            cache.phpResult = phpParsers[request.editorId].parseIncremental(request.text);
+            emit parseMixedFinished(request.editorId, request.revision, cache.phpResult);
+        } else if (request.type == PARSE_REQUEST_JS) {
+            ParseJS parser;
+            cache.jsResult = parser.parse(request.text);
+            emit parseJSFinished(request.editorId, request.revision, cache.jsResult);
+        } else if (request.type == PARSE_REQUEST_CSS) {
+            ParseCSS parser;
+            cache.cssResult = parser.parse(request.text);
+            emit parseCSSFinished(request.editorId, request.revision, cache.cssResult);
+        }
+        parseCache.insert(request.editorId, cache);
+    }
+    WorkerLanes::setPending(WORKER_LANE_INTERACTIVE, parseRequests.size());
+    scheduleParseRequests();
 }
 
 void ParserWorker::parseProject(QString path)
@@ -349,50 +513,204 @@ void ParserWorker::parseProject(QString path)
         return;
     }
     isBusy = true;
-    wantStop = false;
+    wantStop.storeRelease(0);
     QStringList files;
     emit activateProgress();
     emit activateProgressInfo(tr("Scanning")+": "+path);
-    parseProjectDir(path, files);
+    PathFilter filter(path);
+    parseProjectDir(path, files, filter);
     QVariantMap map = Project::createPHPResultMap();
-    QVariantMap data = Project::loadPHPDataMap(path);
-    Project::checkParsePHPFilesModified(files, data, map);
+    ProjectIndex index;
+    Project::loadPHPDataIndex(path, index);
+    Project::checkParsePHPFilesModified(files, index, map);
+    index.close();
     bool isBreaked = false;
     bool isModified = files.count() > 0;
-    for (int i=0; i<files.size(); i++) {
-        if (!enabled || wantStop) {
-            isBreaked = true;
-            break;
+    if (parallelIndexingEnabled && files.size() >= PARSE_PROJECT_PARALLEL_MIN_FILES && ProjectIndexer::isAvailable()) {
+        isBreaked = !parseProjectFilesParallel(files, map);
+    } else {
+        for (int i=0; i<files.size(); i++) {
+            if (!enabled || wantStop.loadAcquire()) {
+                isBreaked = true;
+                break;
+            }
+            QString file = files.at(i);
+            parseProjectFile(file, map);
+            int v = (i + 1) * 100 / files.size();
+            emit parseProjectProgress(v);
         }
-        QString file = files.at(i);
-        parseProjectFile(file, map);
-        int v = (i + 1) * 100 / files.size();
-        emit parseProjectProgress(v);
     }
     if (!isBreaked && isModified) {
         emit updateProgressInfo(tr("Updating project")+"...");
         Project::savePHPResults(path, map);
     }
     map.clear();
-    data.clear();
     files.clear();
     emit parseProjectFinished(!isBreaked, isModified);
     emit deactivateProgress();
     emit deactivateProgressInfo();
     isBusy = false;
-    wantStop = false;
+    wantStop.storeRelease(0);
+    checkProjectChangesPending();
+}
+
+void ParserWorker::updateProjectFile(QString path, QString file, ParsePHP::ParseResult result)
+{
+    if (isBusy) {
+        // file is re-read from disk when worker is free
+        checkProjectChanges(path, QStringList() << file);
+        return;
+    }
+    if (!Helper::fileExists(file)) return;
+    QVariantMap map = Project::createPHPResultMap();
+    QFileInfo fInfo(file);
+    QString lastModified = QString::number(fInfo.lastModified().toMSecsSinceEpoch());
+    Project::parsePHPResult(result, map, file, lastModified);
+    updateProjectFiles(path, QStringList() << file, map);
+}
+
+void ParserWorker::updateProjectFiles(QString path, QStringList files, QVariantMap & map)
+{
+    isBusy = true;
+    ProjectIndex index;
+    if (Project::loadPHPDataIndex(path, index)) {
+        QVariantMap oldMap = Project::createPHPResultMap();
+        Project::loadPHPDataIndexFiles(index, files, oldMap);
+        if (Project::updatePHPResults(path, index, files, oldMap, map)) {
+            emit updateProjectFileFinished(oldMap, map);
+        }
+    }
+    isBusy = false;
+    checkProjectChangesPending();
+}
+
+void ParserWorker::updateFileIndex(QString path, QStringList paths)
+{
+    // changes are applied when the index being built is ready
+    if (fileIndexPendingPath == path && paths.size() > 0) fileIndexPendingPaths.append(paths);
+    if (!fileIndex.isBuilt() || fileIndex.getPath() != path) return;
+    // polling mode invalidates the index
+    if (paths.size() > 0) fileIndex.update(paths);
+    else fileIndex.clear();
 }
 
-void ParserWorker::parseProjectDir(QString dir, QStringList & files)
+void ParserWorker::checkProjectChanges(QString path, QStringList paths)
+{
+    if (isBusy) {
+        // changes are checked when worker is free
+        if (!watchPending) watchPaths = paths;
+        else if (watchPaths.size() > 0 && paths.size() > 0) watchPaths.append(paths);
+        else watchPaths.clear(); // checks all files
+        watchProjectPath = path;
+        watchPending = true;
+        return;
+    }
+    ProjectIndex index;
+    if (!Project::loadPHPDataIndex(path, index)) return;
+    QStringList candidates, deletedFiles;
+    PathFilter filter(path);
+    if (paths.size() == 0) {
+        // polling mode
+        parseProjectDir(path, candidates, filter);
+        for (int i=0; i<index.getFilesCount(); i++) {
+            QString file = index.getFilePath(i);
+            // files replaced by index overlay have no path
+            if (file.size() > 0 && !Helper::fileExists(file)) deletedFiles.append(file);
+        }
+    } else {
+        for (int i=0; i<paths.size(); i++) {
+            QString p = paths.at(i);
+            QFileInfo fInfo(p);
+            if (fInfo.isDir() && !filter.isIgnored(p, true)) {
+                QDirIterator it(p, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+                while (it.hasNext()) {
+                    QString _path = it.next();
+                    QFileInfo _fInfo = it.fileInfo();
+                    if (!_fInfo.exists() || !_fInfo.isReadable()) continue;
+                    if (filter.isIgnored(_path, _fInfo.isDir())) continue;
+                    if (_fInfo.isDir()) {
+                        // new directories are scanned
+                        if (index.getDirectoryFilesRecursive(_path).size() == 0) parseProjectDir(_path, candidates, filter);
+                    } else if (_fInfo.isFile() && Project::isProjectFile(_path) && !filter.isFileTooLarge(_fInfo.size())) {
+                        candidates.append(_path);
+                    }
+                }
+            } else if (!fInfo.isDir() && Project::isProjectFile(p) && !filter.isIgnored(p, false) && !filter.isFileTooLarge(fInfo.size())) {
+                candidates.append(p);
+            }
+            // changed directory checks its own files and subdirectories, files of removed directory are all deleted
+            QStringList indexFiles;
+            if (fInfo.exists()) {
+                indexFiles = index.getDirectoryFiles(p);
+                QStringList subdirs = index.getDirectorySubdirs(p);
+                for (int y=0; y<subdirs.size(); y++) {
+                    if (!Helper::folderExists(subdirs.at(y))) indexFiles.append(index.getDirectoryFilesRecursive(subdirs.at(y)));
+                }
+            } else {
+                indexFiles = index.getDirectoryFilesRecursive(p);
+            }
+            indexFiles.append(p);
+            for (int y=0; y<indexFiles.size(); y++) {
+                QString file = indexFiles.at(y);
+                if (!Helper::fileExists(file) && index.findFile(file) >= 0) deletedFiles.append(file);
+            }
+        }
+    }
+    QStringList modifiedFiles;
+    candidates.removeDuplicates();
+    for (int i=0; i<candidates.size(); i++) {
+        QString file = candidates.at(i);
+        if (!Helper::fileExists(file)) continue;
+        int fileIndex = index.findFile(file);
+        QFileInfo fInfo(file);
+        if (fileIndex >= 0 && fInfo.lastModified().toMSecsSinceEpoch() == index.getFileLastModified(fileIndex)) continue;
+        modifiedFiles.append(file);
+    }
+    deletedFiles.removeDuplicates();
+    index.close();
+    if (modifiedFiles.size() == 0 && deletedFiles.size() == 0) return;
+    if (modifiedFiles.size() + deletedFiles.size() > PARSE_PROJECT_WATCH_MAX_FILES) {
+        // large changes are handled by project scan
+        parseProject(path);
+        return;
+    }
+    QVariantMap map = Project::createPHPResultMap();
+    ParsePHP parser;
+    for (int i=0; i<modifiedFiles.size(); i++) {
+        WorkerLanes::yield(WORKER_LANE_INDEX, wantStop);
+        QString file = modifiedFiles.at(i);
+        QString content = Helper::loadTextFile(file, encoding, encodingFallback, true);
+        ParsePHP::ParseResult result = parser.parse(content);
+        QFileInfo fInfo(file);
+        QString lastModified = QString::number(fInfo.lastModified().toMSecsSinceEpoch());
+        Project::parsePHPResult(result, map, file, lastModified);
+    }
+    updateProjectFiles(path, modifiedFiles + deletedFiles, map);
+}
+
+void ParserWorker::checkProjectChangesPending()
+{
+    if (!watchPending || isBusy) return;
+    QString path = watchProjectPath;
+    QStringList paths = watchPaths;
+    watchPending = false;
+    watchProjectPath = "";
+    watchPaths.clear();
+    checkProjectChanges(path, paths);
+}
+
+void ParserWorker::parseProjectDir(QString dir, QStringList & files, PathFilter & filter)
 {
     QDirIterator it(dir, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
     while (it.hasNext()) {
         QString path = it.next();
-        QFileInfo fInfo(path);
+        QFileInfo fInfo = it.fileInfo();
         if (!fInfo.exists() || !fInfo.isReadable()) continue;
+        // ignored directories are pruned with their whole subtree
+        if (filter.isIgnored(path, fInfo.isDir())) continue;
         if (fInfo.isDir()) {
-            parseProjectDir(path, files);
-        } else if (fInfo.isFile() && Project::isProjectFile(path)) {
+            parseProjectDir(path, files, filter);
+        } else if (fInfo.isFile() && Project::isProjectFile(path) && !filter.isFileTooLarge(fInfo.size())) {
             files.append(path);
         }
     }
@@ -401,7 +719,8 @@ void ParserWorker::parseProjectDir(QString dir, QStringList & files)
 void ParserWorker::parseProjectFile(QString file, QVariantMap & map)
 {
     QCoreApplication::processEvents();
-    if (wantStop) return;
+    WorkerLanes::yield(WORKER_LANE_INDEX, wantStop);
+    if (wantStop.loadAcquire()) return;
     if (!Helper::fileExists(file)) return;
     emit updateProgressInfo(tr("Scanning")+": "+file);
     QString content = Helper::loadTextFile(file, encoding, encodingFallback, true);
@@ -413,6 +732,37 @@ void ParserWorker::parseProjectFile(QString file, QVariantMap & map)
     Project::parsePHPResult(result, map, file, dts);
 }
 
+bool ParserWorker::parseProjectFilesParallel(QStringList & files, QVariantMap & map)
+{
+    ProjectIndexer indexer(files, encoding, encodingFallback);
+    indexer.start();
+    QString file, lastModified;
+    ParsePHP::ParseResult result;
+    int merged = 0, progress = -1;
+    while (merged < files.size()) {
+        QCoreApplication::processEvents();
+        if (!enabled || wantStop.loadAcquire()) {
+            indexer.cancel();
+            return false;
+        }
+        // merging in the order of files list to keep results identical to sequential scan
+        while (indexer.takeNext(file, result, lastModified)) {
+            merged++;
+            if (lastModified.size() == 0) continue;
+            Project::parsePHPResult(result, map, file, lastModified);
+        }
+        int parsed = indexer.getParsedCount();
+        int v = parsed * 100 / files.size();
+        if (v != progress) {
+            progress = v;
+            emit parseProjectProgress(v);
+            emit updateProgressInfo(tr("Scanning")+": "+QString::number(parsed)+" / "+QString::number(files.size()));
+        }
+        if (merged < files.size()) indexer.wait(PARSE_PROJECT_PARALLEL_WAIT_INTERVAL);
+    }
+    return true;
+}
+
 void ParserWorker::searchInFiles(QString searchDirectory, QString searchText, QString searchExtensions, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp, QStringList excludeDirs)
 {
     if (isBusy) {
@@ -420,7 +770,7 @@ void ParserWorker::searchInFiles(QString searchDirectory, QString searchText, QS
         return;
     }
     isBusy = true;
-    wantStop = false;
+    wantStop.storeRelease(0);
     if (!Helper::folderExists(searchDirectory) || searchText.size() == 0) return;
     emit activateProgress();
     emit activateProgressInfo(tr("Searching in")+": "+searchDirectory);
@@ -437,27 +787,39 @@ void ParserWorker::searchInFiles(QString searchDirectory, QString searchText, QS
     }
     searchResultsCount = 0;
     searchBreaked = false;
-    searchInDir(searchDirectory, searchText, allowedExtensions, searchOptionCase, searchOptionWord, searchOptionRegexp, excludeDirs);
+    FileSearcher searcher(searchText, searchOptionCase, searchOptionWord, searchOptionRegexp, encoding, encodingFallback);
+    searcher.start();
+    PathFilter filter(searchDirectory);
+    searchInDir(searcher, filter, searchDirectory, allowedExtensions, excludeDirs);
+    searcher.finish();
+    while (!searchBreaked && !searcher.isDone()) {
+        QCoreApplication::processEvents();
+        if (!enabled || wantStop.loadAcquire()) break;
+        takeSearchResults(searcher);
+        if (!searcher.isDone()) searcher.wait(SEARCH_IN_FILES_WAIT_INTERVAL);
+    }
+    searcher.cancel();
+    if (searchBreaked) emit searchInFilesFound("", tr("Too many results. Search stopped."), -1, -1);
     emit searchInFilesFinished();
     emit deactivateProgress();
     emit deactivateProgressInfo();
     isBusy = false;
-    wantStop = false;
+    wantStop.storeRelease(0);
 }
 
-void ParserWorker::searchInDir(QString searchDirectory, QString searchText, QString searchExtensions, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp, QStringList excludeDirs)
+void ParserWorker::searchInDir(FileSearcher & searcher, PathFilter & filter, QString searchDirectory, QString searchExtensions, QStringList excludeDirs)
 {
     QDirIterator it(searchDirectory, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
     while (it.hasNext()) {
         if (!enabled) break;
-        if (searchBreaked || wantStop) break;
+        if (searchBreaked || wantStop.loadAcquire()) break;
         QString path = it.next();
-        QFileInfo fInfo(path);
+        QFileInfo fInfo = it.fileInfo();
         if (!fInfo.exists() || !fInfo.isReadable()) continue;
-        if (fInfo.isDir() && (fInfo.fileName() == ".git" || fInfo.fileName() == PROJECT_SUBDIR || fInfo.fileName() == ".idea" || fInfo.fileName() == ".vscode" || fInfo.fileName() == "nbproject")) continue;
+        if (filter.isIgnored(path, fInfo.isDir())) continue;
         if (fInfo.isDir() && excludeDirs.contains(fInfo.absoluteFilePath())) continue;
         if (fInfo.isDir()) {
-            searchInDir(path, searchText, searchExtensions, searchOptionCase, searchOptionWord, searchOptionRegexp, excludeDirs);
+            searchInDir(searcher, filter, path, searchExtensions, excludeDirs);
         } else if (fInfo.isFile()) {
             if (searchExtensions.size() > 0) {
                 int p = path.lastIndexOf(".");
@@ -466,84 +828,39 @@ void ParserWorker::searchInDir(QString searchDirectory, QString searchText, QStr
                 if (ext.size() == 0) continue;
                 if (searchExtensions.indexOf("*"+ext+";") < 0) continue;
             }
-            searchInFile(path, searchText, searchOptionCase, searchOptionWord, searchOptionRegexp);
+            if (filter.isFileTooLarge(fInfo.size())) continue;
+            // files are searched while the directory walk goes on
+            searcher.addFile(path);
+            if (searcher.getFilesCount() % SEARCH_IN_FILES_TAKE_INTERVAL == 0) {
+                QCoreApplication::processEvents();
+                takeSearchResults(searcher);
+            }
         }
     }
 }
 
-void ParserWorker::searchInFile(QString file, QString searchText, bool searchOptionCase, bool searchOptionWord, bool searchOptionRegexp)
+void ParserWorker::takeSearchResults(FileSearcher & searcher)
 {
-    QCoreApplication::processEvents();
-    if (wantStop) return;
-    if (!Helper::fileExists(file) || searchText.size() == 0) return;
-    emit updateProgressInfo(tr("Searching in")+": "+file);
-    QString content = Helper::loadTextFile(file, encoding, encodingFallback, true);
-    Parse parser;
-    if (!searchOptionWord && !searchOptionRegexp) {
-        // regular search
-        int p = -1, offset = 0;
-        Qt::CaseSensitivity cs = searchOptionCase ? Qt::CaseSensitive : Qt::CaseInsensitive;
-        do {
-            if (searchBreaked || wantStop) break;
-            p = content.indexOf(searchText, offset, cs);
-            if (p >= 0) {
-                offset = p + searchText.size();
-                int line = parser.getLine(content, p);
-                QString lineText = parser.getLineText(content, p);
-                searchInFilesResultFound(file, lineText, line, p);
-            }
-        } while (p >= 0);
-    } else if (searchOptionWord) {
-        // search whole words
-        int p = -1, offset = 0;
-        QRegularExpression::PatternOptions opt = QRegularExpression::NoPatternOption;
-        if (!searchOptionCase) opt = QRegularExpression::CaseInsensitiveOption;
-        QRegularExpression regexp = QRegularExpression("\\b"+QRegularExpression::escape(searchText)+"\\b", opt);
-        if (!regexp.isValid()) return;
-        do {
-            if (searchBreaked || wantStop) break;
-            QRegularExpressionMatch match = regexp.match(content, offset);
-            p = match.capturedStart();
-            if (p >= 0) {
-                offset = p + match.capturedLength();
-                int line = parser.getLine(content, p);
-                QString lineText = parser.getLineText(content, p);
-                searchInFilesResultFound(file, lineText, line, p);
-            }
-        } while (p >= 0);
-    } else if (searchOptionRegexp) {
-        // search regexp
-        int p = -1, offset = 0;
-        QRegularExpression::PatternOptions opt = QRegularExpression::NoPatternOption;
-        if (!searchOptionCase) opt = QRegularExpression::CaseInsensitiveOption;
-        QRegularExpression regexp = QRegularExpression(searchText, opt);
-        if (!regexp.isValid()) return;
-        do {
-            if (searchBreaked || wantStop) break;
-            QRegularExpressionMatch match = regexp.match(content, offset);
-            p = match.capturedStart();
-            if (p >= 0) {
-                offset = p + match.capturedLength();
-                int line = parser.getLine(content, p);
-                QString lineText = parser.getLineText(content, p);
-                searchInFilesResultFound(file, lineText, line, p);
+    // results are sent in batches in the order of walked files
+    QString file = "";
+    FileSearcher::Results fileResults, results;
+    while (!searchBreaked && searcher.takeNext(file, fileResults)) {
+        for (int i=0; i<fileResults.size(); i++) {
+            results.append(fileResults.at(i));
+            searchResultsCount++;
+            if (searchResultsCount >= SEARCH_IN_FILES_MAX_RESULTS) {
+                searchBreaked = true;
+                break;
             }
-        } while (p >= 0);
-    }
-}
-
-void ParserWorker::searchInFilesResultFound(QString file, QString lineText, int line, int symbol)
-{
-    searchResultsCount++;
-    emit searchInFilesFound(file, lineText, line, symbol);
-    if (searchResultsCount >= 1000) {
-        searchBreaked = true;
-        emit searchInFilesFound("", tr("Too many results. Search stopped."), -1, -1);
+        }
     }
+    if (results.size() > 0) emit searchInFilesResultsFound(results);
+    if (file.size() > 0) emit updateProgressInfo(tr("Searching in")+": "+file);
 }
 
 void ParserWorker::gitCommand(QString path, QString command, QStringList attrs, bool outputResult, bool silent)
 {
+    wantStop.storeRelease(0);
     if (gitPath.size() == 0) {
         QString msgSuffix = "";
         #if defined(Q_OS_ANDROID)
@@ -559,7 +876,7 @@ void ParserWorker::gitCommand(QString path, QString command, QStringList attrs,
     QProcess process(this);
     process.setWorkingDirectory(path);
     process.start(gitPath, QStringList() << command << attrs);
-    if (!process.waitForFinished(300000)) {
+    if (!waitForProcess(process, 300000)) {
         if (useProgress && !isBusy) emit deactivateProgress();
         return;
     }
@@ -571,6 +888,7 @@ void ParserWorker::gitCommand(QString path, QString command, QStringList attrs,
 
 void ParserWorker::serversCommand(QString command, QString pwd)
 {
+    wantStop.storeRelease(0);
     if (bashPath.size() == 0) {
         emit message(tr("Bash not found."));
         return;
@@ -581,7 +899,7 @@ void ParserWorker::serversCommand(QString command, QString pwd)
     // apache2
     QProcess processApache(this);
     processApache.start(bashPath, QStringList() << "-c" << Servers::generateApacheServiceCommand(command, pwd));
-    if (!processApache.waitForFinished(300000)) {
+    if (!waitForProcess(processApache, 300000)) {
         if (!isBusy) emit deactivateProgress();
         return;
     }
@@ -609,7 +927,7 @@ void ParserWorker::serversCommand(QString command, QString pwd)
     QString errorMariadb = "";
     QProcess processMariadb(this);
     processMariadb.start(bashPath, QStringList() << "-c" << Servers::generateMariaDBServiceCommand(command, pwd));
-    if (!processMariadb.waitForFinished(300000)) {
+    if (!waitForProcess(processMariadb, 300000)) {
         if (!isBusy) emit deactivateProgress();
         return;
     }
@@ -644,6 +962,7 @@ void ParserWorker::serversCommand(QString command, QString pwd)
 
 void ParserWorker::sassCommand(QString src, QString dst)
 {
+    wantStop.storeRelease(0);
     if (sasscPath.size() == 0) {
         QString msgSuffix = "";
         #if defined(Q_OS_ANDROID)
@@ -657,7 +976,7 @@ void ParserWorker::sassCommand(QString src, QString dst)
     if (!isBusy) emit activateProgress();
     QProcess process(this);
     process.start(sasscPath, QStringList() << src << dst);
-    if (!process.waitForFinished()) {
+    if (!waitForProcess(process)) {
         if (!isBusy) emit deactivateProgress();
         return;
     }
@@ -670,14 +989,12 @@ void ParserWorker::sassCommand(QString src, QString dst)
     if (!isBusy) emit deactivateProgress();
 }
 
-void ParserWorker::quickFind(QString dir, QString text, WordsMapList words, QStringList wordPrefixes)
+void ParserWorker::quickFind(QString dir, QString text, WordsMapList words, QStringList wordPrefixes, bool dirWatched)
 {
     if (!isBusy) emit activateProgress();
-    quickResultsCount = 0;
-    quickBreaked = false;
     // words
     int it = 0;
-    for (auto wordsList : words) {
+    for (const auto & wordsList : words) {
         //QCoreApplication::processEvents();
         if (!enabled) break;
         QString prefix = "";
@@ -685,7 +1002,7 @@ void ParserWorker::quickFind(QString dir, QString text, WordsMapList words, QStr
         it++;
         int co = 0;
         // words
-        for (auto it : wordsList) {
+        for (const auto & it : wordsList) {
             QString name = QString::fromStdString(it.first);
             if (name.indexOf(text, 0, Qt::CaseInsensitive) >= 0) {
                 QString dec_str = QString::fromStdString(it.second);
@@ -701,42 +1018,74 @@ void ParserWorker::quickFind(QString dir, QString text, WordsMapList words, QStr
         }
     }
     // search files
-    quickFindInDir(dir, dir, text);
+    if (enabled) quickFindFiles(dir, text, dirWatched);
     if (!isBusy) emit deactivateProgress();
 }
 
-void ParserWorker::quickFindInDir(QString startDir, QString dir, QString text)
+void ParserWorker::quickFindFiles(QString dir, QString text, bool dirWatched)
 {
-    QString prefix = "file: ";
-    QDirIterator it(dir, QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
-    while (it.hasNext()) {
-        //QCoreApplication::processEvents();
-        if (!enabled) break;
-        if (quickBreaked) break;
-        QString path = it.next();
-        QFileInfo fInfo(path);
-        if (!fInfo.exists() || !fInfo.isReadable()) continue;
-        if (fInfo.isDir() && (fInfo.fileName() == ".git" || fInfo.fileName() == PROJECT_SUBDIR || fInfo.fileName() == ".idea" || fInfo.fileName() == ".vscode" || fInfo.fileName() == "nbproject")) continue;
-        if (fInfo.isDir()) {
-            quickFindInDir(startDir, path, text);
-        } else if (fInfo.isFile()) {
-            if (fInfo.fileName().indexOf(text, 0, Qt::CaseInsensitive) >= 0) {
-                QString info = path;
-                if (info.size() > startDir.size()) info = info.mid(startDir.size()+1);
-                emit quickFound(text, prefix+info, path, 1);
-                quickResultsCount++;
-                if (quickResultsCount >= 100) {
-                    quickBreaked = true;
-                    break;
-                }
-            }
+    // directory is scanned on index lane, watched project keeps the index up to date
+    if (!fileIndex.isBuilt() || fileIndex.getPath() != dir || (!dirWatched && fileIndex.isExpired())) {
+        if (fileIndexPendingPath != dir) {
+            fileIndexPendingPath = dir;
+            fileIndexPendingPaths.clear();
+            emit fileIndexRequested(dir);
         }
     }
+    quickFindDir = dir;
+    quickFindText = text;
+    // ready index is used until the new one is built
+    quickFindFilesMissed = !fileIndex.isBuilt() || fileIndex.getPath() != dir;
+    if (!quickFindFilesMissed) quickFindIndexedFiles(text);
+}
+
+void ParserWorker::quickFindIndexedFiles(QString text)
+{
+    QString prefix = "file: ";
+    std::vector<FileIndex::Match> matches;
+    fileIndex.find(text, matches, QUICK_FIND_FILES_LIMIT);
+    for (auto & match : matches) {
+        emit quickFound(text, prefix+match.entry->relativePath, match.entry->path, 1);
+    }
+}
+
+void ParserWorker::buildFileIndex(QString dir)
+{
+    FileIndex index;
+    index.build(dir);
+    emit fileIndexBuilt(index);
+}
+
+void ParserWorker::setFileIndex(FileIndex index)
+{
+    // outdated builds are dropped
+    if (index.getPath() != fileIndexPendingPath) return;
+    fileIndex = index;
+    fileIndexPendingPath = "";
+    if (fileIndexPendingPaths.size() > 0) fileIndex.update(fileIndexPendingPaths);
+    fileIndexPendingPaths.clear();
+    // last search had no files, so they are added now
+    if (quickFindFilesMissed && quickFindDir == fileIndex.getPath() && quickFindText.size() > 0) {
+        quickFindFilesMissed = false;
+        quickFindIndexedFiles(quickFindText);
+    }
+}
+
+void ParserWorker::releaseEditor(int editorId)
+{
+    // closed editor ids are not reused
+    parseCache.remove(editorId);
+    phpParsers.erase(editorId);
+    for (int i=parseRequests.size()-1; i>=0; i--) {
+        if (parseRequests.at(i).editorId == editorId) parseRequests.removeAt(i);
+    }
+    WorkerLanes::setPending(WORKER_LANE_INTERACTIVE, parseRequests.size());
 }
 
 void ParserWorker::cancelRequested()
 {
-    wantStop = true;
+    // called directly from GUI thread, so that blocked lanes see it too
+    wantStop.storeRelease(1);
 }
 
 bool ParserWorker::createAndroidDirectory(QDir rootDir, QString path)
@@ -788,6 +1137,7 @@ void ParserWorker::installAndroidPack()
     if (androidHomePath.size() == 0) return;
     if (isAndroidPackInstalled()) {
         setAndroidBinPaths();
+        emit toolPathsDetected(phpPath, gitPath, bashPath, sasscPath, phpcsPath);
         return;
     }
 
@@ -818,6 +1168,7 @@ void ParserWorker::installAndroidPack()
             result += ANDROID_INSTALL_RESULT_LINE_TEMPLATE.arg(QString(sasscResult).trimmed().split("\n").at(0));
         }
         setAndroidBinPaths();
+        emit toolPathsDetected(phpPath, gitPath, bashPath, sasscPath, phpcsPath);
         emit installAndroidPackFinished(ANDROID_INSTALL_RESULT_LINE_TEMPLATE.arg(tr("Development pack successfully installed."))+result);
     } else {
         emit installAndroidPackFinished(ANDROID_INSTALL_RESULT_LINE_TEMPLATE.arg(tr("Installation failed :(")));
@@ -0,0 +1,214 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "pathfilter.h"
+#include <QStringList>
+#include "helper.h"
+#include "settings.h"
+#include "project.h"
+
+const QString PATH_FILTER_GIT_IGNORE_FILE = ".gitignore";
+const QString PATH_FILTER_IGNORE_FILE = ".ignore";
+const QString PATH_FILTER_PROJECT_EXCLUDE_FILE = "exclude";
+const std::string PATH_FILTER_ENCODING = "UTF-8";
+
+const int PATH_FILTER_RULE_EXACT = 0;
+const int PATH_FILTER_RULE_SUFFIX = 1;
+const int PATH_FILTER_RULE_WILDCARD = 2;
+
+const int PATH_FILTER_NO_MATCH = 0;
+const int PATH_FILTER_MATCH_IGNORED = 1;
+const int PATH_FILTER_MATCH_INCLUDED = 2;
+
+PathFilter::PathFilter(QString rootDir)
+{
+    if (rootDir.size() > 1 && rootDir.endsWith("/")) rootDir.chop(1);
+    rootPath = rootDir;
+    rootPrefix = rootPath.endsWith("/") ? rootPath : rootPath + "/";
+    ignoreFilesEnabled = Settings::get("parser_enable_ignore_files") == "yes";
+    // size limit is set in kilobytes, zero disables it
+    maxFileSize = static_cast<qint64>(std::stoi(Settings::get("parser_max_file_size"))) * 1024;
+}
+
+QString PathFilter::getRootPath()
+{
+    return rootPath;
+}
+
+bool PathFilter::isExcludedDirectoryName(const QString & name)
+{
+    return name == ".git" || name == PROJECT_SUBDIR || name == ".idea" || name == ".vscode" || name == "nbproject";
+}
+
+bool PathFilter::isFileTooLarge(qint64 size)
+{
+    return maxFileSize > 0 && size > maxFileSize;
+}
+
+QString PathFilter::getParentPath(const QString & path)
+{
+    int p = path.lastIndexOf("/");
+    if (p < 0) return "";
+    if (p == 0) return "/";
+    return path.mid(0, p);
+}
+
+QString PathFilter::getRelativePath(const QString & dir, const QString & path)
+{
+    if (dir.endsWith("/")) return path.mid(dir.size());
+    return path.mid(dir.size() + 1);
+}
+
+bool PathFilter::isIgnored(const QString & path, bool isDir)
+{
+    QString name = path.mid(path.lastIndexOf("/") + 1);
+    if (isDir && isExcludedDirectoryName(name)) return true;
+    if (rootPath.size() == 0 || !path.startsWith(rootPrefix)) return false;
+    // rules of nested directories take precedence over the parent ones
+    QString dir = getParentPath(path);
+    while (dir.size() >= rootPath.size()) {
+        const QVector<Rule> & rules = getRules(dir);
+        if (rules.size() > 0) {
+            int result = matchRules(rules, getRelativePath(dir, path), name, isDir);
+            if (result != PATH_FILTER_NO_MATCH) return result == PATH_FILTER_MATCH_IGNORED;
+        }
+        if (dir == rootPath || dir == "/") break;
+        dir = getParentPath(dir);
+    }
+    return false;
+}
+
+const QVector<PathFilter::Rule> & PathFilter::getRules(const QString & dir)
+{
+    // ignore files are read once, when a path of their directory is checked first
+    QHash<QString, QVector<Rule>>::const_iterator it = rulesMap.constFind(dir);
+    if (it != rulesMap.constEnd()) return it.value();
+    QVector<Rule> rules;
+    QString prefix = dir.endsWith("/") ? dir : dir + "/";
+    if (ignoreFilesEnabled) {
+        loadRulesFile(prefix + PATH_FILTER_GIT_IGNORE_FILE, rules);
+        loadRulesFile(prefix + PATH_FILTER_IGNORE_FILE, rules);
+    }
+    if (dir == rootPath) {
+        loadRulesFile(prefix + PROJECT_SUBDIR + "/" + PATH_FILTER_PROJECT_EXCLUDE_FILE, rules);
+    }
+    return rulesMap.insert(dir, rules).value();
+}
+
+void PathFilter::loadRulesFile(QString file, QVector<Rule> & rules)
+{
+    if (!Helper::fileExists(file)) return;
+    QString content = Helper::loadTextFile(file, PATH_FILTER_ENCODING, PATH_FILTER_ENCODING, true);
+    QStringList lines = content.split("\n");
+    for (int i=0; i<lines.size(); i++) {
+        Rule rule;
+        if (parseRule(lines.at(i), rule)) rules.append(rule);
+    }
+}
+
+bool PathFilter::parseRule(QString line, Rule & rule)
+{
+    if (line.endsWith("\r")) line.chop(1);
+    while (line.endsWith(" ") && !line.endsWith("\\ ")) line.chop(1);
+    if (line.size() == 0 || line[0] == "#") return false;
+    rule.negated = false;
+    rule.directoryOnly = false;
+    if (line[0] == "!") {
+        rule.negated = true;
+        line = line.mid(1);
+    } else if (line.startsWith("\\#") || line.startsWith("\\!")) {
+        line = line.mid(1);
+    }
+    if (line.endsWith("/")) {
+        rule.directoryOnly = true;
+        line.chop(1);
+    }
+    if (line.startsWith("**/") && line.indexOf("/", 3) < 0) line = line.mid(3);
+    rule.anchored = line.indexOf("/") >= 0;
+    if (line.startsWith("/")) line = line.mid(1);
+    if (line.size() == 0) return false;
+    QRegularExpression wildcardExpression("[*?\\[\\\\]");
+    if (line.indexOf(wildcardExpression) < 0) {
+        rule.type = PATH_FILTER_RULE_EXACT;
+        rule.pattern = line;
+    } else if (!rule.anchored && line[0] == "*" && line.indexOf(wildcardExpression, 1) < 0) {
+        rule.type = PATH_FILTER_RULE_SUFFIX;
+        rule.pattern = line.mid(1);
+    } else {
+        rule.type = PATH_FILTER_RULE_WILDCARD;
+        rule.pattern = line;
+        rule.expression = QRegularExpression(wildcardToPattern(line));
+        if (!rule.expression.isValid()) return false;
+        rule.expression.optimize();
+    }
+    return true;
+}
+
+QString PathFilter::wildcardToPattern(const QString & wildcard)
+{
+    QString pattern = "^";
+    int size = wildcard.size();
+    for (int i=0; i<size; i++) {
+        QChar c = wildcard[i];
+        if (c == "*" && i+1 < size && wildcard[i+1] == "*") {
+            bool atStart = (i == 0 || wildcard[i-1] == "/");
+            if (atStart && i+2 < size && wildcard[i+2] == "/") {
+                // "**/" matches zero or more directories
+                pattern += "(?:.*/)?";
+                i += 2;
+            } else if (atStart && i+2 == size) {
+                // trailing "**" matches everything inside
+                pattern += ".*";
+                i++;
+            } else {
+                pattern += "[^/]*";
+                i++;
+            }
+        } else if (c == "*") {
+            pattern += "[^/]*";
+        } else if (c == "?") {
+            pattern += "[^/]";
+        } else if (c == "[") {
+            int end = wildcard.indexOf("]", i+2);
+            if (end < 0) {
+                pattern += "\\[";
+                continue;
+            }
+            QString chars = wildcard.mid(i+1, end-i-1);
+            if (chars.startsWith("!")) chars = "^" + chars.mid(1);
+            chars.replace("\\", "\\\\");
+            pattern += "[" + chars + "]";
+            i = end;
+        } else if (c == "\\" && i+1 < size) {
+            pattern += QRegularExpression::escape(wildcard.mid(i+1, 1));
+            i++;
+        } else {
+            pattern += QRegularExpression::escape(QString(c));
+        }
+    }
+    pattern += "$";
+    return pattern;
+}
+
+int PathFilter::matchRules(const QVector<Rule> & rules, const QString & relativePath, const QString & name, bool isDir)
+{
+    // the last matching rule wins
+    for (int i=rules.size()-1; i>=0; i--) {
+        const Rule & rule = rules.at(i);
+        if (rule.directoryOnly && !isDir) continue;
+        const QString & subject = rule.anchored ? relativePath : name;
+        bool matched = false;
+        if (rule.type == PATH_FILTER_RULE_EXACT) {
+            matched = subject == rule.pattern;
+        } else if (rule.type == PATH_FILTER_RULE_SUFFIX) {
+            matched = subject.endsWith(rule.pattern);
+        } else {
+            matched = rule.expression.match(subject).hasMatch();
+        }
+        if (matched) return rule.negated ? PATH_FILTER_MATCH_INCLUDED : PATH_FILTER_MATCH_IGNORED;
+    }
+    return PATH_FILTER_NO_MATCH;
+}
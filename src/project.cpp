@@ -15,11 +15,13 @@
 #include <QDateTime>
 #include <QFileInfo>
 #include <QTextStream>
+#include <QHash>
 
 const std::string PROJECT_DATA_ENCODING = "UTF-8";
 const QString PROJECT_SUBDIR = ".zira";
 const QString PROJECT_META_FILE = "meta.json";
 const QString PROJECT_PHP_DATA_FILE = "php_data.json";
+const QString PROJECT_PHP_INDEX_FILE = "php_data.idx";
 const QString PROJECT_PHP_CONSTS_FILE = "php_consts";
 const QString PROJECT_PHP_CLASS_CONSTS_FILE = "php_class_consts";
 const QString PROJECT_PHP_VARS_FILE = "php_globals";
@@ -35,6 +37,8 @@ const QString PROJECT_PHP_CLASS_METHODS_SEARCH_FILE = "php_class_methods_search"
 const QString PROJECT_PHP_CLASSES_SEARCH_FILE = "php_classes_search";
 const QString PROJECT_PHP_CLASS_METHODS_HELP_FILE = "php_class_methods_help";
 const QString PROJECT_PHP_FUNCTIONS_HELP_FILE = "php_functions_help";
+const QString PROJECT_PHP_WORDS_DELTA_SUFFIX = ".delta";
+const qint64 PROJECT_PHP_WORDS_DELTA_MAX_SIZE = 262144;
 
 const QString PARSE_PROJECT_PHP_EXT = "php";
 const QString GIT_IGNORE_FILE = ".gitignore";
@@ -67,6 +71,7 @@ void Project::reset()
     phpFunctionDeclarations.clear();
     phpClassMethodDeclarations.clear();
     phpClassDeclarations.clear();
+    phpWordsRefs.clear();
 }
 
 bool Project::isOpen()
@@ -82,11 +87,17 @@ void Project::deleteDataFile()
     if (!Helper::folderExists(project_dir)) {
         return;
     }
+    QString index_filename = project_dir + "/" + PROJECT_PHP_INDEX_FILE;
+    if (Helper::fileExists(index_filename)) {
+        Helper::deleteFile(index_filename);
+    }
+    if (Helper::fileExists(index_filename + PROJECT_INDEX_OVERLAY_SUFFIX)) {
+        Helper::deleteFile(index_filename + PROJECT_INDEX_OVERLAY_SUFFIX);
+    }
     QString data_filename = project_dir + "/" + PROJECT_PHP_DATA_FILE;
-    if (!Helper::fileExists(data_filename)) {
-        return;
+    if (Helper::fileExists(data_filename)) {
+        Helper::deleteFile(data_filename);
     }
-    Helper::deleteFile(data_filename);
 }
 
 bool Project::updateMetaFile(QString name, QString path, bool lintEnabled, bool csEnabled, QString time_created, QString time_modified, QStringList openTabFiles, QList<int> openTabLines, int currentTabIndex, QString todo)
@@ -320,17 +331,103 @@ void Project::loadWords()
     loadPHPWords(project_dir);
 }
 
+QStringList Project::getPHPWordsFiles()
+{
+    // order matters, later files override tooltips
+    QStringList files;
+    files.append(PROJECT_PHP_FUNCTIONS_FILE);
+    files.append(PROJECT_PHP_CONSTS_FILE);
+    files.append(PROJECT_PHP_CLASSES_FILE);
+    files.append(PROJECT_PHP_CLASS_METHODS_FILE);
+    files.append(PROJECT_PHP_CLASS_CONSTS_FILE);
+    files.append(PROJECT_PHP_CLASS_PROPS_FILE);
+    files.append(PROJECT_PHP_CLASS_PARENTS_FILE);
+    files.append(PROJECT_PHP_FUNCTION_TYPES_FILE);
+    files.append(PROJECT_PHP_CLASS_METHOD_TYPES_FILE);
+    files.append(PROJECT_PHP_FUNCTIONS_HELP_FILE);
+    files.append(PROJECT_PHP_CLASS_METHODS_HELP_FILE);
+    files.append(PROJECT_PHP_FUNCTIONS_SEARCH_FILE);
+    files.append(PROJECT_PHP_CLASS_METHODS_SEARCH_FILE);
+    files.append(PROJECT_PHP_CLASSES_SEARCH_FILE);
+    return files;
+}
+
 void Project::loadPHPWords(QString project_dir)
 {
+    phpWordsRefs.clear();
     QString k;
+    QStringList files = getPHPWordsFiles();
+    for (int i=0; i<files.size(); i++) {
+        QString file = files.at(i);
+        QStringList lines = loadPHPWordsLines(project_dir, file);
+        for (int y=0; y<lines.size(); y++) {
+            k = lines.at(y);
+            if (k == "") continue;
+            loadPHPWord(file, k);
+        }
+    }
+    CW->invalidateIndexes();
+}
 
-    // php functions
-    QFile ff(project_dir + "/" + PROJECT_PHP_FUNCTIONS_FILE);
-    ff.open(QIODevice::ReadOnly);
-    QTextStream fin(&ff);
-    while (!fin.atEnd()) {
-        k = fin.readLine();
+QStringList Project::loadPHPWordsLines(QString project_dir, QString file)
+{
+    // lines of saved files are added and removed by delta, see updatePHPResults
+    QStringList addedLines;
+    QHash<QString, int> removedLines;
+    QFile d(project_dir + "/" + file + PROJECT_PHP_WORDS_DELTA_SUFFIX);
+    if (d.open(QIODevice::ReadOnly)) {
+        QTextStream in(&d);
+        in.setCodec(PROJECT_DATA_ENCODING.c_str());
+        while (!in.atEnd()) {
+            QString line = in.readLine();
+            if (line.size() < 2) continue;
+            QString k = line.mid(1);
+            if (line[0] == '+') {
+                addedLines.append(k);
+            } else if (line[0] == '-') {
+                int p = addedLines.lastIndexOf(k);
+                if (p >= 0) addedLines.removeAt(p);
+                else removedLines[k]++;
+            }
+        }
+        d.close();
+    }
+    QStringList lines;
+    QFile f(project_dir + "/" + file);
+    f.open(QIODevice::ReadOnly);
+    QTextStream in(&f);
+    while (!in.atEnd()) {
+        QString k = in.readLine();
         if (k == "") continue;
+        QHash<QString, int>::iterator it = removedLines.find(k);
+        if (it != removedLines.end() && it.value() > 0) {
+            it.value()--;
+            continue;
+        }
+        lines.append(k);
+    }
+    f.close();
+    lines.append(addedLines);
+    return lines;
+}
+
+void Project::compactPHPWordsFile(QString project_dir, QString file)
+{
+    QStringList lines = loadPHPWordsLines(project_dir, file);
+    QString str = "";
+    for (int i=0; i<lines.size(); i++) {
+        str += lines.at(i) + "\n";
+    }
+    if (!Helper::saveTextFile(project_dir + "/" + file, str, PROJECT_DATA_ENCODING)) return;
+    Helper::deleteFile(project_dir + "/" + file + PROJECT_PHP_WORDS_DELTA_SUFFIX);
+}
+
+void Project::loadPHPWord(QString file, QString k)
+{
+    QString key = getPHPWordKey(file, k);
+    if (key.size() > 0) phpWordsRefs[key.toStdString()]++;
+    if (file == PROJECT_PHP_FUNCTIONS_FILE) {
+        // php functions
         QString kName = "", kParams = "";
         int kSep = k.indexOf("(");
         if (kSep > 0) {
@@ -343,28 +440,12 @@ void Project::loadPHPWords(QString project_dir)
             CW->phpFunctionsComplete[k.toStdString()] = k.toStdString();
             //HighlightWords::addPHPFunction(k);
         }
-    }
-    ff.close();
-
-    // php consts
-    QFile cnf(project_dir + "/" + PROJECT_PHP_CONSTS_FILE);
-    cnf.open(QIODevice::ReadOnly);
-    QTextStream cnin(&cnf);
-    while (!cnin.atEnd()) {
-        k = cnin.readLine();
-        if (k == "") continue;
+    } else if (file == PROJECT_PHP_CONSTS_FILE) {
+        // php consts
         CW->phpConstsComplete[k.toStdString()] = k.toStdString();
         HighlightWords::addPHPConstant(k);
-    }
-    cnf.close();
-
-    // php classes
-    QFile cf(project_dir + "/" + PROJECT_PHP_CLASSES_FILE);
-    cf.open(QIODevice::ReadOnly);
-    QTextStream cin(&cf);
-    while (!cin.atEnd()) {
-        k = cin.readLine();
-        if (k == "") continue;
+    } else if (file == PROJECT_PHP_CLASSES_FILE) {
+        // php classes
         QString kName = "", kParams = "";
         int kSep = k.indexOf("(");
         if (kSep > 0) {
@@ -372,31 +453,18 @@ void Project::loadPHPWords(QString project_dir)
             kParams = k.mid(kSep).trimmed();
             CW->phpClassesComplete[kName.toStdString()] = kParams.toStdString();
             CW->tooltipsPHP[kName.toStdString()] = kParams.replace("<", "&lt;").replace(">", "&gt;").toStdString();
-            QStringList classParts = kName.split("\\");
-            for (int i=0; i<classParts.size(); i++) {
-                QString classPart = classParts.at(i);
-                if (classPart.size() == 0) continue;
-                HighlightWords::addPHPClass(classPart);
-            }
         } else {
+            kName = k;
             CW->phpClassesComplete[k.toStdString()] = k.toStdString();
-            QStringList classParts = k.split("\\");
-            for (int i=0; i<classParts.size(); i++) {
-                QString classPart = classParts.at(i);
-                if (classPart.size() == 0) continue;
-                HighlightWords::addPHPClass(classPart);
-            }
         }
-    }
-    cf.close();
-
-    // php class methods
-    QFile mf(project_dir + "/" + PROJECT_PHP_CLASS_METHODS_FILE);
-    mf.open(QIODevice::ReadOnly);
-    QTextStream min(&mf);
-    while (!min.atEnd()) {
-        k = min.readLine();
-        if (k == "") continue;
+        QStringList classParts = kName.split("\\");
+        for (int i=0; i<classParts.size(); i++) {
+            QString classPart = classParts.at(i);
+            if (classPart.size() == 0) continue;
+            HighlightWords::addPHPClass(classPart);
+        }
+    } else if (file == PROJECT_PHP_CLASS_METHODS_FILE) {
+        // php class methods
         QString kName = "", kParams = "";
         int kSep = k.indexOf("(");
         if (kSep > 0) {
@@ -409,138 +477,152 @@ void Project::loadPHPWords(QString project_dir)
             CW->phpClassMethodsComplete[k.toStdString()] = k.toStdString();
             //HighlightWords::addPHPFunction(k);
         }
-    }
-    mf.close();
-
-    // php class consts
-    QFile cof(project_dir + "/" + PROJECT_PHP_CLASS_CONSTS_FILE);
-    cof.open(QIODevice::ReadOnly);
-    QTextStream coin(&cof);
-    while (!coin.atEnd()) {
-        k = coin.readLine();
-        if (k == "") continue;
+    } else if (file == PROJECT_PHP_CLASS_CONSTS_FILE) {
+        // php class consts
         CW->phpClassConstsComplete[k.toStdString()] = k.toStdString();
         QStringList kParts = k.split("::");
         if (kParts.size() == 2) HighlightWords::addPHPClassConstant(kParts.at(0), kParts.at(1));
-    }
-    cof.close();
-
-    // php class props
-    QFile pof(project_dir + "/" + PROJECT_PHP_CLASS_PROPS_FILE);
-    pof.open(QIODevice::ReadOnly);
-    QTextStream poin(&pof);
-    while (!poin.atEnd()) {
-        k = poin.readLine();
-        if (k == "") continue;
+    } else if (file == PROJECT_PHP_CLASS_PROPS_FILE) {
+        // php class props
         CW->phpClassPropsComplete[k.toStdString()] = k.toStdString();
-    }
-    pof.close();
-
-    // php class parents
-    QFile cpf(project_dir + "/" + PROJECT_PHP_CLASS_PARENTS_FILE);
-    cpf.open(QIODevice::ReadOnly);
-    QTextStream cpin(&cpf);
-    while (!cpin.atEnd()) {
-        k = cpin.readLine();
-        if (k == "") continue;
+    } else if (file == PROJECT_PHP_CLASS_PARENTS_FILE) {
+        // php class parents
         QStringList kList = k.split(" ");
-        if (kList.size() != 2) continue;
+        if (kList.size() != 2) return;
         CW->phpClassParents[kList.at(0).toStdString()] = kList.at(1).toStdString();
-    }
-    cpf.close();
-
-    // php function types
-    QFile ftf(project_dir + "/" + PROJECT_PHP_FUNCTION_TYPES_FILE);
-    ftf.open(QIODevice::ReadOnly);
-    QTextStream ftin(&ftf);
-    while (!ftin.atEnd()) {
-        k = ftin.readLine();
-        if (k == "") continue;
+    } else if (file == PROJECT_PHP_FUNCTION_TYPES_FILE) {
+        // php function types
         QStringList kList = k.split(" ");
-        if (kList.size() != 2) continue;
+        if (kList.size() != 2) return;
         CW->phpFunctionTypes[kList.at(0).toStdString()] = kList.at(1).toStdString();
-    }
-    ftf.close();
-
-    // php class method types
-    QFile mtf(project_dir + "/" + PROJECT_PHP_CLASS_METHOD_TYPES_FILE);
-    mtf.open(QIODevice::ReadOnly);
-    QTextStream mtin(&mtf);
-    while (!mtin.atEnd()) {
-        k = mtin.readLine();
-        if (k == "") continue;
+    } else if (file == PROJECT_PHP_CLASS_METHOD_TYPES_FILE) {
+        // php class method types
         QStringList kList = k.split(" ");
-        if (kList.size() != 2) continue;
+        if (kList.size() != 2) return;
         CW->phpClassMethodTypes[kList.at(0).toStdString()] = kList.at(1).toStdString();
+    } else if (file == PROJECT_PHP_FUNCTIONS_HELP_FILE) {
+        // php function descriptions
+        if (k.indexOf(" ") < 0) return;
+        QString func = k.mid(0, k.indexOf(" "));
+        QString desc = k.mid(k.indexOf(" ")+1);
+        HPW->phpFunctionDescs[func.toStdString()] = desc.replace("<br />", "\n").toStdString();
+    } else if (file == PROJECT_PHP_CLASS_METHODS_HELP_FILE) {
+        // php class method descriptions
+        if (k.indexOf(" ") < 0) return;
+        QString func = k.mid(0, k.indexOf(" "));
+        QString desc = k.mid(k.indexOf(" ")+1);
+        HPW->phpClassMethodDescs[func.toStdString()] = desc.replace("<br />", "\n").toStdString();
+    } else if (file == PROJECT_PHP_FUNCTIONS_SEARCH_FILE) {
+        // php function declarations
+        if (k.indexOf(" ") < 0) return;
+        QString func = k.mid(0, k.indexOf(" "));
+        QString desc = k.mid(k.indexOf(" ")+1);
+        phpFunctionDeclarations[func.toStdString()] = desc.toStdString();
+    } else if (file == PROJECT_PHP_CLASS_METHODS_SEARCH_FILE) {
+        // php class method declarations
+        if (k.indexOf(" ") < 0) return;
+        QString func = k.mid(0, k.indexOf(" "));
+        QString desc = k.mid(k.indexOf(" ")+1);
+        phpClassMethodDeclarations[func.toStdString()] = desc.toStdString();
+    } else if (file == PROJECT_PHP_CLASSES_SEARCH_FILE) {
+        // php class declarations
+        if (k.indexOf(" ") < 0) return;
+        QString func = k.mid(0, k.indexOf(" "));
+        QString desc = k.mid(k.indexOf(" ")+1);
+        phpClassDeclarations[func.toStdString()] = desc.toStdString();
     }
-    mtf.close();
+}
 
-    QString func, desc;
+QString Project::getPHPWordKey(QString file, QString k)
+{
+    QString kName = k;
+    if (file == PROJECT_PHP_FUNCTIONS_FILE || file == PROJECT_PHP_CLASSES_FILE || file == PROJECT_PHP_CLASS_METHODS_FILE) {
+        int kSep = k.indexOf("(");
+        if (kSep > 0) kName = k.mid(0, kSep).trimmed();
+    } else if (file != PROJECT_PHP_CONSTS_FILE && file != PROJECT_PHP_CLASS_CONSTS_FILE && file != PROJECT_PHP_CLASS_PROPS_FILE) {
+        if (k.indexOf(" ") < 0) return "";
+        kName = k.mid(0, k.indexOf(" "));
+    }
+    return file + " " + kName;
+}
 
-    // php function descriptions
-    QFile hpf(project_dir + "/" + PROJECT_PHP_FUNCTIONS_HELP_FILE);
-    hpf.open(QIODevice::ReadOnly);
-    QTextStream hpin(&hpf);
-    while (!hpin.atEnd()) {
-        k = hpin.readLine();
-        if (k == "" || k.indexOf(" ") < 0) continue;
-        func = k.mid(0, k.indexOf(" "));
-        desc = k.mid(k.indexOf(" ")+1);
-        HPW->phpFunctionDescs[func.toStdString()] = desc.replace("<br />", "\n").toStdString();
+void Project::unloadPHPWord(QString file, QString k)
+{
+    // highlight words are kept until project reload
+    QString key = getPHPWordKey(file, k);
+    if (key.size() == 0) return;
+    // word is kept, while other project files still declare it
+    phpWordsRefsIterator = phpWordsRefs.find(key.toStdString());
+    if (phpWordsRefsIterator != phpWordsRefs.end()) {
+        phpWordsRefsIterator->second--;
+        if (phpWordsRefsIterator->second > 0) return;
+        phpWordsRefs.erase(phpWordsRefsIterator);
     }
-    hpf.close();
-
-    // php class method descriptions
-    QFile hcf(project_dir + "/" + PROJECT_PHP_CLASS_METHODS_HELP_FILE);
-    hcf.open(QIODevice::ReadOnly);
-    QTextStream hcin(&hcf);
-    while (!hcin.atEnd()) {
-        k = hcin.readLine();
-        if (k == "" || k.indexOf(" ") < 0) continue;
-        func = k.mid(0, k.indexOf(" "));
-        desc = k.mid(k.indexOf(" ")+1);
-        HPW->phpClassMethodDescs[func.toStdString()] = desc.replace("<br />", "\n").toStdString();
+    QString kName = key.mid(file.size() + 1);
+    int kSep = -1;
+    if (file == PROJECT_PHP_FUNCTIONS_FILE || file == PROJECT_PHP_CLASSES_FILE || file == PROJECT_PHP_CLASS_METHODS_FILE) {
+        kSep = k.indexOf("(");
     }
-    hcf.close();
-
-    // php function declarations
-    QFile spf(project_dir + "/" + PROJECT_PHP_FUNCTIONS_SEARCH_FILE);
-    spf.open(QIODevice::ReadOnly);
-    QTextStream spin(&spf);
-    while (!spin.atEnd()) {
-        k = spin.readLine();
-        if (k == "" || k.indexOf(" ") < 0) continue;
-        func = k.mid(0, k.indexOf(" "));
-        desc = k.mid(k.indexOf(" ")+1);
-        phpFunctionDeclarations[func.toStdString()] = desc.toStdString();
+    std::string name = kName.toStdString();
+    if (file == PROJECT_PHP_FUNCTIONS_FILE) {
+        CW->phpFunctionsComplete.erase(name);
+        if (kSep > 0) CW->tooltipsPHP.erase(name);
+    } else if (file == PROJECT_PHP_CONSTS_FILE) {
+        CW->phpConstsComplete.erase(name);
+    } else if (file == PROJECT_PHP_CLASSES_FILE) {
+        CW->phpClassesComplete.erase(name);
+        if (kSep > 0) CW->tooltipsPHP.erase(name);
+    } else if (file == PROJECT_PHP_CLASS_METHODS_FILE) {
+        CW->phpClassMethodsComplete.erase(name);
+        if (kSep > 0) CW->tooltipsPHP.erase(name);
+    } else if (file == PROJECT_PHP_CLASS_CONSTS_FILE) {
+        CW->phpClassConstsComplete.erase(name);
+    } else if (file == PROJECT_PHP_CLASS_PROPS_FILE) {
+        CW->phpClassPropsComplete.erase(name);
+    } else if (file == PROJECT_PHP_CLASS_PARENTS_FILE) {
+        CW->phpClassParents.erase(name);
+    } else if (file == PROJECT_PHP_FUNCTION_TYPES_FILE) {
+        CW->phpFunctionTypes.erase(name);
+    } else if (file == PROJECT_PHP_CLASS_METHOD_TYPES_FILE) {
+        CW->phpClassMethodTypes.erase(name);
+    } else if (file == PROJECT_PHP_FUNCTIONS_HELP_FILE) {
+        HPW->phpFunctionDescs.erase(name);
+    } else if (file == PROJECT_PHP_CLASS_METHODS_HELP_FILE) {
+        HPW->phpClassMethodDescs.erase(name);
+    } else if (file == PROJECT_PHP_FUNCTIONS_SEARCH_FILE) {
+        phpFunctionDeclarations.erase(name);
+    } else if (file == PROJECT_PHP_CLASS_METHODS_SEARCH_FILE) {
+        phpClassMethodDeclarations.erase(name);
+    } else if (file == PROJECT_PHP_CLASSES_SEARCH_FILE) {
+        phpClassDeclarations.erase(name);
     }
-    spf.close();
-
-    // php class method declarations
-    QFile scf(project_dir + "/" + PROJECT_PHP_CLASS_METHODS_SEARCH_FILE);
-    scf.open(QIODevice::ReadOnly);
-    QTextStream scin(&scf);
-    while (!scin.atEnd()) {
-        k = scin.readLine();
-        if (k == "" || k.indexOf(" ") < 0) continue;
-        func = k.mid(0, k.indexOf(" "));
-        desc = k.mid(k.indexOf(" ")+1);
-        phpClassMethodDeclarations[func.toStdString()] = desc.toStdString();
+}
+
+void Project::updateWords(QVariantMap oldMap, QVariantMap newMap)
+{
+    if (!isOpen()) return;
+    QMap<QString, QString> oldData = createPHPResultsData(oldMap);
+    QMap<QString, QString> newData = createPHPResultsData(newMap);
+    QStringList files = getPHPWordsFiles();
+    for (int i=0; i<files.size(); i++) {
+        QString file = files.at(i);
+        QStringList oldLines = oldData.value(file).split("\n");
+        for (int y=0; y<oldLines.size(); y++) {
+            QString k = oldLines.at(y);
+            if (k == "") continue;
+            unloadPHPWord(file, k);
+        }
     }
-    scf.close();
-
-    // php class declarations
-    QFile lcf(project_dir + "/" + PROJECT_PHP_CLASSES_SEARCH_FILE);
-    lcf.open(QIODevice::ReadOnly);
-    QTextStream lcin(&lcf);
-    while (!lcin.atEnd()) {
-        k = lcin.readLine();
-        if (k == "" || k.indexOf(" ") < 0) continue;
-        func = k.mid(0, k.indexOf(" "));
-        desc = k.mid(k.indexOf(" ")+1);
-        phpClassDeclarations[func.toStdString()] = desc.toStdString();
+    for (int i=0; i<files.size(); i++) {
+        QString file = files.at(i);
+        QStringList newLines = newData.value(file).split("\n");
+        for (int y=0; y<newLines.size(); y++) {
+            QString k = newLines.at(y);
+            if (k == "") continue;
+            loadPHPWord(file, k);
+        }
     }
-    lcf.close();
+    CW->invalidateIndexes();
 }
 
 void Project::findDeclaration(QString name, QString & path, int & line)
@@ -596,21 +678,17 @@ QVariantMap Project::createPHPResultMap()
     return map;
 }
 
-QVariantMap Project::loadPHPDataMap(QString path)
+bool Project::loadPHPDataIndex(QString path, ProjectIndex & index)
 {
-    QVariantMap defaultMap;
     QString project_dir = path + "/" + PROJECT_SUBDIR;
     if (!Helper::folderExists(project_dir)) {
-        return defaultMap;
+        return false;
     }
-    QString data_filename = project_dir + "/" + PROJECT_PHP_DATA_FILE;
-    if (!Helper::fileExists(data_filename)) {
-        return defaultMap;
+    QString index_filename = project_dir + "/" + PROJECT_PHP_INDEX_FILE;
+    if (!Helper::fileExists(index_filename)) {
+        return false;
     }
-    QString data = Helper::loadTextFile(data_filename, PROJECT_DATA_ENCODING, PROJECT_DATA_ENCODING, true);
-    QJsonDocument d = QJsonDocument::fromJson(data.toUtf8());
-    QJsonObject o = d.object();
-    return o.toVariantMap();
+    return index.load(index_filename);
 }
 
 bool Project::isProjectFile(QString path)
@@ -630,20 +708,37 @@ bool Project::isProjectFile(QString path)
     return true;
 }
 
-std::unordered_map<std::string, std::string> Project::getPHPFilesMapFromData(QVariantMap & data)
+void Project::checkParsePHPFilesModified(QStringList & files, ProjectIndex & index, QVariantMap & map)
 {
-    std::unordered_map<std::string, std::string> filesMap;
-    QVariant php_files_v = data.value("php_files");
+    QVariant php_files_v = map.value("php_files");
     QVariantMap php_files = qvariant_cast<QVariantMap>(php_files_v);
-    for (auto k : php_files.keys()) {
-        QVariant lastModifiedV = php_files.value(k);
-        QString lastModified = lastModifiedV.toString();
-        filesMap[k.toStdString()] = lastModified.toStdString();
+
+    QVector<bool> filesNotModified;
+    filesNotModified.fill(false, index.getFilesCount());
+    QStringList modifiedFiles;
+    for (int i=0; i<files.size(); i++) {
+        QString file = files.at(i);
+        int fileIndex = index.findFile(file);
+        if (fileIndex >= 0) {
+            QFileInfo fInfo(file);
+            qint64 lastModified = fInfo.lastModified().toMSecsSinceEpoch();
+            if (lastModified == index.getFileLastModified(fileIndex)) {
+                php_files.insert(file, QVariant(QString::number(lastModified)));
+                filesNotModified[fileIndex] = true;
+                continue;
+            }
+        }
+        modifiedFiles.append(file);
     }
-    return filesMap;
+    files = modifiedFiles;
+
+    map.insert("php_files", QVariant(php_files));
+
+    // only records of not modified files are loaded from index
+    loadPHPDataIndexRecords(index, filesNotModified, map);
 }
 
-void Project::checkParsePHPFilesModified(QStringList & files, QVariantMap & data, QVariantMap & map)
+void Project::loadPHPDataIndexRecords(ProjectIndex & index, QVector<bool> & files, QVariantMap & map)
 {
     QVariant php_consts_v = map.value("php_consts");
     QVariantMap php_consts = qvariant_cast<QVariantMap>(php_consts_v);
@@ -653,87 +748,50 @@ void Project::checkParsePHPFilesModified(QStringList & files, QVariantMap & data
     QVariantMap php_functions = qvariant_cast<QVariantMap>(php_functions_v);
     QVariant php_classes_v = map.value("php_classes");
     QVariantMap php_classes = qvariant_cast<QVariantMap>(php_classes_v);
-    QVariant php_files_v = map.value("php_files");
-    QVariantMap php_files = qvariant_cast<QVariantMap>(php_files_v);
 
-    std::unordered_map<std::string, std::string> filesMap = getPHPFilesMapFromData(data);
-    std::unordered_map<std::string, std::string> filesNotModifiedMap;
-    int i=0;
-    while (i<files.size()) {
-        QString file = files.at(i);
-        std::unordered_map<std::string, std::string>::iterator filesMapIt = filesMap.find(file.toStdString());
-        if (filesMapIt != filesMap.end()) {
-            QFileInfo fInfo(file);
-            QDateTime dt = fInfo.lastModified();
-            QString dts = QString::number(dt.toMSecsSinceEpoch());
-            if (dts.toStdString() == filesMapIt->second) {
-                files.removeAt(i);
-                php_files.insert(file, QVariant(dts));
-                filesNotModifiedMap[file.toStdString()] = dts.toStdString();
-                continue;
-            }
-        }
-        i++;
-    }
-
-    QVariant _php_consts_v = data.value("php_consts");
-    QVariantMap _php_consts = qvariant_cast<QVariantMap>(_php_consts_v);
-    QVariant _php_globals_v = data.value("php_globals");
-    QVariantMap _php_globals = qvariant_cast<QVariantMap>(_php_globals_v);
-    QVariant _php_functions_v = data.value("php_functions");
-    QVariantMap _php_functions = qvariant_cast<QVariantMap>(_php_functions_v);
-    QVariant _php_classes_v = data.value("php_classes");
-    QVariantMap _php_classes = qvariant_cast<QVariantMap>(_php_classes_v);
-
-    for (auto k : _php_consts.keys()) {
-        QVariant v = _php_consts.value(k);
-        QVariantMap m = qvariant_cast<QVariantMap>(v);
-        QString name = m.value("name").toString();
-        QString file = m.value("file").toString();
-        std::unordered_map<std::string, std::string>::iterator filesNotModifiedMapIt = filesNotModifiedMap.find(file.toStdString());
-        if (filesNotModifiedMapIt != filesNotModifiedMap.end()) {
-            php_consts.insert(name, m);
-        }
+    for (int i=0; i<index.getConstantsCount(); i++) {
+        int fileIndex = index.getConstantFile(i);
+        if (fileIndex < 0 || fileIndex >= files.size() || !files.at(fileIndex)) continue;
+        QVariantMap m = index.getConstant(i);
+        php_consts.insert(m.value("name").toString(), m);
     }
 
-    for (auto k : _php_globals.keys()) {
-        QVariant v = _php_globals.value(k);
-        QVariantMap m = qvariant_cast<QVariantMap>(v);
-        QString name = m.value("name").toString();
-        QString file = m.value("file").toString();
-        std::unordered_map<std::string, std::string>::iterator filesNotModifiedMapIt = filesNotModifiedMap.find(file.toStdString());
-        if (filesNotModifiedMapIt != filesNotModifiedMap.end()) {
-            php_globals.insert(name, m);
-        }
+    for (int i=0; i<index.getGlobalsCount(); i++) {
+        int fileIndex = index.getGlobalFile(i);
+        if (fileIndex < 0 || fileIndex >= files.size() || !files.at(fileIndex)) continue;
+        QVariantMap m = index.getGlobal(i);
+        php_globals.insert(m.value("name").toString(), m);
     }
 
-    for (auto k : _php_functions.keys()) {
-        QVariant v = _php_functions.value(k);
-        QVariantMap m = qvariant_cast<QVariantMap>(v);
-        QString name = m.value("name").toString();
-        QString file = m.value("file").toString();
-        std::unordered_map<std::string, std::string>::iterator filesNotModifiedMapIt = filesNotModifiedMap.find(file.toStdString());
-        if (filesNotModifiedMapIt != filesNotModifiedMap.end()) {
-            php_functions.insert(name, m);
-        }
+    for (int i=0; i<index.getFunctionsCount(); i++) {
+        int fileIndex = index.getFunctionFile(i);
+        if (fileIndex < 0 || fileIndex >= files.size() || !files.at(fileIndex)) continue;
+        QVariantMap m = index.getFunction(i);
+        php_functions.insert(m.value("name").toString(), m);
     }
 
-    for (auto k : _php_classes.keys()) {
-        QVariant v = _php_classes.value(k);
-        QVariantMap m = qvariant_cast<QVariantMap>(v);
-        QString name = m.value("name").toString();
-        QString file = m.value("file").toString();
-        std::unordered_map<std::string, std::string>::iterator filesNotModifiedMapIt = filesNotModifiedMap.find(file.toStdString());
-        if (filesNotModifiedMapIt != filesNotModifiedMap.end()) {
-            php_classes.insert(name, m);
-        }
+    for (int i=0; i<index.getClassesCount(); i++) {
+        int fileIndex = index.getClassFile(i);
+        if (fileIndex < 0 || fileIndex >= files.size() || !files.at(fileIndex)) continue;
+        QVariantMap m = index.getClass(i);
+        php_classes.insert(m.value("name").toString(), m);
     }
 
     map.insert("php_consts", QVariant(php_consts));
     map.insert("php_globals", QVariant(php_globals));
     map.insert("php_functions", QVariant(php_functions));
     map.insert("php_classes", QVariant(php_classes));
-    map.insert("php_files", QVariant(php_files));
+}
+
+void Project::loadPHPDataIndexFiles(ProjectIndex & index, QStringList files, QVariantMap & map)
+{
+    QVector<bool> filesIndexes;
+    filesIndexes.fill(false, index.getFilesCount());
+    for (int i=0; i<files.size(); i++) {
+        int fileIndex = index.findFile(files.at(i));
+        if (fileIndex >= 0) filesIndexes[fileIndex] = true;
+    }
+    loadPHPDataIndexRecords(index, filesIndexes, map);
 }
 
 void Project::parsePHPResult(ParsePHP::ParseResult result, QVariantMap & map, QString path, QString lastModified)
@@ -915,14 +973,66 @@ void Project::savePHPResults(QString path, QVariantMap & map)
         return;
     }
     preparePHPResults(project_dir, map);
-    QJsonObject o = QJsonObject::fromVariantMap(map);
-    QJsonDocument d;
-    d.setObject(o);
-    QString data = QString(d.toJson());
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_DATA_FILE, data, PROJECT_DATA_ENCODING);
+    ProjectIndex::save(project_dir + "/" + PROJECT_PHP_INDEX_FILE, map);
+    // removes index of older versions
+    QString data_filename = project_dir + "/" + PROJECT_PHP_DATA_FILE;
+    if (Helper::fileExists(data_filename)) {
+        Helper::deleteFile(data_filename);
+    }
+}
+
+bool Project::updatePHPResults(QString path, ProjectIndex & index, QStringList files, QVariantMap & oldMap, QVariantMap & newMap)
+{
+    QString project_dir = path + "/" + PROJECT_SUBDIR;
+    if (!Helper::folderExists(project_dir)) {
+        return false;
+    }
+    QString meta_filename = project_dir + "/" + PROJECT_META_FILE;
+    if (!Helper::fileExists(meta_filename)) {
+        return false;
+    }
+    if (!index.update(project_dir + "/" + PROJECT_PHP_INDEX_FILE, files, newMap)) return false;
+    QMap<QString, QString> oldData = createPHPResultsData(oldMap);
+    QMap<QString, QString> newData = createPHPResultsData(newMap);
+    for (auto k : newData.keys()) {
+        QString oldStr = oldData.value(k);
+        QString newStr = newData.value(k);
+        if (oldStr == newStr) continue;
+        // words files are not rewritten, lines of the changed file are appended to delta
+        QString delta = "";
+        QStringList oldLines = oldStr.split("\n");
+        for (int i=0; i<oldLines.size(); i++) {
+            if (oldLines.at(i).size() > 0) delta += "-" + oldLines.at(i) + "\n";
+        }
+        QStringList newLines = newStr.split("\n");
+        for (int i=0; i<newLines.size(); i++) {
+            if (newLines.at(i).size() > 0) delta += "+" + newLines.at(i) + "\n";
+        }
+        QFile d(project_dir + "/" + k + PROJECT_PHP_WORDS_DELTA_SUFFIX);
+        if (!d.open(QIODevice::WriteOnly | QIODevice::Append)) continue;
+        QTextStream out(&d);
+        out.setGenerateByteOrderMark(false);
+        out.setCodec(PROJECT_DATA_ENCODING.c_str());
+        out << delta;
+        out.flush();
+        qint64 deltaSize = d.size();
+        d.close();
+        if (deltaSize > PROJECT_PHP_WORDS_DELTA_MAX_SIZE) compactPHPWordsFile(project_dir, k);
+    }
+    return true;
 }
 
 void Project::preparePHPResults(QString project_dir, QVariantMap & map)
+{
+    QMap<QString, QString> data = createPHPResultsData(map);
+    for (auto k : data.keys()) {
+        Helper::saveTextFile(project_dir + "/" + k, data.value(k), PROJECT_DATA_ENCODING);
+        QString delta_filename = project_dir + "/" + k + PROJECT_PHP_WORDS_DELTA_SUFFIX;
+        if (Helper::fileExists(delta_filename)) Helper::deleteFile(delta_filename);
+    }
+}
+
+QMap<QString, QString> Project::createPHPResultsData(QVariantMap & map)
 {
     QString consts_str = "";
     QString globals_str = "";
@@ -1031,21 +1141,23 @@ void Project::preparePHPResults(QString project_dir, QVariantMap & map)
         classes_search_str += cls_name + " " + cls.value("file").toString() + ":" + cls.value("line").toString() + "\n";
     }
 
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CONSTS_FILE, consts_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_VARS_FILE, globals_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_FUNCTIONS_FILE, functions_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_FUNCTION_TYPES_FILE, function_types_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASSES_FILE, classes_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASS_PARENTS_FILE, class_parents_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASS_CONSTS_FILE, class_consts_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASS_PROPS_FILE, class_properties_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASS_METHODS_FILE, class_methods_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASS_METHOD_TYPES_FILE, class_method_types_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASSES_SEARCH_FILE, classes_search_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASS_METHODS_SEARCH_FILE, class_methods_search_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_FUNCTIONS_SEARCH_FILE, functions_search_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_FUNCTIONS_HELP_FILE, functions_help_str, PROJECT_DATA_ENCODING);
-    Helper::saveTextFile(project_dir + "/" + PROJECT_PHP_CLASS_METHODS_HELP_FILE, class_methods_help_str, PROJECT_DATA_ENCODING);
+    QMap<QString, QString> data;
+    data.insert(PROJECT_PHP_CONSTS_FILE, consts_str);
+    data.insert(PROJECT_PHP_VARS_FILE, globals_str);
+    data.insert(PROJECT_PHP_FUNCTIONS_FILE, functions_str);
+    data.insert(PROJECT_PHP_FUNCTION_TYPES_FILE, function_types_str);
+    data.insert(PROJECT_PHP_CLASSES_FILE, classes_str);
+    data.insert(PROJECT_PHP_CLASS_PARENTS_FILE, class_parents_str);
+    data.insert(PROJECT_PHP_CLASS_CONSTS_FILE, class_consts_str);
+    data.insert(PROJECT_PHP_CLASS_PROPS_FILE, class_properties_str);
+    data.insert(PROJECT_PHP_CLASS_METHODS_FILE, class_methods_str);
+    data.insert(PROJECT_PHP_CLASS_METHOD_TYPES_FILE, class_method_types_str);
+    data.insert(PROJECT_PHP_CLASSES_SEARCH_FILE, classes_search_str);
+    data.insert(PROJECT_PHP_CLASS_METHODS_SEARCH_FILE, class_methods_search_str);
+    data.insert(PROJECT_PHP_FUNCTIONS_SEARCH_FILE, functions_search_str);
+    data.insert(PROJECT_PHP_FUNCTIONS_HELP_FILE, functions_help_str);
+    data.insert(PROJECT_PHP_CLASS_METHODS_HELP_FILE, class_methods_help_str);
+    return data;
 }
 
 void Project::preparePHPClasses(QString cls_name,
@@ -0,0 +1,932 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "projectindex.h"
+#include <QSaveFile>
+#include <QFileInfo>
+#include <cstring>
+#include <algorithm>
+
+const QString PROJECT_INDEX_OVERLAY_SUFFIX = ".ovl";
+
+const char PROJECT_INDEX_MAGIC[4] = {'Z', 'P', 'H', 'I'};
+const quint32 PROJECT_INDEX_VERSION = 1;
+const quint32 PROJECT_INDEX_BYTE_ORDER = 0x01020304;
+const int PROJECT_INDEX_ALIGNMENT = 8;
+const int PROJECT_INDEX_OVERLAY_MAX_FILES = 64;
+
+const quint32 FUNCTION_FLAG_STATIC = 1;
+const quint32 FUNCTION_FLAG_ABSTRACT = 2;
+const quint32 CLASS_FLAG_ABSTRACT = 1;
+const quint32 CLASS_FLAG_INTERFACE = 2;
+const quint32 CLASS_FLAG_TRAIT = 4;
+const quint32 FILE_ID_UNKNOWN = 0xFFFFFFFF;
+const quint32 FILE_ID_REMOVED = 0xFFFFFFFE;
+const quint32 STRING_ID_UNMAPPED = 0xFFFFFFFF;
+const quint32 FILE_FLAG_REMOVED = 1;
+
+ProjectIndex::ProjectIndex():
+    data(nullptr),
+    dataSize(0),
+    strings(nullptr),
+    stringsCount(0),
+    chars(nullptr),
+    charsCount(0),
+    files(nullptr),
+    filesCount(0),
+    overlay(nullptr)
+{
+
+}
+
+ProjectIndex::~ProjectIndex()
+{
+    close();
+}
+
+bool ProjectIndex::load(QString filename)
+{
+    if (!loadSegment(filename)) return false;
+    // files saved after the last rebuild are read from overlay
+    QString overlayFilename = filename + PROJECT_INDEX_OVERLAY_SUFFIX;
+    if (!QFileInfo::exists(overlayFilename)) return true;
+    overlay = new ProjectIndex();
+    if (!overlay->loadSegment(overlayFilename)) {
+        close();
+        return false;
+    }
+    for (int i=0; i<overlay->filesCount; i++) {
+        QString path = overlay->getString(overlay->files[i].path);
+        int position = findFilePosition(path);
+        if (position < filesCount && compareFilePath(position, path) == 0) shadowedFiles.insert(position);
+    }
+    return true;
+}
+
+bool ProjectIndex::loadSegment(QString filename)
+{
+    close();
+    file.setFileName(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    dataSize = file.size();
+    if (dataSize < static_cast<qint64>(sizeof(Header))) {
+        close();
+        return false;
+    }
+    data = file.map(0, dataSize);
+    if (data == nullptr) {
+        close();
+        return false;
+    }
+    const Header * header = reinterpret_cast<const Header *>(data);
+    if (std::memcmp(header->magic, PROJECT_INDEX_MAGIC, sizeof(PROJECT_INDEX_MAGIC)) != 0 ||
+        header->version != PROJECT_INDEX_VERSION ||
+        header->byteOrder != PROJECT_INDEX_BYTE_ORDER ||
+        header->sectionsCount != SECTIONS_COUNT
+    ) {
+        close();
+        return false;
+    }
+    const quint32 recordSizes[SECTIONS_COUNT] = {
+        sizeof(StringRecord), sizeof(QChar), sizeof(FileRecord),
+        sizeof(ConstantRecord), sizeof(VariableRecord), sizeof(FunctionRecord), sizeof(ClassRecord),
+        sizeof(ConstantRecord), sizeof(VariableRecord), sizeof(FunctionRecord), sizeof(quint32)
+    };
+    for (int i=0; i<SECTIONS_COUNT; i++) {
+        const SectionRecord & section = header->sections[i];
+        if (static_cast<qint64>(section.offset) + static_cast<qint64>(section.count) * recordSizes[i] > dataSize ||
+            section.offset % PROJECT_INDEX_ALIGNMENT != 0
+        ) {
+            close();
+            return false;
+        }
+    }
+    strings = static_cast<const StringRecord *>(getSection(SECTION_STRINGS, stringsCount));
+    chars = static_cast<const QChar *>(getSection(SECTION_CHARS, charsCount));
+    files = static_cast<const FileRecord *>(getSection(SECTION_FILES, filesCount));
+    return true;
+}
+
+void ProjectIndex::close()
+{
+    if (overlay != nullptr) delete overlay;
+    overlay = nullptr;
+    shadowedFiles.clear();
+    if (data != nullptr) file.unmap(data);
+    if (file.isOpen()) file.close();
+    data = nullptr;
+    dataSize = 0;
+    strings = nullptr;
+    stringsCount = 0;
+    chars = nullptr;
+    charsCount = 0;
+    files = nullptr;
+    filesCount = 0;
+}
+
+bool ProjectIndex::isLoaded()
+{
+    return data != nullptr;
+}
+
+const void * ProjectIndex::getSection(Section section, int & count)
+{
+    count = 0;
+    if (data == nullptr) return nullptr;
+    const Header * header = reinterpret_cast<const Header *>(data);
+    const SectionRecord & record = header->sections[section];
+    if (record.count == 0) return nullptr;
+    count = static_cast<int>(record.count);
+    return data + record.offset;
+}
+
+QString ProjectIndex::getString(quint32 id)
+{
+    if (id >= static_cast<quint32>(stringsCount)) return "";
+    const StringRecord & record = strings[id];
+    if (static_cast<qint64>(record.offset) + record.length > charsCount) return "";
+    return QString(chars + record.offset, static_cast<int>(record.length));
+}
+
+QString ProjectIndex::getFileString(quint32 id)
+{
+    if (id >= static_cast<quint32>(filesCount)) return "";
+    return getString(files[id].path);
+}
+
+int ProjectIndex::getFilesCount()
+{
+    // overlay files are numbered after the base ones
+    if (overlay != nullptr) return filesCount + overlay->filesCount;
+    return filesCount;
+}
+
+bool ProjectIndex::isFileRemoved(int index)
+{
+    return (files[index].reserved & FILE_FLAG_REMOVED) != 0;
+}
+
+int ProjectIndex::baseFileIndex(quint32 id)
+{
+    // records of changed and deleted files are hidden by overlay
+    if (id >= static_cast<quint32>(filesCount)) return -1;
+    int index = static_cast<int>(id);
+    if (shadowedFiles.contains(index)) return -1;
+    return index;
+}
+
+int ProjectIndex::overlayFileIndex(int index)
+{
+    if (index < 0) return -1;
+    return filesCount + index;
+}
+
+int ProjectIndex::compareFilePath(int index, QString path)
+{
+    quint32 id = files[index].path;
+    if (id >= static_cast<quint32>(stringsCount)) return -1;
+    const StringRecord & record = strings[id];
+    if (static_cast<qint64>(record.offset) + record.length > charsCount) return -1;
+    QString indexPath = QString::fromRawData(chars + record.offset, static_cast<int>(record.length));
+    return indexPath.compare(path);
+}
+
+int ProjectIndex::findFilePosition(QString path)
+{
+    // files are sorted by path
+    int lo = 0, hi = filesCount;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (compareFilePath(mid, path) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+int ProjectIndex::findFile(QString path)
+{
+    if (overlay != nullptr) {
+        int position = overlay->findFilePosition(path);
+        if (position < overlay->filesCount && overlay->compareFilePath(position, path) == 0) {
+            if (overlay->isFileRemoved(position)) return -1;
+            return overlayFileIndex(position);
+        }
+    }
+    int position = findFilePosition(path);
+    if (position < filesCount && compareFilePath(position, path) == 0 && !isFileRemoved(position)) return position;
+    return -1;
+}
+
+QStringList ProjectIndex::getDirectoryFiles(QString dir)
+{
+    // direct children only, files of subdirectories are skipped
+    QStringList paths;
+    QString prefix = dir + "/";
+    for (int i=findFilePosition(prefix); i<filesCount; i++) {
+        QString path = getString(files[i].path);
+        if (!path.startsWith(prefix)) break;
+        if (path.indexOf("/", prefix.size()) >= 0) continue;
+        if (isFileRemoved(i) || shadowedFiles.contains(i)) continue;
+        paths.append(path);
+    }
+    if (overlay != nullptr) paths.append(overlay->getDirectoryFiles(dir));
+    return paths;
+}
+
+QStringList ProjectIndex::getDirectoryFilesRecursive(QString dir)
+{
+    // files of a directory and its subdirectories are stored in a row
+    QStringList paths;
+    QString prefix = dir + "/";
+    for (int i=findFilePosition(prefix); i<filesCount; i++) {
+        QString path = getString(files[i].path);
+        if (!path.startsWith(prefix)) break;
+        if (isFileRemoved(i) || shadowedFiles.contains(i)) continue;
+        paths.append(path);
+    }
+    if (overlay != nullptr) paths.append(overlay->getDirectoryFilesRecursive(dir));
+    return paths;
+}
+
+QStringList ProjectIndex::getDirectorySubdirs(QString dir)
+{
+    // direct subdirectories, that have indexed files
+    QStringList paths;
+    QString prefix = dir + "/";
+    for (int i=findFilePosition(prefix); i<filesCount; i++) {
+        QString path = getString(files[i].path);
+        if (!path.startsWith(prefix)) break;
+        int pos = path.indexOf("/", prefix.size());
+        if (pos < 0 || isFileRemoved(i) || shadowedFiles.contains(i)) continue;
+        QString subdir = path.left(pos);
+        if (paths.size() == 0 || paths.last() != subdir) paths.append(subdir);
+    }
+    if (overlay != nullptr) paths.append(overlay->getDirectorySubdirs(dir));
+    paths.removeDuplicates();
+    return paths;
+}
+
+QString ProjectIndex::getFilePath(int index)
+{
+    if (overlay != nullptr && index >= filesCount) return overlay->getFilePath(index - filesCount);
+    if (index < 0 || index >= filesCount || isFileRemoved(index) || shadowedFiles.contains(index)) return "";
+    return getString(files[index].path);
+}
+
+qint64 ProjectIndex::getFileLastModified(int index)
+{
+    if (overlay != nullptr && index >= filesCount) return overlay->getFileLastModified(index - filesCount);
+    if (index < 0 || index >= filesCount) return 0;
+    return files[index].lastModified;
+}
+
+int ProjectIndex::getConstantsCount()
+{
+    int count = 0;
+    getSection(SECTION_CONSTANTS, count);
+    if (overlay != nullptr) count += overlay->getConstantsCount();
+    return count;
+}
+
+int ProjectIndex::getConstantFile(int index)
+{
+    int count = 0;
+    const ConstantRecord * records = static_cast<const ConstantRecord *>(getSection(SECTION_CONSTANTS, count));
+    if (overlay != nullptr && index >= count) return overlayFileIndex(overlay->getConstantFile(index - count));
+    if (index < 0 || index >= count) return -1;
+    return baseFileIndex(records[index].file);
+}
+
+QVariantMap ProjectIndex::getConstant(int index)
+{
+    int count = 0;
+    const ConstantRecord * records = static_cast<const ConstantRecord *>(getSection(SECTION_CONSTANTS, count));
+    if (overlay != nullptr && index >= count) return overlay->getConstant(index - count);
+    if (index < 0 || index >= count) return QVariantMap();
+    return constantToMap(records[index]);
+}
+
+int ProjectIndex::getGlobalsCount()
+{
+    int count = 0;
+    getSection(SECTION_GLOBALS, count);
+    if (overlay != nullptr) count += overlay->getGlobalsCount();
+    return count;
+}
+
+int ProjectIndex::getGlobalFile(int index)
+{
+    int count = 0;
+    const VariableRecord * records = static_cast<const VariableRecord *>(getSection(SECTION_GLOBALS, count));
+    if (overlay != nullptr && index >= count) return overlayFileIndex(overlay->getGlobalFile(index - count));
+    if (index < 0 || index >= count) return -1;
+    return baseFileIndex(records[index].file);
+}
+
+QVariantMap ProjectIndex::getGlobal(int index)
+{
+    int count = 0;
+    const VariableRecord * records = static_cast<const VariableRecord *>(getSection(SECTION_GLOBALS, count));
+    if (overlay != nullptr && index >= count) return overlay->getGlobal(index - count);
+    if (index < 0 || index >= count) return QVariantMap();
+    return variableToMap(records[index]);
+}
+
+int ProjectIndex::getFunctionsCount()
+{
+    int count = 0;
+    getSection(SECTION_FUNCTIONS, count);
+    if (overlay != nullptr) count += overlay->getFunctionsCount();
+    return count;
+}
+
+int ProjectIndex::getFunctionFile(int index)
+{
+    int count = 0;
+    const FunctionRecord * records = static_cast<const FunctionRecord *>(getSection(SECTION_FUNCTIONS, count));
+    if (overlay != nullptr && index >= count) return overlayFileIndex(overlay->getFunctionFile(index - count));
+    if (index < 0 || index >= count) return -1;
+    return baseFileIndex(records[index].file);
+}
+
+QVariantMap ProjectIndex::getFunction(int index)
+{
+    int count = 0;
+    const FunctionRecord * records = static_cast<const FunctionRecord *>(getSection(SECTION_FUNCTIONS, count));
+    if (overlay != nullptr && index >= count) return overlay->getFunction(index - count);
+    if (index < 0 || index >= count) return QVariantMap();
+    return functionToMap(records[index]);
+}
+
+int ProjectIndex::getClassesCount()
+{
+    int count = 0;
+    getSection(SECTION_CLASSES, count);
+    if (overlay != nullptr) count += overlay->getClassesCount();
+    return count;
+}
+
+int ProjectIndex::getClassFile(int index)
+{
+    int count = 0;
+    const ClassRecord * records = static_cast<const ClassRecord *>(getSection(SECTION_CLASSES, count));
+    if (overlay != nullptr && index >= count) return overlayFileIndex(overlay->getClassFile(index - count));
+    if (index < 0 || index >= count) return -1;
+    return baseFileIndex(records[index].file);
+}
+
+QVariantMap ProjectIndex::getClass(int index)
+{
+    int count = 0;
+    const ClassRecord * records = static_cast<const ClassRecord *>(getSection(SECTION_CLASSES, count));
+    if (overlay != nullptr && index >= count) return overlay->getClass(index - count);
+    if (index < 0 || index >= count) return QVariantMap();
+    const ClassRecord & record = records[index];
+
+    QVariantMap map;
+    map.insert("name", getString(record.name));
+    map.insert("parent", getString(record.parent));
+    map.insert("isInterface", (record.flags & CLASS_FLAG_INTERFACE) != 0);
+    map.insert("isTrait", (record.flags & CLASS_FLAG_TRAIT) != 0);
+    map.insert("line", record.line);
+    map.insert("isAbstract", (record.flags & CLASS_FLAG_ABSTRACT) != 0);
+    map.insert("file", getFileString(record.file));
+
+    int interfacesCount = 0;
+    const quint32 * interfaces = static_cast<const quint32 *>(getSection(SECTION_CLASS_INTERFACES, interfacesCount));
+    QVariantMap interfacesMap;
+    for (quint32 i=0; i<record.interfacesCount; i++) {
+        quint32 y = record.interfacesStart + i;
+        if (y >= static_cast<quint32>(interfacesCount)) break;
+        interfacesMap.insert(QString::number(i), getString(interfaces[y]));
+    }
+    map.insert("interfaces", QVariant(interfacesMap));
+
+    int constantsCount = 0;
+    const ConstantRecord * constants = static_cast<const ConstantRecord *>(getSection(SECTION_CLASS_CONSTANTS, constantsCount));
+    QVariantMap constantsMap;
+    for (quint32 i=0; i<record.constantsCount; i++) {
+        quint32 y = record.constantsStart + i;
+        if (y >= static_cast<quint32>(constantsCount)) break;
+        QVariantMap constantData = constantToMap(constants[y]);
+        constantsMap.insert(constantData.value("name").toString(), QVariant(constantData));
+    }
+    map.insert("constants", QVariant(constantsMap));
+
+    int propertiesCount = 0;
+    const VariableRecord * properties = static_cast<const VariableRecord *>(getSection(SECTION_CLASS_PROPERTIES, propertiesCount));
+    QVariantMap propertiesMap;
+    for (quint32 i=0; i<record.propertiesCount; i++) {
+        quint32 y = record.propertiesStart + i;
+        if (y >= static_cast<quint32>(propertiesCount)) break;
+        QVariantMap propertyData = variableToMap(properties[y]);
+        propertiesMap.insert(propertyData.value("name").toString(), QVariant(propertyData));
+    }
+    map.insert("properties", QVariant(propertiesMap));
+
+    int methodsCount = 0;
+    const FunctionRecord * methods = static_cast<const FunctionRecord *>(getSection(SECTION_CLASS_METHODS, methodsCount));
+    QVariantMap methodsMap;
+    for (quint32 i=0; i<record.methodsCount; i++) {
+        quint32 y = record.methodsStart + i;
+        if (y >= static_cast<quint32>(methodsCount)) break;
+        QVariantMap methodData = functionToMap(methods[y]);
+        methodsMap.insert(methodData.value("name").toString(), QVariant(methodData));
+    }
+    map.insert("methods", QVariant(methodsMap));
+
+    return map;
+}
+
+QVariantMap ProjectIndex::constantToMap(const ConstantRecord & record)
+{
+    QVariantMap map;
+    map.insert("name", getString(record.name));
+    map.insert("value", getString(record.value));
+    map.insert("line", record.line);
+    map.insert("file", getFileString(record.file));
+    return map;
+}
+
+QVariantMap ProjectIndex::variableToMap(const VariableRecord & record)
+{
+    QVariantMap map;
+    map.insert("name", getString(record.name));
+    map.insert("type", getString(record.type));
+    map.insert("line", record.line);
+    map.insert("visibility", getString(record.visibility));
+    map.insert("file", getFileString(record.file));
+    return map;
+}
+
+QVariantMap ProjectIndex::functionToMap(const FunctionRecord & record)
+{
+    QVariantMap map;
+    map.insert("name", getString(record.name));
+    map.insert("args", getString(record.args));
+    map.insert("synopsis", getString(record.synopsis));
+    map.insert("return_type", getString(record.returnType));
+    map.insert("line", record.line);
+    map.insert("comment", getString(record.comment));
+    map.insert("isStatic", (record.flags & FUNCTION_FLAG_STATIC) != 0);
+    map.insert("isAbstract", (record.flags & FUNCTION_FLAG_ABSTRACT) != 0);
+    map.insert("visibility", getString(record.visibility));
+    map.insert("file", getFileString(record.file));
+    return map;
+}
+
+quint32 ProjectIndex::addString(QString str, Builder & builder)
+{
+    QHash<QString, quint32>::const_iterator it = builder.ids.constFind(str);
+    if (it != builder.ids.constEnd()) return it.value();
+    StringRecord record;
+    record.offset = static_cast<quint32>(builder.chars.size());
+    record.length = static_cast<quint32>(str.size());
+    for (int i=0; i<str.size(); i++) {
+        builder.chars.append(str.at(i));
+    }
+    quint32 id = static_cast<quint32>(builder.strings.size());
+    builder.strings.append(record);
+    builder.ids.insert(str, id);
+    return id;
+}
+
+quint32 ProjectIndex::copyString(quint32 id, Builder & builder)
+{
+    // equal strings of the old pool are merged
+    if (id >= static_cast<quint32>(builder.stringIdsMap.size())) return addString(getString(id), builder);
+    quint32 newId = builder.stringIdsMap.at(static_cast<int>(id));
+    if (newId != STRING_ID_UNMAPPED) return newId;
+    newId = addString(getString(id), builder);
+    builder.stringIdsMap[static_cast<int>(id)] = newId;
+    return newId;
+}
+
+void ProjectIndex::copyStrings(ConstantRecord & record, Builder & builder)
+{
+    record.name = copyString(record.name, builder);
+    record.value = copyString(record.value, builder);
+}
+
+void ProjectIndex::copyStrings(VariableRecord & record, Builder & builder)
+{
+    record.name = copyString(record.name, builder);
+    record.type = copyString(record.type, builder);
+    record.visibility = copyString(record.visibility, builder);
+}
+
+void ProjectIndex::copyStrings(FunctionRecord & record, Builder & builder)
+{
+    record.name = copyString(record.name, builder);
+    record.args = copyString(record.args, builder);
+    record.synopsis = copyString(record.synopsis, builder);
+    record.returnType = copyString(record.returnType, builder);
+    record.comment = copyString(record.comment, builder);
+    record.visibility = copyString(record.visibility, builder);
+}
+
+quint32 ProjectIndex::fileId(QString path, Builder & builder)
+{
+    QHash<QString, quint32>::const_iterator it = builder.fileIds.constFind(path);
+    if (it != builder.fileIds.constEnd()) return it.value();
+    // unknown files are never considered as not modified
+    return FILE_ID_UNKNOWN;
+}
+
+ProjectIndex::ConstantRecord ProjectIndex::createConstantRecord(QVariantMap & data, Builder & builder)
+{
+    ConstantRecord record;
+    record.name = addString(data.value("name").toString(), builder);
+    record.value = addString(data.value("value").toString(), builder);
+    record.file = fileId(data.value("file").toString(), builder);
+    record.line = data.value("line").toInt();
+    return record;
+}
+
+ProjectIndex::VariableRecord ProjectIndex::createVariableRecord(QVariantMap & data, Builder & builder)
+{
+    VariableRecord record;
+    record.name = addString(data.value("name").toString(), builder);
+    record.type = addString(data.value("type").toString(), builder);
+    record.visibility = addString(data.value("visibility").toString(), builder);
+    record.file = fileId(data.value("file").toString(), builder);
+    record.line = data.value("line").toInt();
+    return record;
+}
+
+ProjectIndex::FunctionRecord ProjectIndex::createFunctionRecord(QVariantMap & data, Builder & builder)
+{
+    FunctionRecord record;
+    record.name = addString(data.value("name").toString(), builder);
+    record.args = addString(data.value("args").toString(), builder);
+    record.synopsis = addString(data.value("synopsis").toString(), builder);
+    record.returnType = addString(data.value("return_type").toString(), builder);
+    record.comment = addString(data.value("comment").toString(), builder);
+    record.visibility = addString(data.value("visibility").toString(), builder);
+    record.file = fileId(data.value("file").toString(), builder);
+    record.line = data.value("line").toInt();
+    record.flags = 0;
+    if (data.value("isStatic").toBool()) record.flags |= FUNCTION_FLAG_STATIC;
+    if (data.value("isAbstract").toBool()) record.flags |= FUNCTION_FLAG_ABSTRACT;
+    return record;
+}
+
+ProjectIndex::ClassRecord ProjectIndex::createClassRecord(QVariantMap & data, Builder & builder)
+{
+    ClassRecord record;
+    record.name = addString(data.value("name").toString(), builder);
+    record.parent = addString(data.value("parent").toString(), builder);
+    record.file = fileId(data.value("file").toString(), builder);
+    record.line = data.value("line").toInt();
+    record.flags = 0;
+    if (data.value("isAbstract").toBool()) record.flags |= CLASS_FLAG_ABSTRACT;
+    if (data.value("isInterface").toBool()) record.flags |= CLASS_FLAG_INTERFACE;
+    if (data.value("isTrait").toBool()) record.flags |= CLASS_FLAG_TRAIT;
+
+    QVariantMap interfaces = qvariant_cast<QVariantMap>(data.value("interfaces"));
+    record.interfacesStart = static_cast<quint32>(builder.classInterfaces.size());
+    record.interfacesCount = static_cast<quint32>(interfaces.size());
+    for (int i=0; i<interfaces.size(); i++) {
+        builder.classInterfaces.append(addString(interfaces.value(QString::number(i)).toString(), builder));
+    }
+
+    QVariantMap cls_consts = qvariant_cast<QVariantMap>(data.value("constants"));
+    record.constantsStart = static_cast<quint32>(builder.classConstants.size());
+    record.constantsCount = static_cast<quint32>(cls_consts.size());
+    for (auto kc : cls_consts.keys()) {
+        QVariantMap m = qvariant_cast<QVariantMap>(cls_consts.value(kc));
+        builder.classConstants.append(createConstantRecord(m, builder));
+    }
+
+    QVariantMap cls_props = qvariant_cast<QVariantMap>(data.value("properties"));
+    record.propertiesStart = static_cast<quint32>(builder.classProperties.size());
+    record.propertiesCount = static_cast<quint32>(cls_props.size());
+    for (auto kv : cls_props.keys()) {
+        QVariantMap m = qvariant_cast<QVariantMap>(cls_props.value(kv));
+        builder.classProperties.append(createVariableRecord(m, builder));
+    }
+
+    QVariantMap cls_methods = qvariant_cast<QVariantMap>(data.value("methods"));
+    record.methodsStart = static_cast<quint32>(builder.classMethods.size());
+    record.methodsCount = static_cast<quint32>(cls_methods.size());
+    for (auto km : cls_methods.keys()) {
+        QVariantMap m = qvariant_cast<QVariantMap>(cls_methods.value(km));
+        builder.classMethods.append(createFunctionRecord(m, builder));
+    }
+
+    return record;
+}
+
+void ProjectIndex::addRecords(QVariantMap & map, Builder & builder)
+{
+    // consts
+    QVariantMap php_consts = qvariant_cast<QVariantMap>(map.value("php_consts"));
+    for (auto k : php_consts.keys()) {
+        QVariantMap m = qvariant_cast<QVariantMap>(php_consts.value(k));
+        builder.constants.append(createConstantRecord(m, builder));
+    }
+    // variables
+    QVariantMap php_globals = qvariant_cast<QVariantMap>(map.value("php_globals"));
+    for (auto k : php_globals.keys()) {
+        QVariantMap m = qvariant_cast<QVariantMap>(php_globals.value(k));
+        builder.globals.append(createVariableRecord(m, builder));
+    }
+    // functions
+    QVariantMap php_functions = qvariant_cast<QVariantMap>(map.value("php_functions"));
+    for (auto k : php_functions.keys()) {
+        QVariantMap m = qvariant_cast<QVariantMap>(php_functions.value(k));
+        builder.functions.append(createFunctionRecord(m, builder));
+    }
+    // classes
+    QVariantMap php_classes = qvariant_cast<QVariantMap>(map.value("php_classes"));
+    for (auto k : php_classes.keys()) {
+        QVariantMap m = qvariant_cast<QVariantMap>(php_classes.value(k));
+        builder.classes.append(createClassRecord(m, builder));
+    }
+}
+
+void ProjectIndex::appendSection(QByteArray & data, Header & header, Section section, const void * records, int count, int recordSize)
+{
+    while (data.size() % PROJECT_INDEX_ALIGNMENT != 0) data.append('\0');
+    header.sections[section].offset = static_cast<quint32>(data.size());
+    header.sections[section].count = static_cast<quint32>(count);
+    if (count > 0) data.append(static_cast<const char *>(records), count * recordSize);
+}
+
+bool ProjectIndex::write(QString filename, Builder & builder)
+{
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, PROJECT_INDEX_MAGIC, sizeof(PROJECT_INDEX_MAGIC));
+    header.version = PROJECT_INDEX_VERSION;
+    header.byteOrder = PROJECT_INDEX_BYTE_ORDER;
+    header.sectionsCount = SECTIONS_COUNT;
+
+    QByteArray data(sizeof(Header), '\0');
+    appendSection(data, header, SECTION_STRINGS, builder.strings.constData(), builder.strings.size(), sizeof(StringRecord));
+    appendSection(data, header, SECTION_CHARS, builder.chars.constData(), builder.chars.size(), sizeof(QChar));
+    appendSection(data, header, SECTION_FILES, builder.files.constData(), builder.files.size(), sizeof(FileRecord));
+    appendSection(data, header, SECTION_CONSTANTS, builder.constants.constData(), builder.constants.size(), sizeof(ConstantRecord));
+    appendSection(data, header, SECTION_GLOBALS, builder.globals.constData(), builder.globals.size(), sizeof(VariableRecord));
+    appendSection(data, header, SECTION_FUNCTIONS, builder.functions.constData(), builder.functions.size(), sizeof(FunctionRecord));
+    appendSection(data, header, SECTION_CLASSES, builder.classes.constData(), builder.classes.size(), sizeof(ClassRecord));
+    appendSection(data, header, SECTION_CLASS_CONSTANTS, builder.classConstants.constData(), builder.classConstants.size(), sizeof(ConstantRecord));
+    appendSection(data, header, SECTION_CLASS_PROPERTIES, builder.classProperties.constData(), builder.classProperties.size(), sizeof(VariableRecord));
+    appendSection(data, header, SECTION_CLASS_METHODS, builder.classMethods.constData(), builder.classMethods.size(), sizeof(FunctionRecord));
+    appendSection(data, header, SECTION_CLASS_INTERFACES, builder.classInterfaces.constData(), builder.classInterfaces.size(), sizeof(quint32));
+    std::memcpy(data.data(), &header, sizeof(Header));
+
+    QSaveFile outputFile(filename);
+    if (!outputFile.open(QIODevice::WriteOnly)) return false;
+    if (outputFile.write(data) != data.size()) {
+        outputFile.cancelWriting();
+        return false;
+    }
+    return outputFile.commit();
+}
+
+void ProjectIndex::addFiles(QVariantMap & map, QStringList removedPaths, Builder & builder)
+{
+    QVariantMap php_files = qvariant_cast<QVariantMap>(map.value("php_files"));
+    QStringList paths = php_files.keys() + removedPaths;
+    paths.sort();
+    for (int i=0; i<paths.size(); i++) {
+        QString path = paths.at(i);
+        FileRecord record;
+        record.path = addString(path, builder);
+        // removed files are kept in overlay to hide their old records
+        record.reserved = php_files.contains(path) ? 0 : FILE_FLAG_REMOVED;
+        record.lastModified = php_files.value(path).toString().toLongLong();
+        builder.fileIds.insert(path, static_cast<quint32>(builder.files.size()));
+        builder.files.append(record);
+    }
+}
+
+bool ProjectIndex::save(QString filename, QVariantMap & map)
+{
+    Builder builder;
+    addFiles(map, QStringList(), builder);
+    addRecords(map, builder);
+    if (!write(filename, builder)) return false;
+    QString overlayFilename = filename + PROJECT_INDEX_OVERLAY_SUFFIX;
+    if (QFileInfo::exists(overlayFilename)) QFile::remove(overlayFilename);
+    return true;
+}
+
+bool ProjectIndex::update(QString filename, QStringList paths, QVariantMap & map)
+{
+    if (data == nullptr) return false;
+    // changed files are written to overlay, so that the index is not rewritten on each save
+    paths.sort();
+    paths.removeDuplicates();
+    QVariantMap overlayMap = map;
+    QStringList overlayPaths = paths;
+    if (overlay != nullptr) overlay->appendOverlayRecords(overlayPaths, overlayMap);
+    if (overlayPaths.size() > PROJECT_INDEX_OVERLAY_MAX_FILES) return rebuild(filename, overlayPaths, overlayMap);
+    QVariantMap php_files = qvariant_cast<QVariantMap>(overlayMap.value("php_files"));
+    QStringList removedPaths;
+    for (int i=0; i<overlayPaths.size(); i++) {
+        QString path = overlayPaths.at(i);
+        if (php_files.contains(path)) continue;
+        int position = findFilePosition(path);
+        if (position < filesCount && compareFilePath(position, path) == 0) removedPaths.append(path);
+    }
+    Builder builder;
+    addFiles(overlayMap, removedPaths, builder);
+    addRecords(overlayMap, builder);
+    // overlay should be unmapped before it is replaced
+    close();
+    return write(filename + PROJECT_INDEX_OVERLAY_SUFFIX, builder);
+}
+
+void ProjectIndex::appendOverlayRecords(QStringList & paths, QVariantMap & map)
+{
+    // records of files that are not changed again are kept, newer records take precedence
+    QVariantMap php_files = qvariant_cast<QVariantMap>(map.value("php_files"));
+    QVariantMap php_consts = qvariant_cast<QVariantMap>(map.value("php_consts"));
+    QVariantMap php_globals = qvariant_cast<QVariantMap>(map.value("php_globals"));
+    QVariantMap php_functions = qvariant_cast<QVariantMap>(map.value("php_functions"));
+    QVariantMap php_classes = qvariant_cast<QVariantMap>(map.value("php_classes"));
+    QVector<bool> keptFiles(filesCount, false);
+    QStringList keptPaths;
+    for (int i=0; i<filesCount; i++) {
+        QString path = getString(files[i].path);
+        if (std::binary_search(paths.constBegin(), paths.constEnd(), path)) continue;
+        keptPaths.append(path);
+        if (isFileRemoved(i)) continue;
+        keptFiles[i] = true;
+        php_files.insert(path, QVariant(QString::number(files[i].lastModified)));
+    }
+    for (int i=0; i<getConstantsCount(); i++) {
+        int fileIndex = getConstantFile(i);
+        if (fileIndex < 0 || !keptFiles.at(fileIndex)) continue;
+        QVariantMap m = getConstant(i);
+        if (!php_consts.contains(m.value("name").toString())) php_consts.insert(m.value("name").toString(), m);
+    }
+    for (int i=0; i<getGlobalsCount(); i++) {
+        int fileIndex = getGlobalFile(i);
+        if (fileIndex < 0 || !keptFiles.at(fileIndex)) continue;
+        QVariantMap m = getGlobal(i);
+        if (!php_globals.contains(m.value("name").toString())) php_globals.insert(m.value("name").toString(), m);
+    }
+    for (int i=0; i<getFunctionsCount(); i++) {
+        int fileIndex = getFunctionFile(i);
+        if (fileIndex < 0 || !keptFiles.at(fileIndex)) continue;
+        QVariantMap m = getFunction(i);
+        if (!php_functions.contains(m.value("name").toString())) php_functions.insert(m.value("name").toString(), m);
+    }
+    for (int i=0; i<getClassesCount(); i++) {
+        int fileIndex = getClassFile(i);
+        if (fileIndex < 0 || !keptFiles.at(fileIndex)) continue;
+        QVariantMap m = getClass(i);
+        if (!php_classes.contains(m.value("name").toString())) php_classes.insert(m.value("name").toString(), m);
+    }
+    map.insert("php_files", QVariant(php_files));
+    map.insert("php_consts", QVariant(php_consts));
+    map.insert("php_globals", QVariant(php_globals));
+    map.insert("php_functions", QVariant(php_functions));
+    map.insert("php_classes", QVariant(php_classes));
+    paths.append(keptPaths);
+    paths.sort();
+}
+
+bool ProjectIndex::rebuild(QString filename, QStringList paths, QVariantMap & map)
+{
+    // overlay is merged into the index when it grows
+    Builder builder;
+
+    // only strings of kept records are copied, so that removed strings never pile up
+    builder.ids.reserve(stringsCount);
+    builder.chars.reserve(charsCount);
+    builder.stringIdsMap.fill(STRING_ID_UNMAPPED, stringsCount);
+
+    // files are kept sorted by path, deleted files are dropped
+    QVariantMap php_files = qvariant_cast<QVariantMap>(map.value("php_files"));
+    paths.sort();
+    paths.removeDuplicates();
+    QVector<quint32> fileIdsMap(filesCount);
+    int u = 0;
+    for (int i=0; i<filesCount; i++) {
+        while (u < paths.size() && compareFilePath(i, paths.at(u)) > 0) {
+            appendFile(paths.at(u), php_files, builder);
+            u++;
+        }
+        if (u < paths.size() && compareFilePath(i, paths.at(u)) == 0) {
+            fileIdsMap[i] = FILE_ID_REMOVED;
+            continue;
+        }
+        fileIdsMap[i] = static_cast<quint32>(builder.files.size());
+        FileRecord record = files[i];
+        record.path = copyString(record.path, builder);
+        builder.files.append(record);
+    }
+    while (u < paths.size()) {
+        appendFile(paths.at(u), php_files, builder);
+        u++;
+    }
+
+    // records of other files are copied
+    int constantsCount = 0;
+    const ConstantRecord * constants = static_cast<const ConstantRecord *>(getSection(SECTION_CONSTANTS, constantsCount));
+    for (int i=0; i<constantsCount; i++) {
+        ConstantRecord record = constants[i];
+        record.file = remapFileId(record.file, fileIdsMap);
+        if (record.file == FILE_ID_REMOVED) continue;
+        copyStrings(record, builder);
+        builder.constants.append(record);
+    }
+    int globalsCount = 0;
+    const VariableRecord * globals = static_cast<const VariableRecord *>(getSection(SECTION_GLOBALS, globalsCount));
+    for (int i=0; i<globalsCount; i++) {
+        VariableRecord record = globals[i];
+        record.file = remapFileId(record.file, fileIdsMap);
+        if (record.file == FILE_ID_REMOVED) continue;
+        copyStrings(record, builder);
+        builder.globals.append(record);
+    }
+    int functionsCount = 0;
+    const FunctionRecord * functions = static_cast<const FunctionRecord *>(getSection(SECTION_FUNCTIONS, functionsCount));
+    for (int i=0; i<functionsCount; i++) {
+        FunctionRecord record = functions[i];
+        record.file = remapFileId(record.file, fileIdsMap);
+        if (record.file == FILE_ID_REMOVED) continue;
+        copyStrings(record, builder);
+        builder.functions.append(record);
+    }
+    int classesCount = 0, interfacesCount = 0, classConstantsCount = 0, classPropertiesCount = 0, classMethodsCount = 0;
+    const ClassRecord * classes = static_cast<const ClassRecord *>(getSection(SECTION_CLASSES, classesCount));
+    const quint32 * interfaces = static_cast<const quint32 *>(getSection(SECTION_CLASS_INTERFACES, interfacesCount));
+    const ConstantRecord * classConstants = static_cast<const ConstantRecord *>(getSection(SECTION_CLASS_CONSTANTS, classConstantsCount));
+    const VariableRecord * classProperties = static_cast<const VariableRecord *>(getSection(SECTION_CLASS_PROPERTIES, classPropertiesCount));
+    const FunctionRecord * classMethods = static_cast<const FunctionRecord *>(getSection(SECTION_CLASS_METHODS, classMethodsCount));
+    for (int i=0; i<classesCount; i++) {
+        ClassRecord record = classes[i];
+        record.file = remapFileId(record.file, fileIdsMap);
+        if (record.file == FILE_ID_REMOVED) continue;
+        record.name = copyString(record.name, builder);
+        record.parent = copyString(record.parent, builder);
+        quint32 start = static_cast<quint32>(builder.classInterfaces.size());
+        for (quint32 y=record.interfacesStart; y<record.interfacesStart+record.interfacesCount && y<static_cast<quint32>(interfacesCount); y++) {
+            builder.classInterfaces.append(copyString(interfaces[y], builder));
+        }
+        record.interfacesStart = start;
+        record.interfacesCount = static_cast<quint32>(builder.classInterfaces.size()) - start;
+        start = static_cast<quint32>(builder.classConstants.size());
+        for (quint32 y=record.constantsStart; y<record.constantsStart+record.constantsCount && y<static_cast<quint32>(classConstantsCount); y++) {
+            ConstantRecord constantRecord = classConstants[y];
+            constantRecord.file = remapFileId(constantRecord.file, fileIdsMap);
+            copyStrings(constantRecord, builder);
+            builder.classConstants.append(constantRecord);
+        }
+        record.constantsStart = start;
+        record.constantsCount = static_cast<quint32>(builder.classConstants.size()) - start;
+        start = static_cast<quint32>(builder.classProperties.size());
+        for (quint32 y=record.propertiesStart; y<record.propertiesStart+record.propertiesCount && y<static_cast<quint32>(classPropertiesCount); y++) {
+            VariableRecord propertyRecord = classProperties[y];
+            propertyRecord.file = remapFileId(propertyRecord.file, fileIdsMap);
+            copyStrings(propertyRecord, builder);
+            builder.classProperties.append(propertyRecord);
+        }
+        record.propertiesStart = start;
+        record.propertiesCount = static_cast<quint32>(builder.classProperties.size()) - start;
+        start = static_cast<quint32>(builder.classMethods.size());
+        for (quint32 y=record.methodsStart; y<record.methodsStart+record.methodsCount && y<static_cast<quint32>(classMethodsCount); y++) {
+            FunctionRecord methodRecord = classMethods[y];
+            methodRecord.file = remapFileId(methodRecord.file, fileIdsMap);
+            copyStrings(methodRecord, builder);
+            builder.classMethods.append(methodRecord);
+        }
+        record.methodsStart = start;
+        record.methodsCount = static_cast<quint32>(builder.classMethods.size()) - start;
+        builder.classes.append(record);
+    }
+
+    // records of updated files are appended
+    addRecords(map, builder);
+
+    // index should be unmapped before it is replaced
+    close();
+    if (!write(filename, builder)) return false;
+    QFile::remove(filename + PROJECT_INDEX_OVERLAY_SUFFIX);
+    return true;
+}
+
+quint32 ProjectIndex::remapFileId(quint32 id, QVector<quint32> & fileIdsMap)
+{
+    if (id >= static_cast<quint32>(fileIdsMap.size())) return FILE_ID_UNKNOWN;
+    return fileIdsMap.at(static_cast<int>(id));
+}
+
+void ProjectIndex::appendFile(QString path, QVariantMap & php_files, Builder & builder)
+{
+    if (!php_files.contains(path)) return;
+    FileRecord record;
+    record.path = addString(path, builder);
+    record.reserved = 0;
+    record.lastModified = php_files.value(path).toString().toLongLong();
+    builder.fileIds.insert(path, static_cast<quint32>(builder.files.size()));
+    builder.files.append(record);
+}
@@ -0,0 +1,117 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "projectindexer.h"
+#include <QThread>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutexLocker>
+#include "helper.h"
+#include "workerlanes.h"
+
+ProjectIndexer::ProjectIndexer(QStringList files, std::string encoding, std::string encodingFallback):
+    files(files),
+    nextIndex(0),
+    parsedCount(0),
+    cancelled(0),
+    takeIndex(0),
+    encoding(encoding),
+    encodingFallback(encodingFallback)
+{
+    results.resize(files.size());
+    lastModifiedList.resize(files.size());
+    readyList.fill(false, files.size());
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+    // loads shared data types before workers start
+    ParsePHP parser;
+}
+
+ProjectIndexer::~ProjectIndexer()
+{
+    cancel();
+    pool.waitForDone();
+}
+
+bool ProjectIndexer::isAvailable()
+{
+    return QThread::idealThreadCount() > 1;
+}
+
+void ProjectIndexer::start()
+{
+    int tasksCount = std::min(pool.maxThreadCount(), files.size());
+    for (int i=0; i<tasksCount; i++) {
+        pool.start(new Task(this));
+    }
+}
+
+void ProjectIndexer::cancel()
+{
+    cancelled.storeRelease(1);
+}
+
+int ProjectIndexer::getParsedCount()
+{
+    return parsedCount.loadAcquire();
+}
+
+void ProjectIndexer::wait(int msecs)
+{
+    QMutexLocker locker(&mutex);
+    if (takeIndex < readyList.size() && !readyList.at(takeIndex)) {
+        readyCondition.wait(&mutex, static_cast<unsigned long>(msecs));
+    }
+}
+
+bool ProjectIndexer::takeNext(QString & file, ParsePHP::ParseResult & result, QString & lastModified)
+{
+    // results are taken in the order of files list
+    QMutexLocker locker(&mutex);
+    if (takeIndex >= readyList.size() || !readyList.at(takeIndex)) return false;
+    file = files.at(takeIndex);
+    result = results.at(takeIndex);
+    lastModified = lastModifiedList.at(takeIndex);
+    results[takeIndex] = ParsePHP::ParseResult();
+    takeIndex++;
+    return true;
+}
+
+void ProjectIndexer::run()
+{
+    ParsePHP parser;
+    while (!cancelled.loadAcquire()) {
+        int index = nextIndex.fetchAndAddOrdered(1);
+        if (index >= files.size()) break;
+        QString file = files.at(index);
+        // tab parsing and lint run first
+        WorkerLanes::yield(WORKER_LANE_INDEX, cancelled);
+        ParsePHP::ParseResult result;
+        QString lastModified = "";
+        if (Helper::fileExists(file)) {
+            QString content = Helper::loadTextFile(file, encoding, encodingFallback, true);
+            result = parser.parse(content);
+            QFileInfo fInfo(file);
+            QDateTime dt = fInfo.lastModified();
+            lastModified = QString::number(dt.toMSecsSinceEpoch());
+        }
+        QMutexLocker locker(&mutex);
+        results[index] = result;
+        lastModifiedList[index] = lastModified;
+        readyList[index] = true;
+        parsedCount.fetchAndAddOrdered(1);
+        readyCondition.wakeAll();
+    }
+}
+
+ProjectIndexer::Task::Task(ProjectIndexer * indexer): indexer(indexer)
+{
+    setAutoDelete(true);
+}
+
+void ProjectIndexer::Task::run()
+{
+    indexer->run();
+}
@@ -0,0 +1,198 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "projectwatcher.h"
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+#include "project.h"
+
+const int PROJECT_WATCH_DEBOUNCE_INTERVAL = 1000;
+const int PROJECT_WATCH_POLL_INTERVAL = 10000;
+const int PROJECT_WATCH_FULL_POLL_COUNT = 30;
+
+ProjectWatcher::ProjectWatcher(QObject *parent) : QObject(parent), watcher(nullptr), polling(false), pollCount(0)
+{
+    debounceTimer.setSingleShot(true);
+    debounceTimer.setInterval(PROJECT_WATCH_DEBOUNCE_INTERVAL);
+    connect(&debounceTimer, SIGNAL(timeout()), this, SLOT(debounceTimeout()));
+    pollTimer.setInterval(PROJECT_WATCH_POLL_INTERVAL);
+    connect(&pollTimer, SIGNAL(timeout()), this, SLOT(pollTimeout()));
+}
+
+void ProjectWatcher::watch(QString path)
+{
+    unwatch();
+    projectPath = path;
+    filter = PathFilter(path);
+    watcher = new QFileSystemWatcher(this);
+    connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+    connect(watcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+    QStringList paths;
+    paths.append(path);
+    addDirectory(path, paths);
+    addPaths(paths);
+}
+
+void ProjectWatcher::unwatch()
+{
+    debounceTimer.stop();
+    pollTimer.stop();
+    if (watcher != nullptr) {
+        watcher->deleteLater();
+        watcher = nullptr;
+    }
+    projectPath = "";
+    changedPaths.clear();
+    directoryTimes.clear();
+    polling = false;
+    pollCount = 0;
+}
+
+QString ProjectWatcher::getPath()
+{
+    return projectPath;
+}
+
+void ProjectWatcher::addDirectory(QString dir, QStringList & paths)
+{
+    // hidden and ignored directories are skipped like in project scan
+    QDirIterator it(dir, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo fInfo = it.fileInfo();
+        if (!fInfo.exists() || !fInfo.isReadable()) continue;
+        if (filter.isIgnored(path, fInfo.isDir())) continue;
+        if (fInfo.isDir()) {
+            paths.append(path);
+            addDirectory(path, paths);
+        } else if (fInfo.isFile() && Project::isProjectFile(path)) {
+            paths.append(path);
+        }
+    }
+}
+
+void ProjectWatcher::addPaths(QStringList & paths)
+{
+    if (watcher == nullptr || polling || paths.size() == 0) return;
+    QStringList failedPaths = watcher->addPaths(paths);
+    if (failedPaths.size() > 0) {
+        // watch limit reached or not supported, falling back to polling
+        watcher->deleteLater();
+        watcher = nullptr;
+        polling = true;
+        pollCount = 0;
+        directoryTimes.clear();
+        addPollDirectory(projectPath);
+        pollTimer.start();
+    }
+}
+
+void ProjectWatcher::queuePath(QString path)
+{
+    if (!changedPaths.contains(path)) changedPaths.append(path);
+    debounceTimer.start();
+}
+
+void ProjectWatcher::addPollDirectory(QString dir)
+{
+    directoryTimes.insert(dir, QFileInfo(dir).lastModified().toMSecsSinceEpoch());
+    QDirIterator it(dir, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        QString path = it.next();
+        QFileInfo fInfo = it.fileInfo();
+        if (!fInfo.exists() || !fInfo.isReadable()) continue;
+        if (filter.isIgnored(path, true)) continue;
+        addPollDirectory(path);
+    }
+}
+
+void ProjectWatcher::directoryChanged(const QString & path)
+{
+    if (watcher == nullptr) return;
+    queuePath(path);
+    // new files and directories are watched too
+    QStringList paths;
+    QSet<QString> directories = QSet<QString>::fromList(watcher->directories());
+    QSet<QString> files = QSet<QString>::fromList(watcher->files());
+    QDirIterator it(path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        QString _path = it.next();
+        QFileInfo fInfo = it.fileInfo();
+        if (!fInfo.exists() || !fInfo.isReadable()) continue;
+        if (filter.isIgnored(_path, fInfo.isDir())) continue;
+        if (fInfo.isDir() && !directories.contains(_path)) {
+            paths.append(_path);
+            addDirectory(_path, paths);
+        } else if (fInfo.isFile() && Project::isProjectFile(_path) && !files.contains(_path)) {
+            paths.append(_path);
+        }
+    }
+    addPaths(paths);
+}
+
+void ProjectWatcher::fileChanged(const QString & path)
+{
+    if (watcher == nullptr) return;
+    queuePath(path);
+    // some editors replace files, so they should be watched again
+    if (!watcher->files().contains(path) && QFileInfo(path).exists()) {
+        QStringList paths;
+        paths.append(path);
+        addPaths(paths);
+    }
+}
+
+void ProjectWatcher::debounceTimeout()
+{
+    if (projectPath.size() == 0 || changedPaths.size() == 0) return;
+    QStringList paths = changedPaths;
+    changedPaths.clear();
+    emit changesDetected(projectPath, paths);
+}
+
+void ProjectWatcher::pollTimeout()
+{
+    if (projectPath.size() == 0) return;
+    pollCount++;
+    if (pollCount >= PROJECT_WATCH_FULL_POLL_COUNT) {
+        // files modified in place do not change directory time
+        pollCount = 0;
+        // empty list means that all files should be checked
+        emit changesDetected(projectPath, QStringList());
+        return;
+    }
+    // only directories with added, removed or replaced entries are checked
+    QStringList paths;
+    QHash<QString, qint64>::iterator it = directoryTimes.begin();
+    while (it != directoryTimes.end()) {
+        QFileInfo fInfo(it.key());
+        if (!fInfo.exists()) {
+            paths.append(it.key());
+            it = directoryTimes.erase(it);
+            continue;
+        }
+        qint64 lastModified = fInfo.lastModified().toMSecsSinceEpoch();
+        if (lastModified != it.value()) {
+            paths.append(it.key());
+            it.value() = lastModified;
+        }
+        ++it;
+    }
+    for (int i=0; i<paths.size(); i++) {
+        QString path = paths.at(i);
+        if (!directoryTimes.contains(path)) continue;
+        QDirIterator dirIt(path, QDir::Dirs | QDir::NoDotAndDotDot);
+        while (dirIt.hasNext()) {
+            QString _path = dirIt.next();
+            QFileInfo fInfo = dirIt.fileInfo();
+            if (!fInfo.exists() || !fInfo.isReadable()) continue;
+            if (filter.isIgnored(_path, true) || directoryTimes.contains(_path)) continue;
+            addPollDirectory(_path);
+        }
+    }
+    if (paths.size() > 0) emit changesDetected(projectPath, paths);
+}
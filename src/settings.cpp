@@ -74,6 +74,7 @@ void Settings::initData()
         {"highlight_js_extensions", "js, dart"},
         {"highlight_css_extensions", "css, less, scss, sass"},
         {"highlight_html_extensions", "xml, iml"},
+        {"highlight_lazy_big_files", "yes"},
         {"parser_enable_php_lint", "yes"},
         {"parser_enable_php_cs", "yes"},
         {"parser_enable_parse_php", "yes"},
@@ -89,6 +90,10 @@ void Settings::initData()
         {"parser_phpcs_standard", "PSR2"},
         {"parser_phpcs_error_severity", "5"},
         {"parser_phpcs_warning_severity", "5"},
+        {"parser_enable_parallel_indexing", "yes"},
+        {"parser_enable_project_watch", "yes"},
+        {"parser_enable_ignore_files", "yes"},
+        {"parser_max_file_size", "2048"},
         {"shortcut_backtab", "Shift+Tab"},
         {"shortcut_save", "Ctrl+S"},
         {"shortcut_save_all", "Ctrl+Shift+S"},
@@ -1,7 +1,10 @@
 #include "spellchecker.h"
+#include <QMutexLocker>
 #include "settings.h"
 
-SpellChecker::SpellChecker(): spellChecker(nullptr){}
+const int SPELLCHECKER_CACHE_SIZE = 50000;
+
+SpellChecker::SpellChecker(): spellChecker(nullptr), verdicts(SPELLCHECKER_CACHE_SIZE){}
 
 SpellChecker& SpellChecker::instance()
 {
@@ -16,7 +19,43 @@ SpellCheckerInterface * SpellChecker::getSpellChecker()
 
 SpellCheckerInterface * SpellChecker::load()
 {
+    QMutexLocker locker(&mutex);
+    verdicts.clear();
     if (spellChecker != nullptr) delete spellChecker;
     spellChecker = Helper::loadSpellChecker(QString::fromStdString(Settings::get("plugins_path")));
     return spellChecker;
 }
+
+SpellChecker::Verdict * SpellChecker::findVerdict(const QString & word)
+{
+    // verdicts are shared by all tabs, the least recently used ones are removed
+    Verdict * verdict = verdicts.object(word);
+    if (verdict != nullptr) return verdict;
+    QString _word = word;
+    verdict = new Verdict();
+    verdict->correct = spellChecker->check(_word);
+    verdict->suggested = false;
+    verdicts.insert(word, verdict);
+    return verdict;
+}
+
+bool SpellChecker::check(const QString & word)
+{
+    // plugin is not thread safe, so it is called with the lock held
+    QMutexLocker locker(&mutex);
+    if (spellChecker == nullptr) return true;
+    return findVerdict(word)->correct;
+}
+
+QStringList SpellChecker::suggest(const QString & word)
+{
+    QMutexLocker locker(&mutex);
+    if (spellChecker == nullptr) return QStringList();
+    Verdict * verdict = findVerdict(word);
+    if (!verdict->suggested) {
+        QString _word = word;
+        verdict->suggestions = spellChecker->suggest(_word);
+        verdict->suggested = true;
+    }
+    return verdict->suggestions;
+}
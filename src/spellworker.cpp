@@ -0,0 +1,132 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "spellworker.h"
+#include <QMutexLocker>
+#include <QCoreApplication>
+#include "spellchecker.h"
+
+const int SPELLWORKER_TASK_BLOCKS = 100;
+const int SPELLWORKER_URGENT_PRIORITY = 1;
+
+SpellWorker::SpellWorker(): cancelled(0), running(false)
+{
+
+}
+
+SpellWorker::~SpellWorker()
+{
+    cancelled.storeRelease(1);
+    QMutexLocker locker(&mutex);
+    blocks.clear();
+    results.clear();
+    // queued task exits at once, tasks of other editors are done in slices
+    while (running) finished.wait(&mutex);
+}
+
+QThreadPool * SpellWorker::sharedPool()
+{
+    // plugin calls are serialized by the spell checker, so one thread serves all editors
+    static QThreadPool * pool = nullptr;
+    if (pool == nullptr) {
+        pool = new QThreadPool(QCoreApplication::instance());
+        pool->setMaxThreadCount(1);
+    }
+    return pool;
+}
+
+void SpellWorker::addBlocks(const QVector<Block> & snapshots, bool urgent)
+{
+    if (snapshots.size() == 0) return;
+    QMutexLocker locker(&mutex);
+    for (int i=snapshots.size()-1; i>=0 && urgent; i--) {
+        blocks.prepend(snapshots.at(i));
+    }
+    for (int i=0; i<snapshots.size() && !urgent; i++) {
+        blocks.enqueue(snapshots.at(i));
+    }
+    // task exits when the queue is empty, so it is started again for new blocks
+    if (!running) {
+        running = true;
+        sharedPool()->start(new Task(this), urgent ? SPELLWORKER_URGENT_PRIORITY : 0);
+    }
+}
+
+bool SpellWorker::takeNext(Result & result)
+{
+    QMutexLocker locker(&mutex);
+    if (results.isEmpty()) return false;
+    result = results.dequeue();
+    return true;
+}
+
+bool SpellWorker::isIdle()
+{
+    QMutexLocker locker(&mutex);
+    return !running && blocks.isEmpty() && results.isEmpty();
+}
+
+void SpellWorker::clear()
+{
+    QMutexLocker locker(&mutex);
+    blocks.clear();
+    results.clear();
+}
+
+bool SpellWorker::takeBlock(Block & block)
+{
+    QMutexLocker locker(&mutex);
+    if (cancelled.loadAcquire() || blocks.isEmpty()) {
+        running = false;
+        finished.wakeAll();
+        return false;
+    }
+    block = blocks.dequeue();
+    return true;
+}
+
+void SpellWorker::run()
+{
+    SpellChecker & spellChecker = SpellChecker::instance();
+    Block block;
+    int count = 0;
+    while (takeBlock(block)) {
+        Result result;
+        result.blockNumber = block.number;
+        result.revision = block.revision;
+        result.suggestStart = -1;
+        result.suggestEnd = -1;
+        for (int i=0; i<block.words.size(); i++) {
+            const Word & word = block.words.at(i);
+            if (cancelled.loadAcquire()) break;
+            if (spellChecker.check(word.text)) continue;
+            result.starts.append(word.start);
+            result.lengths.append(word.length);
+            if (i == block.suggestWord) {
+                result.suggestStart = word.start;
+                result.suggestEnd = word.start + word.text.size();
+                result.suggestions = spellChecker.suggest(word.text);
+            }
+        }
+        QMutexLocker locker(&mutex);
+        results.enqueue(result);
+        // pool is shared, so other editors are served between slices
+        if (++count >= SPELLWORKER_TASK_BLOCKS && !blocks.isEmpty() && !cancelled.loadAcquire()) {
+            sharedPool()->start(new Task(this));
+            return;
+        }
+    }
+}
+
+SpellWorker::Task::Task(SpellWorker * worker): worker(worker)
+{
+    setAutoDelete(true);
+}
+
+void SpellWorker::Task::run()
+{
+    worker->run();
+}
@@ -0,0 +1,50 @@
+/*******************************************
+ * Zira Editor
+ * A lightweight PHP Editor
+ * (C)2019 https://github.com/ziracms/editor
+ *******************************************/
+
+#include "workerlanes.h"
+#include <QThread>
+
+const int WORKER_LANE_INTERACTIVE = 0;
+const int WORKER_LANE_LINT = 1;
+const int WORKER_LANE_INDEX = 2;
+const int WORKER_LANE_YIELD_INTERVAL = 10;
+const int WORKER_LANE_YIELD_MAX_WAIT = 1000;
+
+QAtomicInt WorkerLanes::pending[3];
+
+void WorkerLanes::setPending(int lane, int count)
+{
+    pending[lane].storeRelease(count);
+}
+
+void WorkerLanes::acquire(int lane)
+{
+    pending[lane].fetchAndAddOrdered(1);
+}
+
+void WorkerLanes::release(int lane)
+{
+    pending[lane].fetchAndAddOrdered(-1);
+}
+
+bool WorkerLanes::hasPriorityWork(int lane)
+{
+    // lanes with lower number have higher priority
+    for (int i=0; i<lane; i++) {
+        if (pending[i].loadAcquire() > 0) return true;
+    }
+    return false;
+}
+
+void WorkerLanes::yield(int lane, QAtomicInt & cancelled)
+{
+    // background work waits between files, limited so that it is not starved while typing
+    int waited = 0;
+    while (waited < WORKER_LANE_YIELD_MAX_WAIT && !cancelled.loadAcquire() && hasPriorityWork(lane)) {
+        QThread::msleep(WORKER_LANE_YIELD_INTERVAL);
+        waited += WORKER_LANE_YIELD_INTERVAL;
+    }
+}